@@ -26,6 +26,7 @@
 
 #include "pluma-changecase-plugin.h"
 
+#include <string.h>
 #include <glib/gi18n-lib.h>
 #include <gmodule.h>
 #include <libpeas/peas-activatable.h>
@@ -66,110 +67,296 @@ typedef enum {
 	TO_TITLE_CASE,
 } ChangeCaseChoice;
 
-static void
-do_upper_case (GtkTextBuffer *buffer,
-               GtkTextIter   *start,
-               GtkTextIter   *end)
+/* The selection is converted in chunks of this many chars */
+#define CHUNK_CHARS		(64 * 1024)
+
+/* Changed runs closer than this are replaced together */
+#define MERGE_GAP_CHARS		16
+
+#define ONES			G_GUINT64_CONSTANT (0x0101010101010101)
+#define HIGH_BITS		(ONES * 0x80)
+
+/* The case mappings used below map one char to one char, so converting
+ * never changes the char offsets: only the runs of chars that actually
+ * change are replaced, keeping the marks and tags of the rest. */
+typedef struct
 {
-	GString *s = g_string_new (NULL);
+	GtkTextBuffer *buffer;
 
-	while (!gtk_text_iter_is_end (start) &&
-	       !gtk_text_iter_equal (start, end))
-	{
-		gunichar c, nc;
+	/* buffer offset of the chunk text, which may start before the
+	 * chars being converted */
+	gint           chunk_offset;
 
-		c = gtk_text_iter_get_char (start);
-		nc = g_unichar_toupper (c);
-		g_string_append_unichar (s, nc);
+	/* the converted chunk */
+	GString       *out;
 
-		gtk_text_iter_forward_char (start);
-	}
+	/* current run of changed chars (chunk char indexes), and its
+	 * converted text in out */
+	gint           run_start;
+	gint           run_end;
+	gsize          run_out_start;
+	gsize          run_out_end;
+} CaseRun;
+
+static void
+flush_run (CaseRun *r)
+{
+	GtkTextIter start, end;
 
-	gtk_text_buffer_delete_selection (buffer, TRUE, TRUE);
-	gtk_text_buffer_insert_at_cursor (buffer, s->str, s->len);
+	if (r->run_start < 0)
+		return;
+
+	gtk_text_buffer_get_iter_at_offset (r->buffer,
+					    &start,
+					    r->chunk_offset + r->run_start);
+	gtk_text_buffer_get_iter_at_offset (r->buffer,
+					    &end,
+					    r->chunk_offset + r->run_end);
+
+	gtk_text_buffer_delete (r->buffer, &start, &end);
+	gtk_text_buffer_insert (r->buffer,
+				&start,
+				r->out->str + r->run_out_start,
+				r->run_out_end - r->run_out_start);
 
-	g_string_free (s, TRUE);
+	r->run_start = -1;
 }
 
+/* n_chars chars at char index i have been appended to out from out_start */
 static void
-do_lower_case (GtkTextBuffer *buffer,
-               GtkTextIter   *start,
-               GtkTextIter   *end)
+add_to_run (CaseRun  *r,
+	    gint      i,
+	    gint      n_chars,
+	    gsize     out_start,
+	    gboolean  changed)
 {
-	GString *s = g_string_new (NULL);
+	if (!changed)
+		return;
 
-	while (!gtk_text_iter_is_end (start) &&
-	       !gtk_text_iter_equal (start, end))
+	if (r->run_start >= 0 && i - r->run_end <= MERGE_GAP_CHARS)
 	{
-		gunichar c, nc;
+		r->run_end = i + n_chars;
+		r->run_out_end = r->out->len;
+		return;
+	}
+
+	flush_run (r);
 
-		c = gtk_text_iter_get_char (start);
-		nc = g_unichar_tolower (c);
-		g_string_append_unichar (s, nc);
+	r->run_start = i;
+	r->run_end = i + n_chars;
+	r->run_out_start = out_start;
+	r->run_out_end = r->out->len;
+}
+
+/* Returns 0x80 in each byte of w (which must be ASCII) in [first, last] */
+static guint64
+ascii_in_range (guint64 w,
+		guchar  first,
+		guchar  last)
+{
+	guint64 ge_first = w + ONES * (0x80 - first);
+	guint64 gt_last = w + ONES * (0x80 - last - 1);
 
-		gtk_text_iter_forward_char (start);
+	return ge_first & ~gt_last & HIGH_BITS;
+}
+
+/* Returns the case bits to flip in the 8 ASCII chars packed in w */
+static guint64
+ascii_case_flip (ChangeCaseChoice choice,
+		 guint64          w)
+{
+	guint64 letters;
+
+	switch (choice)
+	{
+	case TO_UPPER_CASE:
+		letters = ascii_in_range (w, 'a', 'z');
+		break;
+	case TO_LOWER_CASE:
+		letters = ascii_in_range (w, 'A', 'Z');
+		break;
+	default:
+		letters = ascii_in_range (w, 'a', 'z') |
+			  ascii_in_range (w, 'A', 'Z');
+		break;
 	}
 
-	gtk_text_buffer_delete_selection (buffer, TRUE, TRUE);
-	gtk_text_buffer_insert_at_cursor (buffer, s->str, s->len);
+	/* 0x80 >> 2 is the ASCII case bit */
+	return letters >> 2;
+}
 
-	g_string_free (s, TRUE);
+static gunichar
+convert_char (ChangeCaseChoice  choice,
+	      gunichar          c,
+	      gboolean          starts_word)
+{
+	switch (choice)
+	{
+	case TO_UPPER_CASE:
+		return g_unichar_toupper (c);
+	case TO_LOWER_CASE:
+		return g_unichar_tolower (c);
+	case INVERT_CASE:
+		if (g_unichar_islower (c))
+			return g_unichar_toupper (c);
+		else
+			return g_unichar_tolower (c);
+	case TO_TITLE_CASE:
+		if (starts_word)
+			return g_unichar_totitle (c);
+		else
+			return g_unichar_tolower (c);
+	default:
+		g_return_val_if_reached (c);
+	}
 }
 
+/* Converts n_chars chars of text from char index first; the rest of
+ * text is only there for finding the word starts */
 static void
-do_invert_case (GtkTextBuffer *buffer,
-                GtkTextIter   *start,
-                GtkTextIter   *end)
+convert_chunk (CaseRun          *r,
+	       ChangeCaseChoice  choice,
+	       const gchar      *text,
+	       gsize             len,
+	       gint              first,
+	       gint              n_chars)
 {
-	GString *s = g_string_new (NULL);
+	const gchar *p;
+	const gchar *end;
+	PangoLogAttr *attrs = NULL;
+	gint i = first;
 
-	while (!gtk_text_iter_is_end (start) &&
-	       !gtk_text_iter_equal (start, end))
+	/* word starts as gtk_text_iter_starts_word() would find them */
+	if (choice == TO_TITLE_CASE)
 	{
+		gint n_attrs = g_utf8_strlen (text, len) + 1;
+
+		attrs = g_new (PangoLogAttr, n_attrs);
+		pango_get_log_attrs (text,
+				     len,
+				     -1,
+				     pango_language_get_default (),
+				     attrs,
+				     n_attrs);
+	}
+
+	p = g_utf8_offset_to_pointer (text, first);
+	end = g_utf8_offset_to_pointer (p, n_chars);
+
+	while (p < end)
+	{
+		gsize out_start = r->out->len;
 		gunichar c, nc;
 
-		c = gtk_text_iter_get_char (start);
-		if (g_unichar_islower (c))
-			nc = g_unichar_toupper (c);
-		else
-			nc = g_unichar_tolower (c);
-		g_string_append_unichar (s, nc);
+		/* ASCII fast path, 8 chars at a time */
+		if ((attrs == NULL) && (end - p >= 8))
+		{
+			guint64 w;
+			guint64 flip;
+
+			memcpy (&w, p, 8);
 
-		gtk_text_iter_forward_char (start);
+			if ((w & HIGH_BITS) == 0)
+			{
+				flip = ascii_case_flip (choice, w);
+				w ^= flip;
+
+				g_string_append_len (r->out, (const gchar *) &w, 8);
+				add_to_run (r, i, 8, out_start, flip != 0);
+
+				p += 8;
+				i += 8;
+				continue;
+			}
+		}
+
+		c = g_utf8_get_char (p);
+
+		/* never replace the placeholder of a pixbuf or child anchor */
+		if (c == GTK_TEXT_UNKNOWN_CHAR)
+			flush_run (r);
+
+		nc = convert_char (choice,
+				   c,
+				   (attrs != NULL) && attrs[i].is_word_start);
+
+		g_string_append_unichar (r->out, nc);
+		add_to_run (r, i, 1, out_start, nc != c);
+
+		p = g_utf8_next_char (p);
+		++i;
 	}
 
-	gtk_text_buffer_delete_selection (buffer, TRUE, TRUE);
-	gtk_text_buffer_insert_at_cursor (buffer, s->str, s->len);
+	flush_run (r);
 
-	g_string_free (s, TRUE);
+	g_free (attrs);
 }
 
 static void
-do_title_case (GtkTextBuffer *buffer,
-               GtkTextIter   *start,
-               GtkTextIter   *end)
+do_change_case (GtkTextBuffer    *buffer,
+		ChangeCaseChoice  choice,
+		GtkTextIter      *start,
+		GtkTextIter      *end)
 {
-	GString *s = g_string_new (NULL);
+	CaseRun r;
+	gint start_offset, end_offset;
+	gint offset;
+
+	start_offset = gtk_text_iter_get_offset (start);
+	end_offset = gtk_text_iter_get_offset (end);
+
+	r.buffer = buffer;
+	r.out = g_string_sized_new (CHUNK_CHARS);
+	r.run_start = -1;
+
+	offset = start_offset;
 
-	while (!gtk_text_iter_is_end (start) &&
-	       !gtk_text_iter_equal (start, end))
+	while (offset < end_offset)
 	{
-		gunichar c, nc;
+		GtkTextIter chunk_start, chunk_end;
+		gint chunk_end_offset;
+		gchar *slice;
 
-		c = gtk_text_iter_get_char (start);
-		if (gtk_text_iter_starts_word (start))
-			nc = g_unichar_totitle (c);
-		else
-			nc = g_unichar_tolower (c);
-		g_string_append_unichar (s, nc);
+		gtk_text_buffer_get_iter_at_offset (buffer, &chunk_start, offset);
+		gtk_text_buffer_get_iter_at_offset (buffer,
+						    &chunk_end,
+						    MIN (offset + CHUNK_CHARS, end_offset));
+
+		/* word boundaries are found per line, on the whole line even
+		 * when the selection covers only part of it */
+		if (choice == TO_TITLE_CASE)
+		{
+			gtk_text_iter_set_line_offset (&chunk_start, 0);
+
+			if (!gtk_text_iter_ends_line (&chunk_end))
+				gtk_text_iter_forward_to_line_end (&chunk_end);
+		}
+
+		chunk_end_offset = MIN (gtk_text_iter_get_offset (&chunk_end), end_offset);
+
+		slice = gtk_text_buffer_get_slice (buffer, &chunk_start, &chunk_end, TRUE);
 
-		gtk_text_iter_forward_char (start);
+		r.chunk_offset = gtk_text_iter_get_offset (&chunk_start);
+		g_string_truncate (r.out, 0);
+
+		convert_chunk (&r,
+			       choice,
+			       slice,
+			       strlen (slice),
+			       offset - r.chunk_offset,
+			       chunk_end_offset - offset);
+
+		g_free (slice);
+
+		offset = chunk_end_offset;
 	}
 
-	gtk_text_buffer_delete_selection (buffer, TRUE, TRUE);
-	gtk_text_buffer_insert_at_cursor (buffer, s->str, s->len);
+	g_string_free (r.out, TRUE);
 
-	g_string_free (s, TRUE);
+	/* the char offsets did not change, select the converted text again */
+	gtk_text_buffer_get_iter_at_offset (buffer, start, start_offset);
+	gtk_text_buffer_get_iter_at_offset (buffer, end, end_offset);
+	gtk_text_buffer_select_range (buffer, start, end);
 }
 
 static void
@@ -192,23 +379,7 @@ change_case (PlumaWindow      *window,
 
 	gtk_text_buffer_begin_user_action (GTK_TEXT_BUFFER (doc));
 
-	switch (choice)
-	{
-	case TO_UPPER_CASE:
-		do_upper_case (GTK_TEXT_BUFFER (doc), &start, &end);
-		break;
-	case TO_LOWER_CASE:
-		do_lower_case (GTK_TEXT_BUFFER (doc), &start, &end);
-		break;
-	case INVERT_CASE:
-		do_invert_case (GTK_TEXT_BUFFER (doc), &start, &end);
-		break;
-	case TO_TITLE_CASE:
-		do_title_case (GTK_TEXT_BUFFER (doc), &start, &end);
-		break;
-	default:
-		g_return_if_reached ();
-	}
+	do_change_case (GTK_TEXT_BUFFER (doc), choice, &start, &end);
 
 	gtk_text_buffer_end_user_action (GTK_TEXT_BUFFER (doc));
 }
@@ -32,6 +32,7 @@ class Capture(GObject.Object):
     
     WRITE_BUFFER_SIZE = 0x4000
 
+    # The std*-line signals are emitted with one or more complete lines
     __gsignals__ = {
         'stdout-line'  : (GObject.SignalFlags.RUN_LAST, GObject.TYPE_NONE, (GObject.TYPE_STRING,)),
         'stderr-line'  : (GObject.SignalFlags.RUN_LAST, GObject.TYPE_NONE, (GObject.TYPE_STRING,)),
@@ -83,7 +84,7 @@ class Capture(GObject.Object):
 
         self.tried_killing = False
         self.idle_write_id = 0
-        self.read_buffer = ''
+        self.read_buffers = {}
         
         try:
             self.pipe = subprocess.Popen(self.command, **popen_args)
@@ -151,46 +152,50 @@ class Capture(GObject.Object):
 
             return False
 
+    def decode(self, text):
+        try:
+            return unicode(text, 'utf-8')
+        except:
+            return unicode(text,
+                           locale.getdefaultlocale()[1],
+                           'replace')
+
+    def emit_output(self, source, text):
+        if not self.pipe or source == self.pipe.stdout:
+            self.emit('stdout-line', text)
+        else:
+            self.emit('stderr-line', text)
+
     def on_output(self, source, condition):
+        # Each source keeps its own incomplete last line, which is kept
+        # undecoded so that multibyte characters split across two reads
+        # are decoded correctly
+        read_buffer = self.read_buffers.get(source, '')
+
         if condition & (GLib.IOCondition.IN | GLib.IOCondition.PRI):
-            line = source.read()
-
-            if len(line) > 0:
-                try:
-                    line = unicode(line, 'utf-8')
-                except:
-                    line = unicode(line,
-                                   locale.getdefaultlocale()[1],
-                                   'replace')
-
-                self.read_buffer += line
-                lines = self.read_buffer.splitlines(True)
-                
-                if not lines[-1].endswith("\n"):
-                    self.read_buffer = lines[-1]
-                    lines = lines[0:-1]
-                else:
-                    self.read_buffer = ''
-
-                for line in lines:
-                    if not self.pipe or source == self.pipe.stdout:
-                        self.emit('stdout-line', line)
-                    else:
-                        self.emit('stderr-line', line)
+            text = source.read()
 
-        if condition & ~(GLib.IOCondition.IN | GLib.IOCondition.PRI):
-            if self.read_buffer:
-                if source == self.pipe.stdout:
-                    self.emit('stdout-line', self.read_buffer)
-                else:
-                    self.emit('stderr-line', self.read_buffer)
+            if len(text) > 0:
+                read_buffer += text
+
+                # Emit all the complete lines of this read at once
+                # instead of one signal per line
+                pos = read_buffer.rfind('\n') + 1
 
-                self.read_buffer = ''
+                if pos > 0:
+                    self.emit_output(source, self.decode(read_buffer[:pos]))
+                    read_buffer = read_buffer[pos:]
+
+        if condition & ~(GLib.IOCondition.IN | GLib.IOCondition.PRI):
+            if read_buffer:
+                self.emit_output(source, self.decode(read_buffer))
 
+            self.read_buffers.pop(source, None)
             self.pipe = None
 
             return False
         else:
+            self.read_buffers[source] = read_buffer
             return True
 
     def stop(self, error_code = -1):
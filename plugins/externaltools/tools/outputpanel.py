@@ -25,7 +25,7 @@ from capture import *
 import re
 import linkparsing
 import filelookup
-from gi.repository import GLib, Gdk, Gtk, Pango, Pluma
+from gi.repository import GLib, Gio, Gdk, Gtk, Pango, Pluma
 
 class UniqueById:
     __shared_state = WeakKeyDictionary()
@@ -42,6 +42,11 @@ class UniqueById:
         return self.__class__.__shared_state
 
 class OutputPanel(UniqueById):
+    SETTINGS_SCHEMA = 'org.mate.pluma.plugins.externaltools'
+
+    # The text written to the panel is inserted at most once per frame
+    FLUSH_INTERVAL = 16
+
     def __init__(self, datadir, window):
         if UniqueById.__init__(self, window):
             return
@@ -88,6 +93,23 @@ class OutputPanel(UniqueById):
 
         self.link_parser = linkparsing.LinkParser()
         self.file_lookup = filelookup.FileLookup()
+        self.lookup_cache = {}
+
+        # Text written but not inserted yet, as [texts, tag] runs
+        self.pending = []
+        self.flush_id = 0
+
+        # Links are parsed once per complete line, the text before this
+        # offset has already been parsed
+        self.parse_offset = 0
+
+        self.max_lines = 0
+
+        if self.SETTINGS_SCHEMA in Gio.Settings.list_schemas():
+            self.settings = Gio.Settings.new(self.SETTINGS_SCHEMA)
+            self.settings.connect('changed::output-max-lines',
+                                  self.on_max_lines_changed)
+            self.on_max_lines_changed(self.settings, 'output-max-lines')
 
     def set_process(self, process):
         self.process = process
@@ -102,45 +124,95 @@ class OutputPanel(UniqueById):
                        self.italic_tag)
             self.process.stop(-1)
 
+    def on_max_lines_changed(self, settings, key):
+        self.max_lines = settings.get_int(key)
+
     def scroll_to_end(self):
         iter = self['view'].get_buffer().get_end_iter()
         self['view'].scroll_to_iter(iter, 0.0, False, 0.5, 0.5)
         return False  # don't requeue this handler
 
     def clear(self):
+        if self.flush_id != 0:
+            GLib.source_remove(self.flush_id)
+            self.flush_id = 0
+
+        self.pending = []
         self['view'].get_buffer().set_text("")
         self.links = []
+        self.lookup_cache = {}
+        self.parse_offset = 0
 
     def visible(self):
         panel = self.window.get_bottom_panel()
         return panel.props.visible and panel.item_is_active(self.panel)
 
     def write(self, text, tag = None):
+        # Consecutive writes with the same tag are inserted at once
+        if self.pending and self.pending[-1][1] is tag:
+            self.pending[-1][0].append(text)
+        else:
+            self.pending.append([[text], tag])
+
+        if self.flush_id == 0:
+            self.flush_id = GLib.timeout_add(self.FLUSH_INTERVAL,
+                                             self.on_flush_timeout)
+
+    def on_flush_timeout(self):
+        self.flush_id = 0
+        self.flush()
+
+        return False
+
+    def flush(self):
+        if not self.pending:
+            return
+
         buffer = self['view'].get_buffer()
 
+        for texts, tag in self.pending:
+            text = ''.join(texts)
+            end_iter = buffer.get_end_iter()
+
+            if tag is None:
+                buffer.insert(end_iter, text)
+            else:
+                buffer.insert_with_tags(end_iter, text, tag)
+
+        self.pending = []
+
+        self.parse_links(buffer)
+        self.trim_scrollback(buffer)
+
+        GLib.idle_add(self.scroll_to_end)
+
+    def lookup(self, path):
+        if path not in self.lookup_cache:
+            self.lookup_cache[path] = self.file_lookup.lookup(path)
+
+        return self.lookup_cache[path]
+
+    def parse_links(self, buffer):
+        # The last line may not be complete yet, it is parsed later
+        start_iter = buffer.get_iter_at_offset(self.parse_offset)
         end_iter = buffer.get_end_iter()
-        insert = buffer.create_mark(None, end_iter, True)
+        end_iter.set_line_offset(0)
 
-        if tag is None:
-            buffer.insert(end_iter, text)
-        else:
-            buffer.insert_with_tags(end_iter, text, tag)
+        if end_iter.compare(start_iter) <= 0:
+            return
+
+        text = buffer.get_text(start_iter, end_iter, True).decode('utf-8')
 
         # find all links and apply the appropriate tag for them
-        links = self.link_parser.parse(text)
-        for lnk in links:
-            
-            insert_iter = buffer.get_iter_at_mark(insert)
-            lnk.start = insert_iter.get_offset() + lnk.start
-            lnk.end = insert_iter.get_offset() + lnk.end
-            
+        for lnk in self.link_parser.parse(text):
+            lnk.start += self.parse_offset
+            lnk.end += self.parse_offset
+
             start_iter = buffer.get_iter_at_offset(lnk.start)
             end_iter = buffer.get_iter_at_offset(lnk.end)
 
-            tag = None
-
             # if the link points to an existing file then it is a valid link
-            if self.file_lookup.lookup(lnk.path) is not None:
+            if self.lookup(lnk.path) is not None:
                 self.links.append(lnk)
                 tag = self.link_tag
             else:
@@ -148,8 +220,35 @@ class OutputPanel(UniqueById):
 
             buffer.apply_tag(tag, start_iter, end_iter)
 
-        buffer.delete_mark(insert)
-        GLib.idle_add(self.scroll_to_end)
+        self.parse_offset += len(text)
+
+    def trim_scrollback(self, buffer):
+        if self.max_lines <= 0:
+            return
+
+        # Drop the oldest lines in bulk once the limit is exceeded by a
+        # tenth, rather than a few lines at each flush
+        count = buffer.get_line_count()
+
+        if count <= self.max_lines + self.max_lines / 10:
+            return
+
+        end_iter = buffer.get_iter_at_line(count - self.max_lines)
+        removed = end_iter.get_offset()
+
+        buffer.delete(buffer.get_start_iter(), end_iter)
+
+        self.parse_offset = max(0, self.parse_offset - removed)
+
+        links = []
+
+        for lnk in self.links:
+            if lnk.start >= removed:
+                lnk.start -= removed
+                lnk.end -= removed
+                links.append(lnk)
+
+        self.links = links
 
     def show(self):
         panel = self.window.get_bottom_panel()
@@ -218,7 +317,7 @@ class OutputPanel(UniqueById):
         if link is None:
             return False
 
-        gfile = self.file_lookup.lookup(link.path)
+        gfile = self.lookup(link.path)
 
         if gfile:
             Pluma.commands.load_uri(self.window, gfile.get_uri(), None,
@@ -26,6 +26,7 @@
 #include <string.h>
 #include <glib/gi18n-lib.h>
 #include <gio/gio.h>
+#include <pluma/pluma-dir-cache.h>
 
 #include "pluma-file-browser-store.h"
 #include "pluma-file-browser-marshal.h"
@@ -46,18 +47,30 @@
 
 #define FILE_BROWSER_NODE_DIR(node)	((FileBrowserNodeDir *)(node))
 
+/* A loading directory hands its children over in batches, which are
+ * flushed when full or when reading them took longer than the interval
+ * (in microseconds). Batches grow while the filesystem keeps up. */
 #define DIRECTORY_LOAD_ITEMS_PER_CALLBACK 100
-#define STANDARD_ATTRIBUTE_TYPES G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
-				 G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
-			 	 G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
-				 G_FILE_ATTRIBUTE_STANDARD_NAME "," \
-				 G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE "," \
-				 G_FILE_ATTRIBUTE_STANDARD_ICON
+#define DIRECTORY_LOAD_ITEMS_MAX 3200
+#define DIRECTORY_LOAD_BATCH_INTERVAL 50000
+#define REFILTER_CHUNK_SIZE 16
+#define LIGHT_ATTRIBUTE_TYPES G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+			      G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+			      G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
+			      G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+			      G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME
+#define CONTENT_ATTRIBUTE_TYPES G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE "," \
+				G_FILE_ATTRIBUTE_STANDARD_ICON
+#define STANDARD_ATTRIBUTE_TYPES LIGHT_ATTRIBUTE_TYPES "," \
+				 CONTENT_ATTRIBUTE_TYPES
 
 typedef struct _FileBrowserNode    FileBrowserNode;
 typedef struct _FileBrowserNodeDir FileBrowserNodeDir;
 typedef struct _AsyncData	   AsyncData;
 typedef struct _AsyncNode	   AsyncNode;
+typedef struct _LoadBatch	   LoadBatch;
+typedef struct _ContentJob	   ContentJob;
+typedef struct _ContentBatch	   ContentBatch;
 
 typedef gint (*SortFunc) (FileBrowserNode * node1,
 			  FileBrowserNode * node2);
@@ -76,7 +89,46 @@ struct _AsyncNode
 {
 	FileBrowserNodeDir *dir;
 	GCancellable *cancellable;
-	GSList *original_children;
+
+	/* only read by the loading thread */
+	GFile *file;
+	gchar const *attributes;
+	SortFunc sort_func;
+	GHashTable *original_names;
+	PlumaDirCache *cache;
+	PlumaDirListing *listing;
+
+	/* names shown from the cached listing, and the names the thread
+	   found while revalidating it */
+	GHashTable *cached_names;
+	GHashTable *seen_names;
+	gboolean listing_valid;
+};
+
+struct _LoadBatch
+{
+	FileBrowserNodeDir *dir;
+	GCancellable *cancellable;
+	GSList *nodes;
+};
+
+/* Queries the content types a directory listing did not have */
+struct _ContentJob
+{
+	FileBrowserNodeDir *dir;
+	GCancellable *cancellable;
+
+	/* only read by the thread */
+	GFile *file;
+	PlumaDirCache *cache;
+	GPtrArray *names;
+};
+
+struct _ContentBatch
+{
+	FileBrowserNodeDir *dir;
+	GCancellable *cancellable;
+	GSList *infos;
 };
 
 typedef struct {
@@ -92,8 +144,13 @@ struct _FileBrowserNode
 	guint flags;
 	gchar *name;
 
+	/* the icon is resolved the first time it is shown */
+	GIcon *gicon;
 	GdkPixbuf *icon;
 	GdkPixbuf *emblem;
+	gboolean icon_pending;
+	/* content type and icon were not queried yet */
+	gboolean content_pending;
 
 	FileBrowserNode *parent;
 	gint pos;
@@ -106,8 +163,14 @@ struct _FileBrowserNodeDir
 	GSList *children;
 
 	GCancellable *cancellable;
+	GCancellable *content_cancellable;
 	GFileMonitor *monitor;
 	PlumaFileBrowserStore *model;
+
+	/* expanded in the view, its children are refiltered first */
+	gboolean expanded;
+	/* children not refiltered since the last filter change */
+	gboolean filter_stale;
 };
 
 struct _PlumaFileBrowserStorePrivate 
@@ -122,6 +185,10 @@ struct _PlumaFileBrowserStorePrivate
 
 	SortFunc sort_func;
 
+	/* collapsed directories waiting to be refiltered */
+	GQueue *refilter_queue;
+	guint refilter_id;
+
 	GSList *async_handles;
 	MountInfo *mount_info;
 };
@@ -133,6 +200,7 @@ static void model_remove_node                               (PlumaFileBrowserSto
 							     FileBrowserNode * node, 
 							     GtkTreePath * path,
 							     gboolean free_nodes);
+static GdkPixbuf *model_node_get_icon                        (FileBrowserNode * node);
 
 static void set_virtual_root_from_node                      (PlumaFileBrowserStore * model,
 				                             FileBrowserNode * node);
@@ -191,8 +259,6 @@ static gint model_sort_default                              (FileBrowserNode * n
 							     FileBrowserNode * node2);
 static void model_check_dummy                               (PlumaFileBrowserStore * model,
 							     FileBrowserNode * node);
-static void next_files_async 				    (GFileEnumerator * enumerator,
-							     AsyncNode * async);
 
 G_DEFINE_DYNAMIC_TYPE_EXTENDED (PlumaFileBrowserStore, pluma_file_browser_store,
 			G_TYPE_OBJECT,
@@ -244,8 +310,12 @@ pluma_file_browser_store_finalize (GObject * object)
 	PlumaFileBrowserStore *obj = PLUMA_FILE_BROWSER_STORE (object);
 	GSList *item;
 
+	if (obj->priv->refilter_id != 0)
+		g_source_remove (obj->priv->refilter_id);
+
 	/* Free all the nodes */
 	file_browser_node_free (obj, obj->priv->root);
+	g_queue_free (obj->priv->refilter_queue);
 
 	/* Cancel any asynchronous operations */
 	for (item = obj->priv->async_handles; item; item = item->next)
@@ -474,6 +544,7 @@ pluma_file_browser_store_init (PlumaFileBrowserStore * obj)
 	// Default filter mode is hiding the hidden files
 	obj->priv->filter_mode = pluma_file_browser_store_filter_mode_get_default ();
 	obj->priv->sort_func = model_sort_default;
+	obj->priv->refilter_queue = g_queue_new ();
 }
 
 static gboolean
@@ -692,7 +763,7 @@ pluma_file_browser_store_get_value (GtkTreeModel * tree_model,
 		g_value_set_uint (value, node->flags);
 		break;
 	case PLUMA_FILE_BROWSER_STORE_COLUMN_ICON:
-		g_value_set_object (value, node->icon);
+		g_value_set_object (value, model_node_get_icon (node));
 		break;
 	case PLUMA_FILE_BROWSER_STORE_COLUMN_EMBLEM:
 		g_value_set_object (value, node->emblem);
@@ -1006,8 +1077,11 @@ model_node_update_visibility (PlumaFileBrowserStore * model,
 	if (FILTER_HIDDEN (model->priv->filter_mode) &&
 	    NODE_IS_HIDDEN (node))
 		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_FILTERED;
+	/* Binary files can only be told apart once the content type is
+	   known, until then they are shown */
 	else if (FILTER_BINARY (model->priv->filter_mode) &&
-		 (!NODE_IS_TEXT (node) && !NODE_IS_DIR (node)))
+		 (!NODE_IS_TEXT (node) && !NODE_IS_DIR (node) &&
+		  !node->content_pending))
 		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_FILTERED;
 	else if (model->priv->filter_func) {
 		iter.user_data = node;
@@ -1264,10 +1338,199 @@ model_refilter_node (PlumaFileBrowserStore * model,
 		gtk_tree_path_free (tmppath);
 }
 
+static gboolean
+model_node_refilter_now (PlumaFileBrowserStore * model,
+			 FileBrowserNode * node)
+{
+	/* The ancestors of the virtual root and the directories expanded in
+	   the view are refiltered right away, everything else can wait */
+	if (model->priv->virtual_root == NULL)
+		return FALSE;
+
+	if (node == model->priv->virtual_root ||
+	    node_has_parent (model->priv->virtual_root, node))
+		return TRUE;
+
+	return FILE_BROWSER_NODE_DIR (node)->expanded && node_in_tree (model, node);
+}
+
+static void
+model_refilter_dir (PlumaFileBrowserStore * model,
+		    FileBrowserNode * node,
+		    gboolean narrowing)
+{
+	FileBrowserNodeDir *dir;
+	FileBrowserNode *child;
+	GSList *item;
+	GArray *hidden;
+	GtkTreePath *path = NULL;
+	GtkTreePath *child_path;
+	GtkTreeIter iter;
+	gboolean emit;
+	gboolean old_visible;
+	gint pos;
+	gint i;
+
+	dir = FILE_BROWSER_NODE_DIR (node);
+
+	/* Nodes hidden by a stricter filter stay hidden, but only if they
+	   were tested against the previous filter in the first place */
+	narrowing = narrowing && !dir->filter_stale;
+
+	if (dir->filter_stale) {
+		dir->filter_stale = FALSE;
+		g_queue_remove (model->priv->refilter_queue, node);
+	}
+
+	/* Rows are only signalled when the directory itself is in the model */
+	emit = node == model->priv->virtual_root ||
+	       (node_in_tree (model, node) && model_node_inserted (model, node));
+
+	if (emit)
+		path = pluma_file_browser_store_get_path_real (model, node);
+
+	if (path == NULL)
+		emit = FALSE;
+
+	/* First update all the children, remembering which rows disappear */
+	hidden = g_array_new (FALSE, FALSE, sizeof (gint));
+	pos = 0;
+
+	for (item = dir->children; item; item = item->next) {
+		child = (FileBrowserNode *) (item->data);
+		old_visible = model_node_inserted (model, child);
+
+		if (!NODE_IS_DUMMY (child)) {
+			if (!(narrowing && NODE_IS_FILTERED (child)))
+				model_node_update_visibility (model, child);
+
+			if (old_visible && !model_node_visibility (model, child)) {
+				child->inserted = FALSE;
+				g_array_append_val (hidden, pos);
+			}
+		}
+
+		if (old_visible)
+			++pos;
+	}
+
+	/* Then signal the changes as one batch: removals from the back so
+	   the remaining indices stay valid, insertions from the front */
+	for (i = hidden->len - 1; emit && i >= 0; --i) {
+		child_path = gtk_tree_path_copy (path);
+		gtk_tree_path_append_index (child_path,
+					    g_array_index (hidden, gint, i));
+		row_deleted (model, child_path);
+		gtk_tree_path_free (child_path);
+	}
+
+	g_array_free (hidden, TRUE);
+	pos = 0;
+
+	for (item = dir->children; item; item = item->next) {
+		child = (FileBrowserNode *) (item->data);
+
+		if (!NODE_IS_DUMMY (child) && !child->inserted &&
+		    model_node_visibility (model, child)) {
+			if (emit) {
+				iter.user_data = child;
+				child_path = gtk_tree_path_copy (path);
+				gtk_tree_path_append_index (child_path, pos);
+				row_inserted (model, &child_path, &iter);
+				gtk_tree_path_free (child_path);
+			} else {
+				child->inserted = TRUE;
+			}
+		}
+
+		if (model_node_inserted (model, child))
+			++pos;
+	}
+
+	if (path)
+		gtk_tree_path_free (path);
+
+	model_check_dummy (model, node);
+
+	/* Descend into the expanded directories, queue the others */
+	for (item = dir->children; item; item = item->next) {
+		child = (FileBrowserNode *) (item->data);
+
+		if (!NODE_IS_DIR (child) || !NODE_LOADED (child))
+			continue;
+
+		if (narrowing && NODE_IS_FILTERED (child))
+			continue;
+
+		if (model_node_refilter_now (model, child)) {
+			model_refilter_dir (model, child, narrowing);
+		} else if (!FILE_BROWSER_NODE_DIR (child)->filter_stale) {
+			FILE_BROWSER_NODE_DIR (child)->filter_stale = TRUE;
+			g_queue_push_tail (model->priv->refilter_queue, child);
+		}
+	}
+}
+
+static gboolean
+model_refilter_idle (PlumaFileBrowserStore * model)
+{
+	gint i;
+
+	for (i = 0; i < REFILTER_CHUNK_SIZE &&
+		    !g_queue_is_empty (model->priv->refilter_queue); ++i) {
+		model_refilter_dir (model,
+				    g_queue_peek_head (model->priv->refilter_queue),
+				    FALSE);
+	}
+
+	if (!g_queue_is_empty (model->priv->refilter_queue))
+		return TRUE;
+
+	model->priv->refilter_id = 0;
+	return FALSE;
+}
+
+static void
+model_refilter_flush (PlumaFileBrowserStore * model)
+{
+	while (!g_queue_is_empty (model->priv->refilter_queue)) {
+		model_refilter_dir (model,
+				    g_queue_peek_head (model->priv->refilter_queue),
+				    FALSE);
+	}
+
+	if (model->priv->refilter_id != 0) {
+		g_source_remove (model->priv->refilter_id);
+		model->priv->refilter_id = 0;
+	}
+}
+
+static void
+model_refilter_full (PlumaFileBrowserStore * model,
+		     gboolean narrowing)
+{
+	if (model->priv->root == NULL)
+		return;
+
+	model_node_update_visibility (model, model->priv->root);
+
+	if (NODE_IS_DIR (model->priv->root))
+		model_refilter_dir (model, model->priv->root, narrowing);
+
+	if (!g_queue_is_empty (model->priv->refilter_queue) &&
+	    model->priv->refilter_id == 0) {
+		model->priv->refilter_id =
+		    g_idle_add_full (G_PRIORITY_LOW,
+				     (GSourceFunc) model_refilter_idle,
+				     model,
+				     NULL);
+	}
+}
+
 static void
 model_refilter (PlumaFileBrowserStore * model)
 {
-	model_refilter_node (model, model->priv->root, NULL);
+	model_refilter_full (model, FALSE);
 }
 
 static void
@@ -1365,8 +1628,16 @@ file_browser_node_free (PlumaFileBrowserStore * model,
 			model_end_loading (model, node);
 		}
 
+		if (dir->content_cancellable) {
+			g_cancellable_cancel (dir->content_cancellable);
+			g_object_unref (dir->content_cancellable);
+		}
+
 		file_browser_node_free_children (model, node);
 
+		if (dir->filter_stale)
+			g_queue_remove (model->priv->refilter_queue, node);
+
 		if (dir->monitor) {
 			g_file_monitor_cancel (dir->monitor);
 			g_object_unref (dir->monitor);
@@ -1382,6 +1653,9 @@ file_browser_node_free (PlumaFileBrowserStore * model,
 		g_object_unref (node->file);
 	}
 
+	if (node->gicon)
+		g_object_unref (node->gicon);
+
 	if (node->icon)
 		g_object_unref (node->icon);
 
@@ -1581,6 +1855,12 @@ file_browser_node_unload (PlumaFileBrowserStore * model,
 		dir->cancellable = NULL;
 	}
 
+	if (dir->content_cancellable) {
+		g_cancellable_cancel (dir->content_cancellable);
+		g_object_unref (dir->content_cancellable);
+		dir->content_cancellable = NULL;
+	}
+
 	if (dir->monitor) {
 		g_file_monitor_cancel (dir->monitor);
 		g_object_unref (dir->monitor);
@@ -1591,13 +1871,13 @@ file_browser_node_unload (PlumaFileBrowserStore * model,
 	node->flags &= ~PLUMA_FILE_BROWSER_STORE_FLAG_LOADED;
 }
 
+/* Only remembers the icon: most nodes are never shown, and the pixbuf
+ * is shared by all the nodes with the same icon */
 static void
 model_recomposite_icon_real (PlumaFileBrowserStore * tree_model,
 			     FileBrowserNode * node,
 			     GFileInfo * info)
 {
-	GdkPixbuf *icon;
-
 	g_return_if_fail (PLUMA_IS_FILE_BROWSER_STORE (tree_model));
 	g_return_if_fail (node != NULL);
 
@@ -1606,41 +1886,68 @@ model_recomposite_icon_real (PlumaFileBrowserStore * tree_model,
 
 	if (info) {
 		GIcon *gicon = g_file_info_get_icon (info);
-		if (gicon != NULL)
-			icon = pluma_file_browser_utils_pixbuf_from_icon (gicon, GTK_ICON_SIZE_MENU);
-		else
-			icon = NULL;
-	} else {
-		icon = pluma_file_browser_utils_pixbuf_from_file (node->file, GTK_ICON_SIZE_MENU);
+
+		if (node->gicon)
+			g_object_unref (node->gicon);
+
+		node->gicon = gicon ? g_object_ref (gicon) : NULL;
 	}
 
-	if (node->icon)
+	if (node->icon) {
 		g_object_unref (node->icon);
+		node->icon = NULL;
+	}
+
+	node->icon_pending = TRUE;
+}
+
+static gchar const *
+backup_content_type (GFileInfo * info)
+{
+	gchar const * content;
+	
+	if (!g_file_info_get_is_backup (info))
+		return NULL;
+	
+	content = g_file_info_get_content_type (info);
+	
+	if (!content || g_content_type_equals (content, "application/x-trash"))
+		return "text/plain";
+	
+	return content;
+}
+
+static gboolean
+file_info_is_text (GFileInfo * info)
+{
+	gchar const * content;
 
-	if (node->emblem) {
-		gint icon_size;
+	if (!(content = backup_content_type (info)))
+		content = g_file_info_get_content_type (info);
 
-		gtk_icon_size_lookup (GTK_ICON_SIZE_MENU, NULL, &icon_size);
+	return !content ||
+	       g_content_type_is_unknown (content) ||
+	       g_content_type_is_a (content, "text/plain");
+}
 
-		if (icon == NULL) {
-			node->icon =
-			    gdk_pixbuf_new (gdk_pixbuf_get_colorspace (node->emblem),
-					    gdk_pixbuf_get_has_alpha (node->emblem),
-					    gdk_pixbuf_get_bits_per_sample (node->emblem),
-					    icon_size,
-					    icon_size);
-		} else {
-			node->icon = gdk_pixbuf_copy (icon);
-			g_object_unref (icon);
-		}
+static GdkPixbuf *
+model_node_get_icon (FileBrowserNode * node)
+{
+	if (!node->icon_pending)
+		return node->icon;
 
-		gdk_pixbuf_composite (node->emblem, node->icon,
-				      icon_size - 10, icon_size - 10, 10,
-				      10, icon_size - 10, icon_size - 10,
-				      1, 1, GDK_INTERP_NEAREST, 255);
-	} else {
-		node->icon = icon;
-	}
+	node->icon_pending = FALSE;
+
+	/* The icon was not listed: show a generic one rather than query the
+	   file here, the real icon comes with the content type */
+	if (node->gicon == NULL)
+		node->gicon = g_themed_icon_new (NODE_IS_DIR (node) ? "folder" : "text-x-generic");
+
+	node->icon = pluma_file_browser_utils_pixbuf_from_icon_cached (node->gicon,
+								       node->emblem,
+								       GTK_ICON_SIZE_MENU);
+
+	return node->icon;
 }
 
 static void
@@ -1803,104 +2110,89 @@ model_add_node (PlumaFileBrowserStore * model, FileBrowserNode * child,
 
 static void
 model_add_nodes_batch (PlumaFileBrowserStore * model,
-		       GSList * children,
+		       GSList * sorted_children,
 		       FileBrowserNode * parent)
 {
-	GSList *sorted_children;
 	GSList *child;
+	GSList *next_child;
 	GSList *prev;
 	GSList *l;
 	FileBrowserNodeDir *dir;
+	GtkTreePath *path = NULL;
+	gint pos = 0;
 
 	dir = FILE_BROWSER_NODE_DIR (parent);
 
-	sorted_children = g_slist_sort (children, (GCompareFunc) model->priv->sort_func);
+	model_check_dummy (model, parent);
+
+	if (model_node_visibility (model, parent))
+		path = pluma_file_browser_store_get_path_real (model, parent);
 
 	child = sorted_children;
 	l = dir->children;
 	prev = NULL;
 
-	model_check_dummy (model, parent);
-
+	/* Merge the sorted children in a single pass, keeping track of the
+	   row index instead of looking up the path of every new node */
 	while (child) {
 		FileBrowserNode *node = child->data;
-		GtkTreeIter iter;
-		GtkTreePath *path;
-
-		/* reached the end of the first list, just append the second */
-		if (l == NULL) {
-
-			dir->children = g_slist_concat (dir->children, child);
-
-			for (l = child; l; l = l->next) {
-				if (model_node_visibility (model, parent) &&
-				    model_node_visibility (model, l->data)) {
-					iter.user_data = l->data;
-					path = pluma_file_browser_store_get_path_real (model, l->data);
-
-					// Emit row inserted
-					row_inserted (model, &path, &iter);
-					gtk_tree_path_free (path);
-				}
 
-				model_check_dummy (model, l->data);
-			}
+		if (l != NULL && model->priv->sort_func (l->data, node) <= 0) {
+			if (model_node_inserted (model, l->data))
+				++pos;
 
-			break;
+			prev = l;
+			l = l->next;
+			continue;
 		}
 
-		if (model->priv->sort_func (l->data, node) > 0) {
-			GSList *next_child;
+		next_child = child->next;
+		child->next = l;
 
-			if (prev == NULL) {
-				/* prepend to the list */
-				dir->children = g_slist_prepend (dir->children, child);
-			} else {
-				prev->next = child;
-			}
+		if (prev == NULL)
+			dir->children = child;
+		else
+			prev->next = child;
 
-			next_child = child->next;
-			prev = child;
-			child->next = l;
-			child = next_child;
+		prev = child;
+		child = next_child;
 
-			if (model_node_visibility (model, parent) &&
-			    model_node_visibility (model, node)) {
-				iter.user_data = node;
-				path = pluma_file_browser_store_get_path_real (model, node);
+		if (path != NULL && model_node_visibility (model, node)) {
+			GtkTreeIter iter;
+			GtkTreePath *child_path;
 
-				// Emit row inserted
-				row_inserted (model, &path, &iter);
-				gtk_tree_path_free (path);
-			}
+			iter.user_data = node;
+			child_path = gtk_tree_path_copy (path);
+			gtk_tree_path_append_index (child_path, pos);
 
-			model_check_dummy (model, node);
+			// Emit row inserted
+			row_inserted (model, &child_path, &iter);
+			gtk_tree_path_free (child_path);
+		}
 
-			/* try again at the same l position with the
-			 * next child */
-		} else {
+		if (model_node_inserted (model, node))
+			++pos;
 
-			/* Move to the next item in the list */
-			prev = l;
-			l = l->next;
-		}
+		model_check_dummy (model, node);
 	}
+
+	if (path)
+		gtk_tree_path_free (path);
 }
 
-static gchar const *
-backup_content_type (GFileInfo * info)
+static void
+file_browser_node_set_flags_from_info (FileBrowserNode * node,
+				       GFileInfo * info)
 {
-	gchar const * content;
-	
-	if (!g_file_info_get_is_backup (info))
-		return NULL;
-	
-	content = g_file_info_get_content_type (info);
-	
-	if (!content || g_content_type_equals (content, "application/x-trash"))
-		return "text/plain";
-	
-	return content;
+	if (g_file_info_get_is_hidden (info) || g_file_info_get_is_backup (info))
+		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_HIDDEN;
+
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_DIRECTORY;
+	else if (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE))
+		node->content_pending = TRUE;
+	else if (file_info_is_text (info))
+		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_TEXT;
 }
 
 static void
@@ -1909,7 +2201,6 @@ file_browser_node_set_from_info (PlumaFileBrowserStore * model,
 				 GFileInfo * info,
 				 gboolean isadded)
 {
-	gchar const * content;
 	gboolean free_info = FALSE;
 	GtkTreePath * path;
 	gchar * uri;
@@ -1936,21 +2227,7 @@ file_browser_node_set_from_info (PlumaFileBrowserStore * model,
 		free_info = TRUE;
 	}
 
-	if (g_file_info_get_is_hidden (info) || g_file_info_get_is_backup (info))
-		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_HIDDEN;
-
-	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
-		node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_DIRECTORY;
-	else {
-		if (!(content = backup_content_type (info)))
-			content = g_file_info_get_content_type (info);
-		
-		if (!content || 
-		    g_content_type_is_unknown (content) ||
-		    g_content_type_is_a (content, "text/plain"))
-			node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_TEXT;		
-	}
-	
+	file_browser_node_set_flags_from_info (node, info);
 	model_recomposite_icon_real (model, node, info);
 
 	if (free_info)
@@ -2027,67 +2304,6 @@ model_add_node_from_file (PlumaFileBrowserStore * model,
 	return node;
 }
 
-/* We pass in a copy of the list of parent->children so that we do
- * not have to check if a file already exists among the ones we just
- * added */
-static void
-model_add_nodes_from_files (PlumaFileBrowserStore * model,
-			    FileBrowserNode * parent,
-			    GSList * original_children,
-			    GList * files)
-{
-	GList *item;
-	GSList *nodes = NULL;
-
-	for (item = files; item; item = item->next) {
-		GFileInfo *info = G_FILE_INFO (item->data);
-		GFileType type;
-		gchar const * name;
-		GFile * file;
-		FileBrowserNode *node;
-
-		type = g_file_info_get_file_type (info);
-
-		/* Skip all non regular, non directory files */
-		if (type != G_FILE_TYPE_REGULAR &&
-		    type != G_FILE_TYPE_DIRECTORY &&
-		    type != G_FILE_TYPE_SYMBOLIC_LINK) {
-			g_object_unref (info);
-			continue;
-		}		
-
-		name = g_file_info_get_name (info);
-
-		/* Skip '.' and '..' directories */
-		if (type == G_FILE_TYPE_DIRECTORY &&
-		    (strcmp (name, ".") == 0 ||
-		     strcmp (name, "..") == 0)) {
-			continue;
-		}
-
-		file = g_file_get_child (parent->file, name);
-
-		if ((node = node_list_contains_file (original_children, file)) == NULL) {
-
-			if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
-				node = file_browser_node_dir_new (model, file, parent);
-			} else {
-				node = file_browser_node_new (file, parent);
-			}
-
-			file_browser_node_set_from_info (model, node, info, FALSE);
-
-			nodes = g_slist_prepend (nodes, node);
-		}
-
-		g_object_unref (file);
-		g_object_unref (info);
-	}
-
-	if (nodes)
-		model_add_nodes_batch (model, nodes, parent);
-}
-
 static FileBrowserNode *
 model_add_node_from_dir (PlumaFileBrowserStore * model,
 			 FileBrowserNode * parent,
@@ -2104,8 +2320,9 @@ model_add_node_from_dir (PlumaFileBrowserStore * model,
 			file_browser_node_set_name (node);
 		}
 
-		if (node->icon == NULL) {
-			node->icon = pluma_file_browser_utils_pixbuf_from_theme ("folder", GTK_ICON_SIZE_MENU);
+		if (node->gicon == NULL) {
+			node->gicon = g_themed_icon_new ("folder");
+			node->icon_pending = TRUE;
 		}
 
 		model_add_node (model, node, parent);
@@ -2147,123 +2364,629 @@ static void
 async_node_free (AsyncNode *async)
 {
 	g_object_unref (async->cancellable);
-	g_slist_free (async->original_children);
+	g_object_unref (async->file);
+	g_object_unref (async->cache);
+	g_hash_table_destroy (async->original_names);
+
+	if (async->listing != NULL) {
+		pluma_dir_listing_unref (async->listing);
+		g_hash_table_destroy (async->cached_names);
+		g_hash_table_destroy (async->seen_names);
+	}
+
 	g_free (async);
 }
 
 static void
-model_iterate_next_files_cb (GFileEnumerator * enumerator, 
-			     GAsyncResult * result, 
-			     AsyncNode * async)
+file_browser_node_discard (FileBrowserNode * node)
 {
-	GList * files;
-	GError * error = NULL;
-	FileBrowserNodeDir * dir = async->dir;
-	FileBrowserNode * parent = (FileBrowserNode *)dir;
-	
-	files = g_file_enumerator_next_files_finish (enumerator, result, &error);
+	/* Frees a node from a load batch that never made it into the model */
+	g_object_unref (node->file);
+	g_free (node->name);
 
-	if (files == NULL) {
-		g_file_enumerator_close (enumerator, NULL, NULL);
-		async_node_free (async);
-		
-		if (!error)
-		{
-			/* We're done loading */
-			g_object_unref (dir->cancellable);
-			dir->cancellable = NULL;
-			
-/*
- * FIXME: This is temporarly, it is a bug in gio:
- * http://bugzilla.gnome.org/show_bug.cgi?id=565924
- */
-			if (g_file_is_native (parent->file) && dir->monitor == NULL) {
-				dir->monitor = g_file_monitor_directory (parent->file, 
-									 G_FILE_MONITOR_NONE,
-									 NULL,
-									 NULL);
-				if (dir->monitor != NULL)
-				{
-					g_signal_connect (dir->monitor,
-							  "changed",
-							  G_CALLBACK (on_directory_monitor_event),
-							  parent);
-				}
-			}
+	if (node->gicon)
+		g_object_unref (node->gicon);
 
-			model_check_dummy (dir->model, parent);
-			model_end_loading (dir->model, parent);
-		} else {
-			/* Simply return if we were cancelled */
-			if (error->domain == G_IO_ERROR && error->code == G_IO_ERROR_CANCELLED)
-				return;
-		
-			/* Otherwise handle the error appropriately */
-			g_signal_emit (dir->model,
-				       model_signals[ERROR],
-				       0,
-				       PLUMA_FILE_BROWSER_ERROR_LOAD_DIRECTORY,
-				       error->message);
-
-			file_browser_node_unload (dir->model, (FileBrowserNode *)parent, TRUE);
-			g_error_free (error);
-		}
-	} else if (g_cancellable_is_cancelled (async->cancellable)) {
-		/* Check cancel state manually */
-		g_file_enumerator_close (enumerator, NULL, NULL);
-		async_node_free (async);
+	if (NODE_IS_DIR (node))
+		g_slice_free (FileBrowserNodeDir, (FileBrowserNodeDir *)node);
+	else
+		g_slice_free (FileBrowserNode, (FileBrowserNode *)node);
+}
+
+/* Called in the loading thread, only reads the AsyncNode */
+static FileBrowserNode *
+file_browser_node_new_from_info (AsyncNode * async,
+				 GFileInfo * info)
+{
+	FileBrowserNode *node;
+	GFileType type;
+	gchar const * name;
+	gchar const * display_name;
+
+	type = g_file_info_get_file_type (info);
+
+	/* Skip all non regular, non directory files */
+	if (type != G_FILE_TYPE_REGULAR &&
+	    type != G_FILE_TYPE_DIRECTORY &&
+	    type != G_FILE_TYPE_SYMBOLIC_LINK)
+		return NULL;
+
+	name = g_file_info_get_name (info);
+
+	/* Skip '.' and '..' directories */
+	if (type == G_FILE_TYPE_DIRECTORY &&
+	    (strcmp (name, ".") == 0 ||
+	     strcmp (name, "..") == 0))
+		return NULL;
+
+	/* Skip the children that were there before loading */
+	if (g_hash_table_lookup (async->original_names, name) != NULL)
+		return NULL;
+
+	if (type == G_FILE_TYPE_DIRECTORY) {
+		node = (FileBrowserNode *) g_slice_new0 (FileBrowserNodeDir);
+		FILE_BROWSER_NODE_DIR (node)->model = async->dir->model;
 	} else {
-		model_add_nodes_from_files (dir->model, parent, async->original_children, files);
-		
-		g_list_free (files);
-		next_files_async (enumerator, async);
+		node = g_slice_new0 (FileBrowserNode);
+	}
+
+	node->file = g_file_get_child (async->file, name);
+	node->parent = (FileBrowserNode *) async->dir;
+	node->icon_pending = TRUE;
+
+	/* The display name comes with the enumeration, no need to query
+	   every file again like file_browser_node_set_name does */
+	display_name = g_file_info_get_display_name (info);
+
+	if (display_name != NULL)
+		node->name = g_strdup (display_name);
+	else
+		node->name = pluma_file_browser_utils_file_basename (node->file);
+
+	file_browser_node_set_flags_from_info (node, info);
+
+	if (g_file_info_get_icon (info))
+		node->gicon = g_object_ref (g_file_info_get_icon (info));
+
+	return node;
+}
+
+static gboolean
+load_batch_merge (LoadBatch * batch)
+{
+	PlumaFileBrowserStore *model;
+	GSList *item;
+
+	if (g_cancellable_is_cancelled (batch->cancellable)) {
+		/* The directory may be gone already */
+		g_slist_foreach (batch->nodes, (GFunc) file_browser_node_discard, NULL);
+		g_slist_free (batch->nodes);
+	} else {
+		model = batch->dir->model;
+
+		for (item = batch->nodes; item; item = item->next)
+			model_node_update_visibility (model, (FileBrowserNode *) (item->data));
+
+		model_add_nodes_batch (model, batch->nodes, (FileBrowserNode *) batch->dir);
 	}
+
+	g_object_unref (batch->cancellable);
+	g_free (batch);
+
+	return FALSE;
 }
 
 static void
-next_files_async (GFileEnumerator * enumerator,
-		  AsyncNode * async)
+load_batch_post (AsyncNode * async,
+		 GSList * nodes)
 {
-	g_file_enumerator_next_files_async (enumerator,
-					    DIRECTORY_LOAD_ITEMS_PER_CALLBACK,
-					    G_PRIORITY_DEFAULT,
-					    async->cancellable,
-					    (GAsyncReadyCallback)model_iterate_next_files_cb,
-					    async);
+	LoadBatch *batch;
+
+	batch = g_new (LoadBatch, 1);
+	batch->dir = async->dir;
+	batch->cancellable = g_object_ref (async->cancellable);
+
+	/* Sort in the thread, merging into the model is then linear */
+	batch->nodes = g_slist_sort (nodes, (GCompareFunc) async->sort_func);
+
+	g_idle_add_full (G_PRIORITY_DEFAULT,
+			 (GSourceFunc) load_batch_merge,
+			 batch,
+			 NULL);
 }
 
 static void
-model_iterate_children_cb (GFile * file, 
-			   GAsyncResult * result,
+model_load_directory_thread (GTask * task,
+			     gpointer source_object,
+			     AsyncNode * async,
+			     GCancellable * cancellable)
+{
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	FileBrowserNode *node;
+	GSList *nodes = NULL;
+	GList *infos = NULL;
+	GError *error = NULL;
+	guint batch_size = DIRECTORY_LOAD_ITEMS_PER_CALLBACK;
+	guint count = 0;
+	guint64 mtime;
+	gint64 start;
+
+	mtime = pluma_dir_cache_query_mtime (async->file, cancellable, NULL);
+
+	if (async->listing != NULL &&
+	    mtime != 0 &&
+	    mtime == pluma_dir_listing_get_mtime (async->listing)) {
+		/* Nothing was added or removed since the cached listing
+		   that is shown already */
+		async->listing_valid = TRUE;
+		g_task_return_boolean (task, TRUE);
+		return;
+	}
+
+	enumerator = g_file_enumerate_children (async->file,
+						async->attributes,
+						G_FILE_QUERY_INFO_NONE,
+						cancellable,
+						&error);
+
+	if (enumerator == NULL) {
+		g_task_return_error (task, error);
+		return;
+	}
+
+	start = g_get_monotonic_time ();
+
+	while ((info = g_file_enumerator_next_file (enumerator,
+						    cancellable,
+						    &error)) != NULL) {
+		if (async->listing != NULL)
+			g_hash_table_insert (async->seen_names,
+					     g_strdup (g_file_info_get_name (info)),
+					     GINT_TO_POINTER (1));
+
+		node = file_browser_node_new_from_info (async, info);
+		infos = g_list_prepend (infos, info);
+
+		if (node == NULL)
+			continue;
+
+		nodes = g_slist_prepend (nodes, node);
+
+		if (++count >= batch_size) {
+			/* The filesystem keeps up, hand over bigger batches */
+			batch_size = MIN (batch_size * 2, DIRECTORY_LOAD_ITEMS_MAX);
+		} else if (g_get_monotonic_time () - start < DIRECTORY_LOAD_BATCH_INTERVAL) {
+			continue;
+		}
+
+		load_batch_post (async, nodes);
+
+		nodes = NULL;
+		count = 0;
+		start = g_get_monotonic_time ();
+	}
+
+	if (nodes != NULL)
+		load_batch_post (async, nodes);
+
+	g_file_enumerator_close (enumerator, NULL, NULL);
+	g_object_unref (enumerator);
+
+	if (error == NULL && mtime != 0) {
+		infos = g_list_reverse (infos);
+		pluma_dir_cache_store (async->cache, async->file, mtime, infos);
+	}
+
+	g_list_free_full (infos, g_object_unref);
+
+	if (error != NULL)
+		g_task_return_error (task, error);
+	else
+		g_task_return_boolean (task, TRUE);
+}
+
+/* Removes the nodes shown from the cached listing that the loading
+   thread did not find anymore */
+static void
+model_remove_stale_cached (PlumaFileBrowserStore * model,
 			   AsyncNode * async)
 {
+	GSList *children;
+	GSList *item;
+
+	children = g_slist_copy (async->dir->children);
+
+	for (item = children; item; item = item->next) {
+		FileBrowserNode *child = (FileBrowserNode *) (item->data);
+		gchar *name;
+
+		if (child->file == NULL)
+			continue;
+
+		name = g_file_get_basename (child->file);
+
+		if (g_hash_table_lookup (async->cached_names, name) != NULL &&
+		    g_hash_table_lookup (async->seen_names, name) == NULL)
+			model_remove_node (model, child, NULL, TRUE);
+
+		g_free (name);
+	}
+
+	g_slist_free (children);
+}
+
+static void
+content_job_free (ContentJob * job)
+{
+	g_object_unref (job->cancellable);
+	g_object_unref (job->file);
+	g_object_unref (job->cache);
+	g_ptr_array_free (job->names, TRUE);
+
+	g_free (job);
+}
+
+static gboolean
+content_batch_merge (ContentBatch * batch)
+{
+	PlumaFileBrowserStore *model;
+	FileBrowserNode *parent;
+	GHashTable *children;
+	GSList *item;
+
+	if (g_cancellable_is_cancelled (batch->cancellable))
+		goto out;
+
+	model = batch->dir->model;
+	parent = (FileBrowserNode *) batch->dir;
+	children = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+
+	for (item = batch->dir->children; item; item = item->next) {
+		FileBrowserNode *child = (FileBrowserNode *) (item->data);
+
+		if (child->file != NULL)
+			g_hash_table_insert (children, child->file, child);
+	}
+
+	for (item = batch->infos; item; item = item->next) {
+		GFileInfo *info = G_FILE_INFO (item->data);
+		FileBrowserNode *node;
+		GFile *file;
+
+		file = g_file_get_child (parent->file, g_file_info_get_name (info));
+		node = g_hash_table_lookup (children, file);
+		g_object_unref (file);
+
+		if (node == NULL || !node->content_pending)
+			continue;
+
+		node->content_pending = FALSE;
+
+		if (file_info_is_text (info))
+			node->flags |= PLUMA_FILE_BROWSER_STORE_FLAG_IS_TEXT;
+
+		if (g_file_info_get_icon (info))
+			model_recomposite_icon_real (model, node, info);
+
+		if (node->inserted) {
+			GtkTreeIter iter;
+			GtkTreePath *path;
+
+			iter.user_data = node;
+			path = pluma_file_browser_store_get_path_real (model, node);
+			row_changed (model, &path, &iter);
+			gtk_tree_path_free (path);
+		}
+
+		/* it was shown while it could still be a binary file */
+		if (FILTER_BINARY (model->priv->filter_mode))
+			model_refilter_node (model, node, NULL);
+	}
+
+	if (FILTER_BINARY (model->priv->filter_mode))
+		model_check_dummy (model, parent);
+
+	g_hash_table_destroy (children);
+
+out:
+	g_slist_free_full (batch->infos, g_object_unref);
+	g_object_unref (batch->cancellable);
+	g_free (batch);
+
+	return FALSE;
+}
+
+static void
+content_batch_post (ContentJob * job,
+		    GSList * infos)
+{
+	ContentBatch *batch;
+
+	batch = g_new (ContentBatch, 1);
+	batch->dir = job->dir;
+	batch->cancellable = g_object_ref (job->cancellable);
+	batch->infos = infos;
+
+	g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+			 (GSourceFunc) content_batch_merge,
+			 batch,
+			 NULL);
+}
+
+/* Writes the content types back to the cached listing, so that they do
+   not have to be queried again the next time the directory is shown */
+static void
+content_job_store (ContentJob * job,
+		   GHashTable * content_types)
+{
+	PlumaDirListing *listing;
+	GList *infos = NULL;
+	guint i;
+
+	listing = pluma_dir_cache_lookup (job->cache, job->file);
+
+	if (listing == NULL)
+		return;
+
+	for (i = pluma_dir_listing_get_n_entries (listing); i > 0; --i) {
+		GFileInfo *info;
+		gchar const *content_type;
+
+		info = pluma_dir_listing_get_info (listing, i - 1);
+		content_type = g_hash_table_lookup (content_types,
+						    g_file_info_get_name (info));
+
+		if (content_type != NULL)
+			g_file_info_set_content_type (info, content_type);
+
+		infos = g_list_prepend (infos, info);
+	}
+
+	pluma_dir_cache_store (job->cache,
+			       job->file,
+			       pluma_dir_listing_get_mtime (listing),
+			       infos);
+
+	g_list_free_full (infos, g_object_unref);
+	pluma_dir_listing_unref (listing);
+}
+
+static void
+content_job_thread (GTask * task,
+		    gpointer source_object,
+		    ContentJob * job,
+		    GCancellable * cancellable)
+{
+	GHashTable *content_types;
+	GSList *infos = NULL;
+	guint count = 0;
+	gint64 start;
+	guint i;
+
+	content_types = g_hash_table_new_full (g_str_hash,
+					       g_str_equal,
+					       g_free,
+					       g_free);
+
+	start = g_get_monotonic_time ();
+
+	for (i = 0; i < job->names->len; ++i) {
+		gchar const *name = g_ptr_array_index (job->names, i);
+		GFileInfo *info;
+		GFile *file;
+
+		if (g_cancellable_is_cancelled (cancellable))
+			break;
+
+		file = g_file_get_child (job->file, name);
+		info = g_file_query_info (file,
+					  G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP ","
+					  CONTENT_ATTRIBUTE_TYPES,
+					  G_FILE_QUERY_INFO_NONE,
+					  cancellable,
+					  NULL);
+		g_object_unref (file);
+
+		/* Unknown content is treated as text, like when loading */
+		if (info == NULL)
+			info = g_file_info_new ();
+
+		g_file_info_set_name (info, name);
+
+		if (g_file_info_get_content_type (info) != NULL)
+			g_hash_table_insert (content_types,
+					     g_strdup (name),
+					     g_strdup (g_file_info_get_content_type (info)));
+
+		infos = g_slist_prepend (infos, info);
+
+		if (++count < DIRECTORY_LOAD_ITEMS_PER_CALLBACK &&
+		    g_get_monotonic_time () - start < DIRECTORY_LOAD_BATCH_INTERVAL)
+			continue;
+
+		content_batch_post (job, infos);
+
+		infos = NULL;
+		count = 0;
+		start = g_get_monotonic_time ();
+	}
+
+	if (infos != NULL)
+		content_batch_post (job, infos);
+
+	if (!g_cancellable_is_cancelled (cancellable) &&
+	    g_hash_table_size (content_types) > 0)
+		content_job_store (job, content_types);
+
+	g_hash_table_destroy (content_types);
+
+	g_task_return_boolean (task, TRUE);
+}
+
+/* Finds out in a thread which of the children of dir are text files,
+   and updates their rows once it is known */
+static void
+model_resolve_content (PlumaFileBrowserStore * model,
+		       FileBrowserNodeDir * dir)
+{
+	ContentJob *job;
+	GTask *task;
+	GSList *item;
+
+	job = g_new (ContentJob, 1);
+	job->names = g_ptr_array_new_with_free_func (g_free);
+
+	for (item = dir->children; item; item = item->next) {
+		FileBrowserNode *child = (FileBrowserNode *) (item->data);
+
+		if (child->file != NULL && child->content_pending)
+			g_ptr_array_add (job->names, g_file_get_basename (child->file));
+	}
+
+	if (job->names->len == 0) {
+		g_ptr_array_free (job->names, TRUE);
+		g_free (job);
+		return;
+	}
+
+	if (dir->content_cancellable != NULL) {
+		g_cancellable_cancel (dir->content_cancellable);
+		g_object_unref (dir->content_cancellable);
+	}
+
+	dir->content_cancellable = g_cancellable_new ();
+
+	job->dir = dir;
+	job->cancellable = g_object_ref (dir->content_cancellable);
+	job->file = g_object_ref (((FileBrowserNode *) dir)->file);
+	job->cache = g_object_ref (pluma_dir_cache_get_default ());
+
+	task = g_task_new (model, job->cancellable, NULL, NULL);
+	g_task_set_task_data (task, job, (GDestroyNotify) content_job_free);
+	g_task_run_in_thread (task, (GTaskThreadFunc) content_job_thread);
+	g_object_unref (task);
+}
+
+static void
+model_load_directory_ready (PlumaFileBrowserStore * model,
+			    GAsyncResult * result,
+			    AsyncNode * async)
+{
+	FileBrowserNodeDir * dir = async->dir;
+	FileBrowserNode * parent = (FileBrowserNode *)dir;
 	GError * error = NULL;
-	GFileEnumerator * enumerator;
 
-	if (g_cancellable_is_cancelled (async->cancellable))
-	{
+	/* Simply return if we were cancelled, the node may be gone */
+	if (g_cancellable_is_cancelled (async->cancellable)) {
 		async_node_free (async);
 		return;
 	}
-	
-	enumerator = g_file_enumerate_children_finish (file, result, &error);
 
-	if (enumerator == NULL) {
-		/* Simply return if we were cancelled or if the dir is not there */
-		FileBrowserNodeDir *dir = async->dir;
+	/* All the batches were posted before the result, so they have been
+	   merged by now */
+	if (g_task_propagate_boolean (G_TASK (result), &error)) {
+		/* We're done loading */
+		g_object_unref (dir->cancellable);
+		dir->cancellable = NULL;
+
+		if (async->listing != NULL && !async->listing_valid)
+			model_remove_stale_cached (model, async);
 		
+/*
+ * FIXME: This is temporarly, it is a bug in gio:
+ * http://bugzilla.gnome.org/show_bug.cgi?id=565924
+ */
+		if (g_file_is_native (parent->file) && dir->monitor == NULL) {
+			dir->monitor = g_file_monitor_directory (parent->file, 
+								 G_FILE_MONITOR_NONE,
+								 NULL,
+								 NULL);
+			if (dir->monitor != NULL)
+			{
+				g_signal_connect (dir->monitor,
+						  "changed",
+						  G_CALLBACK (on_directory_monitor_event),
+						  parent);
+			}
+		}
+
+		model_check_dummy (model, parent);
+		model_end_loading (model, parent);
+
+		model_resolve_content (model, dir);
+	} else {
 		/* Otherwise handle the error appropriately */
-		g_signal_emit (dir->model,
+		g_signal_emit (model,
 			       model_signals[ERROR],
 			       0,
 			       PLUMA_FILE_BROWSER_ERROR_LOAD_DIRECTORY,
 			       error->message);
 
-		file_browser_node_unload (dir->model, (FileBrowserNode *)dir, TRUE);
+		file_browser_node_unload (model, parent, TRUE);
 		g_error_free (error);
-		async_node_free (async);
-	} else {
-		next_files_async (enumerator, async);
+	}
+
+	async_node_free (async);
+}
+
+/* Shows the entries the directory had the last time it was listed,
+   the loading thread then only adds what is new */
+static void
+model_load_directory_cached (PlumaFileBrowserStore * model,
+			     AsyncNode * async)
+{
+	GSList *nodes = NULL;
+	GSList *item;
+	guint n_entries;
+	guint i;
+
+	async->listing = pluma_dir_cache_lookup (async->cache, async->file);
+
+	if (async->listing == NULL)
+		return;
+
+	async->cached_names = g_hash_table_new_full (g_str_hash,
+						     g_str_equal,
+						     g_free,
+						     NULL);
+	async->seen_names = g_hash_table_new_full (g_str_hash,
+						   g_str_equal,
+						   g_free,
+						   NULL);
+
+	n_entries = pluma_dir_listing_get_n_entries (async->listing);
+
+	for (i = 0; i < n_entries; ++i) {
+		GFileInfo *info;
+		FileBrowserNode *node;
+
+		info = pluma_dir_listing_get_info (async->listing, i);
+		node = file_browser_node_new_from_info (async, info);
+		g_object_unref (info);
+
+		if (node == NULL)
+			continue;
+
+		g_hash_table_insert (async->cached_names,
+				     g_strdup (pluma_dir_listing_get_name (async->listing, i)),
+				     GINT_TO_POINTER (1));
+
+		model_node_update_visibility (model, node);
+		nodes = g_slist_prepend (nodes, node);
+	}
+
+	nodes = g_slist_sort (nodes, (GCompareFunc) async->sort_func);
+	model_add_nodes_batch (model, nodes, (FileBrowserNode *) async->dir);
+
+	/* The thread must not add them a second time */
+	for (item = async->dir->children; item; item = item->next) {
+		FileBrowserNode *child = (FileBrowserNode *) (item->data);
+
+		if (child->file != NULL)
+			g_hash_table_insert (async->original_names,
+					     g_file_get_basename (child->file),
+					     GINT_TO_POINTER (1));
 	}
 }
 
@@ -2273,6 +2996,8 @@ model_load_directory (PlumaFileBrowserStore * model,
 {
 	FileBrowserNodeDir *dir;
 	AsyncNode *async;
+	GTask *task;
+	GSList *item;
 
 	g_return_if_fail (NODE_IS_DIR (node));
 
@@ -2291,16 +3016,45 @@ model_load_directory (PlumaFileBrowserStore * model,
 	async = g_new (AsyncNode, 1);
 	async->dir = dir;
 	async->cancellable = g_object_ref (dir->cancellable);
-	async->original_children = g_slist_copy (dir->children);
+	async->file = g_object_ref (node->file);
+	async->sort_func = model->priv->sort_func;
+	async->cache = g_object_ref (pluma_dir_cache_get_default ());
+	async->listing = NULL;
+	async->cached_names = NULL;
+	async->seen_names = NULL;
+	async->listing_valid = FALSE;
+
+	/* The content type is expensive to sniff, only query it up front
+	   when binary files are filtered out */
+	if (FILTER_BINARY (model->priv->filter_mode))
+		async->attributes = STANDARD_ATTRIBUTE_TYPES;
+	else
+		async->attributes = LIGHT_ATTRIBUTE_TYPES;
+
+	async->original_names = g_hash_table_new_full (g_str_hash,
+						       g_str_equal,
+						       g_free,
+						       NULL);
 
-	/* Start loading async */
-	g_file_enumerate_children_async (node->file,
-					 STANDARD_ATTRIBUTE_TYPES,
-					 G_FILE_QUERY_INFO_NONE,
-					 G_PRIORITY_DEFAULT,
-					 async->cancellable,
-					 (GAsyncReadyCallback)model_iterate_children_cb,
-					 async);
+	for (item = dir->children; item; item = item->next) {
+		FileBrowserNode *child = (FileBrowserNode *) (item->data);
+
+		if (child->file != NULL)
+			g_hash_table_insert (async->original_names,
+					     g_file_get_basename (child->file),
+					     GINT_TO_POINTER (1));
+	}
+
+	model_load_directory_cached (model, async);
+
+	/* Enumerate the directory and build the nodes in a thread */
+	task = g_task_new (model,
+			   async->cancellable,
+			   (GAsyncReadyCallback) model_load_directory_ready,
+			   async);
+	g_task_set_task_data (task, async, NULL);
+	g_task_run_in_thread (task, (GTaskThreadFunc) model_load_directory_thread);
+	g_object_unref (task);
 }
 
 static GList *
@@ -2465,6 +3219,8 @@ set_virtual_root_from_node (PlumaFileBrowserStore * model,
 	   "root_changed" signal can be emitted before any "inserted" signals */
 	g_object_notify (G_OBJECT (model), "virtual-root");
 
+	/* The new tree must not show nodes that still await refiltering */
+	model_refilter_flush (model);
 	model_fill (model, NULL, &empty);
 
 	if (!NODE_LOADED (node))
@@ -3038,9 +3794,17 @@ _pluma_file_browser_store_iter_expanded (PlumaFileBrowserStore * model,
 
 	node = (FileBrowserNode *) (iter->user_data);
 
-	if (NODE_IS_DIR (node) && !NODE_LOADED (node)) {
+	if (!NODE_IS_DIR (node))
+		return;
+
+	FILE_BROWSER_NODE_DIR (node)->expanded = TRUE;
+
+	if (!NODE_LOADED (node)) {
 		/* Load it now */
 		model_load_directory (model, node);
+	} else if (FILE_BROWSER_NODE_DIR (node)->filter_stale) {
+		/* Refilter it now instead of waiting for its turn */
+		model_refilter_dir (model, node, FALSE);
 	}
 }
 
@@ -3057,6 +3821,9 @@ _pluma_file_browser_store_iter_collapsed (PlumaFileBrowserStore * model,
 
 	node = (FileBrowserNode *) (iter->user_data);
 
+	if (NODE_IS_DIR (node))
+		FILE_BROWSER_NODE_DIR (node)->expanded = FALSE;
+
 	if (NODE_IS_DIR (node) && NODE_LOADED (node)) {
 		/* Unload children of the children, keeping 1 depth in cache */
 
@@ -3064,6 +3831,9 @@ _pluma_file_browser_store_iter_collapsed (PlumaFileBrowserStore * model,
 		     item = item->next) {
 			node = (FileBrowserNode *) (item->data);
 
+			if (NODE_IS_DIR (node))
+				FILE_BROWSER_NODE_DIR (node)->expanded = FALSE;
+
 			if (NODE_IS_DIR (node) && NODE_LOADED (node)) {
 				file_browser_node_unload (model, node,
 							  TRUE);
@@ -3110,9 +3880,26 @@ pluma_file_browser_store_set_filter_func (PlumaFileBrowserStore * model,
 void
 pluma_file_browser_store_refilter (PlumaFileBrowserStore * model)
 {
+	g_return_if_fail (PLUMA_IS_FILE_BROWSER_STORE (model));
+
 	model_refilter (model);
 }
 
+/**
+ * pluma_file_browser_store_refilter_narrowed:
+ * @model: the #PlumaFileBrowserStore
+ *
+ * Refilter the model after the filter became stricter: nodes that are
+ * already filtered out are not tested again.
+ */
+void
+pluma_file_browser_store_refilter_narrowed (PlumaFileBrowserStore * model)
+{
+	g_return_if_fail (PLUMA_IS_FILE_BROWSER_STORE (model));
+
+	model_refilter_full (model, TRUE);
+}
+
 PlumaFileBrowserStoreFilterMode
 pluma_file_browser_store_filter_mode_get_default (void)
 {
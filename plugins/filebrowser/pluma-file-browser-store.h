@@ -43,6 +43,9 @@ typedef enum
 	PLUMA_FILE_BROWSER_STORE_COLUMN_NUM
 } PlumaFileBrowserStoreColumn;
 
+/* IS_TEXT is only known once the icon of the row has been requested or
+ * when binary files are filtered out, the content type is not sniffed
+ * while loading a directory otherwise */
 typedef enum 
 {
 	PLUMA_FILE_BROWSER_STORE_FLAG_IS_DIRECTORY = 1 << 0,
@@ -168,6 +171,7 @@ void pluma_file_browser_store_set_filter_func         (PlumaFileBrowserStore * m
                                                        PlumaFileBrowserStoreFilterFunc func, 
                                                        gpointer user_data);
 void pluma_file_browser_store_refilter                (PlumaFileBrowserStore * model);
+void pluma_file_browser_store_refilter_narrowed       (PlumaFileBrowserStore * model);
 PlumaFileBrowserStoreFilterMode
 pluma_file_browser_store_filter_mode_get_default      (void);
 
@@ -125,6 +125,185 @@ pluma_file_browser_utils_pixbuf_from_file (GFile * file,
 	return ret;
 }
 
+/* Pixbufs shared by all the nodes showing the same icon and emblem. The
+ * emblems are not referenced: the entries using one are removed when it
+ * is finalized, once no node shows it anymore */
+typedef struct
+{
+	GIcon *icon;
+	GdkPixbuf *emblem;
+	GtkIconSize size;
+} IconKey;
+
+static GHashTable *icon_cache = NULL;
+
+/* Emblems with a weak reference */
+static GHashTable *watched_emblems = NULL;
+
+static guint
+icon_key_hash (IconKey const * key)
+{
+	return (key->icon ? g_icon_hash (key->icon) : 0) ^
+	       g_direct_hash (key->emblem) ^
+	       (guint) key->size;
+}
+
+static gboolean
+icon_key_equal (IconKey const * a,
+		IconKey const * b)
+{
+	if (a->emblem != b->emblem || a->size != b->size)
+		return FALSE;
+
+	if (a->icon == NULL || b->icon == NULL)
+		return a->icon == b->icon;
+
+	return g_icon_equal (a->icon, b->icon);
+}
+
+static void
+icon_key_free (IconKey * key)
+{
+	if (key->icon)
+		g_object_unref (key->icon);
+
+	g_slice_free (IconKey, key);
+}
+
+static gboolean
+icon_key_has_emblem (IconKey const * key,
+		     gpointer value,
+		     gpointer emblem)
+{
+	return key->emblem == emblem;
+}
+
+static void
+emblem_finalized (gpointer data,
+		  GObject * emblem)
+{
+	g_hash_table_remove (watched_emblems, emblem);
+	g_hash_table_foreach_remove (icon_cache,
+				     (GHRFunc) icon_key_has_emblem,
+				     emblem);
+}
+
+static void
+watch_emblem (GdkPixbuf * emblem)
+{
+	if (g_hash_table_contains (watched_emblems, emblem))
+		return;
+
+	g_hash_table_add (watched_emblems, emblem);
+	g_object_weak_ref (G_OBJECT (emblem), emblem_finalized, NULL);
+}
+
+static void
+cached_pixbuf_free (GdkPixbuf * pixbuf)
+{
+	if (pixbuf)
+		g_object_unref (pixbuf);
+}
+
+static void
+icon_theme_changed (GtkIconTheme * theme)
+{
+	g_hash_table_remove_all (icon_cache);
+}
+
+static GdkPixbuf *
+composite_emblem (GdkPixbuf * icon,
+		  GdkPixbuf * emblem,
+		  GtkIconSize size)
+{
+	GdkPixbuf *ret;
+	gint icon_size;
+
+	gtk_icon_size_lookup (size, NULL, &icon_size);
+
+	if (icon == NULL) {
+		ret = gdk_pixbuf_new (gdk_pixbuf_get_colorspace (emblem),
+				      gdk_pixbuf_get_has_alpha (emblem),
+				      gdk_pixbuf_get_bits_per_sample (emblem),
+				      icon_size,
+				      icon_size);
+	} else {
+		ret = gdk_pixbuf_copy (icon);
+	}
+
+	gdk_pixbuf_composite (emblem, ret,
+			      icon_size - 10, icon_size - 10, 10,
+			      10, icon_size - 10, icon_size - 10,
+			      1, 1, GDK_INTERP_NEAREST, 255);
+
+	return ret;
+}
+
+/*
+ * Like pluma_file_browser_utils_pixbuf_from_icon, with @emblem drawn in
+ * the bottom right corner if not NULL. The pixbufs are cached until the
+ * icon theme changes, or until @emblem is finalized: they must not be
+ * modified.
+ */
+GdkPixbuf *
+pluma_file_browser_utils_pixbuf_from_icon_cached (GIcon * icon,
+                                                  GdkPixbuf * emblem,
+                                                  GtkIconSize size)
+{
+	IconKey key = { icon, emblem, size };
+	IconKey *new_key;
+	GdkPixbuf *pixbuf;
+	gpointer cached;
+
+	if (icon == NULL && emblem == NULL)
+		return NULL;
+
+	if (icon_cache == NULL) {
+		icon_cache = g_hash_table_new_full ((GHashFunc) icon_key_hash,
+						    (GEqualFunc) icon_key_equal,
+						    (GDestroyNotify) icon_key_free,
+						    (GDestroyNotify) cached_pixbuf_free);
+
+		watched_emblems = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		g_signal_connect (gtk_icon_theme_get_default (),
+				  "changed",
+				  G_CALLBACK (icon_theme_changed),
+				  NULL);
+	}
+
+	if (g_hash_table_lookup_extended (icon_cache, &key, NULL, &cached))
+		return cached ? g_object_ref (cached) : NULL;
+
+	pixbuf = pluma_file_browser_utils_pixbuf_from_icon (icon, size);
+
+	if (emblem != NULL) {
+		GdkPixbuf *composited;
+
+		composited = composite_emblem (pixbuf, emblem, size);
+
+		if (pixbuf)
+			g_object_unref (pixbuf);
+
+		pixbuf = composited;
+	}
+
+	new_key = g_slice_new (IconKey);
+	new_key->icon = icon ? g_object_ref (icon) : NULL;
+	new_key->emblem = emblem;
+	new_key->size = size;
+
+	if (emblem != NULL)
+		watch_emblem (emblem);
+
+	/* failed lookups are cached as well */
+	g_hash_table_insert (icon_cache,
+			     new_key,
+			     pixbuf ? g_object_ref (pixbuf) : NULL);
+
+	return pixbuf;
+}
+
 gchar *
 pluma_file_browser_utils_file_basename (GFile * file)
 {
@@ -11,6 +11,9 @@ GdkPixbuf *pluma_file_browser_utils_pixbuf_from_icon	  (GIcon * icon,
                                                            GtkIconSize size);
 GdkPixbuf *pluma_file_browser_utils_pixbuf_from_file	  (GFile * file,
                                                            GtkIconSize size);
+GdkPixbuf *pluma_file_browser_utils_pixbuf_from_icon_cached (GIcon * icon,
+                                                             GdkPixbuf * emblem,
+                                                             GtkIconSize size);
 
 gchar * pluma_file_browser_utils_file_basename		  (GFile * file);
 gchar * pluma_file_browser_utils_uri_basename             (gchar const * uri);
@@ -49,6 +49,11 @@
 #define XML_UI_FILE "pluma-file-browser-widget-ui.xml"
 #define LOCATION_DATA_KEY "pluma-file-browser-widget-location"
 
+/* Delay before a pattern typed in the filter entry is applied */
+#define FILTER_DELAY 150
+/* Number of recent patterns whose match results are kept */
+#define FILTER_CACHE_SIZE 4
+
 enum 
 {
 	BOOKMARKS_ID,
@@ -115,6 +120,12 @@ typedef struct
 	GdkPixbuf *icon;
 } NameIcon;
 
+typedef struct
+{
+	gchar *pattern;
+	GHashTable *matches;
+} FilterCache;
+
 struct _PlumaFileBrowserWidgetPrivate 
 {
 	PlumaFileBrowserView *treeview;
@@ -145,6 +156,8 @@ struct _PlumaFileBrowserWidgetPrivate
 	gulong glob_filter_id;
 	GPatternSpec *filter_pattern;
 	gchar *filter_pattern_str;
+	GQueue *filter_caches;
+	guint filter_timeout_id;
 
 	GList *locations;
 	GList *current_location;
@@ -194,6 +207,7 @@ static void on_virtual_root_changed            (PlumaFileBrowserStore * model,
 						PlumaFileBrowserWidget * obj);
 
 static gboolean on_entry_filter_activate       (PlumaFileBrowserWidget * obj);
+static void on_entry_filter_changed            (PlumaFileBrowserWidget * obj);
 static void on_location_jump_activate          (GtkMenuItem * item,
 						PlumaFileBrowserWidget * obj);
 static void on_bookmarks_row_changed           (GtkTreeModel * model, 
@@ -273,6 +287,14 @@ filter_func_new (PlumaFileBrowserWidget * obj,
 	return result;
 }
 
+static void
+filter_cache_free (FilterCache * cache)
+{
+	g_free (cache->pattern);
+	g_hash_table_destroy (cache->matches);
+	g_free (cache);
+}
+
 static void
 location_free (Location * loc)
 {
@@ -339,6 +361,13 @@ pluma_file_browser_widget_finalize (GObject * object)
 	pluma_file_browser_store_set_filter_func (obj->priv->file_store,
 						  NULL, NULL);
 
+	if (obj->priv->filter_timeout_id != 0)
+		g_source_remove (obj->priv->filter_timeout_id);
+
+	g_queue_foreach (obj->priv->filter_caches, (GFunc) filter_cache_free,
+			 NULL);
+	g_queue_free (obj->priv->filter_caches);
+
 	g_object_unref (obj->priv->manager);
 	g_object_unref (obj->priv->file_store);
 	g_object_unref (obj->priv->bookmarks_store);
@@ -1242,6 +1271,9 @@ create_filter (PlumaFileBrowserWidget * obj)
 	g_signal_connect_swapped (entry, "activate",
 				  G_CALLBACK (on_entry_filter_activate),
 				  obj);
+	g_signal_connect_swapped (entry, "changed",
+				  G_CALLBACK (on_entry_filter_changed),
+				  obj);
 	g_signal_connect_swapped (entry, "focus_out_event",
 				  G_CALLBACK (on_entry_filter_activate),
 				  obj);
@@ -1261,6 +1293,7 @@ pluma_file_browser_widget_init (PlumaFileBrowserWidget * obj)
 			                                   (GEqualFunc)g_file_equal,
 			                                   g_object_unref,
 			                                   free_name_icon);
+	obj->priv->filter_caches = g_queue_new ();
 
 	gtk_box_set_spacing (GTK_BOX (obj), 3);
 	gtk_orientable_set_orientation (GTK_ORIENTABLE (obj),
@@ -1394,18 +1427,79 @@ filter_glob (PlumaFileBrowserWidget * obj, PlumaFileBrowserStore * store,
 			    PLUMA_FILE_BROWSER_STORE_COLUMN_FLAGS, &flags,
 			    -1);
 
-	if (FILE_IS_DIR (flags) || FILE_IS_DUMMY (flags))
+	if (FILE_IS_DIR (flags) || FILE_IS_DUMMY (flags)) {
 		result = TRUE;
-	else
-		result =
-		    g_pattern_match_string (obj->priv->filter_pattern,
-					    name);
+	} else {
+		FilterCache *cache;
+		gpointer match;
+
+		/* The head of the queue holds the results of the current pattern */
+		cache = g_queue_peek_head (obj->priv->filter_caches);
+
+		if (g_hash_table_lookup_extended (cache->matches, name,
+						  NULL, &match)) {
+			result = GPOINTER_TO_INT (match);
+		} else {
+			result =
+			    g_pattern_match_string (obj->priv->filter_pattern,
+						    name);
+			g_hash_table_insert (cache->matches, name,
+					     GINT_TO_POINTER (result));
+			return result;
+		}
+	}
 
 	g_free (name);
 
 	return result;
 }
 
+static void
+filter_cache_select (PlumaFileBrowserWidget * obj,
+		     gchar const * pattern)
+{
+	FilterCache *cache;
+	GList *item;
+
+	for (item = obj->priv->filter_caches->head; item; item = item->next) {
+		cache = (FilterCache *) (item->data);
+
+		if (strcmp (cache->pattern, pattern) == 0) {
+			g_queue_unlink (obj->priv->filter_caches, item);
+			g_queue_push_head_link (obj->priv->filter_caches, item);
+			return;
+		}
+	}
+
+	cache = g_new (FilterCache, 1);
+	cache->pattern = g_strdup (pattern);
+	cache->matches = g_hash_table_new_full (g_str_hash, g_str_equal,
+						g_free, NULL);
+	g_queue_push_head (obj->priv->filter_caches, cache);
+
+	if (g_queue_get_length (obj->priv->filter_caches) > FILTER_CACHE_SIZE)
+		filter_cache_free (g_queue_pop_tail (obj->priv->filter_caches));
+}
+
+static gboolean
+filter_pattern_narrows (gchar const * old_pattern,
+			gchar const * new_pattern)
+{
+	gsize len;
+
+	if (new_pattern == NULL)
+		return FALSE;
+
+	if (old_pattern == NULL)
+		return TRUE;
+
+	/* Everything matching "foo*bar" (or "foo") also matches "foo*" */
+	len = strlen (old_pattern);
+
+	return len > 0 && old_pattern[len - 1] == '*' &&
+	       strncmp (old_pattern, new_pattern, len - 1) == 0;
+}
+
 static void
 rename_selected_file (PlumaFileBrowserWidget * obj)
 {
@@ -1736,10 +1830,16 @@ set_filter_pattern_real (PlumaFileBrowserWidget * obj,
                         gboolean update_entry)
 {
 	GtkTreeModel *model;
+	gboolean narrowed;
 
 	model =
 	    gtk_tree_view_get_model (GTK_TREE_VIEW (obj->priv->treeview));
 
+	if (obj->priv->filter_timeout_id != 0) {
+		g_source_remove (obj->priv->filter_timeout_id);
+		obj->priv->filter_timeout_id = 0;
+	}
+
 	if (pattern != NULL && *pattern == '\0')
 		pattern = NULL;
 
@@ -1750,6 +1850,9 @@ set_filter_pattern_real (PlumaFileBrowserWidget * obj,
 	    strcmp (pattern, obj->priv->filter_pattern_str) == 0)
 		return;
 
+	narrowed = filter_pattern_narrows (obj->priv->filter_pattern_str,
+					   pattern);
+
 	/* Free the old pattern */
 	g_free (obj->priv->filter_pattern_str);
 	obj->priv->filter_pattern_str = g_strdup (pattern);
@@ -1769,13 +1872,17 @@ set_filter_pattern_real (PlumaFileBrowserWidget * obj,
 		}
 	} else {
 		obj->priv->filter_pattern = g_pattern_spec_new (pattern);
+		filter_cache_select (obj, pattern);
 
-		if (obj->priv->glob_filter_id == 0)
-			obj->priv->glob_filter_id =
-			    pluma_file_browser_widget_add_filter (obj,
-								  filter_glob,
-								  NULL,
-								  NULL);
+		if (obj->priv->glob_filter_id == 0) {
+			FilterFunc *f;
+
+			/* Added directly, the model is refiltered below */
+			f = filter_func_new (obj, filter_glob, NULL, NULL);
+			obj->priv->filter_funcs =
+			    g_slist_append (obj->priv->filter_funcs, f);
+			obj->priv->glob_filter_id = f->id;
+		}
 	}
 
 	if (update_entry) {
@@ -1789,11 +1896,22 @@ set_filter_pattern_real (PlumaFileBrowserWidget * obj,
 			gtk_expander_set_expanded (GTK_EXPANDER (obj->priv->filter_expander),
 		        	                   TRUE);
 		}
+
+		/* Setting the text queued the pattern once more */
+		if (obj->priv->filter_timeout_id != 0) {
+			g_source_remove (obj->priv->filter_timeout_id);
+			obj->priv->filter_timeout_id = 0;
+		}
 	}
 
-	if (PLUMA_IS_FILE_BROWSER_STORE (model))
-		pluma_file_browser_store_refilter (PLUMA_FILE_BROWSER_STORE
-						   (model));
+	if (PLUMA_IS_FILE_BROWSER_STORE (model)) {
+		if (narrowed)
+			pluma_file_browser_store_refilter_narrowed (PLUMA_FILE_BROWSER_STORE
+								    (model));
+		else
+			pluma_file_browser_store_refilter (PLUMA_FILE_BROWSER_STORE
+							   (model));
+	}
 
 	g_object_notify (G_OBJECT (obj), "filter-pattern");
 }
@@ -2882,6 +3000,26 @@ on_entry_filter_activate (PlumaFileBrowserWidget * obj)
 	return FALSE;
 }
 
+static gboolean
+filter_timeout (PlumaFileBrowserWidget * obj)
+{
+	obj->priv->filter_timeout_id = 0;
+	on_entry_filter_activate (obj);
+
+	return FALSE;
+}
+
+static void
+on_entry_filter_changed (PlumaFileBrowserWidget * obj)
+{
+	/* Wait for the user to stop typing before refiltering */
+	if (obj->priv->filter_timeout_id != 0)
+		g_source_remove (obj->priv->filter_timeout_id);
+
+	obj->priv->filter_timeout_id =
+	    g_timeout_add (FILTER_DELAY, (GSourceFunc) filter_timeout, obj);
+}
+
 static void
 on_location_jump_activate (GtkMenuItem * item,
 			   PlumaFileBrowserWidget * obj)
@@ -26,7 +26,9 @@ from virtualdirs import VirtualDirectory
 class Popup(Gtk.Dialog):
         __gtype_name__ = "QuickOpenPopup"
 
-        def __init__(self, window, paths, handler):
+        MAX_INDEX_RESULTS = 200
+
+        def __init__(self, window, paths, handler, indexes=None):
                 Gtk.Dialog.__init__(self,
                                     title=_('Quick Open'),
                                     parent=window,
@@ -59,6 +61,17 @@ class Popup(Gtk.Dialog):
                                 self._dirs.append(path)
                                 unique.append(path.get_uri())
 
+                self._indexes = []
+
+                for index in indexes or []:
+                        handler_id = index.connect('updated', self.on_index_updated)
+                        self._indexes.append((index, handler_id))
+
+                self._dir_cache = Pluma.DirCache.get_default()
+                self._dir_cache_id = self._dir_cache.connect('changed', self.on_dir_cache_changed)
+
+                self.connect('destroy', self.on_destroy)
+
         def get_final_size(self):
                 return self._size
 
@@ -136,8 +149,43 @@ class Popup(Gtk.Dialog):
 
                 return pixbuf
 
+        def _list_cached(self, gfile, listing):
+                children = []
+
+                for i in range(listing.get_n_entries()):
+                        name = listing.get_name(i)
+                        file_type = listing.get_file_type(i)
+
+                        content_type = listing.get_content_type(i)
+
+                        if file_type == Gio.FileType.DIRECTORY:
+                                icon = Gio.ThemedIcon.new('folder')
+                        elif content_type:
+                                icon = Gio.content_type_get_icon(content_type)
+                        else:
+                                icon = self._icon_for_name(name)
+
+                        children.append((gfile.get_child(name), name, file_type, icon))
+
+                return children
+
         def _list_dir(self, gfile):
                 entries = []
+                ret = None
+
+                if not isinstance(gfile, VirtualDirectory):
+                        # Show what the directory contained the last time,
+                        # it is checked (or listed for the first time) in
+                        # the background and on_dir_cache_changed shows
+                        # the new entries; listings the cache cannot write
+                        # are kept in memory, so they show up anyway
+                        listing = self._dir_cache.lookup(gfile)
+                        self._dir_cache.revalidate(gfile)
+
+                        if listing:
+                                return self._list_cached(gfile, listing)
+                        else:
+                                return []
 
                 try:
                         ret = gfile.enumerate_children("standard::*", Gio.FileQueryInfoFlags.NONE, None)
@@ -152,7 +200,7 @@ class Popup(Gtk.Dialog):
                                         break
 
                                 entries.append((gfile.get_child(entry.get_name()), entry))
-                else:
+                elif ret:
                         entries = ret
 
                 children = []
@@ -222,6 +270,41 @@ class Popup(Gtk.Dialog):
 
                 return found
 
+        def _fuzzy_markup(self, path, text):
+                out = ''
+                lpath = path.lower()
+                ltext = text.lower()
+                i = 0
+
+                for j in range(0, len(path)):
+                        if i < len(ltext) and lpath[j] == ltext[i]:
+                                out += '<b>%s</b>' % (xml.sax.saxutils.escape(path[j]),)
+                                i += 1
+                        else:
+                                out += xml.sax.saxutils.escape(path[j])
+
+                return out
+
+        def _icon_for_name(self, name):
+                content_type, uncertain = Gio.content_type_guess(name, None)
+                return Gio.content_type_get_icon(content_type)
+
+        def do_search_indexes(self, text):
+                found = {}
+
+                for index, handler_id in self._indexes:
+                        root = index.get_root()
+
+                        for path in index.query(text, self.MAX_INDEX_RESULTS):
+                                gfile = root.resolve_relative_path(path)
+                                found[gfile.get_uri()] = True
+                                self._append_to_store((self._icon_for_name(os.path.basename(path)),
+                                                       self._fuzzy_markup(path, text),
+                                                       gfile,
+                                                       Gio.FileType.REGULAR))
+
+                return found
+
         def _replace_insensitive(self, s, find, rep):
                 out = ''
                 l = s.lower()
@@ -334,9 +417,17 @@ class Popup(Gtk.Dialog):
                 else:
                         parts = self.normalize_relative(text.split(os.sep))
                         files = []
+                        indexed = {}
+
+                        if not '..' in parts:
+                                indexed = self.do_search_indexes(text)
 
                         for d in self._dirs:
                                 for entry in self.do_search_dir(parts, d):
+                                        # already listed from an index
+                                        if entry[0].get_uri() in indexed:
+                                                continue
+
                                         pathparts = self._make_parts(d, entry[0], parts)
                                         self._append_to_store((entry[3], self.make_markup(parts, pathparts), entry[0], entry[2]))
 
@@ -553,4 +644,32 @@ class Popup(Gtk.Dialog):
         def on_focus_entry(self, group, accel, keyval, modifier):
                 self._entry.grab_focus()
 
+        def on_index_updated(self, index):
+                if self._entry.get_text().strip() != '':
+                        self.do_search()
+                        self.on_selection_changed(self._treeview.get_selection())
+
+        def on_dir_cache_changed(self, cache, gfile):
+                stale = [d for d in self._cache if not isinstance(d, VirtualDirectory) and d.equal(gfile)]
+
+                if not stale:
+                        return
+
+                for d in stale:
+                        del self._cache[d]
+
+                if self._entry.get_text().strip() != '':
+                        self.do_search()
+                        self.on_selection_changed(self._treeview.get_selection())
+
+        def on_destroy(self, widget):
+                for index, handler_id in self._indexes:
+                        index.disconnect(handler_id)
+
+                self._indexes = []
+
+                if self._dir_cache_id:
+                        self._dir_cache.disconnect(self._dir_cache_id)
+                        self._dir_cache_id = 0
+
 # ex:ts=8:et:
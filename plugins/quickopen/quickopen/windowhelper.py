@@ -72,6 +72,7 @@ class WindowHelper:
 
         def _create_popup(self):
                 paths = []
+                indexes = []
 
                 # Open documents
                 paths.append(CurrentDocumentsDirectory(self._window))
@@ -98,6 +99,12 @@ class WindowHelper:
                                         if gfile.is_native():
                                                 paths.append(gfile)
 
+                                                # The project tree is also searched recursively
+                                                # through an index kept in the background
+                                                index = Pluma.FileIndex.get_for_root(gfile)
+                                                index.refresh()
+                                                indexes.append(index)
+
                 except StandardError:
                         pass
 
@@ -117,7 +124,7 @@ class WindowHelper:
                 # Home directory
                 paths.append(Gio.file_new_for_path(os.path.expanduser('~')))
 
-                self._popup = Popup(self._window, paths, self.on_activated)
+                self._popup = Popup(self._window, paths, self.on_activated, indexes)
 
                 self._popup.set_default_size(*self._plugin.get_popup_size())
                 self._popup.set_transient_for(self._window)
@@ -81,16 +81,20 @@ class Provider(GObject.Object, GtkSource.CompletionProvider):
         def get_proposals(self, word):
                 if self.proposals:
                         proposals = self.proposals
+
+                        # Filter based on the current word
+                        if word:
+                                proposals = filter(lambda x: x['tag'].startswith(word), proposals)
+                elif word:
+                        # Look up the triggers starting with the current word
+                        # in the index instead of filtering every snippet
+                        proposals = Library().complete_tag(word, self.language_id)
                 else:
                         proposals = Library().get_snippets(None)
                         
                         if self.language_id:
                                 proposals += Library().get_snippets(self.language_id)
 
-                # Filter based on the current word
-                if word:
-                        proposals = filter(lambda x: x['tag'].startswith(word), proposals)
-
                 return map(lambda x: Proposal(x), proposals)
 
         def do_populate(self, context):
@@ -43,6 +43,7 @@ class Document:
                 self.active_snippets = []
                 self.active_placeholder = None
                 self.signal_ids = {}
+                self.watch_ids = []
                 
                 self.ordered_placeholders = []
                 self.update_placeholders = []
@@ -96,7 +97,7 @@ class Document:
                         # Remove signals
                         signals = {self.view: ('key-press-event', 'destroy', 
                                                'notify::editable', 'drag-data-received', 'expose-event'),
-                                   buf:       ('notify::language', 'changed', 'cursor-moved', 'insert-text'),
+                                   buf:       ('notify::language', 'insert-text'),
                                    self.view.get_completion(): ('hide',)}
 
                         for obj, sig in signals.items():
@@ -200,16 +201,35 @@ class Document:
         def first_snippet_inserted(self):
                 buf = self.view.get_buffer()
                 
-                self.connect_signal(buf, 'changed', self.on_buffer_changed)
-                self.connect_signal(buf, 'cursor-moved', self.on_buffer_cursor_moved)
                 self.connect_signal_after(buf, 'insert-text', self.on_buffer_insert_text)
         
         def last_snippet_removed(self):
                 buf = self.view.get_buffer()
-                self.disconnect_signal(buf, 'changed')
-                self.disconnect_signal(buf, 'cursor-moved')
                 self.disconnect_signal(buf, 'insert-text')
 
+        # Only get called back for changes and cursor moves within the range
+        # spanned by the active snippets, not on every keystroke
+        def update_watches(self):
+                buf = self.view.get_buffer()
+
+                for watch_id in self.watch_ids:
+                        buf.remove_watch(watch_id)
+
+                self.watch_ids = []
+
+                if len(self.active_snippets) == 0:
+                        return
+
+                first = min(self.active_snippets, key=lambda x: x.begin_iter().get_offset())
+                last = max(self.active_snippets, key=lambda x: x.end_iter().get_offset())
+
+                self.watch_ids.append(buf.add_watch(first.begin_mark, last.end_mark,
+                                Pluma.DocumentWatchFlags.CHANGES,
+                                self.on_watch_changed, None))
+                self.watch_ids.append(buf.add_watch(first.begin_mark, last.end_mark,
+                                Pluma.DocumentWatchFlags.CURSOR,
+                                self.on_watch_cursor_moved, None))
+
         def current_placeholder(self):
                 buf = self.view.get_buffer()
                 
@@ -535,6 +555,7 @@ class Document:
 
                 sn = s.insert_into(self, start)
                 self.active_snippets.append(sn)
+                self.update_watches()
 
                 # Put cursor at first tab placeholder
                 keys = filter(lambda x: x > 0, sn.placeholders.keys())
@@ -677,6 +698,7 @@ class Document:
 
                 snippet.deactivate()
                 self.active_snippets.remove(snippet)
+                self.update_watches()
 
                 if len(self.active_snippets) == 0:
                         self.last_snippet_removed()
@@ -702,6 +724,12 @@ class Document:
                 self.stop()
                 return
 
+        def on_watch_cursor_moved(self, buf, start, end, data):
+                self.on_buffer_cursor_moved(buf)
+
+        def on_watch_changed(self, buf, start, end, data):
+                self.on_buffer_changed(buf)
+
         def on_buffer_cursor_moved(self, buf):
                 piter = buf.get_iter_at_mark(buf.get_insert())
 
@@ -20,11 +20,13 @@ import weakref
 import sys
 import tempfile
 import re
+import bisect
 
 from gi.repository import Gdk, Gtk
 
 import xml.etree.ElementTree as et
 from Helper import *
+from TriggerIndex import TriggerIndex, prefix_range
 
 class NamespacedId:
         def __init__(self, namespace, id):
@@ -271,6 +273,7 @@ class LanguageContainer:
                 self.language = language
                 self.snippets = []
                 self.snippets_by_prop = {'tag': {}, 'accelerator': {}, 'drop-targets': {}}
+                self.tags = []
                 self.accel_group = Gtk.AccelGroup()
                 self._refs = 0
 
@@ -299,6 +302,9 @@ class LanguageContainer:
                         else:
                                 snippets[val] = [snippet]
 
+                                if prop == 'tag':
+                                        bisect.insort(self.tags, val)
+
         def _remove_prop(self, snippet, prop, value=0):
                 if value == 0:
                         value = snippet[prop]
@@ -323,6 +329,12 @@ class LanguageContainer:
                         except:
                                 True
 
+                        if val in snippets and not snippets[val]:
+                                del snippets[val]
+
+                                if prop == 'tag':
+                                        self.tags.remove(val)
+
         def append(self, snippet):
                 tag = snippet['tag']
                 accelerator = snippet['accelerator']
@@ -619,6 +631,8 @@ class SnippetsUserFile(SnippetsSystemFile):
                 try:
                         write_xml(self.root, self.path, ('text', 'accelerator'))
                         self.tainted = False
+
+                        Library().invalidate_index(self.language)
                 except IOError:
                         # Couldn't save, what to do
                         sys.stderr.write("Could not save user snippets file to " + \
@@ -645,11 +659,13 @@ class Library(Singleton):
                 self.loaded = False
                 self.check_buffer = Gtk.TextBuffer()
 
-        def set_dirs(self, userdir, systemdirs):
+        def set_dirs(self, userdir, systemdirs, cachedir=None):
                 self.userdir = userdir
                 self.systemdirs = systemdirs
+                self.cachedir = cachedir
                 
                 self.libraries = {}
+                self.indices = {}
                 self.containers = {}
                 self.overridden = {}
                 self.loaded_ids = []
@@ -800,6 +816,7 @@ class Library(Singleton):
                 else:
                         self.libraries[library.language] = [library]
 
+                self.invalidate_index(library.language)
                 return True
         
         def remove_library(self, library):
@@ -819,6 +836,8 @@ class Library(Singleton):
                 for snippet in list(container.snippets):
                         if snippet.library() == library:
                                 container.remove(snippet)
+
+                self.invalidate_index(library.language)
         
         def add_user_library(self, path):
                 library = SnippetsUserFile(path)
@@ -912,6 +931,70 @@ class Library(Singleton):
                                 for library in self.libraries[lang]:
                                         library.ensure()
 
+        def is_loaded(self, language):
+                if not language in self.containers:
+                        return False
+
+                for library in self.libraries.get(language, []):
+                        if library.ok and not library.loaded:
+                                return False
+
+                return True
+
+        def index_path(self, language):
+                if not self.cachedir:
+                        return None
+
+                return os.path.join(self.cachedir, (language or 'global') + '.index')
+
+        # Returns the trigger index of a single language, parsing the libraries
+        # only when the cached index is missing or out of date
+        def index(self, language):
+                if language in self.indices:
+                        return self.indices[language]
+
+                libraries = self.libraries.get(language, [])
+                files = [library.path for library in libraries if library.path]
+                index = TriggerIndex(self.index_path(language), files)
+
+                if libraries and not index.load():
+                        self.container(language)
+
+                        for library in libraries:
+                                library.ensure()
+
+                        index.save(self.containers[language].tags)
+
+                self.indices[language] = index
+                return index
+
+        def invalidate_index(self, language):
+                language = self.normalize_language(language)
+
+                if language in self.indices:
+                        del self.indices[language]
+
+        # Returns the sorted tab triggers of a language, from the snippets when
+        # they are loaded and from the trigger index otherwise
+        def _tags(self, language):
+                if self.is_loaded(language):
+                        return self.containers[language].tags
+                else:
+                        return self.index(language).tags
+
+        def has_tag(self, tag, language=None):
+                self.ensure_files()
+                language = self.normalize_language(language)
+
+                for lang in (language, None):
+                        tags = self._tags(lang)
+                        start, end = prefix_range(tags, tag)
+
+                        if start != end and tags[start] == tag:
+                                return True
+
+                return False
+
         def ensure_files(self):
                 if self.loaded:
                         return
@@ -990,7 +1073,43 @@ class Library(Singleton):
 
         # Get snippets for a given tag
         def from_tag(self, tag, language=None):
+                # Most words are not a trigger, avoid loading the libraries
+                # for those
+                if not self.has_tag(tag, language):
+                        return []
+
                 return self._from_prop('tag', tag, language)
+
+        # Get the global and language snippets of which the tag starts with
+        # prefix
+        def complete_tag(self, prefix, language=None):
+                self.ensure_files()
+                language = self.normalize_language(language)
+
+                result = []
+
+                for lang in (None, language):
+                        if not lang in self.libraries:
+                                continue
+
+                        tags = self._tags(lang)
+                        start, end = prefix_range(tags, prefix)
+
+                        if start == end:
+                                continue
+
+                        tags = tags[start:end]
+                        self.ensure(lang)
+
+                        container = self.containers[lang]
+
+                        for tag in tags:
+                                result += container.from_prop('tag', tag)
+
+                        if lang == language:
+                                break
+
+                return result
         
         # Get snippets for a given drop target
         def from_drop_target(self, drop_target, language=None):
@@ -0,0 +1,121 @@
+#    Pluma snippets plugin
+#    Copyright (C) 2005-2006  Jesse van den Kieboom <jesse@icecrew.nl>
+#
+#    This program is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 2 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import os
+import bisect
+import marshal
+
+from Helper import *
+
+# Returns the range of a sorted list of triggers that start with prefix
+def prefix_range(tags, prefix):
+        start = bisect.bisect_left(tags, prefix)
+        end = start
+
+        while end < len(tags) and tags[end].startswith(prefix):
+                end += 1
+
+        return (start, end)
+
+# The trigger index is the sorted list of tab triggers provided by the
+# snippet files of a single language. It is stored in the user cache
+# directory together with the modification times of the files it was built
+# from, so that a trigger can be looked up without parsing any XML as long
+# as none of the files changed.
+class TriggerIndex:
+        VERSION = 1
+
+        def __init__(self, path, files):
+                self.path = path
+                self.stamp = self._stamp(files)
+                self.tags = []
+
+        def _stamp(self, files):
+                stamp = []
+
+                for f in files:
+                        try:
+                                st = os.stat(f)
+                        except OSError:
+                                continue
+
+                        stamp.append((f, st.st_mtime, st.st_size))
+
+                stamp.sort()
+                return stamp
+
+        def load(self):
+                if not self.path:
+                        return False
+
+                try:
+                        f = open(self.path, 'rb')
+
+                        try:
+                                data = marshal.load(f)
+                        finally:
+                                f.close()
+                except (IOError, EOFError, ValueError, TypeError):
+                        return False
+
+                try:
+                        if data['version'] != TriggerIndex.VERSION or \
+                           data['stamp'] != self.stamp:
+                                return False
+
+                        self.tags = data['tags']
+                except (KeyError, TypeError):
+                        return False
+
+                snippets_debug('Loaded trigger index: ', self.path)
+                return True
+
+        def save(self, tags):
+                self.tags = sorted(tags)
+
+                if not self.path:
+                        return
+
+                path = os.path.dirname(self.path)
+                data = {'version': TriggerIndex.VERSION,
+                        'stamp': self.stamp,
+                        'tags': self.tags}
+
+                try:
+                        if not os.path.isdir(path):
+                                os.makedirs(path, 0755)
+
+                        f = open(self.path, 'wb')
+
+                        try:
+                                marshal.dump(data, f)
+                        finally:
+                                f.close()
+                except (IOError, OSError, ValueError):
+                        # Not being able to write the cache only costs a
+                        # parse on the next startup
+                        snippets_debug('Could not write trigger index: ', self.path)
+
+        def lookup(self, tag):
+                start, end = prefix_range(self.tags, tag)
+                return start != end and self.tags[start] == tag
+
+        def complete(self, prefix):
+                start, end = prefix_range(self.tags, prefix)
+                return self.tags[start:end]
+
+# ex:ts=8:et:
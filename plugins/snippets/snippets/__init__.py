@@ -54,7 +54,8 @@ class SnippetsPlugin(GObject.Object, Peas.Activatable):
                 library.add_accelerator_callback(self.accelerator_activated)
 
                 snippetsdir = os.path.join(GLib.get_user_config_dir(), '/pluma/snippets')
-                library.set_dirs(snippetsdir, self.system_dirs())
+                cachedir = os.path.join(GLib.get_user_cache_dir(), 'pluma', 'snippets')
+                library.set_dirs(snippetsdir, self.system_dirs(), cachedir)
 
                 self._helper = WindowHelper(self)
 
@@ -1131,6 +1131,10 @@ set_auto_spell_from_metadata (PlumaSpellPlugin *plugin,
 		g_free (active_str);
 	}
 
+	/* e.g. turned off by the large file profile */
+	if (pluma_document_get_disabled_features (doc) & PLUMA_DOCUMENT_FEATURE_SPELL_CHECKING)
+		active = FALSE;
+
 	window = PLUMA_WINDOW (plugin->priv->window);
 
 	set_auto_spell (window, doc, active);
@@ -1220,6 +1224,21 @@ on_document_saved (PlumaDocument *doc,
 	}
 }
 
+static void
+on_document_disabled_features (PlumaDocument    *doc,
+			       GParamSpec       *pspec,
+			       PlumaSpellPlugin *plugin)
+{
+	PlumaTab *tab;
+
+	/* the profile is chosen while loading, "loaded" will take care */
+	tab = pluma_tab_get_from_document (doc);
+	if (tab != NULL && pluma_tab_get_state (tab) == PLUMA_TAB_STATE_LOADING)
+		return;
+
+	set_auto_spell_from_metadata (plugin, doc, plugin->priv->action_group);
+}
+
 static void
 tab_added_cb (PlumaWindow *window,
 	      PlumaTab    *tab,
@@ -1246,6 +1265,10 @@ tab_added_cb (PlumaWindow *window,
 	g_signal_connect (doc, "saved",
 			  G_CALLBACK (on_document_saved),
 			  plugin);
+
+	g_signal_connect (doc, "notify::disabled-features",
+			  G_CALLBACK (on_document_disabled_features),
+			  plugin);
 }
 
 static void
@@ -1259,6 +1282,7 @@ tab_removed_cb (PlumaWindow *window,
 	
 	g_signal_handlers_disconnect_by_func (doc, on_document_loaded, plugin);
 	g_signal_handlers_disconnect_by_func (doc, on_document_saved, plugin);
+	g_signal_handlers_disconnect_by_func (doc, on_document_disabled_features, plugin);
 }
 
 static void
@@ -1339,6 +1363,10 @@ pluma_spell_plugin_activate (PeasActivatable *activatable)
 		g_signal_handlers_disconnect_by_func (doc,
 		                                      on_document_saved,
 		                                      plugin);
+
+		g_signal_handlers_disconnect_by_func (doc,
+		                                      on_document_disabled_features,
+		                                      plugin);
 	}
 
 	data->tab_added_id =
@@ -53,79 +53,76 @@ enum {
 };
 
 static void
-strip_trailing_spaces (GtkTextBuffer *text_buffer)
+strip_line (GtkTextBuffer *text_buffer,
+	    gint           line_num)
 {
-	gint line_count, line_num;
-	GtkTextIter line_start, line_end;
-	gchar *slice;
-	gchar byte;
-	gint byte_index;
-	gint strip_start_index, strip_end_index;
-	gboolean should_strip;
 	GtkTextIter strip_start, strip_end;
+	gunichar c;
 
-	g_assert (text_buffer != NULL);
+	gtk_text_buffer_get_iter_at_line (text_buffer, &strip_end, line_num);
 
-	line_count = gtk_text_buffer_get_line_count (text_buffer);
+	if (!gtk_text_iter_ends_line (&strip_end))
+	{
+		gtk_text_iter_forward_to_line_end (&strip_end);
+	}
 
-	for (line_num = 0; line_num < line_count; ++line_num)
+	/* Find the spaces and tabs before the end of the line */
+	strip_start = strip_end;
+
+	while (!gtk_text_iter_starts_line (&strip_start))
 	{
-		/* Get line text */
-		gtk_text_buffer_get_iter_at_line (text_buffer, &line_start, line_num);
+		gtk_text_iter_backward_char (&strip_start);
+		c = gtk_text_iter_get_char (&strip_start);
 
-		if (line_num == line_count - 1)
+		if ((c != ' ') && (c != '\t'))
 		{
-			gtk_text_buffer_get_end_iter (text_buffer, &line_end);
-		}
-		else
-		{
-			gtk_text_buffer_get_iter_at_line (text_buffer, &line_end, line_num + 1);
+			gtk_text_iter_forward_char (&strip_start);
+			break;
 		}
+	}
 
-		slice = gtk_text_buffer_get_slice (text_buffer, &line_start, &line_end, TRUE);
+	/* Strip trailing spaces */
+	if (!gtk_text_iter_equal (&strip_start, &strip_end))
+	{
+		gtk_text_buffer_delete (text_buffer, &strip_start, &strip_end);
+	}
+}
 
-		if (slice == NULL)
-		{
-			continue;
-		}
+static void
+strip_trailing_spaces (PlumaDocument *document)
+{
+	GtkTextBuffer *text_buffer = GTK_TEXT_BUFFER (document);
+	gint *dirty_lines;
+	guint n_values;
+	guint i;
+	gint line_num;
 
-		/* Find indices of bytes that should be stripped */
-		should_strip = FALSE;
+	g_assert (document != NULL);
 
-		for (byte_index = 0; slice [byte_index] != 0; ++byte_index)
-		{
-			byte = slice [byte_index];
-
-			if ((byte == ' ') || (byte == '\t'))
-			{
-				if (!should_strip)
-				{
-					strip_start_index = byte_index;
-					should_strip = TRUE;
-				}
-
-				strip_end_index = byte_index + 1;
-			}
-			else if ((byte == '\r') || (byte == '\n'))
-			{
-				break;
-			}
-			else
-			{
-				should_strip = FALSE;
-			}
-		}
+	/* Only the lines edited since the last load or save can have new
+	 * trailing spaces: stripping does not change the line numbers, so
+	 * they can be fetched once before editing */
+	dirty_lines = pluma_document_get_dirty_lines (document, &n_values);
+
+	if (n_values == 0)
+	{
+		g_free (dirty_lines);
+		return;
+	}
 
-		g_free (slice);
+	gtk_text_buffer_begin_user_action (text_buffer);
 
-		/* Strip trailing spaces */
-		if (should_strip)
+	for (i = 0; i + 1 < n_values; i += 2)
+	{
+		for (line_num = dirty_lines[i]; line_num <= dirty_lines[i + 1]; ++line_num)
 		{
-			gtk_text_buffer_get_iter_at_line_index (text_buffer, &strip_start, line_num, strip_start_index);
-			gtk_text_buffer_get_iter_at_line_index (text_buffer, &strip_end, line_num, strip_end_index);
-			gtk_text_buffer_delete (text_buffer, &strip_start, &strip_end);
+			strip_line (text_buffer, line_num);
 		}
 	}
+
+	gtk_text_buffer_end_user_action (text_buffer);
+
+	g_free (dirty_lines);
 }
 
 static void
@@ -135,9 +132,7 @@ on_save (PlumaDocument         *document,
 	 PlumaDocumentSaveFlags save_flags,
 	 PlumaTrailSavePlugin  *plugin)
 {
-	GtkTextBuffer *text_buffer = GTK_TEXT_BUFFER (document);
-
-	strip_trailing_spaces (text_buffer);
+	strip_trailing_spaces (document);
 }
 
 static void
@@ -27,6 +27,7 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <errno.h>
+#include <poll.h>
 
 #include "bacon-message-connection.h"
 
@@ -34,6 +35,16 @@
 #define UNIX_PATH_MAX 108
 #endif
 
+/* A frame is this byte, the length of the data as a 32 bit big endian
+ * number and the data. Text messages never start with it */
+#define FRAME_START '\001'
+#define FRAME_MAX_LEN (16 * 1024 * 1024)
+#define FRAME_ACK 'A'
+
+/* How long a client waits for the server to acknowledge a frame, in
+ * milliseconds */
+#define ACK_TIMEOUT 10000
+
 struct BaconMessageConnection {
 	/* A server accepts connections */
 	gboolean is_server;
@@ -54,6 +65,10 @@ struct BaconMessageConnection {
 	/* callback */
 	void (*func) (const char *message, gpointer user_data);
 	gpointer data;
+
+	/* callback for frames */
+	BaconDataReceivedFunc data_func;
+	gpointer data_data;
 };
 
 static gboolean
@@ -117,6 +132,8 @@ accept_new_connection (BaconMessageConnection *server_conn)
 	conn->is_server = FALSE;
 	conn->func = server_conn->func;
 	conn->data = server_conn->data;
+	conn->data_func = server_conn->data_func;
+	conn->data_data = server_conn->data_data;
 
 	conn->fd = accept (server_conn->fd, NULL, (guint *)&alen);
 
@@ -126,6 +143,90 @@ accept_new_connection (BaconMessageConnection *server_conn)
 	setup_connection (conn);
 }
 
+static gboolean
+read_all (int fd, char *buf, gsize len)
+{
+	while (len > 0)
+	{
+		ssize_t rc;
+
+		rc = read (fd, buf, len);
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc <= 0)
+			return FALSE;
+
+		buf += rc;
+		len -= rc;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+write_all (int fd, const char *buf, gsize len)
+{
+	while (len > 0)
+	{
+		ssize_t rc;
+
+		rc = write (fd, buf, len);
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc <= 0)
+			return FALSE;
+
+		buf += rc;
+		len -= rc;
+	}
+
+	return TRUE;
+}
+
+static void
+close_connection (BaconMessageConnection *conn)
+{
+	g_io_channel_shutdown (conn->chan, FALSE, NULL);
+	g_io_channel_unref (conn->chan);
+	conn->chan = NULL;
+	close (conn->fd);
+	conn->fd = -1;
+	conn->conn_id = 0;
+}
+
+/* Reads the rest of a frame in one go, instead of a byte at a time */
+static gboolean
+read_frame (BaconMessageConnection *conn)
+{
+	guint32 len;
+	char *data;
+	char ack = FRAME_ACK;
+
+	if (!read_all (conn->fd, (char *) &len, sizeof (len)))
+		return FALSE;
+
+	len = GUINT32_FROM_BE (len);
+	if (len > FRAME_MAX_LEN)
+		return FALSE;
+
+	data = g_malloc (len + 1);
+
+	if (!read_all (conn->fd, data, len))
+	{
+		g_free (data);
+		return FALSE;
+	}
+
+	data[len] = '\0';
+
+	if (conn->data_func != NULL)
+		(*conn->data_func) (data, len, conn->data_data);
+
+	g_free (data);
+
+	return write_all (conn->fd, &ack, 1);
+}
+
 static gboolean
 server_cb (GIOChannel *source, GIOCondition condition, gpointer data)
 {
@@ -142,6 +243,20 @@ server_cb (GIOChannel *source, GIOCondition condition, gpointer data)
 	message = g_malloc (1);
 	cd = conn->fd;
 	rc = read (cd, &buf, 1);
+
+	if (rc > 0 && buf == FRAME_START)
+	{
+		g_free (message);
+
+		if (!read_frame (conn))
+		{
+			close_connection (conn);
+			return FALSE;
+		}
+
+		return TRUE;
+	}
+
 	while (rc > 0 && buf != '\n')
 	{
 		message = g_realloc (message, rc + offset + 1);
@@ -150,13 +265,8 @@ server_cb (GIOChannel *source, GIOCondition condition, gpointer data)
 		rc = read (cd, &buf, 1);
 	}
 	if (rc <= 0) {
-		g_io_channel_shutdown (conn->chan, FALSE, NULL);
-		g_io_channel_unref (conn->chan);
-		conn->chan = NULL;
-		close (conn->fd);
-		conn->fd = -1;
+		close_connection (conn);
 		g_free (message);
-		conn->conn_id = 0;
 
 		return FALSE;
 	}
@@ -386,6 +496,60 @@ bacon_message_connection_send (BaconMessageConnection *conn,
 	g_io_channel_flush (conn->chan, NULL);
 }
 
+void
+bacon_message_connection_set_data_callback (BaconMessageConnection *conn,
+					    BaconDataReceivedFunc func,
+					    gpointer user_data)
+{
+	g_return_if_fail (conn != NULL);
+
+	conn->data_func = func;
+	conn->data_data = user_data;
+}
+
+/* Returns FALSE if the frame could not be sent or, when @wait_ack is
+ * TRUE, if the server did not acknowledge it in time */
+gboolean
+bacon_message_connection_send_data (BaconMessageConnection *conn,
+				    const char *data,
+				    gsize len,
+				    gboolean wait_ack)
+{
+	char header[1 + sizeof (guint32)];
+	guint32 be_len;
+	struct pollfd pfd;
+	char ack;
+
+	g_return_val_if_fail (conn != NULL, FALSE);
+	g_return_val_if_fail (data != NULL || len == 0, FALSE);
+	g_return_val_if_fail (len <= FRAME_MAX_LEN, FALSE);
+
+	header[0] = FRAME_START;
+	be_len = GUINT32_TO_BE ((guint32) len);
+	memcpy (header + 1, &be_len, sizeof (be_len));
+
+	if (!write_all (conn->fd, header, sizeof (header)) ||
+	    !write_all (conn->fd, data, len))
+		return FALSE;
+
+	if (!wait_ack)
+		return TRUE;
+
+	pfd.fd = conn->fd;
+	pfd.events = POLLIN;
+
+	while (poll (&pfd, 1, ACK_TIMEOUT) < 0)
+	{
+		if (errno != EINTR)
+			return FALSE;
+	}
+
+	if ((pfd.revents & POLLIN) == 0)
+		return FALSE;
+
+	return read_all (conn->fd, &ack, 1) && ack == FRAME_ACK;
+}
+
 gboolean
 bacon_message_connection_get_is_server (BaconMessageConnection *conn)
 {
@@ -27,6 +27,12 @@ G_BEGIN_DECLS
 typedef void (*BaconMessageReceivedFunc) (const char *message,
 					  gpointer user_data);
 
+/* Binary requests, sent as a length prefixed frame. The server answers
+ * each frame with one byte once the callback has returned */
+typedef void (*BaconDataReceivedFunc) (const char *data,
+				       gsize       len,
+				       gpointer    user_data);
+
 typedef struct BaconMessageConnection BaconMessageConnection;
 
 BaconMessageConnection *bacon_message_connection_new	(const char *prefix);
@@ -36,6 +42,13 @@ void bacon_message_connection_set_callback		(BaconMessageConnection *conn,
 							 gpointer user_data);
 void bacon_message_connection_send			(BaconMessageConnection *conn,
 							 const char *message);
+void bacon_message_connection_set_data_callback		(BaconMessageConnection *conn,
+							 BaconDataReceivedFunc func,
+							 gpointer user_data);
+gboolean bacon_message_connection_send_data		(BaconMessageConnection *conn,
+							 const char *data,
+							 gsize len,
+							 gboolean wait_ack);
 gboolean bacon_message_connection_get_is_server		(BaconMessageConnection *conn);
 
 G_END_DECLS
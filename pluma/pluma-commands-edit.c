@@ -34,6 +34,7 @@
 #include <config.h>
 #endif
 
+#include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
 #include "pluma-commands.h"
@@ -116,6 +117,101 @@ _pluma_cmd_edit_copy (GtkAction   *action,
 	gtk_widget_grab_focus (GTK_WIDGET (active_view));
 }
 
+/* Paged documents only hold part of the file, this copies lines which
+ * are not in the buffer */
+void
+_pluma_cmd_edit_copy_lines (GtkAction   *action,
+			    PlumaWindow *window)
+{
+	PlumaView *active_view;
+	PlumaDocument *doc;
+	GtkTextBuffer *buffer;
+	GtkTextIter start;
+	GtkTextIter end;
+	GtkWidget *dialog;
+	GtkWidget *grid;
+	GtkWidget *label;
+	GtkWidget *from_spin;
+	GtkWidget *to_spin;
+	gint64 first_line;
+	gint from;
+	gint to;
+
+	pluma_debug (DEBUG_COMMANDS);
+
+	active_view = pluma_window_get_active_view (window);
+	g_return_if_fail (active_view);
+
+	buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (active_view));
+	doc = PLUMA_DOCUMENT (buffer);
+
+	g_return_if_fail (_pluma_document_is_paged (doc));
+
+	/* start from the selected lines */
+	first_line = _pluma_document_get_paged_first_line (doc);
+	gtk_text_buffer_get_selection_bounds (buffer, &start, &end);
+	from = MIN (first_line + gtk_text_iter_get_line (&start) + 1, G_MAXINT);
+	to = MIN (first_line + gtk_text_iter_get_line (&end) + 1, G_MAXINT);
+
+	dialog = gtk_dialog_new_with_buttons (_("Copy Lines"),
+					      GTK_WINDOW (window),
+					      GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+					      _("_Cancel"), GTK_RESPONSE_CANCEL,
+					      _("_Copy"), GTK_RESPONSE_OK,
+					      NULL);
+	gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_OK);
+
+	grid = gtk_grid_new ();
+	gtk_grid_set_row_spacing (GTK_GRID (grid), 6);
+	gtk_grid_set_column_spacing (GTK_GRID (grid), 12);
+	gtk_container_set_border_width (GTK_CONTAINER (grid), 6);
+
+	label = gtk_label_new_with_mnemonic (_("_From line:"));
+	from_spin = gtk_spin_button_new_with_range (1, G_MAXINT, 1);
+	gtk_spin_button_set_value (GTK_SPIN_BUTTON (from_spin), from);
+	gtk_entry_set_activates_default (GTK_ENTRY (from_spin), TRUE);
+	gtk_label_set_mnemonic_widget (GTK_LABEL (label), from_spin);
+	gtk_grid_attach (GTK_GRID (grid), label, 0, 0, 1, 1);
+	gtk_grid_attach (GTK_GRID (grid), from_spin, 1, 0, 1, 1);
+
+	label = gtk_label_new_with_mnemonic (_("_To line:"));
+	to_spin = gtk_spin_button_new_with_range (1, G_MAXINT, 1);
+	gtk_spin_button_set_value (GTK_SPIN_BUTTON (to_spin), to);
+	gtk_entry_set_activates_default (GTK_ENTRY (to_spin), TRUE);
+	gtk_label_set_mnemonic_widget (GTK_LABEL (label), to_spin);
+	gtk_grid_attach (GTK_GRID (grid), label, 0, 1, 1, 1);
+	gtk_grid_attach (GTK_GRID (grid), to_spin, 1, 1, 1, 1);
+
+	gtk_box_pack_start (GTK_BOX (gtk_dialog_get_content_area (GTK_DIALOG (dialog))),
+			    grid, TRUE, TRUE, 0);
+	gtk_widget_show_all (grid);
+
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_OK)
+	{
+		gchar *text;
+
+		from = gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (from_spin));
+		to = gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (to_spin));
+
+		text = _pluma_document_get_paged_lines (doc,
+							MIN (from, to) - 1,
+							MAX (from, to) - 1);
+
+		if (text != NULL)
+		{
+			gtk_clipboard_set_text (gtk_widget_get_clipboard (GTK_WIDGET (active_view),
+									  GDK_SELECTION_CLIPBOARD),
+						text,
+						-1);
+			g_free (text);
+		}
+	}
+
+	gtk_widget_destroy (dialog);
+
+	gtk_widget_grab_focus (GTK_WIDGET (active_view));
+}
+
 void
 _pluma_cmd_edit_paste (GtkAction   *action,
 		      PlumaWindow *window)
@@ -144,6 +144,74 @@ text_not_found (PlumaWindow *window,
 	g_free (searched);
 }
 
+static void
+paged_search_ready (PlumaDocument *doc,
+		    GAsyncResult  *result,
+		    PlumaView     *view)
+{
+	GError *error = NULL;
+
+	if (_pluma_document_search_paged_finish (doc, result, &error))
+	{
+		pluma_view_scroll_to_cursor (view);
+	}
+	else if (error == NULL ||
+		 !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	{
+		GtkWidget *window;
+
+		window = gtk_widget_get_toplevel (GTK_WIDGET (view));
+
+		if (PLUMA_IS_WINDOW (window))
+		{
+			gchar *search_text;
+			gchar *text;
+
+			search_text = pluma_document_get_search_text (doc, NULL);
+			text = pluma_utils_unescape_search_text (search_text);
+
+			text_not_found (PLUMA_WINDOW (window), text);
+
+			g_free (text);
+			g_free (search_text);
+		}
+	}
+
+	if (error != NULL)
+		g_error_free (error);
+
+	g_object_unref (view);
+}
+
+/* The buffer of a paged document only holds part of the file: look for
+ * the text in the rest of it in the background */
+static gboolean
+run_paged_search (PlumaView *view,
+		  gboolean   wrap_around,
+		  gboolean   search_backwards)
+{
+	PlumaDocument *doc;
+	guint flags = 0;
+
+	doc = PLUMA_DOCUMENT (gtk_text_view_get_buffer (GTK_TEXT_VIEW (view)));
+
+	if (!_pluma_document_is_paged (doc))
+		return FALSE;
+
+	g_free (pluma_document_get_search_text (doc, &flags));
+
+	if (PLUMA_SEARCH_IS_MATCH_REGEX (flags))
+		return FALSE;
+
+	_pluma_document_search_paged_async (doc,
+					    search_backwards,
+					    wrap_around,
+					    (GAsyncReadyCallback) paged_search_ready,
+					    g_object_ref (view));
+
+	return TRUE;
+}
+
 static gboolean
 run_search (PlumaView   *view,
 	    gboolean     wrap_around,
@@ -157,6 +225,8 @@ run_search (PlumaView   *view,
 
 	doc = PLUMA_DOCUMENT (gtk_text_view_get_buffer (GTK_TEXT_VIEW (view)));
 
+	pluma_debug_span_begin (DEBUG_SEARCH, "search");
+
 	if (!search_backwards)
 	{
 		gtk_text_buffer_get_selection_bounds (GTK_TEXT_BUFFER (doc),
@@ -182,6 +252,17 @@ run_search (PlumaView   *view,
 						        &match_end);
 	}
 
+	/* the result is reported when the search is done */
+	if (!found && run_paged_search (view, wrap_around, search_backwards))
+	{
+		gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (doc),
+					      &start_iter);
+
+		pluma_debug_span_end (DEBUG_SEARCH, "search");
+
+		return TRUE;
+	}
+
 	if (!found && wrap_around)
 	{
 		if (!search_backwards)
@@ -215,6 +296,8 @@ run_search (PlumaView   *view,
 					      &start_iter);
 	}
 
+	pluma_debug_span_end (DEBUG_SEARCH, "search");
+
 	return found;
 }
 
@@ -288,7 +371,7 @@ do_find (PlumaSearchDialog *dialog,
 
 	gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog),
 					   PLUMA_SEARCH_DIALOG_REPLACE_RESPONSE,
-					   found);
+					   found && !_pluma_document_is_paged (doc));
 }
 
 /* FIXME: move in pluma-document.c and share it with pluma-view */
@@ -152,3 +152,25 @@ _pluma_cmd_view_leave_fullscreen_mode (GtkAction *action,
 		(view_action, G_CALLBACK (_pluma_cmd_view_toggle_fullscreen_mode),
 		 window);
 }
+
+void
+_pluma_cmd_view_follow (GtkAction   *action,
+			PlumaWindow *window)
+{
+	PlumaTab *tab;
+
+	pluma_debug (DEBUG_COMMANDS);
+
+	tab = pluma_window_get_active_tab (window);
+	if (tab == NULL)
+		return;
+
+	_pluma_tab_set_follow (tab,
+			       gtk_toggle_action_get_active (GTK_TOGGLE_ACTION (action)));
+
+	/* the tab refuses to follow files with unsaved changes */
+	g_signal_handlers_block_by_func (action, G_CALLBACK (_pluma_cmd_view_follow), window);
+	gtk_toggle_action_set_active (GTK_TOGGLE_ACTION (action),
+				      _pluma_tab_get_follow (tab));
+	g_signal_handlers_unblock_by_func (action, G_CALLBACK (_pluma_cmd_view_follow), window);
+}
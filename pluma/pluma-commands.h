@@ -99,6 +99,8 @@ void		_pluma_cmd_edit_cut			(GtkAction   *action,
 							 PlumaWindow *window);
 void		_pluma_cmd_edit_copy			(GtkAction   *action,
 							 PlumaWindow *window);
+void		_pluma_cmd_edit_copy_lines		(GtkAction   *action,
+							 PlumaWindow *window);
 void		_pluma_cmd_edit_paste			(GtkAction   *action,
 							 PlumaWindow *window);
 void		_pluma_cmd_edit_delete			(GtkAction   *action,
@@ -120,6 +122,8 @@ void		_pluma_cmd_view_toggle_fullscreen_mode	(GtkAction   *action,
 							 PlumaWindow *window);
 void		_pluma_cmd_view_leave_fullscreen_mode	(GtkAction   *action,
 							 PlumaWindow *window);
+void		_pluma_cmd_view_follow			(GtkAction   *action,
+							 PlumaWindow *window);
 
 void		_pluma_cmd_search_find			(GtkAction   *action,
 							 PlumaWindow *window);
@@ -0,0 +1,555 @@
+/*
+ * pluma-compression.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "pluma-compression.h"
+#include "pluma-debug.h"
+
+/*
+ * Converters for the compressed files, to be put in the stream chain in
+ * front of the charset converter when loading and after it when saving.
+ * gzip comes with gio, xz and zstd are wrapped here when pluma is built
+ * with their libraries.
+ */
+
+static const gchar gzip_magic[] = { 0x1f, 0x8b };
+static const gchar xz_magic[] = { 0xfd, '7', 'z', 'X', 'Z', 0x00 };
+static const gchar zstd_magic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+/* Compression level of the saved files, the defaults of the tools */
+#define XZ_PRESET	6
+#define ZSTD_LEVEL	3
+
+/* Sets the error for a call that could not make any progress */
+static GConverterResult
+no_progress (gboolean   output_full,
+	     GError   **error)
+{
+	if (output_full)
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+				     "Not enough space in the output buffer");
+	else
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+				     "Need more input");
+
+	return G_CONVERTER_ERROR;
+}
+
+#ifdef HAVE_LZMA
+
+#define PLUMA_TYPE_LZMA_CONVERTER	(pluma_lzma_converter_get_type ())
+#define PLUMA_LZMA_CONVERTER(obj)	(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_LZMA_CONVERTER, PlumaLzmaConverter))
+
+typedef struct
+{
+	GObject      parent;
+
+	lzma_stream  stream;
+	gboolean     compress;
+} PlumaLzmaConverter;
+
+typedef struct
+{
+	GObjectClass parent_class;
+} PlumaLzmaConverterClass;
+
+static GType	pluma_lzma_converter_get_type	(void) G_GNUC_CONST;
+static void	pluma_lzma_converter_iface_init	(GConverterIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (PlumaLzmaConverter, pluma_lzma_converter,
+			 G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
+						pluma_lzma_converter_iface_init))
+
+static gboolean
+lzma_converter_setup (PlumaLzmaConverter *conv)
+{
+	lzma_stream init = LZMA_STREAM_INIT;
+	lzma_ret ret;
+
+	conv->stream = init;
+
+	if (conv->compress)
+		ret = lzma_easy_encoder (&conv->stream, XZ_PRESET, LZMA_CHECK_CRC64);
+	else
+		ret = lzma_stream_decoder (&conv->stream, UINT64_MAX, LZMA_CONCATENATED);
+
+	return ret == LZMA_OK;
+}
+
+static void
+pluma_lzma_converter_finalize (GObject *object)
+{
+	lzma_end (&PLUMA_LZMA_CONVERTER (object)->stream);
+
+	G_OBJECT_CLASS (pluma_lzma_converter_parent_class)->finalize (object);
+}
+
+static void
+pluma_lzma_converter_class_init (PlumaLzmaConverterClass *klass)
+{
+	G_OBJECT_CLASS (klass)->finalize = pluma_lzma_converter_finalize;
+}
+
+static void
+pluma_lzma_converter_init (PlumaLzmaConverter *conv)
+{
+}
+
+static GConverterResult
+pluma_lzma_converter_convert (GConverter      *converter,
+			      const void      *inbuf,
+			      gsize            inbuf_size,
+			      void            *outbuf,
+			      gsize            outbuf_size,
+			      GConverterFlags  flags,
+			      gsize           *bytes_read,
+			      gsize           *bytes_written,
+			      GError         **error)
+{
+	PlumaLzmaConverter *conv = PLUMA_LZMA_CONVERTER (converter);
+	lzma_action action = LZMA_RUN;
+	lzma_ret ret;
+
+	if (flags & G_CONVERTER_INPUT_AT_END)
+		action = LZMA_FINISH;
+	else if ((flags & G_CONVERTER_FLUSH) && conv->compress)
+		action = LZMA_SYNC_FLUSH;
+
+	conv->stream.next_in = inbuf;
+	conv->stream.avail_in = inbuf_size;
+	conv->stream.next_out = outbuf;
+	conv->stream.avail_out = outbuf_size;
+
+	ret = lzma_code (&conv->stream, action);
+
+	*bytes_read = inbuf_size - conv->stream.avail_in;
+	*bytes_written = outbuf_size - conv->stream.avail_out;
+
+	switch (ret)
+	{
+		case LZMA_OK:
+			break;
+		case LZMA_STREAM_END:
+			return action == LZMA_SYNC_FLUSH ? G_CONVERTER_FLUSHED
+							 : G_CONVERTER_FINISHED;
+		case LZMA_BUF_ERROR:
+			return no_progress (conv->stream.avail_out == 0, error);
+		case LZMA_MEM_ERROR:
+		case LZMA_MEMLIMIT_ERROR:
+			g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+					     "Not enough memory to decompress the file");
+			return G_CONVERTER_ERROR;
+		default:
+			g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+					     "The xz data is corrupt");
+			return G_CONVERTER_ERROR;
+	}
+
+	if (*bytes_read == 0 && *bytes_written == 0)
+		return no_progress (outbuf_size == 0, error);
+
+	if ((flags & G_CONVERTER_FLUSH) && !conv->compress &&
+	    conv->stream.avail_in == 0 && conv->stream.avail_out > 0)
+	{
+		return G_CONVERTER_FLUSHED;
+	}
+
+	return G_CONVERTER_CONVERTED;
+}
+
+static void
+pluma_lzma_converter_reset (GConverter *converter)
+{
+	PlumaLzmaConverter *conv = PLUMA_LZMA_CONVERTER (converter);
+
+	lzma_end (&conv->stream);
+	lzma_converter_setup (conv);
+}
+
+static void
+pluma_lzma_converter_iface_init (GConverterIface *iface)
+{
+	iface->convert = pluma_lzma_converter_convert;
+	iface->reset = pluma_lzma_converter_reset;
+}
+
+static GConverter *
+lzma_converter_new (gboolean compress)
+{
+	PlumaLzmaConverter *conv;
+
+	conv = g_object_new (PLUMA_TYPE_LZMA_CONVERTER, NULL);
+	conv->compress = compress;
+
+	if (!lzma_converter_setup (conv))
+	{
+		g_object_unref (conv);
+		return NULL;
+	}
+
+	return G_CONVERTER (conv);
+}
+
+#endif /* HAVE_LZMA */
+
+#ifdef HAVE_ZSTD
+
+#define PLUMA_TYPE_ZSTD_CONVERTER	(pluma_zstd_converter_get_type ())
+#define PLUMA_ZSTD_CONVERTER(obj)	(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_ZSTD_CONVERTER, PlumaZstdConverter))
+
+typedef struct
+{
+	GObject      parent;
+
+	ZSTD_CCtx   *cctx;
+	ZSTD_DCtx   *dctx;
+
+	/* Whether the decompressor is between two frames */
+	gboolean     frame_done;
+} PlumaZstdConverter;
+
+typedef struct
+{
+	GObjectClass parent_class;
+} PlumaZstdConverterClass;
+
+static GType	pluma_zstd_converter_get_type	(void) G_GNUC_CONST;
+static void	pluma_zstd_converter_iface_init	(GConverterIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (PlumaZstdConverter, pluma_zstd_converter,
+			 G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
+						pluma_zstd_converter_iface_init))
+
+static void
+pluma_zstd_converter_finalize (GObject *object)
+{
+	PlumaZstdConverter *conv = PLUMA_ZSTD_CONVERTER (object);
+
+	if (conv->cctx != NULL)
+		ZSTD_freeCCtx (conv->cctx);
+
+	if (conv->dctx != NULL)
+		ZSTD_freeDCtx (conv->dctx);
+
+	G_OBJECT_CLASS (pluma_zstd_converter_parent_class)->finalize (object);
+}
+
+static void
+pluma_zstd_converter_class_init (PlumaZstdConverterClass *klass)
+{
+	G_OBJECT_CLASS (klass)->finalize = pluma_zstd_converter_finalize;
+}
+
+static void
+pluma_zstd_converter_init (PlumaZstdConverter *conv)
+{
+	conv->frame_done = TRUE;
+}
+
+static GConverterResult
+zstd_compress (PlumaZstdConverter *conv,
+	       ZSTD_inBuffer      *in,
+	       ZSTD_outBuffer     *out,
+	       GConverterFlags     flags,
+	       GError            **error)
+{
+	ZSTD_EndDirective mode = ZSTD_e_continue;
+	size_t remaining;
+
+	if (flags & G_CONVERTER_INPUT_AT_END)
+		mode = ZSTD_e_end;
+	else if (flags & G_CONVERTER_FLUSH)
+		mode = ZSTD_e_flush;
+
+	remaining = ZSTD_compressStream2 (conv->cctx, out, in, mode);
+
+	if (ZSTD_isError (remaining))
+	{
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+				     ZSTD_getErrorName (remaining));
+		return G_CONVERTER_ERROR;
+	}
+
+	if (remaining == 0 && in->pos == in->size)
+	{
+		if (mode == ZSTD_e_end)
+			return G_CONVERTER_FINISHED;
+
+		if (mode == ZSTD_e_flush)
+			return G_CONVERTER_FLUSHED;
+	}
+
+	if (in->pos == 0 && out->pos == 0)
+		return no_progress (out->size == 0 || mode != ZSTD_e_continue, error);
+
+	return G_CONVERTER_CONVERTED;
+}
+
+static GConverterResult
+zstd_decompress (PlumaZstdConverter *conv,
+		 ZSTD_inBuffer      *in,
+		 ZSTD_outBuffer     *out,
+		 GConverterFlags     flags,
+		 GError            **error)
+{
+	size_t hint;
+
+	hint = ZSTD_decompressStream (conv->dctx, out, in);
+
+	if (ZSTD_isError (hint))
+	{
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+				     ZSTD_getErrorName (hint));
+		return G_CONVERTER_ERROR;
+	}
+
+	/* 0 once a frame is complete, more frames may follow */
+	if (in->pos > 0 || out->pos > 0)
+		conv->frame_done = (hint == 0);
+
+	if (in->pos == in->size && conv->frame_done &&
+	    (flags & G_CONVERTER_INPUT_AT_END))
+	{
+		/* everything buffered in the context has been written */
+		if (out->pos < out->size)
+			return G_CONVERTER_FINISHED;
+	}
+
+	if (in->pos == 0 && out->pos == 0)
+		return no_progress (out->size == 0, error);
+
+	if ((flags & G_CONVERTER_FLUSH) && in->pos == in->size && out->pos < out->size)
+		return G_CONVERTER_FLUSHED;
+
+	return G_CONVERTER_CONVERTED;
+}
+
+static GConverterResult
+pluma_zstd_converter_convert (GConverter      *converter,
+			      const void      *inbuf,
+			      gsize            inbuf_size,
+			      void            *outbuf,
+			      gsize            outbuf_size,
+			      GConverterFlags  flags,
+			      gsize           *bytes_read,
+			      gsize           *bytes_written,
+			      GError         **error)
+{
+	PlumaZstdConverter *conv = PLUMA_ZSTD_CONVERTER (converter);
+	ZSTD_inBuffer in = { inbuf, inbuf_size, 0 };
+	ZSTD_outBuffer out = { outbuf, outbuf_size, 0 };
+	GConverterResult ret;
+
+	if (conv->cctx != NULL)
+		ret = zstd_compress (conv, &in, &out, flags, error);
+	else
+		ret = zstd_decompress (conv, &in, &out, flags, error);
+
+	*bytes_read = in.pos;
+	*bytes_written = out.pos;
+
+	return ret;
+}
+
+static void
+pluma_zstd_converter_reset (GConverter *converter)
+{
+	PlumaZstdConverter *conv = PLUMA_ZSTD_CONVERTER (converter);
+
+	if (conv->cctx != NULL)
+		ZSTD_CCtx_reset (conv->cctx, ZSTD_reset_session_only);
+	else
+		ZSTD_DCtx_reset (conv->dctx, ZSTD_reset_session_only);
+
+	conv->frame_done = TRUE;
+}
+
+static void
+pluma_zstd_converter_iface_init (GConverterIface *iface)
+{
+	iface->convert = pluma_zstd_converter_convert;
+	iface->reset = pluma_zstd_converter_reset;
+}
+
+static GConverter *
+zstd_converter_new (gboolean compress)
+{
+	PlumaZstdConverter *conv;
+
+	conv = g_object_new (PLUMA_TYPE_ZSTD_CONVERTER, NULL);
+
+	if (compress)
+	{
+		conv->cctx = ZSTD_createCCtx ();
+
+		if (conv->cctx != NULL)
+			ZSTD_CCtx_setParameter (conv->cctx, ZSTD_c_compressionLevel, ZSTD_LEVEL);
+	}
+	else
+	{
+		conv->dctx = ZSTD_createDCtx ();
+	}
+
+	if (conv->cctx == NULL && conv->dctx == NULL)
+	{
+		g_object_unref (conv);
+		return NULL;
+	}
+
+	return G_CONVERTER (conv);
+}
+
+#endif /* HAVE_ZSTD */
+
+gboolean
+pluma_compression_is_supported (PlumaDocumentCompressionType type)
+{
+	switch (type)
+	{
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE:
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP:
+			return TRUE;
+#ifdef HAVE_LZMA
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ:
+			return TRUE;
+#endif
+#ifdef HAVE_ZSTD
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD:
+			return TRUE;
+#endif
+		default:
+			return FALSE;
+	}
+}
+
+/* Returns the compression of a file starting with @data, or
+ * PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE if it is not a format pluma can
+ * decompress */
+PlumaDocumentCompressionType
+pluma_compression_detect (const gchar *data,
+			  gsize        length)
+{
+	PlumaDocumentCompressionType type = PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
+
+	if (length >= sizeof (gzip_magic) &&
+	    memcmp (data, gzip_magic, sizeof (gzip_magic)) == 0)
+	{
+		type = PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP;
+	}
+	else if (length >= sizeof (xz_magic) &&
+		 memcmp (data, xz_magic, sizeof (xz_magic)) == 0)
+	{
+		type = PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ;
+	}
+	else if (length >= sizeof (zstd_magic) &&
+		 memcmp (data, zstd_magic, sizeof (zstd_magic)) == 0)
+	{
+		type = PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD;
+	}
+
+	if (!pluma_compression_is_supported (type))
+	{
+		pluma_debug_message (DEBUG_UTILS, "Compression %d not supported", type);
+		return PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
+	}
+
+	return type;
+}
+
+/* The compression a file named @filename is expected to have, when
+ * pluma supports it */
+PlumaDocumentCompressionType
+pluma_compression_for_filename (const gchar *filename)
+{
+	PlumaDocumentCompressionType type = PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
+
+	g_return_val_if_fail (filename != NULL, PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE);
+
+	if (g_str_has_suffix (filename, ".gz"))
+		type = PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP;
+	else if (g_str_has_suffix (filename, ".xz"))
+		type = PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ;
+	else if (g_str_has_suffix (filename, ".zst"))
+		type = PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD;
+
+	if (!pluma_compression_is_supported (type))
+		return PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
+
+	return type;
+}
+
+/* Returns NULL for PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE and the formats
+ * which are not supported */
+GConverter *
+pluma_compression_new_decompressor (PlumaDocumentCompressionType type)
+{
+	switch (type)
+	{
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP:
+			return G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+#ifdef HAVE_LZMA
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ:
+			return lzma_converter_new (FALSE);
+#endif
+#ifdef HAVE_ZSTD
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD:
+			return zstd_converter_new (FALSE);
+#endif
+		default:
+			return NULL;
+	}
+}
+
+GConverter *
+pluma_compression_new_compressor (PlumaDocumentCompressionType type)
+{
+	switch (type)
+	{
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP:
+			return G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+#ifdef HAVE_LZMA
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ:
+			return lzma_converter_new (TRUE);
+#endif
+#ifdef HAVE_ZSTD
+		case PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD:
+			return zstd_converter_new (TRUE);
+#endif
+		default:
+			return NULL;
+	}
+}
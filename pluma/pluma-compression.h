@@ -0,0 +1,50 @@
+/*
+ * pluma-compression.h
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef __PLUMA_COMPRESSION_H__
+#define __PLUMA_COMPRESSION_H__
+
+#include <gio/gio.h>
+
+#include "pluma-document.h"
+
+G_BEGIN_DECLS
+
+/* Enough bytes to recognize all the supported formats */
+#define PLUMA_COMPRESSION_MAGIC_LENGTH 6
+
+gboolean			 pluma_compression_is_supported	(PlumaDocumentCompressionType  type);
+
+PlumaDocumentCompressionType	 pluma_compression_detect	(const gchar                  *data,
+								 gsize                         length);
+
+PlumaDocumentCompressionType	 pluma_compression_for_filename	(const gchar                  *filename);
+
+GConverter			*pluma_compression_new_decompressor
+								(PlumaDocumentCompressionType  type);
+
+GConverter			*pluma_compression_new_compressor
+								(PlumaDocumentCompressionType  type);
+
+G_END_DECLS
+
+#endif /* __PLUMA_COMPRESSION_H__ */
@@ -35,8 +35,13 @@
 #endif
 
 #include <stdio.h>
+#include <glib/gstdio.h>
 #include "pluma-debug.h"
 
+/* the functions are defined here, not the call site checks */
+#undef pluma_debug
+#undef pluma_debug_message
+
 #define ENABLE_PROFILING
 
 #ifdef ENABLE_PROFILING
@@ -44,7 +49,225 @@ static GTimer *timer = NULL;
 static gdouble last = 0.0;
 #endif
 
-static PlumaDebugSection debug = PLUMA_NO_DEBUG;
+guint _pluma_debug_sections = PLUMA_NO_DEBUG;
+gboolean _pluma_debug_tracing = FALSE;
+
+#define debug _pluma_debug_sections
+
+/* Number of events kept per thread, the oldest ones are overwritten */
+#define TRACE_BUFFER_SIZE (64 * 1024)
+
+typedef struct
+{
+	gint64             time;
+	const gchar       *name;
+	const gchar       *file;
+	const gchar       *function;
+	gconstpointer      id;
+	PlumaDebugSection  section;
+	gint               line;
+	gchar              phase;
+} TraceEvent;
+
+/* Each thread only writes to its own buffer, the buffers are only
+ * read when writing the trace file */
+typedef struct
+{
+	gint        tid;
+	gint        n_events;	/* total written, atomic */
+	TraceEvent  events[TRACE_BUFFER_SIZE];
+} TraceBuffer;
+
+static gchar *trace_file = NULL;
+static gint64 trace_start = 0;
+static GPrivate trace_buffer_key;
+static GSList *trace_buffers = NULL;
+static GMutex trace_buffers_lock;
+
+static const gchar *
+section_name (PlumaDebugSection section)
+{
+	static const gchar *names[] = {
+		"view", "search", "print", "prefs", "plugins",
+		"tab", "document", "commands", "app", "session",
+		"utils", "metadata", "window", "loader", "saver"
+	};
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++)
+	{
+		if (section & (1 << i))
+			return names[i];
+	}
+
+	return "pluma";
+}
+
+static TraceBuffer *
+get_trace_buffer (void)
+{
+	TraceBuffer *buffer;
+	static gint next_tid = 1;
+
+	buffer = g_private_get (&trace_buffer_key);
+
+	if (G_UNLIKELY (buffer == NULL))
+	{
+		/* never freed: the events are written on exit */
+		buffer = g_new0 (TraceBuffer, 1);
+		buffer->tid = g_atomic_int_add (&next_tid, 1);
+
+		g_private_set (&trace_buffer_key, buffer);
+
+		g_mutex_lock (&trace_buffers_lock);
+		trace_buffers = g_slist_prepend (trace_buffers, buffer);
+		g_mutex_unlock (&trace_buffers_lock);
+	}
+
+	return buffer;
+}
+
+void
+_pluma_debug_trace (gchar              phase,
+		    PlumaDebugSection  section,
+		    const gchar       *file,
+		    gint               line,
+		    const gchar       *function,
+		    const gchar       *name,
+		    gconstpointer      id)
+{
+	TraceBuffer *buffer;
+	TraceEvent *event;
+	gint n;
+
+	if (!_pluma_debug_tracing)
+		return;
+
+	buffer = get_trace_buffer ();
+
+	n = buffer->n_events;
+	event = &buffer->events[n % TRACE_BUFFER_SIZE];
+
+	event->time = g_get_monotonic_time ();
+	event->name = name;
+	event->file = file;
+	event->function = function;
+	event->id = id;
+	event->section = section;
+	event->line = line;
+	event->phase = phase;
+
+	g_atomic_int_set (&buffer->n_events, n + 1);
+}
+
+void
+pluma_debug_set_trace_file (const gchar *filename)
+{
+	g_free (trace_file);
+	trace_file = g_strdup (filename);
+
+	if (trace_file != NULL && !_pluma_debug_tracing)
+	{
+		trace_start = g_get_monotonic_time ();
+		_pluma_debug_tracing = TRUE;
+	}
+	else if (trace_file == NULL)
+	{
+		_pluma_debug_tracing = FALSE;
+	}
+}
+
+static void
+write_json_string (FILE        *f,
+		   const gchar *str)
+{
+	fputc ('"', f);
+
+	for (; str != NULL && *str != '\0'; str++)
+	{
+		if (*str == '"' || *str == '\\')
+			fputc ('\\', f);
+
+		if ((guchar) *str >= 0x20)
+			fputc (*str, f);
+	}
+
+	fputc ('"', f);
+}
+
+static void
+write_trace_event (FILE             *f,
+		   const TraceEvent *event,
+		   gint              tid,
+		   gboolean          first)
+{
+	fputs (first ? "\n" : ",\n", f);
+
+	fputs ("{\"name\":", f);
+	write_json_string (f, event->name);
+	fputs (",\"cat\":", f);
+	write_json_string (f, section_name (event->section));
+	fprintf (f,
+		 ",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":1,\"tid\":%d",
+		 event->phase,
+		 event->time - trace_start,
+		 tid);
+
+	if (event->phase == 'b' || event->phase == 'e')
+		fprintf (f, ",\"id\":\"%p\"", event->id);
+	else if (event->phase == 'i')
+		fputs (",\"s\":\"t\"", f);
+
+	fputs (",\"args\":{\"function\":", f);
+	write_json_string (f, event->function);
+	fputs (",\"file\":", f);
+	write_json_string (f, event->file);
+	fprintf (f, ",\"line\":%d}}", event->line);
+}
+
+static void
+write_trace_file (void)
+{
+	FILE *f;
+	GSList *l;
+	gboolean first = TRUE;
+
+	f = g_fopen (trace_file, "w");
+
+	if (f == NULL)
+	{
+		g_warning ("Could not write the trace file %s", trace_file);
+		return;
+	}
+
+	fputs ("{\"traceEvents\":[", f);
+
+	g_mutex_lock (&trace_buffers_lock);
+
+	for (l = trace_buffers; l != NULL; l = l->next)
+	{
+		TraceBuffer *buffer = l->data;
+		gint n_events;
+		gint i;
+
+		n_events = g_atomic_int_get (&buffer->n_events);
+
+		for (i = MAX (0, n_events - TRACE_BUFFER_SIZE); i < n_events; i++)
+		{
+			write_trace_event (f,
+					   &buffer->events[i % TRACE_BUFFER_SIZE],
+					   buffer->tid,
+					   first);
+			first = FALSE;
+		}
+	}
+
+	g_mutex_unlock (&trace_buffers_lock);
+
+	fputs ("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+
+	fclose (f);
+}
 
 void
 pluma_debug_init (void)
@@ -89,6 +312,9 @@ pluma_debug_init (void)
 
 out:		
 
+	if (g_getenv ("PLUMA_TRACE_FILE") != NULL)
+		pluma_debug_set_trace_file (g_getenv ("PLUMA_TRACE_FILE"));
+
 #ifdef ENABLE_PROFILING
 	if (debug != PLUMA_NO_DEBUG)
 		timer = g_timer_new ();
@@ -96,6 +322,20 @@ out:
 	return;
 }
 
+void
+pluma_debug_shutdown (void)
+{
+	if (trace_file == NULL)
+		return;
+
+	_pluma_debug_tracing = FALSE;
+
+	write_trace_file ();
+
+	g_free (trace_file);
+	trace_file = NULL;
+}
+
 void
 pluma_debug_message (PlumaDebugSection  section,
 		     const gchar       *file,
@@ -131,6 +371,9 @@ pluma_debug_message (PlumaDebugSection  section,
 		fflush (stdout);
 
 		g_free (msg);
+
+		if (_pluma_debug_tracing)
+			_pluma_debug_trace ('i', section, file, line, function, function, NULL);
 	}
 }
 
@@ -154,5 +397,8 @@ void pluma_debug (PlumaDebugSection  section,
 		g_print ("%s:%d (%s)\n", file, line, function);
 #endif		
 		fflush (stdout);
+
+		if (_pluma_debug_tracing)
+			_pluma_debug_trace ('i', section, file, line, function, function, NULL);
 	}
 }
@@ -79,6 +79,8 @@ typedef enum {
 
 void pluma_debug_init (void);
 
+void pluma_debug_shutdown (void);
+
 void pluma_debug (PlumaDebugSection  section,
 		  const gchar       *file,
 		  gint               line,
@@ -90,5 +92,72 @@ void pluma_debug_message (PlumaDebugSection  section,
 			  const gchar       *function,
 			  const gchar       *format, ...) G_GNUC_PRINTF(5, 6);
 
+/*
+ * Tracing: when the PLUMA_TRACE_FILE environment variable or the
+ * --trace-file command line option is set, spans are recorded in memory
+ * and written to that file in the Chrome trace event format on exit.
+ * Span names must be static strings.
+ */
+void pluma_debug_set_trace_file (const gchar *filename);
+
+void _pluma_debug_trace (gchar              phase,
+			 PlumaDebugSection  section,
+			 const gchar       *file,
+			 gint               line,
+			 const gchar       *function,
+			 const gchar       *name,
+			 gconstpointer      id);
+
+#ifndef __GI_SCANNER__
+
+/* Checked at the call site, so that disabled sections cost one test */
+extern guint _pluma_debug_sections;
+extern gboolean _pluma_debug_tracing;
+
+#define _PLUMA_DEBUG_SECTION(section, ...) (section)
+
+#define pluma_debug(...)							\
+	G_STMT_START {								\
+		if (G_UNLIKELY (_pluma_debug_sections &				\
+				_PLUMA_DEBUG_SECTION (__VA_ARGS__, 0)))		\
+			pluma_debug (__VA_ARGS__);				\
+	} G_STMT_END
+
+#define pluma_debug_message(...)						\
+	G_STMT_START {								\
+		if (G_UNLIKELY (_pluma_debug_sections &				\
+				_PLUMA_DEBUG_SECTION (__VA_ARGS__, 0)))		\
+			pluma_debug_message (__VA_ARGS__);			\
+	} G_STMT_END
+
+/* Spans which begin and end in the same function call, they must nest,
+ * e.g. pluma_debug_span_begin (DEBUG_SEARCH, "replace-all") */
+#define pluma_debug_span_begin(...)						\
+	G_STMT_START {								\
+		if (G_UNLIKELY (_pluma_debug_tracing))				\
+			_pluma_debug_trace ('B', __VA_ARGS__, NULL);		\
+	} G_STMT_END
+
+#define pluma_debug_span_end(...)						\
+	G_STMT_START {								\
+		if (G_UNLIKELY (_pluma_debug_tracing))				\
+			_pluma_debug_trace ('E', __VA_ARGS__, NULL);		\
+	} G_STMT_END
+
+/* Spans of asynchronous operations, matched by name and id,
+ * e.g. pluma_debug_async_span_begin (DEBUG_LOADER, "load", doc) */
+#define pluma_debug_async_span_begin(...)					\
+	G_STMT_START {								\
+		if (G_UNLIKELY (_pluma_debug_tracing))				\
+			_pluma_debug_trace ('b', __VA_ARGS__);			\
+	} G_STMT_END
+
+#define pluma_debug_async_span_end(...)						\
+	G_STMT_START {								\
+		if (G_UNLIKELY (_pluma_debug_tracing))				\
+			_pluma_debug_trace ('e', __VA_ARGS__);			\
+	} G_STMT_END
+
+#endif /* __GI_SCANNER__ */
 
 #endif /* __PLUMA_DEBUG_H__ */
@@ -0,0 +1,1225 @@
+/*
+ * pluma-dir-cache.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "pluma-dir-cache.h"
+#include "pluma-dirs.h"
+#include "pluma-debug.h"
+
+/**
+ * SECTION:pluma-dir-cache
+ * @short_description: persistent cache of directory listings
+ * @include: pluma/pluma-dir-cache.h
+ *
+ * A #PlumaDirCache remembers the entries of the directories that were
+ * listed in previous sessions, so that the file browser and Quick Open
+ * can show them right away, even on slow network file systems, and
+ * check in the background whether they are still up to date.
+ *
+ * Every directory is stored in its own file, named after a checksum of
+ * its URI, together with the modification time the directory had when
+ * it was listed. Lookups map the file into memory and a #PlumaDirListing
+ * reads the entries straight from the mapping, so looking up a large
+ * directory costs neither parsing nor allocations per entry.
+ *
+ * The cache only keeps the listings that were used most recently: when
+ * there are more than #PlumaDirCache:max-listings of them, or when they
+ * take more than 64 MiB, the oldest are removed.
+ *
+ * Only the name, display name, type, hidden state and content type of
+ * the entries are kept; anything else has to be queried from the file
+ * itself. Since sniffing the content type is expensive, listings may be
+ * stored without it, and entries then keep the content type they had in
+ * the previous listing.
+ */
+
+#define PLUMA_DIR_CACHE_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE((object), PLUMA_TYPE_DIR_CACHE, PlumaDirCachePrivate))
+
+/* "PLDC" */
+#define CACHE_MAGIC		0x43444c50
+#define CACHE_VERSION		2
+
+#define LIST_ATTRIBUTES		G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+				G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+				G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+				G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+				G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP
+
+#define MTIME_ATTRIBUTES	G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+				G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+
+#define DEFAULT_MAX_LISTINGS	1024
+#define MAX_CACHE_SIZE		(64 * 1024 * 1024)
+
+/* lookups mark a listing as used at most this often, in seconds */
+#define TOUCH_INTERVAL		3600
+
+#define ENTRY_FLAG_HIDDEN	(1 << 0)
+#define ENTRY_FLAG_BACKUP	(1 << 1)
+
+/* The file is written and read on the same machine, so it simply uses
+ * the native byte order. The header is followed by the entry table and
+ * by the strings, which start with the URI of the directory. */
+typedef struct
+{
+	guint32 magic;
+	guint32 version;
+	guint64 mtime;
+	guint32 n_entries;
+	guint32 uri_length;
+} CacheHeader;
+
+typedef struct
+{
+	guint32 name;		/* offsets into the strings */
+	guint32 display_name;
+	guint32 content_type;	/* 0 if unknown */
+	guint8  type;
+	guint8  flags;
+	guint16 padding;
+} CacheEntry;
+
+struct _PlumaDirListing
+{
+	volatile gint ref_count;
+
+	GBytes            *bytes;
+	const CacheHeader *header;
+	const CacheEntry  *entries;
+	const gchar       *strings;
+};
+
+struct _PlumaDirCachePrivate
+{
+	gchar        *path;
+	guint         max_listings;
+
+	/* listings stored since old ones were last removed, updated from
+	 * any thread */
+	volatile gint n_stored;
+
+	/* directories being revalidated */
+	GHashTable   *pending;
+	GCancellable *cancellable;
+
+	/* listings which could not be written, by URI, so that they can
+	 * still be looked up; updated from any thread */
+	GMutex        unstored_lock;
+	GHashTable   *unstored;
+};
+
+enum
+{
+	PROP_0,
+	PROP_PATH,
+	PROP_MAX_LISTINGS
+};
+
+enum
+{
+	CHANGED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+static PlumaDirCache *default_cache = NULL;
+
+G_DEFINE_TYPE (PlumaDirCache, pluma_dir_cache, G_TYPE_OBJECT)
+
+G_DEFINE_BOXED_TYPE (PlumaDirListing,
+		     pluma_dir_listing,
+		     pluma_dir_listing_ref,
+		     pluma_dir_listing_unref)
+
+static void
+pluma_dir_cache_dispose (GObject *object)
+{
+	PlumaDirCache *cache = PLUMA_DIR_CACHE (object);
+
+	if (cache->priv->cancellable != NULL)
+	{
+		g_cancellable_cancel (cache->priv->cancellable);
+		g_object_unref (cache->priv->cancellable);
+		cache->priv->cancellable = NULL;
+	}
+
+	G_OBJECT_CLASS (pluma_dir_cache_parent_class)->dispose (object);
+}
+
+static void
+pluma_dir_cache_finalize (GObject *object)
+{
+	PlumaDirCache *cache = PLUMA_DIR_CACHE (object);
+
+	g_hash_table_destroy (cache->priv->pending);
+	g_hash_table_destroy (cache->priv->unstored);
+	g_mutex_clear (&cache->priv->unstored_lock);
+	g_free (cache->priv->path);
+
+	G_OBJECT_CLASS (pluma_dir_cache_parent_class)->finalize (object);
+}
+
+static void
+pluma_dir_cache_set_property (GObject      *object,
+			      guint         prop_id,
+			      const GValue *value,
+			      GParamSpec   *pspec)
+{
+	PlumaDirCache *cache = PLUMA_DIR_CACHE (object);
+
+	switch (prop_id)
+	{
+		case PROP_PATH:
+			cache->priv->path = g_value_dup_string (value);
+			break;
+		case PROP_MAX_LISTINGS:
+			cache->priv->max_listings = g_value_get_uint (value);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+pluma_dir_cache_get_property (GObject    *object,
+			      guint       prop_id,
+			      GValue     *value,
+			      GParamSpec *pspec)
+{
+	PlumaDirCache *cache = PLUMA_DIR_CACHE (object);
+
+	switch (prop_id)
+	{
+		case PROP_PATH:
+			g_value_set_string (value, cache->priv->path);
+			break;
+		case PROP_MAX_LISTINGS:
+			g_value_set_uint (value, cache->priv->max_listings);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+pluma_dir_cache_class_init (PlumaDirCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = pluma_dir_cache_dispose;
+	object_class->finalize = pluma_dir_cache_finalize;
+	object_class->set_property = pluma_dir_cache_set_property;
+	object_class->get_property = pluma_dir_cache_get_property;
+
+	g_object_class_install_property (object_class,
+					 PROP_PATH,
+					 g_param_spec_string ("path",
+							      "Path",
+							      "The directory the listings are stored in",
+							      NULL,
+							      G_PARAM_READWRITE |
+							      G_PARAM_CONSTRUCT_ONLY |
+							      G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * PlumaDirCache:max-listings:
+	 *
+	 * The number of listings kept, the least recently used ones are
+	 * removed when storing new ones.
+	 */
+	g_object_class_install_property (object_class,
+					 PROP_MAX_LISTINGS,
+					 g_param_spec_uint ("max-listings",
+							    "Maximum listings",
+							    "The number of listings kept",
+							    1,
+							    G_MAXUINT,
+							    DEFAULT_MAX_LISTINGS,
+							    G_PARAM_READWRITE |
+							    G_PARAM_CONSTRUCT_ONLY |
+							    G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * PlumaDirCache::changed:
+	 * @cache: the #PlumaDirCache
+	 * @directory: the directory whose listing changed
+	 *
+	 * Emitted when pluma_dir_cache_revalidate() found that the entries
+	 * of @directory changed and stored the new listing, or kept it in
+	 * memory if it could not be written.
+	 */
+	signals[CHANGED] =
+		g_signal_new ("changed",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaDirCacheClass, changed),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__OBJECT,
+			      G_TYPE_NONE,
+			      1,
+			      G_TYPE_FILE);
+
+	g_type_class_add_private (object_class, sizeof (PlumaDirCachePrivate));
+}
+
+static void
+pluma_dir_cache_init (PlumaDirCache *cache)
+{
+	cache->priv = PLUMA_DIR_CACHE_GET_PRIVATE (cache);
+
+	cache->priv->pending = g_hash_table_new_full (g_file_hash,
+						      (GEqualFunc) g_file_equal,
+						      g_object_unref,
+						      NULL);
+	cache->priv->cancellable = g_cancellable_new ();
+
+	g_mutex_init (&cache->priv->unstored_lock);
+	cache->priv->unstored = g_hash_table_new_full (g_str_hash,
+						       g_str_equal,
+						       g_free,
+						       (GDestroyNotify) pluma_dir_listing_unref);
+}
+
+/**
+ * pluma_dir_cache_new:
+ * @path: the directory to store the listings in
+ *
+ * Creates a cache that keeps its listings in @path. Most callers want
+ * the cache shared by the application, see pluma_dir_cache_get_default().
+ *
+ * Returns: a new #PlumaDirCache
+ */
+PlumaDirCache *
+pluma_dir_cache_new (const gchar *path)
+{
+	g_return_val_if_fail (path != NULL, NULL);
+
+	return g_object_new (PLUMA_TYPE_DIR_CACHE, "path", path, NULL);
+}
+
+/**
+ * pluma_dir_cache_get_default:
+ *
+ * Gets the cache shared by the whole application, which is stored in
+ * the pluma user cache directory.
+ *
+ * Returns: (transfer none): the default #PlumaDirCache
+ */
+PlumaDirCache *
+pluma_dir_cache_get_default (void)
+{
+	if (default_cache == NULL)
+	{
+		gchar *cache_dir;
+		gchar *path;
+
+		cache_dir = pluma_dirs_get_user_cache_dir ();
+		path = g_build_filename (cache_dir, "dirs", NULL);
+
+		default_cache = pluma_dir_cache_new (path);
+
+		g_free (path);
+		g_free (cache_dir);
+	}
+
+	return default_cache;
+}
+
+static gchar *
+cache_file_for_uri (PlumaDirCache *cache,
+		    const gchar   *uri)
+{
+	gchar *checksum;
+	gchar *path;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+	path = g_build_filename (cache->priv->path, checksum, NULL);
+	g_free (checksum);
+
+	return path;
+}
+
+/* The modification time of the files tells which listings were used
+ * last, atime is too often not updated */
+static void
+touch_listing (const gchar *path)
+{
+	GStatBuf buf;
+
+	if (g_stat (path, &buf) == 0 &&
+	    buf.st_mtime + TOUCH_INTERVAL < g_get_real_time () / G_USEC_PER_SEC)
+	{
+		g_utime (path, NULL);
+	}
+}
+
+typedef struct
+{
+	gchar  *name;
+	gint64  mtime;
+	goffset size;
+} StoredListing;
+
+static gint
+compare_stored_listings (gconstpointer a,
+			 gconstpointer b)
+{
+	const StoredListing *la = a;
+	const StoredListing *lb = b;
+
+	/* most recent first */
+	return (la->mtime < lb->mtime) - (la->mtime > lb->mtime);
+}
+
+/* Removes the least recently used listings beyond the limits */
+static void
+evict_listings (PlumaDirCache *cache)
+{
+	GArray *listings;
+	GDir *dir;
+	const gchar *name;
+	goffset size = 0;
+	guint i;
+
+	dir = g_dir_open (cache->priv->path, 0, NULL);
+
+	if (dir == NULL)
+		return;
+
+	listings = g_array_new (FALSE, FALSE, sizeof (StoredListing));
+
+	while ((name = g_dir_read_name (dir)) != NULL)
+	{
+		StoredListing listing;
+		GStatBuf buf;
+		gchar *path;
+
+		/* skips the temporary files of listings being written */
+		if (strchr (name, '.') != NULL)
+			continue;
+
+		path = g_build_filename (cache->priv->path, name, NULL);
+
+		if (g_stat (path, &buf) == 0)
+		{
+			listing.name = g_strdup (name);
+			listing.mtime = buf.st_mtime;
+			listing.size = buf.st_size;
+			g_array_append_val (listings, listing);
+		}
+
+		g_free (path);
+	}
+
+	g_dir_close (dir);
+
+	g_array_sort (listings, compare_stored_listings);
+
+	for (i = 0; i < listings->len; ++i)
+	{
+		StoredListing *listing = &g_array_index (listings, StoredListing, i);
+
+		size += listing->size;
+
+		if (i >= cache->priv->max_listings || size > MAX_CACHE_SIZE)
+		{
+			gchar *path;
+
+			path = g_build_filename (cache->priv->path, listing->name, NULL);
+			g_remove (path);
+			g_free (path);
+		}
+
+		g_free (listing->name);
+	}
+
+	g_array_free (listings, TRUE);
+}
+
+/* Checks that all the offsets in the file can be dereferenced, so that
+ * the accessors do not have to. Strings cannot run past the end since
+ * the file ends with a NUL. */
+static gboolean
+listing_validate (PlumaDirListing *listing,
+		  const gchar     *uri)
+{
+	gsize length;
+	const gchar *contents = g_bytes_get_data (listing->bytes, &length);
+	const CacheHeader *header;
+	gsize strings_offset;
+	gsize strings_length;
+	guint32 i;
+
+	if (length < sizeof (CacheHeader) || contents[length - 1] != '\0')
+		return FALSE;
+
+	header = (const CacheHeader *) contents;
+
+	if (header->magic != CACHE_MAGIC ||
+	    header->version != CACHE_VERSION ||
+	    header->n_entries > (length - sizeof (CacheHeader)) / sizeof (CacheEntry))
+	{
+		return FALSE;
+	}
+
+	strings_offset = sizeof (CacheHeader) + header->n_entries * sizeof (CacheEntry);
+	strings_length = length - strings_offset;
+
+	/* Different URIs may share a checksum */
+	if (header->uri_length >= strings_length ||
+	    strcmp (contents + strings_offset, uri) != 0)
+	{
+		return FALSE;
+	}
+
+	listing->header = header;
+	listing->entries = (const CacheEntry *) (contents + sizeof (CacheHeader));
+	listing->strings = contents + strings_offset;
+
+	for (i = 0; i < header->n_entries; ++i)
+	{
+		if (listing->entries[i].name >= strings_length ||
+		    listing->entries[i].display_name >= strings_length ||
+		    listing->entries[i].content_type >= strings_length)
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/* Takes @bytes, returns NULL if they are not a listing of @uri */
+static PlumaDirListing *
+listing_new (GBytes      *bytes,
+	     const gchar *uri)
+{
+	PlumaDirListing *listing;
+
+	listing = g_slice_new0 (PlumaDirListing);
+	listing->ref_count = 1;
+	listing->bytes = bytes;
+
+	if (!listing_validate (listing, uri))
+	{
+		pluma_debug_message (DEBUG_UTILS, "Ignoring invalid listing for %s", uri);
+
+		pluma_dir_listing_unref (listing);
+		return NULL;
+	}
+
+	return listing;
+}
+
+/* Keeps the listing of @uri which could not be written, or forgets it
+ * if @listing is NULL */
+static void
+set_unstored (PlumaDirCache   *cache,
+	      const gchar     *uri,
+	      PlumaDirListing *listing)
+{
+	g_mutex_lock (&cache->priv->unstored_lock);
+
+	if (listing == NULL)
+	{
+		g_hash_table_remove (cache->priv->unstored, uri);
+	}
+	else
+	{
+		/* bounded like the stored listings, any one can go */
+		if (g_hash_table_size (cache->priv->unstored) >= cache->priv->max_listings &&
+		    !g_hash_table_contains (cache->priv->unstored, uri))
+		{
+			GHashTableIter iter;
+
+			g_hash_table_iter_init (&iter, cache->priv->unstored);
+			if (g_hash_table_iter_next (&iter, NULL, NULL))
+				g_hash_table_iter_remove (&iter);
+		}
+
+		g_hash_table_replace (cache->priv->unstored, g_strdup (uri), listing);
+	}
+
+	g_mutex_unlock (&cache->priv->unstored_lock);
+}
+
+/**
+ * pluma_dir_cache_lookup:
+ * @cache: a #PlumaDirCache
+ * @directory: the directory to look up
+ *
+ * Gets the entries @directory had when it was last stored. The listing
+ * may be out of date, use pluma_dir_cache_revalidate() to check it in
+ * the background. This function may be called from any thread.
+ *
+ * Listings which could not be written are looked up in memory.
+ *
+ * Returns: (transfer full) (allow-none): the cached listing of
+ * @directory, or %NULL if it is not in the cache
+ */
+PlumaDirListing *
+pluma_dir_cache_lookup (PlumaDirCache *cache,
+			GFile         *directory)
+{
+	PlumaDirListing *listing;
+	GMappedFile *mapped;
+	gchar *uri;
+	gchar *path;
+
+	g_return_val_if_fail (PLUMA_IS_DIR_CACHE (cache), NULL);
+	g_return_val_if_fail (G_IS_FILE (directory), NULL);
+
+	uri = g_file_get_uri (directory);
+
+	g_mutex_lock (&cache->priv->unstored_lock);
+
+	listing = g_hash_table_lookup (cache->priv->unstored, uri);
+	if (listing != NULL)
+		pluma_dir_listing_ref (listing);
+
+	g_mutex_unlock (&cache->priv->unstored_lock);
+
+	if (listing != NULL)
+	{
+		g_free (uri);
+		return listing;
+	}
+
+	path = cache_file_for_uri (cache, uri);
+
+	mapped = g_mapped_file_new (path, FALSE, NULL);
+
+	if (mapped == NULL)
+	{
+		g_free (path);
+		g_free (uri);
+		return NULL;
+	}
+
+	touch_listing (path);
+	g_free (path);
+
+	listing = listing_new (g_mapped_file_get_bytes (mapped), uri);
+	g_mapped_file_unref (mapped);
+
+	g_free (uri);
+
+	return listing;
+}
+
+/**
+ * pluma_dir_cache_store:
+ * @cache: a #PlumaDirCache
+ * @directory: the directory that was listed
+ * @mtime: the modification time of @directory, as returned by
+ * pluma_dir_cache_query_mtime() before it was listed
+ * @infos: (element-type GFileInfo): the entries of @directory
+ *
+ * Replaces the cached listing of @directory. Only the name, display
+ * name, type, hidden, backup and content type attributes of @infos are
+ * stored; entries without a content type keep the one they had in the
+ * previous listing. This function may be called from any thread.
+ *
+ * A listing which cannot be written, e.g. because the disk is full, is
+ * kept in memory for the life of @cache instead.
+ *
+ * Returns: %TRUE if the listing can be looked up, whether it was written
+ * or not
+ */
+gboolean
+pluma_dir_cache_store (PlumaDirCache *cache,
+		       GFile         *directory,
+		       guint64        mtime,
+		       GList         *infos)
+{
+	CacheHeader header;
+	PlumaDirListing *previous;
+	GHashTable *content_types = NULL;
+	GArray *entries;
+	GString *strings;
+	GString *contents;
+	GError *error = NULL;
+	GList *l;
+	gchar *uri;
+	gchar *path;
+	gboolean ret;
+
+	g_return_val_if_fail (PLUMA_IS_DIR_CACHE (cache), FALSE);
+	g_return_val_if_fail (G_IS_FILE (directory), FALSE);
+
+	/* the strings stay valid as long as the previous listing is held */
+	previous = pluma_dir_cache_lookup (cache, directory);
+
+	if (previous != NULL)
+	{
+		guint i;
+
+		content_types = g_hash_table_new (g_str_hash, g_str_equal);
+
+		for (i = 0; i < previous->header->n_entries; ++i)
+		{
+			const CacheEntry *entry = &previous->entries[i];
+
+			if (entry->content_type != 0)
+				g_hash_table_insert (content_types,
+						     (gpointer) (previous->strings + entry->name),
+						     (gpointer) (previous->strings + entry->content_type));
+		}
+	}
+
+	uri = g_file_get_uri (directory);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (CacheEntry));
+	strings = g_string_new (NULL);
+	g_string_append_len (strings, uri, strlen (uri) + 1);
+
+	for (l = infos; l != NULL; l = l->next)
+	{
+		GFileInfo *info = G_FILE_INFO (l->data);
+		CacheEntry entry = { 0 };
+		const gchar *name;
+		const gchar *display_name;
+		const gchar *content_type = NULL;
+
+		name = g_file_info_get_name (info);
+
+		if (name == NULL)
+			continue;
+
+		entry.name = strings->len;
+		g_string_append_len (strings, name, strlen (name) + 1);
+
+		display_name = g_file_info_get_attribute_string (info,
+								 G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME);
+
+		if (display_name != NULL && strcmp (display_name, name) != 0)
+		{
+			entry.display_name = strings->len;
+			g_string_append_len (strings, display_name, strlen (display_name) + 1);
+		}
+		else
+		{
+			entry.display_name = entry.name;
+		}
+
+		if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE))
+			content_type = g_file_info_get_content_type (info);
+		else if (content_types != NULL)
+			content_type = g_hash_table_lookup (content_types, name);
+
+		if (content_type != NULL)
+		{
+			entry.content_type = strings->len;
+			g_string_append_len (strings, content_type, strlen (content_type) + 1);
+		}
+
+		entry.type = g_file_info_get_attribute_uint32 (info,
+							       G_FILE_ATTRIBUTE_STANDARD_TYPE);
+
+		if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN))
+			entry.flags |= ENTRY_FLAG_HIDDEN;
+
+		if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP))
+			entry.flags |= ENTRY_FLAG_BACKUP;
+
+		g_array_append_val (entries, entry);
+	}
+
+	if (previous != NULL)
+	{
+		g_hash_table_destroy (content_types);
+		pluma_dir_listing_unref (previous);
+	}
+
+	if (strings->len > G_MAXUINT32)
+	{
+		/* offsets would not fit, such a directory is not cached */
+		g_array_free (entries, TRUE);
+		g_string_free (strings, TRUE);
+		g_free (uri);
+
+		return FALSE;
+	}
+
+	memset (&header, 0, sizeof (CacheHeader));
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.mtime = mtime;
+	header.n_entries = entries->len;
+	header.uri_length = strlen (uri);
+
+	contents = g_string_sized_new (sizeof (CacheHeader) +
+				       entries->len * sizeof (CacheEntry) +
+				       strings->len);
+	g_string_append_len (contents, (const gchar *) &header, sizeof (CacheHeader));
+	g_string_append_len (contents,
+			     (const gchar *) entries->data,
+			     entries->len * sizeof (CacheEntry));
+	g_string_append_len (contents, strings->str, strings->len);
+
+	g_array_free (entries, TRUE);
+	g_string_free (strings, TRUE);
+
+	path = cache_file_for_uri (cache, uri);
+
+	/* g_file_set_contents () replaces the file atomically, so readers
+	 * never see a partial listing */
+	ret = g_mkdir_with_parents (cache->priv->path, 0700) == 0 &&
+	      g_file_set_contents (path, contents->str, contents->len, &error);
+
+	if (error != NULL)
+	{
+		pluma_debug_message (DEBUG_UTILS,
+				     "Could not store listing of %s: %s",
+				     uri,
+				     error->message);
+		g_error_free (error);
+	}
+
+	g_free (path);
+
+	if (ret)
+	{
+		set_unstored (cache, uri, NULL);
+		g_string_free (contents, TRUE);
+	}
+	else
+	{
+		PlumaDirListing *listing;
+
+		listing = listing_new (g_string_free_to_bytes (contents), uri);
+		set_unstored (cache, uri, listing);
+	}
+
+	g_free (uri);
+
+	/* old listings are looked for once per session, then again after
+	 * an eighth of the limit was stored */
+	if (ret &&
+	    g_atomic_int_add (&cache->priv->n_stored, 1) % MAX (cache->priv->max_listings / 8, 1) == 0)
+	{
+		evict_listings (cache);
+	}
+
+	return TRUE;
+}
+
+/**
+ * pluma_dir_cache_query_mtime:
+ * @directory: a directory
+ * @cancellable: (allow-none): a #GCancellable
+ * @error: return location for a #GError
+ *
+ * Queries the modification time of @directory, in microseconds. This is
+ * what the cache compares to decide whether a listing is up to date.
+ * It blocks, call it from a thread.
+ *
+ * Returns: the modification time, or 0 on error
+ */
+guint64
+pluma_dir_cache_query_mtime (GFile         *directory,
+			     GCancellable  *cancellable,
+			     GError       **error)
+{
+	GFileInfo *info;
+	guint64 mtime;
+
+	g_return_val_if_fail (G_IS_FILE (directory), 0);
+
+	info = g_file_query_info (directory,
+				  MTIME_ATTRIBUTES,
+				  G_FILE_QUERY_INFO_NONE,
+				  cancellable,
+				  error);
+
+	if (info == NULL)
+		return 0;
+
+	mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+		g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+	g_object_unref (info);
+
+	return mtime;
+}
+
+static void
+revalidate_thread (GTask        *task,
+		   gpointer      source_object,
+		   gpointer      task_data,
+		   GCancellable *cancellable)
+{
+	PlumaDirCache *cache = PLUMA_DIR_CACHE (source_object);
+	GFile *directory = G_FILE (task_data);
+	PlumaDirListing *listing;
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	GList *infos = NULL;
+	GError *error = NULL;
+	guint64 mtime;
+
+	mtime = pluma_dir_cache_query_mtime (directory, cancellable, &error);
+
+	if (error != NULL)
+	{
+		g_task_return_error (task, error);
+		return;
+	}
+
+	listing = pluma_dir_cache_lookup (cache, directory);
+
+	if (listing != NULL)
+	{
+		gboolean valid = pluma_dir_listing_get_mtime (listing) == mtime;
+
+		pluma_dir_listing_unref (listing);
+
+		if (valid)
+		{
+			g_task_return_boolean (task, FALSE);
+			return;
+		}
+	}
+
+	enumerator = g_file_enumerate_children (directory,
+						LIST_ATTRIBUTES,
+						G_FILE_QUERY_INFO_NONE,
+						cancellable,
+						&error);
+
+	if (enumerator == NULL)
+	{
+		g_task_return_error (task, error);
+		return;
+	}
+
+	while ((info = g_file_enumerator_next_file (enumerator, cancellable, &error)) != NULL)
+		infos = g_list_prepend (infos, info);
+
+	g_file_enumerator_close (enumerator, NULL, NULL);
+	g_object_unref (enumerator);
+
+	if (error == NULL)
+	{
+		infos = g_list_reverse (infos);
+
+		/* nothing changed if it could not be kept, the listing
+		 * would be missing again for whoever looks it up */
+		g_task_return_boolean (task,
+				       pluma_dir_cache_store (cache, directory, mtime, infos));
+	}
+	else
+	{
+		g_task_return_error (task, error);
+	}
+
+	g_list_free_full (infos, g_object_unref);
+}
+
+static void
+revalidate_ready (GObject      *source,
+		  GAsyncResult *result,
+		  gpointer      user_data)
+{
+	PlumaDirCache *cache = PLUMA_DIR_CACHE (source);
+	GFile *directory = G_FILE (g_task_get_task_data (G_TASK (result)));
+	GError *error = NULL;
+	gboolean changed;
+
+	changed = g_task_propagate_boolean (G_TASK (result), &error);
+
+	if (error != NULL)
+	{
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			gchar *uri = g_file_get_uri (directory);
+
+			pluma_debug_message (DEBUG_UTILS,
+					     "Could not revalidate %s: %s",
+					     uri,
+					     error->message);
+			g_free (uri);
+		}
+
+		g_error_free (error);
+	}
+
+	g_hash_table_remove (cache->priv->pending, directory);
+
+	if (changed)
+		g_signal_emit (cache, signals[CHANGED], 0, directory);
+}
+
+/**
+ * pluma_dir_cache_revalidate:
+ * @cache: a #PlumaDirCache
+ * @directory: the directory to check
+ *
+ * Checks in the background whether the modification time of @directory
+ * is still the one of its cached listing. If it is not, or if there is
+ * no cached listing, the directory is listed again and
+ * #PlumaDirCache::changed is emitted once the new listing is stored.
+ */
+void
+pluma_dir_cache_revalidate (PlumaDirCache *cache,
+			    GFile         *directory)
+{
+	GTask *task;
+
+	g_return_if_fail (PLUMA_IS_DIR_CACHE (cache));
+	g_return_if_fail (G_IS_FILE (directory));
+
+	if (g_hash_table_lookup (cache->priv->pending, directory) != NULL)
+		return;
+
+	g_hash_table_insert (cache->priv->pending,
+			     g_object_ref (directory),
+			     GINT_TO_POINTER (1));
+
+	task = g_task_new (cache, cache->priv->cancellable, revalidate_ready, NULL);
+	g_task_set_task_data (task, g_object_ref (directory), g_object_unref);
+	g_task_run_in_thread (task, revalidate_thread);
+	g_object_unref (task);
+}
+
+/**
+ * pluma_dir_listing_ref:
+ * @listing: a #PlumaDirListing
+ *
+ * Returns: (transfer full): @listing
+ */
+PlumaDirListing *
+pluma_dir_listing_ref (PlumaDirListing *listing)
+{
+	g_return_val_if_fail (listing != NULL, NULL);
+
+	g_atomic_int_inc (&listing->ref_count);
+
+	return listing;
+}
+
+/**
+ * pluma_dir_listing_unref:
+ * @listing: a #PlumaDirListing
+ *
+ * Releases a reference, the listing is unmapped or freed with the last
+ * one.
+ */
+void
+pluma_dir_listing_unref (PlumaDirListing *listing)
+{
+	g_return_if_fail (listing != NULL);
+
+	if (!g_atomic_int_dec_and_test (&listing->ref_count))
+		return;
+
+	g_bytes_unref (listing->bytes);
+	g_slice_free (PlumaDirListing, listing);
+}
+
+/**
+ * pluma_dir_listing_get_mtime:
+ * @listing: a #PlumaDirListing
+ *
+ * Returns: the modification time the directory had when it was listed
+ */
+guint64
+pluma_dir_listing_get_mtime (PlumaDirListing *listing)
+{
+	g_return_val_if_fail (listing != NULL, 0);
+
+	return listing->header->mtime;
+}
+
+/**
+ * pluma_dir_listing_get_n_entries:
+ * @listing: a #PlumaDirListing
+ *
+ * Returns: the number of entries of the directory
+ */
+guint
+pluma_dir_listing_get_n_entries (PlumaDirListing *listing)
+{
+	g_return_val_if_fail (listing != NULL, 0);
+
+	return listing->header->n_entries;
+}
+
+/**
+ * pluma_dir_listing_get_name:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Returns: the file name of the entry
+ */
+const gchar *
+pluma_dir_listing_get_name (PlumaDirListing *listing,
+			    guint            index)
+{
+	g_return_val_if_fail (listing != NULL, NULL);
+	g_return_val_if_fail (index < listing->header->n_entries, NULL);
+
+	return listing->strings + listing->entries[index].name;
+}
+
+/**
+ * pluma_dir_listing_get_display_name:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Returns: the display name of the entry
+ */
+const gchar *
+pluma_dir_listing_get_display_name (PlumaDirListing *listing,
+				    guint            index)
+{
+	g_return_val_if_fail (listing != NULL, NULL);
+	g_return_val_if_fail (index < listing->header->n_entries, NULL);
+
+	return listing->strings + listing->entries[index].display_name;
+}
+
+/**
+ * pluma_dir_listing_get_file_type:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Returns: the type of the entry
+ */
+GFileType
+pluma_dir_listing_get_file_type (PlumaDirListing *listing,
+				 guint            index)
+{
+	g_return_val_if_fail (listing != NULL, G_FILE_TYPE_UNKNOWN);
+	g_return_val_if_fail (index < listing->header->n_entries, G_FILE_TYPE_UNKNOWN);
+
+	return listing->entries[index].type;
+}
+
+/**
+ * pluma_dir_listing_get_is_hidden:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Returns: %TRUE if the entry is a hidden file
+ */
+gboolean
+pluma_dir_listing_get_is_hidden (PlumaDirListing *listing,
+				 guint            index)
+{
+	g_return_val_if_fail (listing != NULL, FALSE);
+	g_return_val_if_fail (index < listing->header->n_entries, FALSE);
+
+	return (listing->entries[index].flags & ENTRY_FLAG_HIDDEN) != 0;
+}
+
+/**
+ * pluma_dir_listing_get_is_backup:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Returns: %TRUE if the entry is a backup file
+ */
+gboolean
+pluma_dir_listing_get_is_backup (PlumaDirListing *listing,
+				 guint            index)
+{
+	g_return_val_if_fail (listing != NULL, FALSE);
+	g_return_val_if_fail (index < listing->header->n_entries, FALSE);
+
+	return (listing->entries[index].flags & ENTRY_FLAG_BACKUP) != 0;
+}
+
+/**
+ * pluma_dir_listing_get_content_type:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Returns: (allow-none): the content type of the entry, or %NULL if it
+ * was never stored
+ */
+const gchar *
+pluma_dir_listing_get_content_type (PlumaDirListing *listing,
+				    guint            index)
+{
+	g_return_val_if_fail (listing != NULL, NULL);
+	g_return_val_if_fail (index < listing->header->n_entries, NULL);
+
+	if (listing->entries[index].content_type == 0)
+		return NULL;
+
+	return listing->strings + listing->entries[index].content_type;
+}
+
+/**
+ * pluma_dir_listing_get_info:
+ * @listing: a #PlumaDirListing
+ * @index: the index of an entry
+ *
+ * Builds a #GFileInfo with the cached attributes of an entry, for code
+ * that handles listings the same way as enumerations. The content type
+ * and icon are only set if the content type was stored.
+ *
+ * Returns: (transfer full): a new #GFileInfo
+ */
+GFileInfo *
+pluma_dir_listing_get_info (PlumaDirListing *listing,
+			    guint            index)
+{
+	const CacheEntry *entry;
+	GFileInfo *info;
+
+	g_return_val_if_fail (listing != NULL, NULL);
+	g_return_val_if_fail (index < listing->header->n_entries, NULL);
+
+	entry = &listing->entries[index];
+
+	info = g_file_info_new ();
+	g_file_info_set_name (info, listing->strings + entry->name);
+	g_file_info_set_display_name (info, listing->strings + entry->display_name);
+	g_file_info_set_file_type (info, entry->type);
+	g_file_info_set_is_hidden (info, (entry->flags & ENTRY_FLAG_HIDDEN) != 0);
+	g_file_info_set_is_backup (info, (entry->flags & ENTRY_FLAG_BACKUP) != 0);
+
+	/* the icon follows from the content type, as for local files */
+	if (entry->content_type != 0)
+	{
+		const gchar *content_type = listing->strings + entry->content_type;
+		GIcon *icon;
+
+		g_file_info_set_content_type (info, content_type);
+
+		icon = g_content_type_get_icon (content_type);
+		g_file_info_set_icon (info, icon);
+		g_object_unref (icon);
+	}
+
+	return info;
+}
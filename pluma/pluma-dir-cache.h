@@ -0,0 +1,116 @@
+/*
+ * pluma-dir-cache.h
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef __PLUMA_DIR_CACHE_H__
+#define __PLUMA_DIR_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define PLUMA_TYPE_DIR_CACHE			(pluma_dir_cache_get_type ())
+#define PLUMA_DIR_CACHE(obj)			(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_DIR_CACHE, PlumaDirCache))
+#define PLUMA_DIR_CACHE_CONST(obj)		(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_DIR_CACHE, PlumaDirCache const))
+#define PLUMA_DIR_CACHE_CLASS(klass)		(G_TYPE_CHECK_CLASS_CAST ((klass), PLUMA_TYPE_DIR_CACHE, PlumaDirCacheClass))
+#define PLUMA_IS_DIR_CACHE(obj)			(G_TYPE_CHECK_INSTANCE_TYPE ((obj), PLUMA_TYPE_DIR_CACHE))
+#define PLUMA_IS_DIR_CACHE_CLASS(klass)		(G_TYPE_CHECK_CLASS_TYPE ((klass), PLUMA_TYPE_DIR_CACHE))
+#define PLUMA_DIR_CACHE_GET_CLASS(obj)		(G_TYPE_INSTANCE_GET_CLASS ((obj), PLUMA_TYPE_DIR_CACHE, PlumaDirCacheClass))
+
+#define PLUMA_TYPE_DIR_LISTING			(pluma_dir_listing_get_type ())
+
+typedef struct _PlumaDirCache		PlumaDirCache;
+typedef struct _PlumaDirCacheClass	PlumaDirCacheClass;
+typedef struct _PlumaDirCachePrivate	PlumaDirCachePrivate;
+
+typedef struct _PlumaDirListing		PlumaDirListing;
+
+struct _PlumaDirCache
+{
+	GObject parent;
+
+	PlumaDirCachePrivate *priv;
+};
+
+struct _PlumaDirCacheClass
+{
+	GObjectClass parent_class;
+
+	/* Signals */
+	void (* changed)	(PlumaDirCache *cache,
+				 GFile         *directory);
+};
+
+GType		 pluma_dir_cache_get_type		(void) G_GNUC_CONST;
+
+PlumaDirCache	*pluma_dir_cache_new			(const gchar   *path);
+
+PlumaDirCache	*pluma_dir_cache_get_default		(void);
+
+PlumaDirListing	*pluma_dir_cache_lookup			(PlumaDirCache *cache,
+							 GFile         *directory);
+
+gboolean	 pluma_dir_cache_store			(PlumaDirCache *cache,
+							 GFile         *directory,
+							 guint64        mtime,
+							 GList         *infos);
+
+void		 pluma_dir_cache_revalidate		(PlumaDirCache *cache,
+							 GFile         *directory);
+
+guint64		 pluma_dir_cache_query_mtime		(GFile         *directory,
+							 GCancellable  *cancellable,
+							 GError       **error);
+
+GType		 pluma_dir_listing_get_type		(void) G_GNUC_CONST;
+
+PlumaDirListing	*pluma_dir_listing_ref			(PlumaDirListing *listing);
+
+void		 pluma_dir_listing_unref		(PlumaDirListing *listing);
+
+guint64		 pluma_dir_listing_get_mtime		(PlumaDirListing *listing);
+
+guint		 pluma_dir_listing_get_n_entries	(PlumaDirListing *listing);
+
+const gchar	*pluma_dir_listing_get_name		(PlumaDirListing *listing,
+							 guint            index);
+
+const gchar	*pluma_dir_listing_get_display_name	(PlumaDirListing *listing,
+							 guint            index);
+
+GFileType	 pluma_dir_listing_get_file_type	(PlumaDirListing *listing,
+							 guint            index);
+
+gboolean	 pluma_dir_listing_get_is_hidden	(PlumaDirListing *listing,
+							 guint            index);
+
+gboolean	 pluma_dir_listing_get_is_backup	(PlumaDirListing *listing,
+							 guint            index);
+
+const gchar	*pluma_dir_listing_get_content_type	(PlumaDirListing *listing,
+							 guint            index);
+
+GFileInfo	*pluma_dir_listing_get_info		(PlumaDirListing *listing,
+							 guint            index);
+
+G_END_DECLS
+
+#endif /* __PLUMA_DIR_CACHE_H__ */
@@ -220,6 +220,9 @@ pluma_document_loader_init (PlumaDocumentLoader *loader)
 {
 	loader->used = FALSE;
 	loader->auto_detected_newline_type = PLUMA_DOCUMENT_NEWLINE_TYPE_DEFAULT;
+	loader->auto_detected_compression_type = PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
+	loader->io_priority = G_PRIORITY_HIGH;
+	loader->paused = FALSE;
 }
 
 void
@@ -300,6 +303,59 @@ pluma_document_loader_cancel (PlumaDocumentLoader *loader)
 	return PLUMA_DOCUMENT_LOADER_GET_CLASS (loader)->cancel (loader);
 }
 
+/* The I/O priority of the reads, so that the documents loading in the
+ * background do not compete with the one being looked at. Takes effect
+ * from the next read on. */
+void
+pluma_document_loader_set_priority (PlumaDocumentLoader *loader,
+				    gint                 io_priority)
+{
+	g_return_if_fail (PLUMA_IS_DOCUMENT_LOADER (loader));
+
+	loader->io_priority = io_priority;
+}
+
+gint
+pluma_document_loader_get_priority (PlumaDocumentLoader *loader)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT_LOADER (loader), G_PRIORITY_HIGH);
+
+	return loader->io_priority;
+}
+
+/* A paused loader finishes the read in progress and does not issue the
+ * next one until it is resumed. Loaders which cannot be paused ignore it. */
+void
+pluma_document_loader_set_paused (PlumaDocumentLoader *loader,
+				  gboolean             paused)
+{
+	PlumaDocumentLoaderClass *klass;
+
+	g_return_if_fail (PLUMA_IS_DOCUMENT_LOADER (loader));
+
+	paused = (paused != FALSE);
+
+	if (loader->paused == paused)
+		return;
+
+	pluma_debug_message (DEBUG_LOADER, paused ? "paused" : "resumed");
+
+	loader->paused = paused;
+
+	klass = PLUMA_DOCUMENT_LOADER_GET_CLASS (loader);
+
+	if (!paused && klass->resume != NULL)
+		klass->resume (loader);
+}
+
+gboolean
+pluma_document_loader_get_paused (PlumaDocumentLoader *loader)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT_LOADER (loader), FALSE);
+
+	return loader->paused;
+}
+
 PlumaDocument *
 pluma_document_loader_get_document (PlumaDocumentLoader *loader)
 {
@@ -348,6 +404,16 @@ pluma_document_loader_get_newline_type (PlumaDocumentLoader *loader)
 	return loader->auto_detected_newline_type;
 }
 
+/* The compression of the file, known once the first bytes have been read */
+PlumaDocumentCompressionType
+pluma_document_loader_get_compression_type (PlumaDocumentLoader *loader)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT_LOADER (loader),
+			      PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE);
+
+	return loader->auto_detected_compression_type;
+}
+
 GFileInfo *
 pluma_document_loader_get_info (PlumaDocumentLoader *loader)
 {
@@ -67,6 +67,11 @@ struct _PlumaDocumentLoader
 	const PlumaEncoding	 *encoding;
 	const PlumaEncoding	 *auto_detected_encoding;
 	PlumaDocumentNewlineType  auto_detected_newline_type;
+	PlumaDocumentCompressionType auto_detected_compression_type;
+
+	/* Scheduling of the reads, see pluma_document_loader_set_priority */
+	gint			  io_priority;
+	gboolean		  paused;
 };
 
 /*
@@ -87,6 +92,7 @@ struct _PlumaDocumentLoaderClass
 	void			(* load)		(PlumaDocumentLoader *loader);
 	gboolean		(* cancel)		(PlumaDocumentLoader *loader);
 	goffset			(* get_bytes_read)	(PlumaDocumentLoader *loader);
+	void			(* resume)		(PlumaDocumentLoader *loader);
 };
 
 /*
@@ -109,6 +115,14 @@ gboolean		 pluma_document_loader_load_from_stdin	(PlumaDocumentLoader *loader);
 #endif		 
 gboolean		 pluma_document_loader_cancel		(PlumaDocumentLoader *loader);
 
+void			 pluma_document_loader_set_priority	(PlumaDocumentLoader *loader,
+								 gint                 io_priority);
+gint			 pluma_document_loader_get_priority	(PlumaDocumentLoader *loader);
+
+void			 pluma_document_loader_set_paused	(PlumaDocumentLoader *loader,
+								 gboolean             paused);
+gboolean		 pluma_document_loader_get_paused	(PlumaDocumentLoader *loader);
+
 PlumaDocument		*pluma_document_loader_get_document	(PlumaDocumentLoader *loader);
 
 /* Returns STDIN_URI if loading from stdin */
@@ -119,6 +133,10 @@ const PlumaEncoding	*pluma_document_loader_get_encoding	(PlumaDocumentLoader *lo
 
 PlumaDocumentNewlineType pluma_document_loader_get_newline_type (PlumaDocumentLoader *loader);
 
+PlumaDocumentCompressionType
+			 pluma_document_loader_get_compression_type
+								(PlumaDocumentLoader *loader);
+
 goffset			 pluma_document_loader_get_bytes_read	(PlumaDocumentLoader *loader);
 
 /* You can get from the info: content_type, time_modified, standard_size, access_can_write 
@@ -48,14 +48,20 @@ struct _PlumaDocumentOutputStreamPrivate
 	gchar *buffer;
 	gsize buflen;
 
+	/* line terminator removed from the end of the document */
+	gchar *ending_newline;
+
 	guint is_initialized : 1;
 	guint is_closed : 1;
+	guint append : 1;
+	guint was_modified : 1;
 };
 
 enum
 {
 	PROP_0,
-	PROP_DOCUMENT
+	PROP_DOCUMENT,
+	PROP_APPEND
 };
 
 G_DEFINE_TYPE (PlumaDocumentOutputStream, pluma_document_output_stream, G_TYPE_OUTPUT_STREAM)
@@ -88,6 +94,10 @@ pluma_document_output_stream_set_property (GObject      *object,
 			stream->priv->doc = PLUMA_DOCUMENT (g_value_get_object (value));
 			break;
 
+		case PROP_APPEND:
+			stream->priv->append = g_value_get_boolean (value);
+			break;
+
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 			break;
@@ -108,6 +118,10 @@ pluma_document_output_stream_get_property (GObject    *object,
 			g_value_set_object (value, stream->priv->doc);
 			break;
 
+		case PROP_APPEND:
+			g_value_set_boolean (value, stream->priv->append);
+			break;
+
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 			break;
@@ -120,6 +134,7 @@ pluma_document_output_stream_finalize (GObject *object)
 	PlumaDocumentOutputStream *stream = PLUMA_DOCUMENT_OUTPUT_STREAM (object);
 
 	g_free (stream->priv->buffer);
+	g_free (stream->priv->ending_newline);
 
 	G_OBJECT_CLASS (pluma_document_output_stream_parent_class)->finalize (object);
 }
@@ -135,6 +150,10 @@ pluma_document_output_stream_constructed (GObject *object)
 		return;
 	}
 
+	/* appending keeps the current content */
+	if (stream->priv->append)
+		return;
+
 	/* Init the undoable action */
 	gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (stream->priv->doc));
 	/* clear the buffer */
@@ -170,6 +189,15 @@ pluma_document_output_stream_class_init (PlumaDocumentOutputStreamClass *klass)
 							      G_PARAM_READWRITE |
 							      G_PARAM_CONSTRUCT_ONLY));
 
+	g_object_class_install_property (object_class,
+					 PROP_APPEND,
+					 g_param_spec_boolean ("append",
+							       "Append",
+							       "Whether to append to the document instead of replacing its content",
+							       FALSE,
+							       G_PARAM_READWRITE |
+							       G_PARAM_CONSTRUCT_ONLY));
+
 	g_type_class_add_private (object_class, sizeof (PlumaDocumentOutputStreamPrivate));
 }
 
@@ -222,6 +250,18 @@ pluma_document_output_stream_new (PlumaDocument *doc)
 					      "document", doc, NULL));
 }
 
+/* Writes at the end of @doc, keeping its current content. The terminator
+ * dropped by the previous stream (see get_ending_newline) has to be written
+ * first by the caller. */
+GOutputStream *
+pluma_document_output_stream_new_for_append (PlumaDocument *doc)
+{
+	return G_OUTPUT_STREAM (g_object_new (PLUMA_TYPE_DOCUMENT_OUTPUT_STREAM,
+					      "document", doc,
+					      "append", TRUE,
+					      NULL));
+}
+
 PlumaDocumentNewlineType
 pluma_document_output_stream_detect_newline_type (PlumaDocumentOutputStream *stream)
 {
@@ -265,6 +305,13 @@ remove_ending_newline (PlumaDocumentOutputStream *stream)
 			gtk_text_iter_forward_to_line_end (&start);
 		}
 
+		g_free (stream->priv->ending_newline);
+		stream->priv->ending_newline =
+			gtk_text_buffer_get_text (GTK_TEXT_BUFFER (stream->priv->doc),
+						  &start,
+						  &end,
+						  TRUE);
+
 		/* Delete the empty line which is from 'start' to 'end' */
 		gtk_text_buffer_delete (GTK_TEXT_BUFFER (stream->priv->doc),
 		                        &start,
@@ -272,13 +319,28 @@ remove_ending_newline (PlumaDocumentOutputStream *stream)
 	}
 }
 
+/**
+ * pluma_document_output_stream_get_ending_newline:
+ * @stream: a #PlumaDocumentOutputStream
+ *
+ * Returns: the line terminator removed from the end of the document when
+ * the stream was closed, or %NULL if the text did not end with one
+ */
+const gchar *
+pluma_document_output_stream_get_ending_newline (PlumaDocumentOutputStream *stream)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT_OUTPUT_STREAM (stream), NULL);
+
+	return stream->priv->ending_newline;
+}
+
 static void
 end_append_text_to_document (PlumaDocumentOutputStream *stream)
 {
 	remove_ending_newline (stream);
 
 	gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (stream->priv->doc),
-				      FALSE);
+				      stream->priv->was_modified);
 
 	gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (stream->priv->doc));
 }
@@ -307,8 +369,20 @@ pluma_document_output_stream_write (GOutputStream            *stream,
 		/* Init the undoable action */
 		gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (ostream->priv->doc));
 
-		gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (ostream->priv->doc),
-						&ostream->priv->pos);
+		if (ostream->priv->append)
+		{
+			ostream->priv->was_modified =
+				gtk_text_buffer_get_modified (GTK_TEXT_BUFFER (ostream->priv->doc));
+
+			gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (ostream->priv->doc),
+						      &ostream->priv->pos);
+		}
+		else
+		{
+			gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (ostream->priv->doc),
+							&ostream->priv->pos);
+		}
+
 		ostream->priv->is_initialized = TRUE;
 	}
 
@@ -57,6 +57,10 @@ GType			 pluma_document_output_stream_get_type		(void) G_GNUC_CONST;
 
 GOutputStream		*pluma_document_output_stream_new		(PlumaDocument *doc);
 
+GOutputStream		*pluma_document_output_stream_new_for_append	(PlumaDocument *doc);
+
+const gchar		*pluma_document_output_stream_get_ending_newline (PlumaDocumentOutputStream *stream);
+
 PlumaDocumentNewlineType pluma_document_output_stream_detect_newline_type (PlumaDocumentOutputStream *stream);
 
 G_END_DECLS
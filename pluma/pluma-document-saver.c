@@ -64,6 +64,7 @@ enum {
 	PROP_URI,
 	PROP_ENCODING,
 	PROP_NEWLINE_TYPE,
+	PROP_COMPRESSION_TYPE,
 	PROP_FLAGS
 };
 
@@ -92,6 +93,9 @@ pluma_document_saver_set_property (GObject      *object,
 		case PROP_NEWLINE_TYPE:
 			saver->newline_type = g_value_get_enum (value);
 			break;
+		case PROP_COMPRESSION_TYPE:
+			saver->compression_type = g_value_get_enum (value);
+			break;
 		case PROP_FLAGS:
 			saver->flags = g_value_get_flags (value);
 			break;
@@ -123,6 +127,9 @@ pluma_document_saver_get_property (GObject    *object,
 		case PROP_NEWLINE_TYPE:
 			g_value_set_enum (value, saver->newline_type);
 			break;
+		case PROP_COMPRESSION_TYPE:
+			g_value_set_enum (value, saver->compression_type);
+			break;
 		case PROP_FLAGS:
 			g_value_set_flags (value, saver->flags);
 			break;
@@ -208,6 +215,17 @@ pluma_document_saver_class_init (PlumaDocumentSaverClass *klass)
 					                    G_PARAM_STATIC_BLURB |
 					                    G_PARAM_CONSTRUCT_ONLY));
 
+	g_object_class_install_property (object_class,
+					 PROP_COMPRESSION_TYPE,
+					 g_param_spec_enum ("compression-type",
+					                    "Compression type",
+					                    "The compression of the saved file",
+					                    PLUMA_TYPE_DOCUMENT_COMPRESSION_TYPE,
+					                    PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE,
+					                    G_PARAM_READWRITE |
+					                    G_PARAM_STATIC_STRINGS |
+					                    G_PARAM_CONSTRUCT_ONLY));
+
 	g_object_class_install_property (object_class,
 					 PROP_FLAGS,
 					 g_param_spec_flags ("flags",
@@ -242,6 +260,7 @@ pluma_document_saver_new (PlumaDocument           *doc,
 			  const gchar             *uri,
 			  const PlumaEncoding     *encoding,
 			  PlumaDocumentNewlineType newline_type,
+			  PlumaDocumentCompressionType compression_type,
 			  PlumaDocumentSaveFlags   flags)
 {
 	PlumaDocumentSaver *saver;
@@ -259,6 +278,7 @@ pluma_document_saver_new (PlumaDocument           *doc,
 						    "uri", uri,
 						    "encoding", encoding,
 						    "newline_type", newline_type,
+						    "compression_type", compression_type,
 						    "flags", flags,
 						    NULL));
 
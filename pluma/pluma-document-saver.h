@@ -63,6 +63,7 @@ struct _PlumaDocumentSaver
 	gchar			 *uri;
 	const PlumaEncoding      *encoding;
 	PlumaDocumentNewlineType  newline_type;
+	PlumaDocumentCompressionType compression_type;
 
 	PlumaDocumentSaveFlags    flags;
 
@@ -100,6 +101,7 @@ PlumaDocumentSaver 	*pluma_document_saver_new 		(PlumaDocument           *doc,
 								 const gchar             *uri,
 								 const PlumaEncoding     *encoding,
 								 PlumaDocumentNewlineType newline_type,
+								 PlumaDocumentCompressionType compression_type,
 								 PlumaDocumentSaveFlags   flags);
 
 void			 pluma_document_saver_saving		(PlumaDocumentSaver *saver,
@@ -47,10 +47,14 @@
 #include "pluma-language-manager.h"
 #include "pluma-style-scheme-manager.h"
 #include "pluma-document-loader.h"
+#include "pluma-gio-document-loader.h"
 #include "pluma-document-saver.h"
 #include "pluma-marshal.h"
 #include "pluma-enum-types.h"
 #include "plumatextregion.h"
+#include "pluma-line-diff.h"
+#include "pluma-paged-file.h"
+#include "pluma-compression.h"
 
 #ifndef ENABLE_GVFS_METADATA
 #include "pluma-metadata-manager.h"
@@ -98,6 +102,49 @@ static void 	insert_text_cb		 	(PlumaDocument *doc,
 static void	delete_range_cb 		(PlumaDocument *doc, 
 						 GtkTextIter   *start,
 						 GtkTextIter   *end);
+static void	clear_dirty_lines		(PlumaDocument *doc);
+static void	start_monitoring		(PlumaDocument *doc);
+static void	stop_monitoring			(PlumaDocument *doc);
+static void	stop_paging			(PlumaDocument *doc);
+static void	remove_watches			(PlumaDocument *doc);
+
+/* Interval, in seconds, at which documents on file systems where a file
+ * monitor cannot be trusted are checked for external modifications */
+#define EXTERNAL_CHECK_POLL_INTERVAL 5
+
+/* Above this many changed lines an incremental reload replaces the whole
+ * changed block at once instead of looking for a minimal diff */
+#define RELOAD_MAX_EDITS 10000
+
+/* Size of the part of a paged file shown in the buffer */
+#define PAGED_WINDOW_LINES	20000
+#define PAGED_WINDOW_MAX_BYTES	(8 * 1024 * 1024)
+
+/* Most text copied at once out of a paged file */
+#define PAGED_COPY_MAX_BYTES	(64 * 1024 * 1024)
+
+/* Coalesced watches are called before GTK+ resizes and redraws */
+#define WATCH_IDLE_PRIORITY	G_PRIORITY_HIGH_IDLE
+
+typedef struct _DocumentWatch DocumentWatch;
+
+struct _DocumentWatch
+{
+	guint                    id;
+	GtkTextMark             *start;
+	GtkTextMark             *end;
+	PlumaDocumentWatchFlags  flags;
+	PlumaDocumentWatchFunc   func;
+	gpointer                 user_data;
+	GDestroyNotify           notify;
+
+	/* What happened since the last coalesced call */
+	GtkTextMark             *pending_start;
+	GtkTextMark             *pending_end;
+
+	guint cursor_inside : 1;
+	guint removed : 1;
+};
 			     
 struct _PlumaDocumentPrivate
 {
@@ -119,6 +166,7 @@ struct _PlumaDocumentPrivate
 	gint	     num_of_lines_search_text;
 
 	PlumaDocumentNewlineType newline_type;
+	PlumaDocumentCompressionType compression_type;
 
 	/* Temp data while loading */
 	PlumaDocumentLoader *loader;
@@ -127,6 +175,9 @@ struct _PlumaDocumentPrivate
 	const PlumaEncoding *requested_encoding;
 	gint                 requested_line_pos;
 
+	/* Scheduling of the load, see _pluma_document_set_load_priority */
+	gint                 load_priority;
+
 	/* Saving stuff */
 	PlumaDocumentSaver *saver;
 
@@ -134,6 +185,46 @@ struct _PlumaDocumentPrivate
 	PlumaTextRegion *to_search_region;
 	GtkTextTag      *found_tag;
 
+	/* Lines modified since the last load or save */
+	PlumaTextRegion *dirty_region;
+
+	/* External modification tracking */
+	GFileMonitor    *monitor;
+	GCancellable    *monitor_cancellable;
+	guint            poll_id;
+
+	/* Bumped on every change, to detect edits racing with a reload */
+	guint            content_stamp;
+
+	/* Follow mode: the loader that read the file, kept to read what
+	 * gets appended to it */
+	PlumaDocumentLoader *follow_loader;
+
+	/* Features turned off for this document, e.g. by the large file
+	 * profile */
+	PlumaDocumentFeatures disabled_features;
+
+	/* Paged mode: the file is too big to be loaded, the buffer only
+	 * holds the lines from paged_first_line on, read from a mapping */
+	PlumaPagedFile  *paged;
+	gint64           paged_first_line;
+	goffset          paged_start;
+	goffset          paged_end;
+	GCancellable    *paged_search_cancellable;
+	guint            paged_load_id;
+
+	/* Line to go to once the lines up to it are counted, -1 if none */
+	gint64           paged_pending_line;
+	gint             paged_pending_line_offset;
+
+	/* Plugin watches, and the last change waiting for ::changed */
+	GSList          *watches;
+	guint            last_watch_id;
+	guint            watch_idle_id;
+	gint             watch_dispatching;
+	gint             watch_change_start;
+	gint             watch_change_end;
+
 	/* Mount operation factory */
 	PlumaMountOperationFactory  mount_operation_factory;
 	gpointer		    mount_operation_userdata;
@@ -143,6 +234,12 @@ struct _PlumaDocumentPrivate
 	gint language_set_by_user : 1;
 	gint stop_cursor_moved_emission : 1;
 	gint dispose_has_run : 1;
+	gint externally_modified : 1;
+	gint check_pending : 1;
+	gint recheck : 1;
+	gint follow : 1;
+	gint large_file : 1;
+	gint load_paused : 1;
 };
 
 enum {
@@ -156,7 +253,10 @@ enum {
 	PROP_ENCODING,
 	PROP_CAN_SEARCH_AGAIN,
 	PROP_ENABLE_SEARCH_HIGHLIGHTING,
-	PROP_NEWLINE_TYPE
+	PROP_NEWLINE_TYPE,
+	PROP_COMPRESSION_TYPE,
+	PROP_DISABLED_FEATURES,
+	PROP_LARGE_FILE_PROFILE
 };
 
 enum {
@@ -168,6 +268,9 @@ enum {
 	SAVING,
 	SAVED,
 	SEARCH_HIGHLIGHT_UPDATED,
+	EXTERNALLY_MODIFIED,
+	FILE_APPENDED,
+	PAGED_LINE_SHOWN,
 	LAST_SIGNAL
 };
 
@@ -232,7 +335,8 @@ pluma_document_dispose (GObject *object)
 	 * because the language is gone by the time finalize runs.
 	 * beside if some plugin prevents proper finalization by
 	 * holding a ref to the doc, we still save the metadata */
-	if ((!doc->priv->dispose_has_run) && (doc->priv->uri != NULL))
+	if ((!doc->priv->dispose_has_run) && (doc->priv->uri != NULL) &&
+	    (doc->priv->paged == NULL))
 	{
 		GtkTextIter iter;
 		gchar *position;
@@ -268,6 +372,10 @@ pluma_document_dispose (GObject *object)
 		g_free (position);
 	}
 
+	stop_monitoring (doc);
+	stop_paging (doc);
+	remove_watches (doc);
+
 	if (doc->priv->loader)
 	{
 		g_object_unref (doc->priv->loader);
@@ -308,6 +416,9 @@ pluma_document_finalize (GObject *object)
 		pluma_text_region_destroy (doc->priv->to_search_region, FALSE);
 	}
 
+	if (doc->priv->dirty_region != NULL)
+		pluma_text_region_destroy (doc->priv->dirty_region, FALSE);
+
 	G_OBJECT_CLASS (pluma_document_parent_class)->finalize (object);
 }
 
@@ -348,6 +459,15 @@ pluma_document_get_property (GObject    *object,
 		case PROP_NEWLINE_TYPE:
 			g_value_set_enum (value, doc->priv->newline_type);
 			break;
+		case PROP_COMPRESSION_TYPE:
+			g_value_set_enum (value, doc->priv->compression_type);
+			break;
+		case PROP_DISABLED_FEATURES:
+			g_value_set_flags (value, doc->priv->disabled_features);
+			break;
+		case PROP_LARGE_FILE_PROFILE:
+			g_value_set_boolean (value, doc->priv->large_file != FALSE);
+			break;
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 			break;
@@ -372,6 +492,14 @@ pluma_document_set_property (GObject      *object,
 			pluma_document_set_newline_type (doc,
 							 g_value_get_enum (value));
 			break;
+		case PROP_COMPRESSION_TYPE:
+			pluma_document_set_compression_type (doc,
+							     g_value_get_enum (value));
+			break;
+		case PROP_DISABLED_FEATURES:
+			pluma_document_set_disabled_features (doc,
+							      g_value_get_flags (value));
+			break;
 		case PROP_SHORTNAME:
 			pluma_document_set_short_name_for_display (doc,
 			                                           g_value_get_string (value));
@@ -386,6 +514,226 @@ pluma_document_set_property (GObject      *object,
 	}
 }
 
+static void
+watch_get_range (PlumaDocument *doc,
+		 DocumentWatch *watch,
+		 GtkTextIter   *start,
+		 GtkTextIter   *end)
+{
+	if (watch->start != NULL)
+		gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc), start, watch->start);
+	else
+		gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (doc), start);
+
+	if (watch->end != NULL)
+		gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc), end, watch->end);
+	else
+		gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (doc), end);
+}
+
+static gboolean
+watch_is_valid (DocumentWatch *watch)
+{
+	return !watch->removed &&
+	       (watch->start == NULL || !gtk_text_mark_get_deleted (watch->start)) &&
+	       (watch->end == NULL || !gtk_text_mark_get_deleted (watch->end));
+}
+
+static void
+watch_clear_pending (PlumaDocument *doc,
+		     DocumentWatch *watch)
+{
+	if (watch->pending_start == NULL)
+		return;
+
+	gtk_text_buffer_delete_mark (GTK_TEXT_BUFFER (doc), watch->pending_start);
+	gtk_text_buffer_delete_mark (GTK_TEXT_BUFFER (doc), watch->pending_end);
+	watch->pending_start = NULL;
+	watch->pending_end = NULL;
+}
+
+static void
+watch_free (PlumaDocument *doc,
+	    DocumentWatch *watch)
+{
+	watch_clear_pending (doc, watch);
+
+	if (watch->start != NULL)
+		g_object_unref (watch->start);
+
+	if (watch->end != NULL)
+		g_object_unref (watch->end);
+
+	if (watch->notify != NULL)
+		watch->notify (watch->user_data);
+
+	g_slice_free (DocumentWatch, watch);
+}
+
+static void
+purge_removed_watches (PlumaDocument *doc)
+{
+	GSList *l;
+	GSList *next;
+
+	for (l = doc->priv->watches; l != NULL; l = next)
+	{
+		DocumentWatch *watch = l->data;
+
+		next = l->next;
+
+		if (watch->removed)
+		{
+			doc->priv->watches = g_slist_delete_link (doc->priv->watches, l);
+			watch_free (doc, watch);
+		}
+	}
+}
+
+static void
+remove_watches (PlumaDocument *doc)
+{
+	if (doc->priv->watch_idle_id != 0)
+	{
+		g_source_remove (doc->priv->watch_idle_id);
+		doc->priv->watch_idle_id = 0;
+	}
+
+	while (doc->priv->watches != NULL)
+	{
+		DocumentWatch *watch = doc->priv->watches->data;
+
+		doc->priv->watches = g_slist_delete_link (doc->priv->watches,
+							  doc->priv->watches);
+		watch_free (doc, watch);
+	}
+}
+
+static gboolean
+watches_idle (PlumaDocument *doc)
+{
+	GSList *l;
+
+	doc->priv->watch_idle_id = 0;
+	doc->priv->watch_dispatching++;
+
+	for (l = doc->priv->watches; l != NULL; l = l->next)
+	{
+		DocumentWatch *watch = l->data;
+		GtkTextIter start;
+		GtkTextIter end;
+
+		if (watch->pending_start == NULL)
+			continue;
+
+		gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc), &start, watch->pending_start);
+		gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc), &end, watch->pending_end);
+		watch_clear_pending (doc, watch);
+
+		if (watch_is_valid (watch))
+			watch->func (doc, &start, &end, watch->user_data);
+	}
+
+	if (--doc->priv->watch_dispatching == 0)
+		purge_removed_watches (doc);
+
+	return FALSE;
+}
+
+static void
+watch_deliver (PlumaDocument *doc,
+	       DocumentWatch *watch,
+	       GtkTextIter   *start,
+	       GtkTextIter   *end)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (doc);
+	GtkTextIter iter;
+
+	if ((watch->flags & PLUMA_DOCUMENT_WATCH_COALESCE) == 0)
+	{
+		watch->func (doc, start, end, watch->user_data);
+		return;
+	}
+
+	/* Grow the pending range, the marks keep it valid across edits */
+	if (watch->pending_start == NULL)
+	{
+		watch->pending_start = gtk_text_buffer_create_mark (buffer, NULL, start, TRUE);
+		watch->pending_end = gtk_text_buffer_create_mark (buffer, NULL, end, FALSE);
+	}
+	else
+	{
+		gtk_text_buffer_get_iter_at_mark (buffer, &iter, watch->pending_start);
+
+		if (gtk_text_iter_compare (start, &iter) < 0)
+			gtk_text_buffer_move_mark (buffer, watch->pending_start, start);
+
+		gtk_text_buffer_get_iter_at_mark (buffer, &iter, watch->pending_end);
+
+		if (gtk_text_iter_compare (end, &iter) > 0)
+			gtk_text_buffer_move_mark (buffer, watch->pending_end, end);
+	}
+
+	if (doc->priv->watch_idle_id == 0)
+	{
+		doc->priv->watch_idle_id =
+			g_idle_add_full (WATCH_IDLE_PRIORITY,
+					 (GSourceFunc) watches_idle,
+					 doc,
+					 NULL);
+	}
+}
+
+static void
+notify_watches (PlumaDocument           *doc,
+		PlumaDocumentWatchFlags  event,
+		gint                     start_offset,
+		gint                     end_offset)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (doc);
+	GSList *l;
+
+	doc->priv->watch_dispatching++;
+
+	for (l = doc->priv->watches; l != NULL; l = l->next)
+	{
+		DocumentWatch *watch = l->data;
+		GtkTextIter start;
+		GtkTextIter end;
+		GtkTextIter range_start;
+		GtkTextIter range_end;
+
+		if ((watch->flags & event) == 0 || !watch_is_valid (watch))
+			continue;
+
+		/* A previous callback may have changed the buffer */
+		gtk_text_buffer_get_iter_at_offset (buffer, &start, start_offset);
+		gtk_text_buffer_get_iter_at_offset (buffer, &end, end_offset);
+		watch_get_range (doc, watch, &range_start, &range_end);
+
+		if (event == PLUMA_DOCUMENT_WATCH_CURSOR)
+		{
+			gboolean was_inside = watch->cursor_inside;
+
+			watch->cursor_inside = gtk_text_iter_in_range (&start, &range_start, &range_end) ||
+					       gtk_text_iter_equal (&start, &range_end);
+
+			if (!was_inside && !watch->cursor_inside)
+				continue;
+		}
+		else if (gtk_text_iter_compare (&end, &range_start) < 0 ||
+			 gtk_text_iter_compare (&start, &range_end) > 0)
+		{
+			continue;
+		}
+
+		watch_deliver (doc, watch, &start, &end);
+	}
+
+	if (--doc->priv->watch_dispatching == 0)
+		purge_removed_watches (doc);
+}
+
 static void
 emit_cursor_moved (PlumaDocument *doc)
 {
@@ -394,6 +742,19 @@ emit_cursor_moved (PlumaDocument *doc)
 		g_signal_emit (doc,
 			       document_signals[CURSOR_MOVED],
 			       0);
+
+		if (doc->priv->watches != NULL)
+		{
+			GtkTextIter iter;
+			gint offset;
+
+			gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc),
+							  &iter,
+							  gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (doc)));
+			offset = gtk_text_iter_get_offset (&iter);
+
+			notify_watches (doc, PLUMA_DOCUMENT_WATCH_CURSOR, offset, offset);
+		}
 	}
 }
 
@@ -418,7 +779,20 @@ pluma_document_mark_set (GtkTextBuffer     *buffer,
 static void
 pluma_document_changed (GtkTextBuffer *buffer)
 {
-	emit_cursor_moved (PLUMA_DOCUMENT (buffer));
+	PlumaDocument *doc = PLUMA_DOCUMENT (buffer);
+
+	/* Watches are told about changes from here, where they are free to
+	 * modify the buffer again */
+	if (doc->priv->watch_change_start >= 0)
+	{
+		gint start = doc->priv->watch_change_start;
+		gint end = doc->priv->watch_change_end;
+
+		doc->priv->watch_change_start = -1;
+		notify_watches (doc, PLUMA_DOCUMENT_WATCH_CHANGES, start, end);
+	}
+
+	emit_cursor_moved (doc);
 
 	GTK_TEXT_BUFFER_CLASS (pluma_document_parent_class)->changed (buffer);
 }
@@ -520,6 +894,51 @@ pluma_document_class_init (PlumaDocumentClass *klass)
 	                                                    G_PARAM_STATIC_NAME |
 	                                                    G_PARAM_STATIC_BLURB));
 
+	/**
+	 * PlumaDocument:compression-type:
+	 *
+	 * The :compression-type property is the compression of the file,
+	 * detected when loading and used again when saving the document
+	 */
+	g_object_class_install_property (object_class, PROP_COMPRESSION_TYPE,
+	                                 g_param_spec_enum ("compression-type",
+	                                                    "Compression type",
+	                                                    "The compression of the file",
+	                                                    PLUMA_TYPE_DOCUMENT_COMPRESSION_TYPE,
+	                                                    PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE,
+	                                                    G_PARAM_READWRITE |
+	                                                    G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * PlumaDocument:disabled-features:
+	 *
+	 * The features that are turned off for this document, whatever
+	 * the preferences say. Plugins providing one of the
+	 * #PlumaDocumentFeatures should follow it.
+	 */
+	g_object_class_install_property (object_class, PROP_DISABLED_FEATURES,
+					 g_param_spec_flags ("disabled-features",
+							     "Disabled Features",
+							     "The features turned off for the document",
+							     PLUMA_TYPE_DOCUMENT_FEATURES,
+							     0,
+							     G_PARAM_READWRITE |
+							     G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * PlumaDocument:large-file-profile:
+	 *
+	 * Whether the document was loaded from a file big enough to turn
+	 * off the expensive features.
+	 */
+	g_object_class_install_property (object_class, PROP_LARGE_FILE_PROFILE,
+					 g_param_spec_boolean ("large-file-profile",
+							       "Large File Profile",
+							       "Whether the large file profile is active",
+							       FALSE,
+							       G_PARAM_READABLE |
+							       G_PARAM_STATIC_STRINGS));
+
 	/* This signal is used to update the cursor position is the statusbar,
 	 * it's emitted either when the insert mark is moved explicitely or
 	 * when the buffer changes (insert/delete).
@@ -645,6 +1064,59 @@ pluma_document_class_init (PlumaDocumentClass *klass)
 			      GTK_TYPE_TEXT_ITER | G_SIGNAL_TYPE_STATIC_SCOPE,
 			      GTK_TYPE_TEXT_ITER | G_SIGNAL_TYPE_STATIC_SCOPE);
 
+	/**
+	 * PlumaDocument::externally-modified:
+	 * @document: the #PlumaDocument emitting the signal
+	 *
+	 * The "externally-modified" signal is emitted when the file backing
+	 * @document is found to have been modified by another program since
+	 * it was last loaded or saved.
+	 */
+	document_signals[EXTERNALLY_MODIFIED] =
+		g_signal_new ("externally-modified",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaDocumentClass, externally_modified),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+
+	/**
+	 * PlumaDocument::file-appended:
+	 * @document: the #PlumaDocument emitting the signal
+	 *
+	 * The "file-appended" signal is emitted in follow mode, after the
+	 * text added to the end of the file has been appended to @document.
+	 */
+	document_signals[FILE_APPENDED] =
+		g_signal_new ("file-appended",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaDocumentClass, file_appended),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+
+	/**
+	 * PlumaDocument::paged-line-shown:
+	 * @document: the #PlumaDocument emitting the signal
+	 *
+	 * The "paged-line-shown" signal is emitted when the cursor was moved
+	 * to a line of a paged document which had not been counted yet when
+	 * pluma_document_goto_line() was called.
+	 */
+	document_signals[PAGED_LINE_SHOWN] =
+		g_signal_new ("paged-line-shown",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaDocumentClass, paged_line_shown),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+
 	g_type_class_add_private (object_class, sizeof(PlumaDocumentPrivate));
 }
 
@@ -666,7 +1138,8 @@ set_language (PlumaDocument     *doc,
 
 	if (lang != NULL)
 		gtk_source_buffer_set_highlight_syntax (GTK_SOURCE_BUFFER (doc),
-				 pluma_prefs_manager_get_enable_syntax_highlighting ());
+				 pluma_prefs_manager_get_enable_syntax_highlighting () &&
+				 !(doc->priv->disabled_features & PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING));
 	else
 		gtk_source_buffer_set_highlight_syntax (GTK_SOURCE_BUFFER (doc), 
 				 FALSE);
@@ -780,6 +1253,23 @@ on_uri_changed (PlumaDocument *doc,
 #endif
 }
 
+/* The extension of a compressed file says nothing about its text */
+static void
+strip_compression_extension (PlumaDocument *doc,
+			     gchar         *basename)
+{
+	gchar *dot;
+
+	if (basename == NULL ||
+	    doc->priv->compression_type == PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+		return;
+
+	dot = strrchr (basename, '.');
+
+	if (dot != NULL && dot != basename)
+		*dot = '\0';
+}
+
 static GtkSourceLanguage *
 guess_language (PlumaDocument *doc,
 		const gchar   *content_type)
@@ -819,7 +1309,9 @@ guess_language (PlumaDocument *doc,
 			basename = g_strdup (doc->priv->short_name);
 		}
 
-		language = gtk_source_language_manager_guess_language (
+		strip_compression_extension (doc, basename);
+
+		language = pluma_language_manager_guess_language (
 					pluma_get_language_manager (),
 					basename,
 					content_type);
@@ -878,6 +1370,11 @@ pluma_document_init (PlumaDocument *doc)
 	doc->priv->readonly = FALSE;
 
 	doc->priv->stop_cursor_moved_emission = FALSE;
+	doc->priv->watch_change_start = -1;
+	doc->priv->paged_pending_line = -1;
+
+	doc->priv->load_priority = G_PRIORITY_HIGH;
+	doc->priv->load_paused = FALSE;
 
 	doc->priv->last_save_was_manually = TRUE;
 	doc->priv->language_set_by_user = FALSE;
@@ -892,6 +1389,7 @@ pluma_document_init (PlumaDocument *doc)
 	doc->priv->encoding = pluma_encoding_get_utf8 ();
 
 	doc->priv->newline_type = PLUMA_DOCUMENT_NEWLINE_TYPE_DEFAULT;
+	doc->priv->compression_type = PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
 
 	gtk_source_buffer_set_max_undo_levels (GTK_SOURCE_BUFFER (doc), 
 					       pluma_prefs_manager_get_undo_actions_limit ());
@@ -907,6 +1405,8 @@ pluma_document_init (PlumaDocument *doc)
 		gtk_source_buffer_set_style_scheme (GTK_SOURCE_BUFFER (doc),
 						    style_scheme);
 
+	doc->priv->dirty_region = pluma_text_region_new (GTK_TEXT_BUFFER (doc));
+
 	g_signal_connect_after (doc, 
 			  	"insert-text",
 			  	G_CALLBACK (insert_text_cb),
@@ -974,6 +1474,7 @@ set_content_type (PlumaDocument *doc,
 			gchar *basename;
 
 			basename = g_file_get_basename (file);
+			strip_compression_extension (doc, basename);
 			guessed_type = g_content_type_guess (basename, NULL, 0, NULL);
 
 			g_free (basename);
@@ -1067,6 +1568,16 @@ pluma_document_set_uri (PlumaDocument *doc,
 
 	set_uri (doc, uri);
 	set_content_type (doc, NULL);
+
+	/* a document which was never loaded nor saved has nothing to
+	 * compare the file with, document_loader_loaded starts it */
+	if (doc->priv->mtime.tv_sec != 0 || doc->priv->mtime.tv_usec != 0)
+		start_monitoring (doc);
+	else
+	{
+		stop_monitoring (doc);
+		doc->priv->externally_modified = FALSE;
+	}
 }
 
 /**
@@ -1186,79 +1697,1559 @@ _pluma_document_set_readonly (PlumaDocument *doc,
 
 	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
 
-	if (set_readonly (doc, readonly))
+	if (set_readonly (doc, readonly))
+	{
+		g_object_notify (G_OBJECT (doc), "read-only");
+	}
+}
+
+gboolean
+pluma_document_get_readonly (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), TRUE);
+
+	return doc->priv->readonly;
+}
+
+static void queue_external_check (PlumaDocument *doc);
+static void remap_paged_file (PlumaDocument *doc);
+
+/* Changes noticed while a check was running may have been missed by it */
+static void
+external_check_done (PlumaDocument *doc)
+{
+	doc->priv->check_pending = FALSE;
+
+	if (doc->priv->recheck)
+	{
+		doc->priv->recheck = FALSE;
+		queue_external_check (doc);
+	}
+}
+
+static void
+check_info_ready_cb (GFile         *gfile,
+		     GAsyncResult  *res,
+		     PlumaDocument *doc)
+{
+	GFileInfo *info;
+	GError *error = NULL;
+
+	info = g_file_query_info_finish (gfile, res, &error);
+
+	if (error != NULL)
+	{
+		gboolean cancelled;
+
+		cancelled = g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+		g_error_free (error);
+
+		/* the document may be gone already */
+		if (cancelled)
+			return;
+	}
+
+	/* our own load or save is in progress, the stored mtime is about
+	 * to change anyway */
+	if (info == NULL || doc->priv->loader != NULL || doc->priv->saver != NULL)
+	{
+		if (info != NULL)
+			g_object_unref (info);
+
+		external_check_done (doc);
+		return;
+	}
+
+	/* reading the mapping of a paged file past its new end would
+	 * crash */
+	if (doc->priv->paged != NULL &&
+	    g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE) &&
+	    g_file_info_get_size (info) < pluma_paged_file_get_size (doc->priv->paged))
+	{
+		remap_paged_file (doc);
+	}
+
+	/* While at it also check if permissions changed, paged files are
+	 * read-only anyway */
+	if (doc->priv->paged == NULL &&
+	    g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE))
+	{
+		gboolean read_only;
+
+		read_only = !g_file_info_get_attribute_boolean (info,
+								G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE);
+
+		_pluma_document_set_readonly (doc, read_only);
+	}
+
+	if (!doc->priv->externally_modified &&
+	    g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
+	{
+		GTimeVal timeval;
+
+		g_file_info_get_modification_time (info, &timeval);
+
+		if ((timeval.tv_sec > doc->priv->mtime.tv_sec) ||
+		    (timeval.tv_sec == doc->priv->mtime.tv_sec &&
+		     timeval.tv_usec > doc->priv->mtime.tv_usec))
+		{
+			pluma_debug_message (DEBUG_DOCUMENT,
+					     "%s modified externally", doc->priv->uri);
+
+			doc->priv->externally_modified = TRUE;
+
+			g_signal_emit (doc,
+				       document_signals[EXTERNALLY_MODIFIED],
+				       0);
+		}
+	}
+
+	g_object_unref (info);
+
+	external_check_done (doc);
+}
+
+static void
+stop_following (PlumaDocument *doc)
+{
+	if (doc->priv->follow_loader != NULL)
+	{
+		g_object_unref (doc->priv->follow_loader);
+		doc->priv->follow_loader = NULL;
+	}
+}
+
+/* Drops lines from the top so that a followed file does not grow
+ * the buffer forever; done in batches rather than on every append */
+static void
+trim_followed_lines (PlumaDocument *doc)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (doc);
+	GtkTextIter start;
+	GtkTextIter end;
+	gint max_lines;
+	gint n_lines;
+	gboolean modified;
+
+	max_lines = pluma_prefs_manager_get_follow_max_lines ();
+	if (max_lines <= 0)
+		return;
+
+	n_lines = gtk_text_buffer_get_line_count (buffer);
+	if (n_lines <= max_lines + max_lines / 10)
+		return;
+
+	pluma_debug_message (DEBUG_DOCUMENT, "Trimming %d lines", n_lines - max_lines);
+
+	modified = gtk_text_buffer_get_modified (buffer);
+
+	gtk_text_buffer_get_start_iter (buffer, &start);
+	gtk_text_buffer_get_iter_at_line (buffer, &end, n_lines - max_lines);
+
+	gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (doc));
+	gtk_text_buffer_delete (buffer, &start, &end);
+	gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (doc));
+
+	gtk_text_buffer_set_modified (buffer, modified);
+}
+
+static void
+follow_append_ready_cb (PlumaGioDocumentLoader *loader,
+			GAsyncResult           *res,
+			PlumaDocument          *doc)
+{
+	GError *error = NULL;
+	gssize read;
+
+	read = pluma_gio_document_loader_append_finish (loader, res, &error);
+
+	if (read < 0)
+	{
+		/* the document may be gone already */
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			g_error_free (error);
+			return;
+		}
+
+		pluma_debug_message (DEBUG_DOCUMENT,
+				     "Cannot follow %s: %s", doc->priv->uri, error->message);
+		g_error_free (error);
+
+		doc->priv->check_pending = FALSE;
+		doc->priv->recheck = FALSE;
+
+		/* truncated or replaced: it has to be loaded again, which
+		 * is up to the user */
+		stop_following (doc);
+
+		if (!doc->priv->externally_modified)
+		{
+			doc->priv->externally_modified = TRUE;
+
+			g_signal_emit (doc,
+				       document_signals[EXTERNALLY_MODIFIED],
+				       0);
+		}
+
+		return;
+	}
+
+	/* the appended text is what is on disk now */
+	g_file_info_get_modification_time (pluma_document_loader_get_info (PLUMA_DOCUMENT_LOADER (loader)),
+					   &doc->priv->mtime);
+
+	if (read > 0)
+	{
+		trim_followed_lines (doc);
+
+		g_signal_emit (doc, document_signals[FILE_APPENDED], 0);
+	}
+
+	external_check_done (doc);
+}
+
+/* Queries the file on a GIO worker thread; the result is cached in
+ * priv->externally_modified and announced with "externally-modified".
+ * In follow mode, reads what was appended to the file instead. */
+static void
+queue_external_check (PlumaDocument *doc)
+{
+	GFile *gfile;
+
+	if (doc->priv->monitor_cancellable == NULL ||
+	    doc->priv->uri == NULL)
+	{
+		return;
+	}
+
+	/* run again once the current check is over */
+	if (doc->priv->check_pending)
+	{
+		doc->priv->recheck = TRUE;
+		return;
+	}
+
+	doc->priv->check_pending = TRUE;
+
+	if (doc->priv->follow_loader != NULL)
+	{
+		pluma_gio_document_loader_append_async (PLUMA_GIO_DOCUMENT_LOADER (doc->priv->follow_loader),
+							doc->priv->monitor_cancellable,
+							(GAsyncReadyCallback) follow_append_ready_cb,
+							doc);
+		return;
+	}
+
+	gfile = g_file_new_for_uri (doc->priv->uri);
+	g_file_query_info_async (gfile,
+				 G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+				 G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+				 G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE,
+				 G_FILE_QUERY_INFO_NONE,
+				 G_PRIORITY_LOW,
+				 doc->priv->monitor_cancellable,
+				 (GAsyncReadyCallback) check_info_ready_cb,
+				 doc);
+	g_object_unref (gfile);
+}
+
+static void
+monitor_changed_cb (GFileMonitor      *monitor,
+		    GFile             *file,
+		    GFile             *other_file,
+		    GFileMonitorEvent  event_type,
+		    PlumaDocument     *doc)
+{
+	switch (event_type)
+	{
+		/* files being followed are usually kept open by the
+		 * writer, do not wait for it to close them; neither
+		 * when a paged file may be getting truncated */
+		case G_FILE_MONITOR_EVENT_CHANGED:
+			if (doc->priv->follow_loader != NULL ||
+			    doc->priv->paged != NULL)
+				queue_external_check (doc);
+			break;
+		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+		case G_FILE_MONITOR_EVENT_CREATED:
+			queue_external_check (doc);
+			break;
+		default:
+			break;
+	}
+}
+
+static gboolean
+poll_timeout (PlumaDocument *doc)
+{
+	queue_external_check (doc);
+
+	return TRUE;
+}
+
+static void
+filesystem_info_ready_cb (GFile         *gfile,
+			  GAsyncResult  *res,
+			  PlumaDocument *doc)
+{
+	GFileInfo *info;
+	GError *error = NULL;
+	gboolean remote = FALSE;
+
+	info = g_file_query_filesystem_info_finish (gfile, res, &error);
+
+	if (error != NULL)
+	{
+		gboolean cancelled;
+
+		cancelled = g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+		g_error_free (error);
+
+		/* the document may be gone already */
+		if (cancelled)
+			return;
+	}
+
+	if (info != NULL)
+	{
+		remote = g_file_info_get_attribute_boolean (info,
+							    G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE);
+		g_object_unref (info);
+	}
+
+	/* changes made by other hosts on network file systems do not
+	 * reach the local monitor */
+	if (!remote)
+	{
+		doc->priv->monitor = g_file_monitor_file (gfile,
+							  G_FILE_MONITOR_NONE,
+							  doc->priv->monitor_cancellable,
+							  NULL);
+	}
+
+	if (doc->priv->monitor != NULL)
+	{
+		g_signal_connect (doc->priv->monitor,
+				  "changed",
+				  G_CALLBACK (monitor_changed_cb),
+				  doc);
+	}
+	else
+	{
+		pluma_debug_message (DEBUG_DOCUMENT,
+				     "Polling %s for external changes", doc->priv->uri);
+
+		doc->priv->poll_id =
+			g_timeout_add_seconds (EXTERNAL_CHECK_POLL_INTERVAL,
+					       (GSourceFunc) poll_timeout,
+					       doc);
+	}
+
+	/* catch up with anything that happened before we were watching */
+	queue_external_check (doc);
+}
+
+static void
+stop_monitoring (PlumaDocument *doc)
+{
+	if (doc->priv->monitor_cancellable != NULL)
+	{
+		g_cancellable_cancel (doc->priv->monitor_cancellable);
+		g_object_unref (doc->priv->monitor_cancellable);
+		doc->priv->monitor_cancellable = NULL;
+	}
+
+	if (doc->priv->monitor != NULL)
+	{
+		g_signal_handlers_disconnect_by_func (doc->priv->monitor,
+						      monitor_changed_cb,
+						      doc);
+		g_file_monitor_cancel (doc->priv->monitor);
+		g_object_unref (doc->priv->monitor);
+		doc->priv->monitor = NULL;
+	}
+
+	if (doc->priv->poll_id != 0)
+	{
+		g_source_remove (doc->priv->poll_id);
+		doc->priv->poll_id = 0;
+	}
+
+	stop_following (doc);
+
+	doc->priv->check_pending = FALSE;
+	doc->priv->recheck = FALSE;
+}
+
+static void
+start_monitoring (PlumaDocument *doc)
+{
+	GFile *gfile;
+
+	stop_monitoring (doc);
+
+	doc->priv->externally_modified = FALSE;
+
+	/* we only track local files, like the focus-in check always did */
+	if (doc->priv->dispose_has_run || !pluma_document_is_local (doc))
+		return;
+
+	doc->priv->monitor_cancellable = g_cancellable_new ();
+
+	/* finding out the file system type may block on network mounts */
+	gfile = g_file_new_for_uri (doc->priv->uri);
+	g_file_query_filesystem_info_async (gfile,
+					    G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE,
+					    G_PRIORITY_LOW,
+					    doc->priv->monitor_cancellable,
+					    (GAsyncReadyCallback) filesystem_info_ready_cb,
+					    doc);
+	g_object_unref (gfile);
+}
+
+/*
+ * Returns the cached result of the last external modification check, so it
+ * never blocks. When the file is being polled rather than monitored a new
+ * check is started, and "externally-modified" is emitted if it finds a
+ * change.
+ */
+gboolean
+_pluma_document_check_externally_modified (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+
+	if (doc->priv->uri == NULL)
+	{
+		return FALSE;
+	}
+
+	if (doc->priv->poll_id != 0)
+	{
+		queue_external_check (doc);
+	}
+
+	return doc->priv->externally_modified;
+}
+
+typedef struct
+{
+	gchar               *uri;
+	const PlumaEncoding *encoding;
+	PlumaDocumentCompressionType compression_type;
+	gchar               *old_text;
+	guint                stamp;
+
+	/* Filled in by the worker thread */
+	GPtrArray           *hunks;
+	GTimeVal             mtime;
+	gboolean             read_only;
+} ReloadData;
+
+static void
+reload_data_free (ReloadData *data)
+{
+	g_free (data->uri);
+	g_free (data->old_text);
+
+	if (data->hunks != NULL)
+		g_ptr_array_free (data->hunks, TRUE);
+
+	g_slice_free (ReloadData, data);
+}
+
+#define UTF8_BOM		"\xef\xbb\xbf"
+#define UTF8_BOM_LENGTH		3
+
+/* Same as PlumaDocumentOutputStream, which drops the last line terminator */
+static gsize
+strip_ending_newline (const gchar *text,
+		      gsize        len)
+{
+	if (len >= 2 && text[len - 2] == '\r' && text[len - 1] == '\n')
+		return len - 2;
+
+	if (len >= 1 && (text[len - 1] == '\n' || text[len - 1] == '\r'))
+		return len - 1;
+
+	return len;
+}
+
+static gchar *
+decompress_contents (PlumaDocumentCompressionType   compression_type,
+		     const gchar                   *contents,
+		     gsize                          len,
+		     gsize                         *decompressed_len,
+		     GCancellable                  *cancellable,
+		     GError                       **error)
+{
+	GInputStream *memory;
+	GInputStream *stream;
+	GConverter *decompressor;
+	GString *decompressed;
+	gchar buffer[8192];
+	gssize read;
+
+	memory = g_memory_input_stream_new_from_data (contents, len, NULL);
+	decompressor = pluma_compression_new_decompressor (compression_type);
+	stream = g_converter_input_stream_new (memory, decompressor);
+	g_object_unref (decompressor);
+	g_object_unref (memory);
+
+	decompressed = g_string_sized_new (len * 4);
+
+	while ((read = g_input_stream_read (stream, buffer, sizeof (buffer),
+					    cancellable, error)) > 0)
+	{
+		g_string_append_len (decompressed, buffer, read);
+	}
+
+	g_object_unref (stream);
+
+	if (read < 0)
+	{
+		g_string_free (decompressed, TRUE);
+		return NULL;
+	}
+
+	*decompressed_len = decompressed->len;
+
+	return g_string_free (decompressed, FALSE);
+}
+
+static void
+reload_thread (GTask        *task,
+	       gpointer      source_object,
+	       ReloadData   *data,
+	       GCancellable *cancellable)
+{
+	GFile *gfile;
+	GFileInfo *info;
+	gchar *contents;
+	const gchar *text;
+	gsize len;
+	GError *error = NULL;
+
+	gfile = g_file_new_for_uri (data->uri);
+
+	/* stat before reading: if the file changes in between we
+	 * will simply notice it again */
+	info = g_file_query_info (gfile,
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+				  G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE,
+				  G_FILE_QUERY_INFO_NONE,
+				  cancellable,
+				  &error);
+
+	if (info == NULL)
+	{
+		g_object_unref (gfile);
+		g_task_return_error (task, error);
+		return;
+	}
+
+	g_file_info_get_modification_time (info, &data->mtime);
+
+	if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE))
+		data->read_only = !g_file_info_get_attribute_boolean (info,
+								      G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE);
+
+	g_object_unref (info);
+
+	if (!g_file_load_contents (gfile, cancellable, &contents, &len, NULL, &error))
+	{
+		g_object_unref (gfile);
+		g_task_return_error (task, error);
+		return;
+	}
+
+	g_object_unref (gfile);
+
+	/* a file which got compressed or decompressed is loaded again */
+	if (pluma_compression_detect (contents, len) != data->compression_type)
+	{
+		g_free (contents);
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+					 "The compression of the file changed");
+		return;
+	}
+
+	if (data->compression_type != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+	{
+		gchar *decompressed;
+		gsize decompressed_len;
+
+		decompressed = decompress_contents (data->compression_type,
+						    contents, len,
+						    &decompressed_len,
+						    cancellable, &error);
+		g_free (contents);
+
+		if (decompressed == NULL)
+		{
+			g_task_return_error (task, error);
+			return;
+		}
+
+		contents = decompressed;
+		len = decompressed_len;
+	}
+
+	if (data->encoding != pluma_encoding_get_utf8 ())
+	{
+		gchar *converted;
+		gsize converted_len;
+
+		converted = g_convert (contents, len,
+				       "UTF-8",
+				       pluma_encoding_get_charset (data->encoding),
+				       NULL, &converted_len, &error);
+		g_free (contents);
+
+		if (converted == NULL)
+		{
+			g_task_return_error (task, error);
+			return;
+		}
+
+		contents = converted;
+		len = converted_len;
+	}
+
+	/* a full load knows how to deal with invalid text, we do not */
+	if (!g_utf8_validate (contents, len, NULL))
+	{
+		g_free (contents);
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+					 _("Invalid UTF-8 sequence in input"));
+		return;
+	}
+
+	/* a byte order mark the buffer does not have is not new text, it
+	 * would come in as a change of the first line */
+	text = contents;
+
+	if (len >= UTF8_BOM_LENGTH &&
+	    memcmp (contents, UTF8_BOM, UTF8_BOM_LENGTH) == 0 &&
+	    !g_str_has_prefix (data->old_text, UTF8_BOM))
+	{
+		text += UTF8_BOM_LENGTH;
+		len -= UTF8_BOM_LENGTH;
+	}
+
+	data->hunks = pluma_line_diff (data->old_text, -1,
+				       text, strip_ending_newline (text, len),
+				       RELOAD_MAX_EDITS);
+
+	g_free (contents);
+
+	g_task_return_boolean (task, TRUE);
+}
+
+/* Where a position ends up once the hunks are applied: moved by the size
+ * change of the hunks before it, or kept inside the hunk it was in */
+static gint
+map_offset_through_hunks (GPtrArray *hunks,
+			  gint       offset)
+{
+	gint delta = 0;
+	guint i;
+
+	for (i = 0; i < hunks->len; i++)
+	{
+		PlumaLineDiffHunk *hunk = g_ptr_array_index (hunks, i);
+		gint new_length;
+
+		if (hunk->old_offset > offset)
+			break;
+
+		new_length = g_utf8_strlen (hunk->new_text, -1);
+
+		if (offset < hunk->old_offset + hunk->old_length)
+		{
+			return hunk->old_offset + delta +
+			       MIN (offset - hunk->old_offset, new_length);
+		}
+
+		delta += new_length - hunk->old_length;
+	}
+
+	return offset + delta;
+}
+
+static void
+apply_reload (PlumaDocument *doc,
+	      ReloadData    *data)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (doc);
+	GtkTextIter insert;
+	GtkTextIter selection_bound;
+	gint insert_offset;
+	gint bound_offset;
+	gint i;
+
+	gtk_text_buffer_get_iter_at_mark (buffer, &insert,
+					  gtk_text_buffer_get_insert (buffer));
+	gtk_text_buffer_get_iter_at_mark (buffer, &selection_bound,
+					  gtk_text_buffer_get_selection_bound (buffer));
+
+	insert_offset = map_offset_through_hunks (data->hunks,
+						  gtk_text_iter_get_offset (&insert));
+	bound_offset = map_offset_through_hunks (data->hunks,
+						 gtk_text_iter_get_offset (&selection_bound));
+
+	/* one undoable step, applied from the end so that the offsets
+	 * of the remaining hunks stay valid */
+	gtk_text_buffer_begin_user_action (buffer);
+
+	for (i = data->hunks->len - 1; i >= 0; i--)
+	{
+		PlumaLineDiffHunk *hunk = g_ptr_array_index (data->hunks, i);
+		GtkTextIter start;
+		GtkTextIter end;
+
+		gtk_text_buffer_get_iter_at_offset (buffer, &start, hunk->old_offset);
+
+		if (hunk->old_length > 0)
+		{
+			end = start;
+			gtk_text_iter_forward_chars (&end, hunk->old_length);
+			gtk_text_buffer_delete (buffer, &start, &end);
+		}
+
+		if (*hunk->new_text != '\0')
+			gtk_text_buffer_insert (buffer, &start, hunk->new_text, -1);
+	}
+
+	gtk_text_buffer_end_user_action (buffer);
+
+	gtk_text_buffer_get_iter_at_offset (buffer, &insert, insert_offset);
+	gtk_text_buffer_get_iter_at_offset (buffer, &selection_bound, bound_offset);
+	gtk_text_buffer_select_range (buffer, &insert, &selection_bound);
+
+	doc->priv->mtime = data->mtime;
+	g_get_current_time (&doc->priv->time_of_last_save_or_load);
+
+	_pluma_document_set_readonly (doc, data->read_only);
+
+	gtk_text_buffer_set_modified (buffer, FALSE);
+
+	clear_dirty_lines (doc);
+
+	doc->priv->externally_modified = FALSE;
+}
+
+static void
+reload_ready_cb (PlumaDocument *doc,
+		 GAsyncResult  *res,
+		 GTask         *task)
+{
+	ReloadData *data;
+	GError *error = NULL;
+
+	data = g_task_get_task_data (G_TASK (res));
+
+	if (!g_task_propagate_boolean (G_TASK (res), &error))
+	{
+		g_task_return_error (task, error);
+	}
+	else if (doc->priv->content_stamp != data->stamp ||
+		 doc->priv->loader != NULL ||
+		 doc->priv->saver != NULL)
+	{
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_BUSY,
+					 "The document changed while reloading");
+	}
+	else
+	{
+		pluma_debug_message (DEBUG_DOCUMENT,
+				     "Reloading %s: %u changed blocks",
+				     doc->priv->uri, data->hunks->len);
+
+		apply_reload (doc, data);
+
+		g_task_return_boolean (task, TRUE);
+	}
+
+	g_object_unref (task);
+}
+
+/*
+ * Brings the document in line with its file by reading it again and
+ * applying only the changed lines, as a single undoable action. Unlike
+ * pluma_document_load() this keeps the undo history, the marks and the
+ * highlighting of the unchanged text. Reading and comparing happen in a
+ * worker thread. When the new content cannot be handled this way (it
+ * fails to convert, or the buffer was edited meanwhile) the operation
+ * fails, and the caller should fall back to a full load. So does it for
+ * paged documents, whose file is too big to be read in memory.
+ */
+void
+_pluma_document_reload_async (PlumaDocument       *doc,
+			      GCancellable        *cancellable,
+			      GAsyncReadyCallback  callback,
+			      gpointer             user_data)
+{
+	GTask *task;
+	GTask *thread_task;
+	ReloadData *data;
+	GtkTextIter start;
+	GtkTextIter end;
+
+	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
+	g_return_if_fail (doc->priv->uri != NULL);
+
+	pluma_debug (DEBUG_DOCUMENT);
+
+	task = g_task_new (doc, cancellable, callback, user_data);
+
+	if (doc->priv->paged != NULL)
+	{
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+					 "Paged documents cannot be reloaded incrementally");
+		g_object_unref (task);
+		return;
+	}
+
+	data = g_slice_new0 (ReloadData);
+	data->uri = g_strdup (doc->priv->uri);
+	data->encoding = doc->priv->encoding;
+	data->compression_type = doc->priv->compression_type;
+	data->stamp = doc->priv->content_stamp;
+
+	gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (doc), &start, &end);
+	/* the slice keeps one char per embedded object, so that the
+	 * offsets computed from it match the buffer */
+	data->old_text = gtk_text_buffer_get_slice (GTK_TEXT_BUFFER (doc),
+						    &start, &end, TRUE);
+
+	thread_task = g_task_new (doc, cancellable,
+				  (GAsyncReadyCallback) reload_ready_cb,
+				  task);
+	g_task_set_task_data (thread_task, data, (GDestroyNotify) reload_data_free);
+	g_task_run_in_thread (thread_task, (GTaskThreadFunc) reload_thread);
+	g_object_unref (thread_task);
+}
+
+gboolean
+_pluma_document_reload_finish (PlumaDocument  *doc,
+			       GAsyncResult   *result,
+			       GError        **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, doc), FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/*
+ * Follow mode: text appended to the file is appended to the document as
+ * soon as the file monitor notices it, without being recorded in the undo
+ * history; the tab keeps the document read-only meanwhile, so that this
+ * does not throw away any edits. Returns FALSE if the document has to be loaded again for this
+ * to work, since only a loader which read the whole file knows where to
+ * continue from.
+ */
+gboolean
+_pluma_document_set_follow (PlumaDocument *doc,
+			    gboolean       follow)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+
+	doc->priv->follow = (follow != FALSE);
+
+	if (!follow)
+	{
+		stop_following (doc);
+		return TRUE;
+	}
+
+	if (doc->priv->follow_loader == NULL)
+		return FALSE;
+
+	/* catch up with what was appended in the meantime */
+	queue_external_check (doc);
+
+	return TRUE;
+}
+
+gboolean
+_pluma_document_get_follow (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+
+	return doc->priv->follow;
+}
+
+static void
+reset_temp_loading_data (PlumaDocument       *doc)
+{
+	/* the loader has been used, throw it away */
+	g_object_unref (doc->priv->loader);
+	doc->priv->loader = NULL;
+
+	doc->priv->requested_encoding = NULL;
+	doc->priv->requested_line_pos = 0;
+
+	/* a later reload is something the user asked for */
+	doc->priv->load_priority = G_PRIORITY_HIGH;
+	doc->priv->load_paused = FALSE;
+}
+
+static void
+set_large_file_profile (PlumaDocument *doc,
+			gboolean       large_file)
+{
+	if ((doc->priv->large_file != FALSE) == (large_file != FALSE))
+		return;
+
+	doc->priv->large_file = (large_file != FALSE);
+
+	pluma_document_set_disabled_features (doc,
+					      large_file ? PLUMA_DOCUMENT_FEATURES_ALL : 0);
+
+	g_object_notify (G_OBJECT (doc), "large-file-profile");
+}
+
+/* The size is known as soon as the file is opened, the number of lines
+ * only once it is read: check both while loading */
+static void
+check_large_file (PlumaDocument       *doc,
+		  PlumaDocumentLoader *loader,
+		  gboolean             completed)
+{
+	GFileInfo *info;
+	gint max_size;
+	gint max_lines;
+
+	if (doc->priv->large_file)
+		return;
+
+	max_size = pluma_prefs_manager_get_large_file_size ();
+	max_lines = pluma_prefs_manager_get_large_file_lines ();
+
+	info = pluma_document_loader_get_info (loader);
+
+	if (max_size > 0 &&
+	    info != NULL &&
+	    g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE) &&
+	    g_file_info_get_size (info) >= (goffset) max_size * 1024 * 1024)
+	{
+		pluma_debug_message (DEBUG_DOCUMENT, "Large file: %" G_GOFFSET_FORMAT " bytes",
+				     g_file_info_get_size (info));
+
+		set_large_file_profile (doc, TRUE);
+	}
+	else if (completed &&
+		 max_lines > 0 &&
+		 gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc)) >= max_lines)
+	{
+		pluma_debug_message (DEBUG_DOCUMENT, "Large file: %d lines",
+				     gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc)));
+
+		set_large_file_profile (doc, TRUE);
+	}
+}
+
+/* Retries the move to a line which was not counted yet */
+static void
+paged_index_updated (PlumaPagedFile *paged,
+		     PlumaDocument  *doc)
+{
+	gint64 line = doc->priv->paged_pending_line;
+
+	if (line < 0)
+		return;
+
+	if (doc->priv->paged_pending_line_offset < 0)
+		pluma_document_goto_line (doc, line);
+	else
+		pluma_document_goto_line_offset (doc,
+						 line,
+						 doc->priv->paged_pending_line_offset);
+
+	/* still not counted, wait for the next update */
+	if (doc->priv->paged_pending_line >= 0)
+		return;
+
+	g_signal_emit (doc, document_signals[PAGED_LINE_SHOWN], 0);
+}
+
+static void
+stop_paging (PlumaDocument *doc)
+{
+	if (doc->priv->paged_load_id != 0)
+	{
+		g_source_remove (doc->priv->paged_load_id);
+		doc->priv->paged_load_id = 0;
+	}
+
+	if (doc->priv->paged_search_cancellable != NULL)
+	{
+		g_cancellable_cancel (doc->priv->paged_search_cancellable);
+		g_object_unref (doc->priv->paged_search_cancellable);
+		doc->priv->paged_search_cancellable = NULL;
+	}
+
+	if (doc->priv->paged != NULL)
+	{
+		/* running searches keep it alive */
+		g_signal_handlers_disconnect_by_func (doc->priv->paged,
+						      paged_index_updated,
+						      doc);
+		pluma_paged_file_close (doc->priv->paged);
+
+		g_object_unref (doc->priv->paged);
+		doc->priv->paged = NULL;
+	}
+
+	doc->priv->paged_first_line = 0;
+	doc->priv->paged_start = 0;
+	doc->priv->paged_end = 0;
+	doc->priv->paged_pending_line = -1;
+}
+
+static gboolean
+is_compressed (GFile *location)
+{
+	GFileInputStream *stream;
+	gchar magic[PLUMA_COMPRESSION_MAGIC_LENGTH];
+	gsize length = 0;
+
+	stream = g_file_read (location, NULL, NULL);
+
+	if (stream == NULL)
+		return FALSE;
+
+	g_input_stream_read_all (G_INPUT_STREAM (stream), magic, sizeof (magic),
+				 &length, NULL, NULL);
+	g_object_unref (stream);
+
+	return pluma_compression_detect (magic, length) != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE;
+}
+
+/* Local files above the paged file size are not loaded, they are shown
+ * a window at a time. The text is not converted, so only uncompressed
+ * UTF-8 ones */
+static gboolean
+should_page (const gchar         *uri,
+	     const PlumaEncoding *encoding)
+{
+	GFile *location;
+	GFileInfo *info;
+	gint max_size;
+	gboolean ret = FALSE;
+
+	max_size = pluma_prefs_manager_get_paged_file_size ();
+
+	if (max_size <= 0 || !pluma_utils_uri_has_file_scheme (uri))
+		return FALSE;
+
+	if (encoding != NULL && encoding != pluma_encoding_get_utf8 ())
+		return FALSE;
+
+	location = g_file_new_for_uri (uri);
+	info = g_file_query_info (location,
+				  G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+				  G_FILE_ATTRIBUTE_STANDARD_SIZE,
+				  G_FILE_QUERY_INFO_NONE,
+				  NULL,
+				  NULL);
+
+	if (info != NULL)
+	{
+		ret = (g_file_info_get_file_type (info) == G_FILE_TYPE_REGULAR) &&
+		      (g_file_info_get_size (info) >= (goffset) max_size * 1024 * 1024) &&
+		      !is_compressed (location);
+
+		g_object_unref (info);
+	}
+
+	g_object_unref (location);
+
+	return ret;
+}
+
+/* Replaces the content of the buffer with the lines of the file from
+ * @first_line on, which starts at @start, keeping the cursor on the same
+ * line of the file. The window ends after PAGED_WINDOW_LINES lines, at
+ * the last line that fits or in the middle of a very long one */
+static void
+show_paged_window (PlumaDocument *doc,
+		   gint64         first_line,
+		   goffset        start)
+{
+	PlumaPagedFile *paged = doc->priv->paged;
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (doc);
+	GtkTextIter iter;
+	goffset size;
+	goffset end;
+	gint64 n_lines;
+	gint64 cursor_line;
+	gint cursor_offset;
+	gint line;
+	gchar *text;
+	gsize len;
+
+	pluma_debug_span_begin (DEBUG_DOCUMENT, "paged-window");
+
+	size = pluma_paged_file_get_size (paged);
+
+	n_lines = PAGED_WINDOW_LINES;
+	end = pluma_paged_file_forward_lines (paged,
+					      start,
+					      &n_lines,
+					      PAGED_WINDOW_MAX_BYTES);
+
+	text = pluma_paged_file_get_text (paged, start, end);
+	len = strlen (text);
+
+	/* the newline ending the window would show as an empty line */
+	if (end < size && len > 0 && text[len - 1] == '\n')
+		text[--len] = '\0';
+	if (end < size && len > 0 && text[len - 1] == '\r')
+		text[--len] = '\0';
+
+	gtk_text_buffer_get_iter_at_mark (buffer,
+					  &iter,
+					  gtk_text_buffer_get_insert (buffer));
+	cursor_line = doc->priv->paged_first_line + gtk_text_iter_get_line (&iter);
+	cursor_offset = gtk_text_iter_get_line_offset (&iter);
+
+	doc->priv->paged_first_line = first_line;
+	doc->priv->paged_start = start;
+	doc->priv->paged_end = end;
+
+	gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (doc));
+	gtk_text_buffer_set_text (buffer, text, len);
+	gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (doc));
+
+	g_free (text);
+
+	line = CLAMP (cursor_line - first_line,
+		      0,
+		      gtk_text_buffer_get_line_count (buffer) - 1);
+
+	gtk_text_buffer_get_iter_at_line (buffer, &iter, line);
+	if (cursor_offset < gtk_text_iter_get_chars_in_line (&iter))
+		gtk_text_iter_set_line_offset (&iter, cursor_offset);
+
+	gtk_text_buffer_place_cursor (buffer, &iter);
+
+	clear_dirty_lines (doc);
+	gtk_text_buffer_set_modified (buffer, FALSE);
+
+	pluma_debug_span_end (DEBUG_DOCUMENT, "paged-window");
+}
+
+/* Shows the lines of the file from @first_line on, or the last ones if
+ * it is past the end. Returns FALSE, without moving the window, if the
+ * lines up to @first_line were not counted yet */
+static gboolean
+set_paged_window (PlumaDocument *doc,
+		  gint64         first_line)
+{
+	PlumaPagedFile *paged = doc->priv->paged;
+	goffset start;
+
+	first_line = MAX (first_line, 0);
+	start = pluma_paged_file_get_line_offset (paged, first_line);
+
+	if (start < 0)
+	{
+		gboolean complete;
+		gint64 n_lines;
+
+		n_lines = pluma_paged_file_get_n_lines (paged, &complete);
+		if (!complete)
+			return FALSE;
+
+		/* past the end: show the last lines */
+		first_line = MAX (n_lines - PAGED_WINDOW_LINES, 0);
+		start = pluma_paged_file_get_line_offset (paged, first_line);
+	}
+
+	show_paged_window (doc, first_line, start);
+
+	return TRUE;
+}
+
+/* Moves the window if needed so that it shows @line of the file, and
+ * returns the line of the buffer it is on, or -1 if the lines up to it
+ * were not counted yet */
+static gint
+paged_ensure_line (PlumaDocument *doc,
+		   gint64         line)
+{
+	gint64 first = doc->priv->paged_first_line;
+	gint n_lines;
+
+	/* a newer move replaces the one waiting for the lines */
+	doc->priv->paged_pending_line = -1;
+
+	n_lines = gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc));
+
+	if (line < first ||
+	    (line >= first + n_lines &&
+	     doc->priv->paged_end < pluma_paged_file_get_size (doc->priv->paged)))
+	{
+		if (!set_paged_window (doc, MAX (line - PAGED_WINDOW_LINES / 4, 0)))
+			return -1;
+	}
+
+	n_lines = gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc));
+
+	return CLAMP (line - doc->priv->paged_first_line, 0, n_lines);
+}
+
+static gboolean
+paged_load_idle (PlumaDocument *doc)
+{
+	gint line;
+
+	doc->priv->paged_load_id = 0;
+
+	set_readonly (doc, TRUE);
+	set_encoding (doc, pluma_encoding_get_utf8 (), FALSE);
+	set_large_file_profile (doc, TRUE);
+
+	g_get_current_time (&doc->priv->time_of_last_save_or_load);
+
+	line = MAX (doc->priv->requested_line_pos - 1, 0);
+
+	/* the lines are just starting to be counted, the cursor moves to
+	 * @line when they get there */
+	if (!set_paged_window (doc, line - PAGED_WINDOW_LINES / 4))
+		set_paged_window (doc, 0);
+
+	pluma_document_goto_line (doc, line);
+
+	doc->priv->requested_encoding = NULL;
+	doc->priv->requested_line_pos = 0;
+
+	g_signal_emit (doc,
+		       document_signals[LOADED],
+		       0,
+		       NULL);
+
+	return FALSE;
+}
+
+/* Returns FALSE if the file has to be loaded normally */
+static gboolean
+load_paged (PlumaDocument *doc,
+	    const gchar   *uri)
+{
+	GFile *location;
+	GFileInfo *info;
+	GError *error = NULL;
+
+	location = g_file_new_for_uri (uri);
+	doc->priv->paged = pluma_paged_file_new (location, &error);
+
+	if (doc->priv->paged == NULL)
+	{
+		pluma_debug_message (DEBUG_DOCUMENT, "Cannot page the file: %s",
+				     error->message);
+
+		g_error_free (error);
+		g_object_unref (location);
+
+		return FALSE;
+	}
+
+	/* the file is local and was just mapped, this does not block. With
+	 * the mtime known set_uri() starts monitoring the file */
+	info = g_file_query_info (location,
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+				  G_FILE_QUERY_INFO_NONE,
+				  NULL,
+				  NULL);
+	g_object_unref (location);
+
+	if (info != NULL)
+	{
+		g_file_info_get_modification_time (info, &doc->priv->mtime);
+		g_object_unref (info);
+	}
+
+	pluma_debug_message (DEBUG_DOCUMENT, "Paged file: %" G_GOFFSET_FORMAT " bytes",
+			     pluma_paged_file_get_size (doc->priv->paged));
+
+	g_signal_connect (doc->priv->paged,
+			  "index-updated",
+			  G_CALLBACK (paged_index_updated),
+			  doc);
+
+	set_uri (doc, uri);
+	set_content_type (doc, NULL);
+
+	/* LOADED must not be emitted from the handler of LOAD */
+	doc->priv->paged_load_id = g_idle_add ((GSourceFunc) paged_load_idle, doc);
+
+	return TRUE;
+}
+
+/* Maps a paged file again after it got shorter. The threads reading the
+ * old mapping are cancelled, but one may still be reading between two
+ * checks of its cancellable */
+static void
+remap_paged_file (PlumaDocument *doc)
+{
+	GFile *location;
+	GError *error = NULL;
+	gint64 first_line;
+
+	pluma_debug_message (DEBUG_DOCUMENT, "%s got shorter, mapping it again",
+			     doc->priv->uri);
+
+	first_line = doc->priv->paged_first_line;
+
+	stop_paging (doc);
+
+	location = g_file_new_for_uri (doc->priv->uri);
+	doc->priv->paged = pluma_paged_file_new (location, &error);
+	g_object_unref (location);
+
+	if (doc->priv->paged == NULL)
+	{
+		pluma_debug_message (DEBUG_DOCUMENT, "Cannot page the file: %s",
+				     error->message);
+		g_error_free (error);
+
+		/* nothing left to show, the user may reload it */
+		gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (doc));
+		gtk_text_buffer_set_text (GTK_TEXT_BUFFER (doc), "", 0);
+		gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (doc));
+		gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (doc), FALSE);
+
+		return;
+	}
+
+	g_signal_connect (doc->priv->paged,
+			  "index-updated",
+			  G_CALLBACK (paged_index_updated),
+			  doc);
+
+	if (!set_paged_window (doc, first_line))
+		set_paged_window (doc, 0);
+}
+
+gboolean
+_pluma_document_is_paged (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+
+	return doc->priv->paged != NULL;
+}
+
+/* Line of the file shown on the first line of the buffer */
+gint64
+_pluma_document_get_paged_first_line (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), 0);
+
+	return doc->priv->paged_first_line;
+}
+
+/* Moves the window by half its lines. Returns FALSE if it already shows
+ * that end of the file, or if the lines before it were not counted yet */
+gboolean
+_pluma_document_shift_paged_window (PlumaDocument *doc,
+				    gboolean       forward)
+{
+	gint64 shift;
+	goffset start;
+
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+
+	if (doc->priv->paged == NULL)
+		return FALSE;
+
+	if (forward &&
+	    doc->priv->paged_end >= pluma_paged_file_get_size (doc->priv->paged))
+		return FALSE;
+
+	if (!forward && doc->priv->paged_first_line == 0)
+		return FALSE;
+
+	shift = MAX (gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc)) / 2, 1);
+
+	if (!forward)
+		return set_paged_window (doc, doc->priv->paged_first_line - shift);
+
+	/* the lines of the window are known even if they were not counted */
+	start = pluma_paged_file_forward_lines (doc->priv->paged,
+						doc->priv->paged_start,
+						&shift,
+						MAX (doc->priv->paged_end - doc->priv->paged_start, 1));
+	if (shift == 0)
+		return FALSE;
+
+	show_paged_window (doc, doc->priv->paged_first_line + shift, start);
+
+	return TRUE;
+}
+
+/* Copies the lines from @first to @last of the file, both included. The
+ * text is cut at the line before PAGED_COPY_MAX_BYTES. Returns NULL if
+ * @first was not counted yet and is not in the window */
+gchar *
+_pluma_document_get_paged_lines (PlumaDocument *doc,
+				 gint64         first,
+				 gint64         last)
+{
+	PlumaPagedFile *paged;
+	goffset start;
+	goffset end;
+	gint64 n_lines;
+
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), NULL);
+	g_return_val_if_fail (doc->priv->paged != NULL, NULL);
+	g_return_val_if_fail (first <= last, NULL);
+
+	paged = doc->priv->paged;
+
+	start = pluma_paged_file_get_line_offset (paged, first);
+
+	if (start < 0 && first >= doc->priv->paged_first_line)
+	{
+		n_lines = first - doc->priv->paged_first_line;
+		start = pluma_paged_file_forward_lines (paged,
+							doc->priv->paged_start,
+							&n_lines,
+							MAX (doc->priv->paged_end - doc->priv->paged_start, 1));
+
+		if (n_lines != first - doc->priv->paged_first_line)
+			return NULL;
+	}
+
+	if (start < 0)
+		return NULL;
+
+	n_lines = last - first + 1;
+	end = pluma_paged_file_forward_lines (paged, start, &n_lines, PAGED_COPY_MAX_BYTES);
+
+	return pluma_paged_file_get_text (paged, start, end);
+}
+
+static void
+paged_search_ready (PlumaPagedFile *paged,
+		    GAsyncResult   *result,
+		    GTask          *task)
+{
+	PlumaDocument *doc;
+	GtkTextBuffer *buffer;
+	GtkTextIter start;
+	GtkTextIter end;
+	GError *error = NULL;
+	goffset found;
+	goffset line_start;
+	gint64 line;
+	gint buffer_line;
+	gchar *text;
+	gint len;
+
+	doc = g_task_get_source_object (task);
+	buffer = GTK_TEXT_BUFFER (doc);
+
+	found = pluma_paged_file_search_finish (paged, result, &line, &line_start, &error);
+
+	if (error != NULL)
+	{
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	if (found < 0 || doc->priv->paged != paged)
+	{
+		g_task_return_boolean (task, FALSE);
+		g_object_unref (task);
+		return;
+	}
+
+	/* the match may be past the counted lines: the search found where
+	 * its line starts, show the window from there */
+	buffer_line = paged_ensure_line (doc, line);
+	if (buffer_line < 0)
 	{
-		g_object_notify (G_OBJECT (doc), "read-only");
+		show_paged_window (doc, line, line_start);
+		buffer_line = 0;
 	}
-}
 
-gboolean
-pluma_document_get_readonly (PlumaDocument *doc)
-{
-	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), TRUE);
+	gtk_text_buffer_get_iter_at_line (buffer, &start, buffer_line);
 
-	return doc->priv->readonly;
+	/* the text is what the buffer shows, so the characters can be
+	 * counted on it */
+	text = pluma_paged_file_get_text (paged, line_start, found);
+	gtk_text_iter_forward_chars (&start, g_utf8_strlen (text, -1));
+	g_free (text);
+
+	len = strlen (g_task_get_task_data (task));
+	text = pluma_paged_file_get_text (paged, found, found + len);
+	end = start;
+	gtk_text_iter_forward_chars (&end, g_utf8_strlen (text, -1));
+	g_free (text);
+
+	gtk_text_buffer_select_range (buffer, &start, &end);
+
+	g_task_return_boolean (task, TRUE);
+	g_object_unref (task);
 }
 
-gboolean
-_pluma_document_check_externally_modified (PlumaDocument *doc)
+/* Looks for the search text in the part of the file after the window, or
+ * before it if @backward. Only literal text is looked for */
+void
+_pluma_document_search_paged_async (PlumaDocument       *doc,
+				    gboolean             backward,
+				    gboolean             wrap_around,
+				    GAsyncReadyCallback  callback,
+				    gpointer             user_data)
 {
-	GFile *gfile;
-	GFileInfo *info;
+	GTask *task;
 
-	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
+	g_return_if_fail (doc->priv->paged != NULL);
 
-	if (doc->priv->uri == NULL)
+	if (doc->priv->paged_search_cancellable != NULL)
 	{
-		return FALSE;
+		g_cancellable_cancel (doc->priv->paged_search_cancellable);
+		g_object_unref (doc->priv->paged_search_cancellable);
 	}
 
-	gfile = g_file_new_for_uri (doc->priv->uri);
-	info = g_file_query_info (gfile,
-				  G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
-				  G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE,
-				  G_FILE_QUERY_INFO_NONE,
-				  NULL, NULL);
-	g_object_unref (gfile);
-
-	if (info != NULL)
-	{
-		/* While at it also check if permissions changed */
-		if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE))
-		{
-			gboolean read_only;
-
-			read_only = !g_file_info_get_attribute_boolean (info,
-									G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE);
-
-			_pluma_document_set_readonly (doc, read_only);
-		}
+	doc->priv->paged_search_cancellable = g_cancellable_new ();
 
-		if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
-		{
-			GTimeVal timeval;
+	task = g_task_new (doc, doc->priv->paged_search_cancellable, callback, user_data);
 
-			g_file_info_get_modification_time (info, &timeval);
-			g_object_unref (info);
-	
-			return (timeval.tv_sec > doc->priv->mtime.tv_sec) ||
-			       (timeval.tv_sec == doc->priv->mtime.tv_sec && 
-			       timeval.tv_usec > doc->priv->mtime.tv_usec);
-		}
+	if (doc->priv->search_text == NULL || *doc->priv->search_text == '\0')
+	{
+		g_task_return_boolean (task, FALSE);
+		g_object_unref (task);
+		return;
 	}
 
-	return FALSE;
+	g_task_set_task_data (task, g_strdup (doc->priv->search_text), g_free);
+
+	pluma_paged_file_search_async (doc->priv->paged,
+				       doc->priv->search_text,
+				       PLUMA_SEARCH_IS_CASE_SENSITIVE (doc->priv->search_flags),
+				       backward ? doc->priv->paged_start : doc->priv->paged_end,
+				       backward,
+				       wrap_around,
+				       doc->priv->paged_search_cancellable,
+				       (GAsyncReadyCallback) paged_search_ready,
+				       task);
 }
 
-static void
-reset_temp_loading_data (PlumaDocument       *doc)
+gboolean
+_pluma_document_search_paged_finish (PlumaDocument  *doc,
+				     GAsyncResult   *result,
+				     GError        **error)
 {
-	/* the loader has been used, throw it away */
-	g_object_unref (doc->priv->loader);
-	doc->priv->loader = NULL;
+	g_return_val_if_fail (g_task_is_valid (result, doc), FALSE);
 
-	doc->priv->requested_encoding = NULL;
-	doc->priv->requested_line_pos = 0;
+	return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 static void
@@ -1266,6 +3257,8 @@ document_loader_loaded (PlumaDocumentLoader *loader,
 			const GError        *error,
 			PlumaDocument       *doc)
 {
+	pluma_debug_async_span_end (DEBUG_LOADER, "load", doc);
+
 	/* load was successful */
 	if (error == NULL ||
 	    (error->domain == PLUMA_DOCUMENT_ERROR &&
@@ -1297,12 +3290,34 @@ document_loader_loaded (PlumaDocumentLoader *loader,
 
 		set_readonly (doc, read_only);
 
+		check_large_file (doc, loader, TRUE);
+
+		clear_dirty_lines (doc);
+
+		start_monitoring (doc);
+
+		pluma_document_set_compression_type (doc,
+						     pluma_document_loader_get_compression_type (loader));
+
+		/* keep the loader to read what gets appended to the file,
+		 * a compressed one has to be read again from the start */
+		if (doc->priv->follow && PLUMA_IS_GIO_DOCUMENT_LOADER (loader) &&
+		    doc->priv->compression_type == PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+		{
+			doc->priv->follow_loader = g_object_ref (loader);
+		}
+
 		g_get_current_time (&doc->priv->time_of_last_save_or_load);
 
 		set_encoding (doc, 
 			      pluma_document_loader_get_encoding (loader),
 			      (doc->priv->requested_encoding != NULL));
 
+		/* the content type of the file is the one of the
+		 * compression, guess the one of the text from the name */
+		if (doc->priv->compression_type != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+			content_type = NULL;
+
 		set_content_type (doc, content_type);
 
 		pluma_document_set_newline_type (doc,
@@ -1397,6 +3412,8 @@ document_loader_loading (PlumaDocumentLoader *loader,
 
 		read = pluma_document_loader_get_bytes_read (loader);
 
+		check_large_file (doc, loader, FALSE);
+
 		g_signal_emit (doc, 
 			       document_signals[LOADING],
 			       0,
@@ -1416,6 +3433,15 @@ pluma_document_load_real (PlumaDocument       *doc,
 
 	pluma_debug_message (DEBUG_DOCUMENT, "load_real: uri = %s", uri);
 
+	stop_paging (doc);
+
+	doc->priv->create = create;
+	doc->priv->requested_encoding = encoding;
+	doc->priv->requested_line_pos = line_pos;
+
+	if (should_page (uri, encoding) && load_paged (doc, uri))
+		return;
+
 	/* create a loader. It will be destroyed when loading is completed */
 	doc->priv->loader = pluma_document_loader_new (doc, uri, encoding);
 
@@ -1424,13 +3450,20 @@ pluma_document_load_real (PlumaDocument       *doc,
 			  G_CALLBACK (document_loader_loading),
 			  doc);
 
-	doc->priv->create = create;
-	doc->priv->requested_encoding = encoding;
-	doc->priv->requested_line_pos = line_pos;
+	pluma_document_loader_set_priority (doc->priv->loader,
+					    doc->priv->load_priority);
+	pluma_document_loader_set_paused (doc->priv->loader,
+					  doc->priv->load_paused);
+
+	/* keep the features chosen by the user when reverting */
+	if (doc->priv->uri == NULL || strcmp (doc->priv->uri, uri) != 0)
+		set_large_file_profile (doc, FALSE);
 
 	set_uri (doc, uri);
 	set_content_type (doc, NULL);
 
+	pluma_debug_async_span_begin (DEBUG_LOADER, "load", doc);
+
 	pluma_document_loader_load (doc->priv->loader);
 }
 
@@ -1475,6 +3508,28 @@ pluma_document_load_cancel (PlumaDocument *doc)
 	return pluma_document_loader_cancel (doc->priv->loader);
 }
 
+/*
+ * Priority of the reads of the current or of the next load, and whether
+ * they are paused: used by the window to make the visible document load
+ * first and to keep the others out of the way while the user types.
+ */
+void
+_pluma_document_set_load_priority (PlumaDocument *doc,
+				   gint           io_priority,
+				   gboolean       paused)
+{
+	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
+
+	doc->priv->load_priority = io_priority;
+	doc->priv->load_paused = (paused != FALSE);
+
+	if (doc->priv->loader == NULL)
+		return;
+
+	pluma_document_loader_set_priority (doc->priv->loader, io_priority);
+	pluma_document_loader_set_paused (doc->priv->loader, paused);
+}
+
 static void
 document_saver_saving (PlumaDocumentSaver *saver,
 		       gboolean            completed,
@@ -1485,6 +3540,8 @@ document_saver_saving (PlumaDocumentSaver *saver,
 
 	if (completed)
 	{
+		pluma_debug_async_span_end (DEBUG_SAVER, "save", doc);
+
 		/* save was successful */
 		if (error == NULL)
 		{
@@ -1493,6 +3550,8 @@ document_saver_saving (PlumaDocumentSaver *saver,
 			GTimeVal mtime = {0, 0};
 			GFileInfo *info;
 
+			pluma_document_set_compression_type (doc, saver->compression_type);
+
 			uri = pluma_document_saver_get_uri (saver);
 			set_uri (doc, uri);
 
@@ -1508,6 +3567,10 @@ document_saver_saving (PlumaDocumentSaver *saver,
 					g_file_info_get_modification_time (info, &mtime);
 			}
 
+			/* as when loading, the type of the text is in the name */
+			if (doc->priv->compression_type != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+				content_type = NULL;
+
 			set_content_type (doc, content_type);
 			doc->priv->mtime = mtime;
 
@@ -1518,6 +3581,13 @@ document_saver_saving (PlumaDocumentSaver *saver,
 			gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (doc),
 						      FALSE);
 
+			clear_dirty_lines (doc);
+
+			/* the file now has our content, stop following it */
+			doc->priv->follow = FALSE;
+
+			start_monitoring (doc);
+
 			set_encoding (doc, 
 				      doc->priv->requested_encoding, 
 				      TRUE);
@@ -1556,11 +3626,31 @@ pluma_document_save_real (PlumaDocument          *doc,
 			  const PlumaEncoding    *encoding,
 			  PlumaDocumentSaveFlags  flags)
 {
+	PlumaDocumentCompressionType compression_type;
+
 	g_return_if_fail (doc->priv->saver == NULL);
 
+	compression_type = doc->priv->compression_type;
+
+	/* saving as another file, its name tells how to compress it */
+	if (doc->priv->uri == NULL || strcmp (uri, doc->priv->uri) != 0)
+	{
+		GFile *file;
+		gchar *basename;
+
+		file = g_file_new_for_uri (uri);
+		basename = g_file_get_basename (file);
+
+		compression_type = pluma_compression_for_filename (basename);
+
+		g_free (basename);
+		g_object_unref (file);
+	}
+
 	/* create a saver, it will be destroyed once saving is complete */
 	doc->priv->saver = pluma_document_saver_new (doc, uri, encoding,
 						     doc->priv->newline_type,
+						     compression_type,
 						     flags);
 
 	g_signal_connect (doc->priv->saver,
@@ -1570,6 +3660,8 @@ pluma_document_save_real (PlumaDocument          *doc,
 
 	doc->priv->requested_encoding = encoding;
 
+	pluma_debug_async_span_begin (DEBUG_SAVER, "save", doc);
+
 	pluma_document_saver_save (doc->priv->saver,
 				   &doc->priv->mtime);
 }
@@ -1683,7 +3775,8 @@ pluma_document_get_deleted (PlumaDocument *doc)
 
 /*
  * If @line is bigger than the lines of the document, the cursor is moved
- * to the last line and FALSE is returned.
+ * to the last line and FALSE is returned. For paged documents @line is
+ * a line of the file.
  */
 gboolean
 pluma_document_goto_line (PlumaDocument *doc, 
@@ -1698,6 +3791,22 @@ pluma_document_goto_line (PlumaDocument *doc,
 	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
 	g_return_val_if_fail (line >= -1, FALSE);
 
+	if (doc->priv->paged != NULL && line >= 0)
+	{
+		gint64 file_line = line;
+
+		line = paged_ensure_line (doc, file_line);
+
+		/* moved to when the lines get counted */
+		if (line < 0)
+		{
+			doc->priv->paged_pending_line = file_line;
+			doc->priv->paged_pending_line_offset = -1;
+
+			return TRUE;
+		}
+	}
+
 	line_count = gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc));
 
 	if (line >= line_count)
@@ -1730,6 +3839,22 @@ pluma_document_goto_line_offset (PlumaDocument *doc,
 	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
 	g_return_val_if_fail (line >= -1, FALSE);
 	g_return_val_if_fail (line_offset >= -1, FALSE);
+
+	if (doc->priv->paged != NULL && line >= 0)
+	{
+		gint64 file_line = line;
+
+		line = paged_ensure_line (doc, file_line);
+
+		/* moved to when the lines get counted */
+		if (line < 0)
+		{
+			doc->priv->paged_pending_line = file_line;
+			doc->priv->paged_pending_line_offset = MAX (line_offset, 0);
+
+			return TRUE;
+		}
+	}
 	
 	gtk_text_buffer_get_iter_at_line (GTK_TEXT_BUFFER (doc),
 					  &iter,
@@ -2084,6 +4209,8 @@ pluma_document_replace_all (PlumaDocument       *doc,
 
 	replace_text = pluma_utils_unescape_search_text (replace);
 
+	pluma_debug_span_begin (DEBUG_SEARCH, "replace-all");
+
 	gtk_text_buffer_get_start_iter (buffer, &iter);
 
 	search_flags = GTK_TEXT_SEARCH_VISIBLE_ONLY | GTK_TEXT_SEARCH_TEXT_ONLY;
@@ -2177,6 +4304,8 @@ pluma_document_replace_all (PlumaDocument       *doc,
 	g_free (search_text);
 	g_free (replace_text);
 
+	pluma_debug_span_end (DEBUG_SEARCH, "replace-all");
+
 	return cont;
 }
 
@@ -2446,6 +4575,93 @@ search_region (PlumaDocument *doc,
 	} while (found);
 }
 
+static void
+clear_dirty_lines (PlumaDocument *doc)
+{
+	pluma_text_region_destroy (doc->priv->dirty_region, TRUE);
+	doc->priv->dirty_region = pluma_text_region_new (GTK_TEXT_BUFFER (doc));
+}
+
+static void
+add_dirty_lines (PlumaDocument     *doc,
+		 const GtkTextIter *start,
+		 const GtkTextIter *end)
+{
+	GtkTextIter d_start = *start;
+	GtkTextIter d_end = *end;
+
+	/* Make the ranges span whole lines, ending at the start of the next
+	 * line, so that consecutive dirty lines are merged in one subregion */
+	gtk_text_iter_set_line_offset (&d_start, 0);
+	gtk_text_iter_forward_line (&d_end);
+
+	pluma_text_region_add (doc->priv->dirty_region, &d_start, &d_end);
+}
+
+/**
+ * pluma_document_get_dirty_lines:
+ * @doc: a #PlumaDocument
+ * @n_values: (out): return location for the length of the returned array
+ *
+ * Gets the lines modified since @doc was last loaded or saved, e.g. so
+ * that a handler of the #PlumaDocument::save signal only needs to look
+ * at the lines that were edited. The lines are returned as pairs of
+ * first and last line numbers (both included), in increasing order.
+ *
+ * Returns: (array length=n_values) (transfer full): the dirty line
+ * ranges, free with g_free()
+ */
+gint *
+pluma_document_get_dirty_lines (PlumaDocument *doc,
+				guint         *n_values)
+{
+	GArray *lines;
+	PlumaTextRegionIterator iter;
+
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), NULL);
+	g_return_val_if_fail (n_values != NULL, NULL);
+
+	lines = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	pluma_text_region_get_iterator (doc->priv->dirty_region, &iter, 0);
+
+	while (!pluma_text_region_iterator_is_end (&iter))
+	{
+		GtkTextIter start;
+		GtkTextIter end;
+		gint first;
+		gint last;
+
+		pluma_text_region_iterator_get_subregion (&iter, &start, &end);
+
+		first = gtk_text_iter_get_line (&start);
+		last = gtk_text_iter_get_line (&end);
+
+		if ((last > first) && gtk_text_iter_starts_line (&end))
+			--last;
+
+		/* subregions may have come together after a deletion */
+		if ((lines->len > 0) &&
+		    (first <= g_array_index (lines, gint, lines->len - 1) + 1))
+		{
+			gint *prev_last = &g_array_index (lines, gint, lines->len - 1);
+
+			*prev_last = MAX (*prev_last, last);
+		}
+		else
+		{
+			g_array_append_val (lines, first);
+			g_array_append_val (lines, last);
+		}
+
+		pluma_text_region_iterator_next (&iter);
+	}
+
+	*n_values = lines->len;
+
+	return (gint *) g_array_free (lines, FALSE);
+}
+
 static void
 to_search_region_range (PlumaDocument *doc,
 			GtkTextIter   *start, 
@@ -2520,7 +4736,9 @@ _pluma_document_search_region (PlumaDocument     *doc,
 
 		gtk_text_iter_order (&start_search, &end_search);
 
+		pluma_debug_span_begin (DEBUG_SEARCH, "search-highlight");
 		search_region (doc, &start_search, &end_search);
+		pluma_debug_span_end (DEBUG_SEARCH, "search-highlight");
 
 		/* remove the just highlighted region */
 		pluma_text_region_subtract (doc->priv->to_search_region,
@@ -2529,6 +4747,15 @@ _pluma_document_search_region (PlumaDocument     *doc,
 	}
 }
 
+static void
+set_watch_change (PlumaDocument     *doc,
+		  const GtkTextIter *start,
+		  const GtkTextIter *end)
+{
+	doc->priv->watch_change_start = gtk_text_iter_get_offset (start);
+	doc->priv->watch_change_end = gtk_text_iter_get_offset (end);
+}
+
 static void
 insert_text_cb (PlumaDocument *doc, 
 		GtkTextIter   *pos,
@@ -2550,8 +4777,15 @@ insert_text_cb (PlumaDocument *doc,
 	 */
 	gtk_text_iter_backward_chars (&start,
 				      g_utf8_strlen (text, length));
+
+	add_dirty_lines (doc, &start, &end);
+
+	doc->priv->content_stamp++;
 				     
 	to_search_region_range (doc, &start, &end);
+
+	if (doc->priv->watches != NULL)
+		set_watch_change (doc, &start, &end);
 }
 						 
 static void	
@@ -2566,8 +4800,15 @@ delete_range_cb (PlumaDocument *doc,
 		
 	d_start = *start;
 	d_end = *end;
+
+	add_dirty_lines (doc, &d_start, &d_end);
+
+	doc->priv->content_stamp++;
 	
 	to_search_region_range (doc, &d_start, &d_end);
+
+	if (doc->priv->watches != NULL)
+		set_watch_change (doc, &d_start, &d_end);
 }
 
 void
@@ -2632,6 +4873,186 @@ pluma_document_get_enable_search_highlighting (PlumaDocument *doc)
 	return (doc->priv->to_search_region != NULL);
 }
 
+/**
+ * pluma_document_set_disabled_features:
+ * @doc: a #PlumaDocument
+ * @features: the #PlumaDocumentFeatures to turn off
+ *
+ * Turns off @features for @doc, and turns the other ones back on where
+ * the preferences enable them.
+ */
+void
+pluma_document_set_disabled_features (PlumaDocument         *doc,
+				      PlumaDocumentFeatures  features)
+{
+	GtkSourceBuffer *buffer;
+	PlumaDocumentFeatures changed;
+
+	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
+
+	changed = doc->priv->disabled_features ^ features;
+
+	if (changed == 0)
+		return;
+
+	doc->priv->disabled_features = features;
+
+	buffer = GTK_SOURCE_BUFFER (doc);
+
+	if (changed & PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING)
+	{
+		gtk_source_buffer_set_highlight_syntax (buffer,
+			gtk_source_buffer_get_language (buffer) != NULL &&
+			pluma_prefs_manager_get_enable_syntax_highlighting () &&
+			!(features & PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING));
+	}
+
+	if (changed & PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING)
+	{
+		gtk_source_buffer_set_highlight_matching_brackets (buffer,
+			pluma_prefs_manager_get_bracket_matching () &&
+			!(features & PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING));
+	}
+
+	if (changed & PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING)
+	{
+		pluma_document_set_enable_search_highlighting (doc,
+			pluma_prefs_manager_get_enable_search_highlighting () &&
+			!(features & PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING));
+	}
+
+	/* the views and the plugins follow the notification */
+	g_object_notify (G_OBJECT (doc), "disabled-features");
+}
+
+/**
+ * pluma_document_get_disabled_features:
+ * @doc: a #PlumaDocument
+ *
+ * Returns: the features turned off for @doc
+ */
+PlumaDocumentFeatures
+pluma_document_get_disabled_features (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), 0);
+
+	return doc->priv->disabled_features;
+}
+
+/**
+ * pluma_document_get_large_file_profile:
+ * @doc: a #PlumaDocument
+ *
+ * Returns: %TRUE if @doc was loaded from a file over the size or lines
+ * limits in the preferences, and had its expensive features turned off
+ */
+gboolean
+pluma_document_get_large_file_profile (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), FALSE);
+
+	return doc->priv->large_file != FALSE;
+}
+
+/**
+ * pluma_document_add_watch:
+ * @doc: a #PlumaDocument
+ * @start: (allow-none): the start of the watched range, or %NULL for the
+ * start of the document
+ * @end: (allow-none): the end of the watched range, or %NULL for the end
+ * of the document
+ * @flags: the #PlumaDocumentWatchFlags
+ * @func: (scope notified): the function to call
+ * @user_data: (closure): data to pass to @func
+ * @notify: (allow-none): function to free @user_data with
+ *
+ * Calls @func when text is inserted or deleted in the range between the
+ * @start and @end marks, bounds included, or when the cursor moves in
+ * that range or leaves it. This is much cheaper than connecting to
+ * #GtkTextBuffer::changed or #PlumaDocument::cursor-moved for plugins
+ * written in an interpreted language, which then only run when
+ * something they care about happened.
+ *
+ * @func is called from #GtkTextBuffer::changed for changes. With
+ * %PLUMA_DOCUMENT_WATCH_COALESCE it is instead called once before the
+ * next redraw, with the range covering everything that happened since.
+ *
+ * Returns: the id of the watch, for pluma_document_remove_watch()
+ */
+guint
+pluma_document_add_watch (PlumaDocument           *doc,
+			  GtkTextMark             *start,
+			  GtkTextMark             *end,
+			  PlumaDocumentWatchFlags  flags,
+			  PlumaDocumentWatchFunc   func,
+			  gpointer                 user_data,
+			  GDestroyNotify           notify)
+{
+	DocumentWatch *watch;
+	GtkTextIter cursor;
+	GtkTextIter range_start;
+	GtkTextIter range_end;
+
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc), 0);
+	g_return_val_if_fail (start == NULL || GTK_IS_TEXT_MARK (start), 0);
+	g_return_val_if_fail (end == NULL || GTK_IS_TEXT_MARK (end), 0);
+	g_return_val_if_fail (func != NULL, 0);
+
+	watch = g_slice_new0 (DocumentWatch);
+	watch->id = ++doc->priv->last_watch_id;
+	watch->start = start != NULL ? g_object_ref (start) : NULL;
+	watch->end = end != NULL ? g_object_ref (end) : NULL;
+	watch->flags = flags;
+	watch->func = func;
+	watch->user_data = user_data;
+	watch->notify = notify;
+
+	watch_get_range (doc, watch, &range_start, &range_end);
+	gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc),
+					  &cursor,
+					  gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (doc)));
+	watch->cursor_inside = gtk_text_iter_in_range (&cursor, &range_start, &range_end) ||
+			       gtk_text_iter_equal (&cursor, &range_end);
+
+	/* Added in front, so a watch added by a callback does not see the
+	 * event being dispatched */
+	doc->priv->watches = g_slist_prepend (doc->priv->watches, watch);
+
+	return watch->id;
+}
+
+/**
+ * pluma_document_remove_watch:
+ * @doc: a #PlumaDocument
+ * @id: the id returned by pluma_document_add_watch()
+ *
+ * Removes a watch, its function is not called anymore.
+ */
+void
+pluma_document_remove_watch (PlumaDocument *doc,
+			     guint          id)
+{
+	GSList *l;
+
+	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
+
+	for (l = doc->priv->watches; l != NULL; l = l->next)
+	{
+		DocumentWatch *watch = l->data;
+
+		if (watch->id != id || watch->removed)
+			continue;
+
+		/* The list is being walked, free it afterwards */
+		watch->removed = TRUE;
+
+		if (doc->priv->watch_dispatching == 0)
+			purge_removed_watches (doc);
+
+		return;
+	}
+}
+
 void
 pluma_document_set_newline_type (PlumaDocument           *doc,
 				 PlumaDocumentNewlineType newline_type)
@@ -2654,6 +5075,38 @@ pluma_document_get_newline_type (PlumaDocument *doc)
 	return doc->priv->newline_type;
 }
 
+/**
+ * pluma_document_set_compression_type:
+ * @doc: a #PlumaDocument
+ * @compression_type: the compression to save the document with
+ *
+ * Sets the compression of the file the document is saved to. The
+ * formats pluma was built without cannot be set.
+ */
+void
+pluma_document_set_compression_type (PlumaDocument               *doc,
+				     PlumaDocumentCompressionType compression_type)
+{
+	g_return_if_fail (PLUMA_IS_DOCUMENT (doc));
+	g_return_if_fail (pluma_compression_is_supported (compression_type));
+
+	if (doc->priv->compression_type != compression_type)
+	{
+		doc->priv->compression_type = compression_type;
+
+		g_object_notify (G_OBJECT (doc), "compression-type");
+	}
+}
+
+PlumaDocumentCompressionType
+pluma_document_get_compression_type (PlumaDocument *doc)
+{
+	g_return_val_if_fail (PLUMA_IS_DOCUMENT (doc),
+			      PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE);
+
+	return doc->priv->compression_type;
+}
+
 void
 _pluma_document_set_mount_operation_factory (PlumaDocument 	       *doc,
 					    PlumaMountOperationFactory	callback,
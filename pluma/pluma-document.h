@@ -64,6 +64,24 @@ typedef enum
 
 #define PLUMA_DOCUMENT_NEWLINE_TYPE_DEFAULT PLUMA_DOCUMENT_NEWLINE_TYPE_LF
 
+/**
+ * PlumaDocumentCompressionType:
+ * @PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE: the file is not compressed.
+ * @PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP: gzip.
+ * @PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ: xz.
+ * @PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD: Zstandard.
+ *
+ * How the file of a document is compressed. Compressed files are
+ * decompressed while loading and compressed again while saving.
+ */
+typedef enum
+{
+	PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE,
+	PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP,
+	PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ,
+	PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD
+} PlumaDocumentCompressionType;
+
 typedef enum
 {
 	PLUMA_SEARCH_DONT_SET_FLAGS	= 1 << 0, 
@@ -87,6 +105,51 @@ typedef enum
 	PLUMA_DOCUMENT_SAVE_PRESERVE_BACKUP	= 1 << 2
 } PlumaDocumentSaveFlags;
 
+/**
+ * PlumaDocumentFeatures:
+ * @PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING: syntax highlighting.
+ * @PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING: highlighting of the matching brackets.
+ * @PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING: highlighting of the search matches.
+ * @PLUMA_DOCUMENT_FEATURE_SPELL_CHECKING: automatic spell checking.
+ * @PLUMA_DOCUMENT_FEATURE_LINE_NUMBERS: line numbers in the views.
+ * @PLUMA_DOCUMENT_FEATURE_CURRENT_LINE: highlighting of the current line.
+ *
+ * Features that get slow on big documents and that can be turned off
+ * for a single document, see pluma_document_set_disabled_features().
+ */
+typedef enum
+{
+	PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING	= 1 << 0,
+	PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING		= 1 << 1,
+	PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING	= 1 << 2,
+	PLUMA_DOCUMENT_FEATURE_SPELL_CHECKING		= 1 << 3,
+	PLUMA_DOCUMENT_FEATURE_LINE_NUMBERS		= 1 << 4,
+	PLUMA_DOCUMENT_FEATURE_CURRENT_LINE		= 1 << 5
+} PlumaDocumentFeatures;
+
+#define PLUMA_DOCUMENT_FEATURES_ALL (PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING | \
+				     PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING | \
+				     PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING | \
+				     PLUMA_DOCUMENT_FEATURE_SPELL_CHECKING | \
+				     PLUMA_DOCUMENT_FEATURE_LINE_NUMBERS | \
+				     PLUMA_DOCUMENT_FEATURE_CURRENT_LINE)
+
+/**
+ * PlumaDocumentWatchFlags:
+ * @PLUMA_DOCUMENT_WATCH_CHANGES: text inserted or deleted in the range.
+ * @PLUMA_DOCUMENT_WATCH_CURSOR: the cursor moved in the range or left it.
+ * @PLUMA_DOCUMENT_WATCH_COALESCE: report everything that happened once,
+ * before the next redraw.
+ *
+ * What a watch added with pluma_document_add_watch() reports.
+ */
+typedef enum
+{
+	PLUMA_DOCUMENT_WATCH_CHANGES	= 1 << 0,
+	PLUMA_DOCUMENT_WATCH_CURSOR	= 1 << 1,
+	PLUMA_DOCUMENT_WATCH_COALESCE	= 1 << 2
+} PlumaDocumentWatchFlags;
+
 /* Private structure type */
 typedef struct _PlumaDocumentPrivate    PlumaDocumentPrivate;
 
@@ -103,6 +166,18 @@ struct _PlumaDocument
 	PlumaDocumentPrivate *priv;
 };
 
+/**
+ * PlumaDocumentWatchFunc:
+ * @doc: the #PlumaDocument
+ * @start: start of what changed, or the cursor position
+ * @end: end of what changed, or the cursor position
+ * @user_data: the data passed to pluma_document_add_watch()
+ */
+typedef void (*PlumaDocumentWatchFunc) (PlumaDocument *doc,
+					GtkTextIter   *start,
+					GtkTextIter   *end,
+					gpointer       user_data);
+
 /*
  * Class definition
  */
@@ -147,6 +222,12 @@ struct _PlumaDocumentClass
 					(PlumaDocument    *document,
 					 GtkTextIter      *start,
 					 GtkTextIter      *end);
+
+	void (* externally_modified)	(PlumaDocument    *document);
+
+	void (* file_appended)		(PlumaDocument    *document);
+
+	void (* paged_line_shown)	(PlumaDocument    *document);
 };
 
 
@@ -277,6 +358,39 @@ void		 pluma_document_set_newline_type (PlumaDocument           *doc,
 PlumaDocumentNewlineType
 		 pluma_document_get_newline_type (PlumaDocument *doc);
 
+void		 pluma_document_set_compression_type
+						(PlumaDocument               *doc,
+						 PlumaDocumentCompressionType compression_type);
+
+PlumaDocumentCompressionType
+		 pluma_document_get_compression_type
+						(PlumaDocument               *doc);
+
+void		 pluma_document_set_disabled_features
+						(PlumaDocument         *doc,
+						 PlumaDocumentFeatures  features);
+
+PlumaDocumentFeatures
+		 pluma_document_get_disabled_features
+						(PlumaDocument         *doc);
+
+gboolean	 pluma_document_get_large_file_profile
+						(PlumaDocument         *doc);
+
+guint		 pluma_document_add_watch	(PlumaDocument           *doc,
+						 GtkTextMark             *start,
+						 GtkTextMark             *end,
+						 PlumaDocumentWatchFlags  flags,
+						 PlumaDocumentWatchFunc   func,
+						 gpointer                 user_data,
+						 GDestroyNotify           notify);
+
+void		 pluma_document_remove_watch	(PlumaDocument           *doc,
+						 guint                    id);
+
+gint		*pluma_document_get_dirty_lines	(PlumaDocument       *doc,
+						 guint               *n_values);
+
 gchar		*pluma_document_get_metadata	(PlumaDocument *doc,
 						 const gchar   *key);
 
@@ -293,10 +407,55 @@ void		 _pluma_document_set_readonly 	(PlumaDocument       *doc,
 glong		 _pluma_document_get_seconds_since_last_save_or_load 
 						(PlumaDocument       *doc);
 
-/* Note: this is a sync stat: use only on local files */
+/* Note: returns the cached state, the file is checked asynchronously */
 gboolean	_pluma_document_check_externally_modified
 						(PlumaDocument       *doc);
 
+void		_pluma_document_reload_async	(PlumaDocument       *doc,
+						 GCancellable        *cancellable,
+						 GAsyncReadyCallback  callback,
+						 gpointer             user_data);
+
+gboolean	_pluma_document_reload_finish	(PlumaDocument       *doc,
+						 GAsyncResult        *result,
+						 GError             **error);
+
+void		_pluma_document_set_load_priority
+						(PlumaDocument       *doc,
+						 gint                 io_priority,
+						 gboolean             paused);
+
+gboolean	_pluma_document_set_follow	(PlumaDocument       *doc,
+						 gboolean             follow);
+
+gboolean	_pluma_document_get_follow	(PlumaDocument       *doc);
+
+gboolean	_pluma_document_is_paged	(PlumaDocument       *doc);
+
+gint64		_pluma_document_get_paged_first_line
+						(PlumaDocument       *doc);
+
+gboolean	_pluma_document_shift_paged_window
+						(PlumaDocument       *doc,
+						 gboolean             forward);
+
+gchar		*_pluma_document_get_paged_lines
+						(PlumaDocument       *doc,
+						 gint64               first,
+						 gint64               last);
+
+void		_pluma_document_search_paged_async
+						(PlumaDocument       *doc,
+						 gboolean             backward,
+						 gboolean             wrap_around,
+						 GAsyncReadyCallback  callback,
+						 gpointer             user_data);
+
+gboolean	_pluma_document_search_paged_finish
+						(PlumaDocument       *doc,
+						 GAsyncResult        *result,
+						 GError             **error);
+
 void		_pluma_document_search_region   (PlumaDocument       *doc,
 						 const GtkTextIter   *start,
 						 const GtkTextIter   *end);
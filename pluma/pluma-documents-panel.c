@@ -49,10 +49,27 @@ struct _PlumaDocumentsPanelPrivate
 	GtkWidget    *treeview;
 	GtkTreeModel *model;
 
+	/* PlumaTab -> TabRow */
+	GHashTable   *rows;
+
 	guint         adding_tab : 1;
+	guint         removing_tab : 1;
 	guint         is_reodering : 1;
+	/* rows were moved by dnd in the tree view */
+	guint         rows_stale : 1;
 };
 
+/* List store iters persist, so every tab keeps the iter of its row
+ * together with what was last shown in it */
+typedef struct
+{
+	GtkTreeIter    iter;
+
+	gchar         *name;
+	gchar         *icon_uri;
+	PlumaTabState  icon_state;
+} TabRow;
+
 G_DEFINE_TYPE(PlumaDocumentsPanel, pluma_documents_panel, GTK_TYPE_BOX)
 
 enum
@@ -123,21 +140,64 @@ tab_get_name (PlumaTab *tab)
 }
 
 static void
-get_iter_from_tab (PlumaDocumentsPanel *panel, PlumaTab *tab, GtkTreeIter *iter)
+tab_row_free (TabRow *row)
 {
-	gint num;
-	GtkWidget *nb;
-	GtkTreePath *path;
+	g_free (row->name);
+	g_free (row->icon_uri);
+	g_slice_free (TabRow, row);
+}
 
-	nb = _pluma_window_get_notebook (panel->priv->window);
-	num = gtk_notebook_page_num (GTK_NOTEBOOK (nb),
-				     GTK_WIDGET (tab));
+/* After a dnd in the tree view the rows of the moved tab were replaced,
+ * look up the new iters once instead of tracking every step */
+static void
+rows_rebuild (PlumaDocumentsPanel *panel)
+{
+	GtkTreeIter iter;
+	gboolean valid;
 
-	path = gtk_tree_path_new_from_indices (num, -1);
-	gtk_tree_model_get_iter (panel->priv->model,
-		                 iter,
-		                 path);
-	gtk_tree_path_free (path);
+	valid = gtk_tree_model_get_iter_first (panel->priv->model, &iter);
+
+	while (valid)
+	{
+		PlumaTab *tab;
+		TabRow *row;
+
+		gtk_tree_model_get (panel->priv->model,
+				    &iter,
+				    TAB_COLUMN, &tab,
+				    -1);
+
+		row = tab != NULL ? g_hash_table_lookup (panel->priv->rows, tab) : NULL;
+
+		if (row != NULL)
+			row->iter = iter;
+
+		valid = gtk_tree_model_iter_next (panel->priv->model, &iter);
+	}
+
+	panel->priv->rows_stale = FALSE;
+}
+
+static TabRow *
+get_row_from_tab (PlumaDocumentsPanel *panel,
+		  PlumaTab            *tab)
+{
+	if (panel->priv->rows_stale)
+		rows_rebuild (panel);
+
+	return g_hash_table_lookup (panel->priv->rows, tab);
+}
+
+static void
+select_row (PlumaDocumentsPanel *panel,
+	    TabRow              *row)
+{
+	GtkTreeSelection *selection;
+
+	selection = gtk_tree_view_get_selection (
+			GTK_TREE_VIEW (panel->priv->treeview));
+
+	gtk_tree_selection_select_iter (selection, &row->iter);
 }
 
 static void
@@ -149,86 +209,72 @@ window_active_tab_changed (PlumaWindow         *window,
 
 	if (!_pluma_window_is_removing_tabs (window))
 	{
-		GtkTreeIter iter;
-		GtkTreeSelection *selection;
+		TabRow *row;
 
-		get_iter_from_tab (panel, tab, &iter);
+		row = get_row_from_tab (panel, tab);
 
-		if (gtk_list_store_iter_is_valid (GTK_LIST_STORE (panel->priv->model),
-						  &iter))
-		{
-			selection = gtk_tree_view_get_selection (
-					GTK_TREE_VIEW (panel->priv->treeview));
-
-			gtk_tree_selection_select_iter (selection, &iter);
-		}
+		if (row != NULL)
+			select_row (panel, row);
 	}
 }
 
+/* Only touches the columns that changed, so that unrelated notifications
+ * of the tab neither recompute the icon nor redraw the row */
 static void
-refresh_list (PlumaDocumentsPanel *panel)
+update_row (PlumaDocumentsPanel *panel,
+	    PlumaTab            *tab,
+	    TabRow              *row)
 {
-	/* TODO: refresh the list only if the panel is visible */
-
-	GList *tabs;
-	GList *l;
-	GtkWidget *nb;
 	GtkListStore *list_store;
-	PlumaTab *active_tab;
+	PlumaTabState state;
+	gchar *name;
+	gchar *uri;
 
-	/* g_debug ("refresh_list"); */
-	
 	list_store = GTK_LIST_STORE (panel->priv->model);
 
-	gtk_list_store_clear (list_store);
+	name = tab_get_name (tab);
 
-	active_tab = pluma_window_get_active_tab (panel->priv->window);
+	if (g_strcmp0 (name, row->name) != 0)
+	{
+		gtk_list_store_set (list_store,
+				    &row->iter,
+				    NAME_COLUMN, name,
+				    -1);
 
-	nb = _pluma_window_get_notebook (panel->priv->window);
+		g_free (row->name);
+		row->name = name;
+	}
+	else
+	{
+		g_free (name);
+	}
 
-	tabs = gtk_container_get_children (GTK_CONTAINER (nb));
-	l = tabs;
+	/* The icon depends on the state, and on the file in the normal state */
+	state = pluma_tab_get_state (tab);
+	uri = pluma_document_get_uri (pluma_tab_get_document (tab));
 
-	panel->priv->adding_tab = TRUE;
-	
-	while (l != NULL)
-	{	
+	if (state != row->icon_state || g_strcmp0 (uri, row->icon_uri) != 0)
+	{
 		GdkPixbuf *pixbuf;
-		gchar *name;
-		GtkTreeIter iter;
 
-		name = tab_get_name (PLUMA_TAB (l->data));
-		pixbuf = _pluma_tab_get_icon (PLUMA_TAB (l->data));
+		pixbuf = _pluma_tab_get_icon (tab);
 
-		/* Add a new row to the model */
-		gtk_list_store_append (list_store, &iter);
 		gtk_list_store_set (list_store,
-				    &iter,
+				    &row->iter,
 				    PIXBUF_COLUMN, pixbuf,
-				    NAME_COLUMN, name,
-				    TAB_COLUMN, l->data,
 				    -1);
 
-		g_free (name);
 		if (pixbuf != NULL)
 			g_object_unref (pixbuf);
 
-		if (l->data == active_tab)
-		{
-			GtkTreeSelection *selection;
-
-			selection = gtk_tree_view_get_selection (
-					GTK_TREE_VIEW (panel->priv->treeview));
-
-			gtk_tree_selection_select_iter (selection, &iter);
-		}
-
-		l = g_list_next (l);
+		g_free (row->icon_uri);
+		row->icon_uri = uri;
+		row->icon_state = state;
+	}
+	else
+	{
+		g_free (uri);
 	}
-	
-	panel->priv->adding_tab = FALSE;
-
-	g_list_free (tabs);
 }
 
 static void
@@ -236,25 +282,12 @@ sync_name_and_icon (PlumaTab            *tab,
 		    GParamSpec          *pspec,
 		    PlumaDocumentsPanel *panel)
 {
-	GdkPixbuf *pixbuf;
-	gchar *name;
-	GtkTreeIter iter;
+	TabRow *row;
 
-	get_iter_from_tab (panel, tab, &iter);
+	row = get_row_from_tab (panel, tab);
 
-	name = tab_get_name (tab);
-	pixbuf = _pluma_tab_get_icon (tab);
-
-	gtk_list_store_set (GTK_LIST_STORE (panel->priv->model),
-			    &iter,
-			    PIXBUF_COLUMN, pixbuf,
-			    NAME_COLUMN, name,
-			    TAB_COLUMN, tab,
-			    -1);
-
-	g_free (name);
-	if (pixbuf != NULL)
-		g_object_unref (pixbuf);
+	if (row != NULL)
+		update_row (panel, tab, row);
 }
 
 static void
@@ -262,14 +295,34 @@ window_tab_removed (PlumaWindow         *window,
 		    PlumaTab            *tab,
 		    PlumaDocumentsPanel *panel)
 {
+	TabRow *row;
+
 	g_signal_handlers_disconnect_by_func (tab,
 					      G_CALLBACK (sync_name_and_icon),
 					      panel);
 
+	panel->priv->removing_tab = TRUE;
+
 	if (_pluma_window_is_removing_tabs (window))
+	{
+		/* all of them go, the first removal empties the list */
 		gtk_list_store_clear (GTK_LIST_STORE (panel->priv->model));
+		g_hash_table_remove_all (panel->priv->rows);
+		panel->priv->rows_stale = FALSE;
+	}
 	else
-		refresh_list (panel);
+	{
+		row = get_row_from_tab (panel, tab);
+
+		if (row != NULL)
+		{
+			gtk_list_store_remove (GTK_LIST_STORE (panel->priv->model),
+					       &row->iter);
+			g_hash_table_remove (panel->priv->rows, tab);
+		}
+	}
+
+	panel->priv->removing_tab = FALSE;
 }
 
 static void
@@ -277,10 +330,9 @@ window_tab_added (PlumaWindow         *window,
 		  PlumaTab            *tab,
 		  PlumaDocumentsPanel *panel)
 {
-	GtkTreeIter iter;
-	GtkTreeIter sibling;
-	GdkPixbuf *pixbuf;
-	gchar *name;
+	GtkWidget *nb;
+	TabRow *row;
+	gint position;
 
 	g_signal_connect (tab,
 			 "notify::name",
@@ -292,62 +344,56 @@ window_tab_added (PlumaWindow         *window,
 			  G_CALLBACK (sync_name_and_icon),
 			  panel);
 
-	get_iter_from_tab (panel, tab, &sibling);
-
-	panel->priv->adding_tab = TRUE;
-	
-	if (gtk_list_store_iter_is_valid (GTK_LIST_STORE (panel->priv->model), 
-					  &sibling))
-	{
-		gtk_list_store_insert_after (GTK_LIST_STORE (panel->priv->model),
-					     &iter,
-					     &sibling);
-	}
-	else
-	{
-		PlumaTab *active_tab;
-
-		gtk_list_store_append (GTK_LIST_STORE (panel->priv->model), 
-				       &iter);
-
-		active_tab = pluma_window_get_active_tab (panel->priv->window);
-
-		if (tab == active_tab)
-		{
-			GtkTreeSelection *selection;
+	nb = _pluma_window_get_notebook (panel->priv->window);
+	position = gtk_notebook_page_num (GTK_NOTEBOOK (nb), GTK_WIDGET (tab));
 
-			selection = gtk_tree_view_get_selection (
-						GTK_TREE_VIEW (panel->priv->treeview));
+	row = g_slice_new0 (TabRow);
+	row->icon_state = -1;
 
-			gtk_tree_selection_select_iter (selection, &iter);
-		}
-	}
+	panel->priv->adding_tab = TRUE;
 
-	name = tab_get_name (tab);
-	pixbuf = _pluma_tab_get_icon (tab);
+	gtk_list_store_insert_with_values (GTK_LIST_STORE (panel->priv->model),
+					   &row->iter,
+					   position,
+					   TAB_COLUMN, tab,
+					   -1);
 
-	gtk_list_store_set (GTK_LIST_STORE (panel->priv->model),
-			    &iter,
-		            PIXBUF_COLUMN, pixbuf,
-		            NAME_COLUMN, name,
-		            TAB_COLUMN, tab,
-		            -1);
+	panel->priv->adding_tab = FALSE;
 
-	g_free (name);
-	if (pixbuf != NULL)
-		g_object_unref (pixbuf);
+	g_hash_table_insert (panel->priv->rows, tab, row);
+	update_row (panel, tab, row);
 
-	panel->priv->adding_tab = FALSE;
+	if (tab == pluma_window_get_active_tab (panel->priv->window))
+		select_row (panel, row);
 }
 
 static void
-window_tabs_reordered (PlumaWindow         *window,
-		       PlumaDocumentsPanel *panel)
+notebook_page_reordered (GtkNotebook         *notebook,
+			 GtkWidget           *child,
+			 guint                page_num,
+			 PlumaDocumentsPanel *panel)
 {
+	GtkWidget *next;
+	TabRow *row;
+	TabRow *next_row = NULL;
+
+	/* The tree view moved the row itself */
 	if (panel->priv->is_reodering)
 		return;
 
-	refresh_list (panel);
+	row = get_row_from_tab (panel, PLUMA_TAB (child));
+
+	if (row == NULL)
+		return;
+
+	next = gtk_notebook_get_nth_page (notebook, page_num + 1);
+
+	if (next != NULL)
+		next_row = get_row_from_tab (panel, PLUMA_TAB (next));
+
+	gtk_list_store_move_before (GTK_LIST_STORE (panel->priv->model),
+				    &row->iter,
+				    next_row != NULL ? &next_row->iter : NULL);
 }
 
 static void
@@ -367,10 +413,11 @@ set_window (PlumaDocumentsPanel *panel,
 			  "tab_removed",
 			  G_CALLBACK (window_tab_removed),
 			  panel);
-	g_signal_connect (window,
-			  "tabs_reordered",
-			  G_CALLBACK (window_tabs_reordered),
-			  panel);
+	g_signal_connect_object (_pluma_window_get_notebook (window),
+				 "page-reordered",
+				 G_CALLBACK (notebook_page_reordered),
+				 panel,
+				 0);
 	g_signal_connect (window,
 			  "active_tab_changed",
 			  G_CALLBACK (window_active_tab_changed),
@@ -465,6 +512,12 @@ pluma_documents_panel_dispose (GObject *object)
 		panel->priv->window = NULL;
 	}
 
+	if (panel->priv->rows != NULL)
+	{
+		g_hash_table_destroy (panel->priv->rows);
+		panel->priv->rows = NULL;
+	}
+
 	G_OBJECT_CLASS (pluma_documents_panel_parent_class)->dispose (object);
 }
 
@@ -716,6 +769,8 @@ treeview_row_inserted (GtkTreeModel        *tree_model,
 	tab = pluma_window_get_active_tab (panel->priv->window);
 	g_return_if_fail (tab != NULL);
 
+	/* The dragged row is copied here and deleted afterwards */
+	panel->priv->rows_stale = TRUE;
 	panel->priv->is_reodering = TRUE;
 	
 	indeces = gtk_tree_path_get_indices (path);
@@ -737,6 +792,15 @@ treeview_row_inserted (GtkTreeModel        *tree_model,
 	panel->priv->is_reodering = FALSE;
 }
 
+static void
+treeview_row_deleted (GtkTreeModel        *tree_model,
+		      GtkTreePath         *path,
+		      PlumaDocumentsPanel *panel)
+{
+	if (!panel->priv->removing_tab)
+		panel->priv->rows_stale = TRUE;
+}
+
 static void
 pluma_documents_panel_init (PlumaDocumentsPanel *panel)
 {
@@ -748,7 +812,14 @@ pluma_documents_panel_init (PlumaDocumentsPanel *panel)
 	panel->priv = PLUMA_DOCUMENTS_PANEL_GET_PRIVATE (panel);
 	
 	panel->priv->adding_tab = FALSE;
+	panel->priv->removing_tab = FALSE;
 	panel->priv->is_reodering = FALSE;
+	panel->priv->rows_stale = FALSE;
+
+	panel->priv->rows = g_hash_table_new_full (g_direct_hash,
+						   g_direct_equal,
+						   NULL,
+						   (GDestroyNotify) tab_row_free);
 
 	gtk_orientable_set_orientation (GTK_ORIENTABLE (panel),
 	                                GTK_ORIENTATION_VERTICAL);
@@ -821,6 +892,10 @@ pluma_documents_panel_init (PlumaDocumentsPanel *panel)
 			  "row-inserted",
 			  G_CALLBACK (treeview_row_inserted),
 			  panel);
+	g_signal_connect (panel->priv->model,
+			  "row-deleted",
+			  G_CALLBACK (treeview_row_deleted),
+			  panel);
 }
 
 GtkWidget *
@@ -0,0 +1,1009 @@
+/*
+ * pluma-file-index.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "pluma-file-index.h"
+#include "pluma-debug.h"
+
+/**
+ * SECTION:pluma-file-index
+ * @short_description: recursive file name index with fuzzy matching
+ * @include: pluma/pluma-file-index.h
+ *
+ * A #PlumaFileIndex keeps the relative paths of all the regular files
+ * below a root directory. The tree is walked on a worker thread; on
+ * refresh only the directories whose modification time changed are
+ * enumerated again, the others are taken over from the previous scan.
+ *
+ * Paths are stored back to back in one flat buffer, together with an
+ * ASCII case folded copy that is used for matching, so a query is a
+ * linear walk over contiguous memory. When a query extends the previous
+ * one only the entries that matched the previous query are tested again.
+ */
+
+#define PLUMA_FILE_INDEX_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE((object), PLUMA_TYPE_FILE_INDEX, PlumaFileIndexPrivate))
+
+/* Stop indexing past this many files, the index is meant for source
+ * trees, not for whole file systems */
+#define MAX_FILES		2000000
+
+#define SCAN_ATTRIBUTES		G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+				G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+				G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+				G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP
+
+#define MTIME_ATTRIBUTES	G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+				G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+
+/* Scoring weights */
+#define SCORE_MATCH		16
+#define SCORE_BASENAME		8
+#define SCORE_BOUNDARY		12
+#define SCORE_CONSECUTIVE	10
+#define SCORE_BASENAME_SUBSTR	32
+#define SCORE_BASENAME_PREFIX	48
+#define PENALTY_GAP_MAX		8
+
+typedef struct
+{
+	gchar     *path;	/* relative to the root, "" for the root itself */
+	guint64    mtime;
+	GPtrArray *names;	/* sorted child names, directories end with '/' */
+} IndexDir;
+
+typedef struct
+{
+	guint32 offset;		/* start of the path in the buffers */
+	guint32 length;
+	guint32 basename;	/* start of the basename within the path */
+} IndexEntry;
+
+typedef struct
+{
+	volatile gint ref_count;
+
+	GHashTable *dirs;	/* path -> IndexDir */
+	GString    *paths;	/* NUL separated relative paths */
+	gchar      *folded;	/* @paths with ASCII letters lowered */
+	GArray     *entries;	/* IndexEntry */
+} Snapshot;
+
+typedef struct
+{
+	gint    score;
+	guint32 index;
+} Match;
+
+struct _PlumaFileIndexPrivate
+{
+	GFile        *root;
+
+	Snapshot     *snapshot;
+	GCancellable *cancellable;
+
+	/* Entries that matched the last query, so that a query which only
+	 * extends it does not have to walk the whole index again */
+	gchar        *last_query;
+	GArray       *candidates;
+
+	guint         scanning : 1;
+	guint         rescan : 1;
+};
+
+enum
+{
+	PROP_0,
+	PROP_ROOT
+};
+
+enum
+{
+	UPDATED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+static GHashTable *indexes = NULL;
+
+G_DEFINE_TYPE (PlumaFileIndex, pluma_file_index, G_TYPE_OBJECT)
+
+static void
+index_dir_free (IndexDir *dir)
+{
+	g_free (dir->path);
+	g_ptr_array_unref (dir->names);
+	g_slice_free (IndexDir, dir);
+}
+
+static Snapshot *
+snapshot_new (void)
+{
+	Snapshot *snapshot;
+
+	snapshot = g_slice_new0 (Snapshot);
+	snapshot->ref_count = 1;
+	snapshot->dirs = g_hash_table_new_full (g_str_hash,
+						g_str_equal,
+						NULL,
+						(GDestroyNotify) index_dir_free);
+	snapshot->paths = g_string_new (NULL);
+	snapshot->entries = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+
+	return snapshot;
+}
+
+static Snapshot *
+snapshot_ref (Snapshot *snapshot)
+{
+	g_atomic_int_inc (&snapshot->ref_count);
+
+	return snapshot;
+}
+
+static void
+snapshot_unref (Snapshot *snapshot)
+{
+	if (!g_atomic_int_dec_and_test (&snapshot->ref_count))
+		return;
+
+	g_hash_table_destroy (snapshot->dirs);
+	g_string_free (snapshot->paths, TRUE);
+	g_free (snapshot->folded);
+	g_array_free (snapshot->entries, TRUE);
+	g_slice_free (Snapshot, snapshot);
+}
+
+static void
+snapshot_add_file (Snapshot    *snapshot,
+		   const gchar *dir,
+		   const gchar *name)
+{
+	IndexEntry entry;
+
+	entry.offset = snapshot->paths->len;
+
+	if (*dir != '\0')
+	{
+		g_string_append (snapshot->paths, dir);
+		g_string_append_c (snapshot->paths, '/');
+	}
+
+	entry.basename = snapshot->paths->len - entry.offset;
+	g_string_append (snapshot->paths, name);
+	entry.length = snapshot->paths->len - entry.offset;
+
+	/* keep every path NUL terminated */
+	g_string_append_len (snapshot->paths, "", 1);
+
+	g_array_append_val (snapshot->entries, entry);
+}
+
+static void
+snapshot_finish (Snapshot *snapshot)
+{
+	const gchar *src = snapshot->paths->str;
+	gsize len = snapshot->paths->len;
+	gsize i;
+
+	snapshot->folded = g_malloc (len + 1);
+
+	for (i = 0; i < len; ++i)
+		snapshot->folded[i] = g_ascii_tolower (src[i]);
+
+	snapshot->folded[len] = '\0';
+}
+
+static gint
+compare_names (gconstpointer a,
+	       gconstpointer b)
+{
+	return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+static IndexDir *
+index_dir_scan (GFile        *root,
+		const gchar  *path,
+		Snapshot     *previous,
+		GCancellable *cancellable)
+{
+	GFile *location;
+	GFileInfo *info;
+	GFileEnumerator *enumerator;
+	IndexDir *old;
+	IndexDir *dir;
+	guint64 mtime;
+
+	if (*path != '\0')
+		location = g_file_resolve_relative_path (root, path);
+	else
+		location = g_object_ref (root);
+
+	info = g_file_query_info (location,
+				  MTIME_ATTRIBUTES,
+				  G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+				  cancellable,
+				  NULL);
+
+	if (info == NULL)
+	{
+		g_object_unref (location);
+		return NULL;
+	}
+
+	mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+		g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+	g_object_unref (info);
+
+	dir = g_slice_new (IndexDir);
+	dir->path = g_strdup (path);
+	dir->mtime = mtime;
+
+	old = previous != NULL ? g_hash_table_lookup (previous->dirs, path) : NULL;
+
+	if (old != NULL && old->mtime == mtime)
+	{
+		/* nothing was added or removed here since the last scan */
+		dir->names = g_ptr_array_ref (old->names);
+		g_object_unref (location);
+
+		return dir;
+	}
+
+	dir->names = g_ptr_array_new_with_free_func (g_free);
+
+	enumerator = g_file_enumerate_children (location,
+						SCAN_ATTRIBUTES,
+						G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+						cancellable,
+						NULL);
+
+	if (enumerator != NULL)
+	{
+		while ((info = g_file_enumerator_next_file (enumerator, cancellable, NULL)) != NULL)
+		{
+			if (!g_file_info_get_is_hidden (info) &&
+			    !g_file_info_get_is_backup (info))
+			{
+				switch (g_file_info_get_file_type (info))
+				{
+					case G_FILE_TYPE_DIRECTORY:
+						g_ptr_array_add (dir->names,
+								 g_strconcat (g_file_info_get_name (info), "/", NULL));
+						break;
+					case G_FILE_TYPE_REGULAR:
+						g_ptr_array_add (dir->names,
+								 g_strdup (g_file_info_get_name (info)));
+						break;
+					default:
+						/* symlinks are not followed to avoid cycles */
+						break;
+				}
+			}
+
+			g_object_unref (info);
+		}
+
+		g_file_enumerator_close (enumerator, NULL, NULL);
+		g_object_unref (enumerator);
+	}
+
+	g_ptr_array_sort (dir->names, compare_names);
+	g_object_unref (location);
+
+	return dir;
+}
+
+/* Walk the tree breadth first, so that shallow files come first in the
+ * index and win ties when scoring. */
+static Snapshot *
+scan_tree (GFile        *root,
+	   Snapshot     *previous,
+	   GCancellable *cancellable)
+{
+	Snapshot *snapshot;
+	GQueue queue = G_QUEUE_INIT;
+	gchar *path;
+
+	snapshot = snapshot_new ();
+	g_queue_push_tail (&queue, g_strdup (""));
+
+	while ((path = g_queue_pop_head (&queue)) != NULL)
+	{
+		IndexDir *dir;
+		guint i;
+
+		if (g_cancellable_is_cancelled (cancellable) ||
+		    snapshot->entries->len >= MAX_FILES)
+		{
+			g_free (path);
+			continue;
+		}
+
+		dir = index_dir_scan (root, path, previous, cancellable);
+		g_free (path);
+
+		if (dir == NULL)
+			continue;
+
+		g_hash_table_insert (snapshot->dirs, dir->path, dir);
+
+		for (i = 0; i < dir->names->len; ++i)
+		{
+			const gchar *name = g_ptr_array_index (dir->names, i);
+			gsize len = strlen (name);
+
+			if (name[len - 1] == '/')
+			{
+				gchar *child = g_strndup (name, len - 1);
+
+				if (*dir->path != '\0')
+				{
+					g_queue_push_tail (&queue,
+							   g_strconcat (dir->path, "/", child, NULL));
+					g_free (child);
+				}
+				else
+				{
+					g_queue_push_tail (&queue, child);
+				}
+			}
+			else
+			{
+				snapshot_add_file (snapshot, dir->path, name);
+			}
+		}
+	}
+
+	if (g_cancellable_is_cancelled (cancellable))
+	{
+		snapshot_unref (snapshot);
+		return NULL;
+	}
+
+	snapshot_finish (snapshot);
+
+	return snapshot;
+}
+
+static void
+scan_thread (GTask        *task,
+	     gpointer      source_object,
+	     gpointer      task_data,
+	     GCancellable *cancellable)
+{
+	PlumaFileIndex *index = PLUMA_FILE_INDEX (source_object);
+	Snapshot *previous = task_data;
+	Snapshot *snapshot;
+
+	snapshot = scan_tree (index->priv->root, previous, cancellable);
+
+	if (snapshot != NULL)
+	{
+		g_task_return_pointer (task, snapshot, (GDestroyNotify) snapshot_unref);
+	}
+	else
+	{
+		g_task_return_new_error (task,
+					 G_IO_ERROR,
+					 G_IO_ERROR_CANCELLED,
+					 "Scan cancelled");
+	}
+}
+
+static void
+start_scan (PlumaFileIndex *index);
+
+static void
+scan_finished (GObject      *source,
+	       GAsyncResult *result,
+	       gpointer      user_data)
+{
+	PlumaFileIndex *index = PLUMA_FILE_INDEX (source);
+	Snapshot *snapshot;
+
+	snapshot = g_task_propagate_pointer (G_TASK (result), NULL);
+
+	index->priv->scanning = FALSE;
+
+	if (snapshot == NULL)
+		return;
+
+	if (index->priv->snapshot != NULL)
+		snapshot_unref (index->priv->snapshot);
+
+	index->priv->snapshot = snapshot;
+
+	/* candidates refer to entries of the old snapshot */
+	g_free (index->priv->last_query);
+	index->priv->last_query = NULL;
+
+	if (index->priv->candidates != NULL)
+	{
+		g_array_free (index->priv->candidates, TRUE);
+		index->priv->candidates = NULL;
+	}
+
+	pluma_debug_message (DEBUG_UTILS,
+			     "Indexed %u files in %u directories",
+			     snapshot->entries->len,
+			     g_hash_table_size (snapshot->dirs));
+
+	if (index->priv->rescan)
+	{
+		index->priv->rescan = FALSE;
+		start_scan (index);
+	}
+
+	g_signal_emit (index, signals[UPDATED], 0);
+}
+
+static void
+start_scan (PlumaFileIndex *index)
+{
+	GTask *task;
+
+	index->priv->scanning = TRUE;
+
+	task = g_task_new (index, index->priv->cancellable, scan_finished, NULL);
+
+	if (index->priv->snapshot != NULL)
+	{
+		g_task_set_task_data (task,
+				      snapshot_ref (index->priv->snapshot),
+				      (GDestroyNotify) snapshot_unref);
+	}
+
+	g_task_run_in_thread (task, scan_thread);
+	g_object_unref (task);
+}
+
+static void
+pluma_file_index_dispose (GObject *object)
+{
+	PlumaFileIndex *index = PLUMA_FILE_INDEX (object);
+
+	if (index->priv->cancellable != NULL)
+	{
+		g_cancellable_cancel (index->priv->cancellable);
+		g_object_unref (index->priv->cancellable);
+		index->priv->cancellable = NULL;
+	}
+
+	if (index->priv->root != NULL)
+	{
+		g_object_unref (index->priv->root);
+		index->priv->root = NULL;
+	}
+
+	G_OBJECT_CLASS (pluma_file_index_parent_class)->dispose (object);
+}
+
+static void
+pluma_file_index_finalize (GObject *object)
+{
+	PlumaFileIndex *index = PLUMA_FILE_INDEX (object);
+
+	if (index->priv->snapshot != NULL)
+		snapshot_unref (index->priv->snapshot);
+
+	if (index->priv->candidates != NULL)
+		g_array_free (index->priv->candidates, TRUE);
+
+	g_free (index->priv->last_query);
+
+	G_OBJECT_CLASS (pluma_file_index_parent_class)->finalize (object);
+}
+
+static void
+pluma_file_index_set_property (GObject      *object,
+			       guint         prop_id,
+			       const GValue *value,
+			       GParamSpec   *pspec)
+{
+	PlumaFileIndex *index = PLUMA_FILE_INDEX (object);
+
+	switch (prop_id)
+	{
+		case PROP_ROOT:
+			index->priv->root = g_value_dup_object (value);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+pluma_file_index_get_property (GObject    *object,
+			       guint       prop_id,
+			       GValue     *value,
+			       GParamSpec *pspec)
+{
+	PlumaFileIndex *index = PLUMA_FILE_INDEX (object);
+
+	switch (prop_id)
+	{
+		case PROP_ROOT:
+			g_value_set_object (value, index->priv->root);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+pluma_file_index_class_init (PlumaFileIndexClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = pluma_file_index_dispose;
+	object_class->finalize = pluma_file_index_finalize;
+	object_class->set_property = pluma_file_index_set_property;
+	object_class->get_property = pluma_file_index_get_property;
+
+	g_object_class_install_property (object_class,
+					 PROP_ROOT,
+					 g_param_spec_object ("root",
+							      "Root",
+							      "The directory which is indexed",
+							      G_TYPE_FILE,
+							      G_PARAM_READWRITE |
+							      G_PARAM_CONSTRUCT_ONLY |
+							      G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * PlumaFileIndex::updated:
+	 * @index: the #PlumaFileIndex
+	 *
+	 * Emitted when a scan of the tree has finished and queries
+	 * operate on the new content.
+	 */
+	signals[UPDATED] =
+		g_signal_new ("updated",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaFileIndexClass, updated),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+
+	g_type_class_add_private (object_class, sizeof (PlumaFileIndexPrivate));
+}
+
+static void
+pluma_file_index_init (PlumaFileIndex *index)
+{
+	index->priv = PLUMA_FILE_INDEX_GET_PRIVATE (index);
+
+	index->priv->cancellable = g_cancellable_new ();
+}
+
+/**
+ * pluma_file_index_new:
+ * @root: the directory to index
+ *
+ * Creates a new index of @root and starts scanning it in the background.
+ *
+ * Returns: a new #PlumaFileIndex
+ */
+PlumaFileIndex *
+pluma_file_index_new (GFile *root)
+{
+	PlumaFileIndex *index;
+
+	g_return_val_if_fail (G_IS_FILE (root), NULL);
+
+	index = g_object_new (PLUMA_TYPE_FILE_INDEX, "root", root, NULL);
+	start_scan (index);
+
+	return index;
+}
+
+/**
+ * pluma_file_index_get_for_root:
+ * @root: the directory to index
+ *
+ * Gets the index shared by the whole application for @root, creating
+ * it if needed. Shared indexes stay alive until pluma exits, so that
+ * reopening a Quick Open dialog does not scan the tree again.
+ *
+ * Returns: (transfer none): the #PlumaFileIndex for @root
+ */
+PlumaFileIndex *
+pluma_file_index_get_for_root (GFile *root)
+{
+	PlumaFileIndex *index;
+
+	g_return_val_if_fail (G_IS_FILE (root), NULL);
+
+	if (indexes == NULL)
+	{
+		indexes = g_hash_table_new_full (g_file_hash,
+						 (GEqualFunc) g_file_equal,
+						 g_object_unref,
+						 g_object_unref);
+	}
+
+	index = g_hash_table_lookup (indexes, root);
+
+	if (index == NULL)
+	{
+		index = pluma_file_index_new (root);
+		g_hash_table_insert (indexes, g_object_ref (root), index);
+	}
+
+	return index;
+}
+
+/**
+ * pluma_file_index_get_root:
+ * @index: a #PlumaFileIndex
+ *
+ * Returns: (transfer none): the indexed directory
+ */
+GFile *
+pluma_file_index_get_root (PlumaFileIndex *index)
+{
+	g_return_val_if_fail (PLUMA_IS_FILE_INDEX (index), NULL);
+
+	return index->priv->root;
+}
+
+/**
+ * pluma_file_index_get_n_files:
+ * @index: a #PlumaFileIndex
+ *
+ * Returns: the number of files found by the last completed scan
+ */
+guint
+pluma_file_index_get_n_files (PlumaFileIndex *index)
+{
+	g_return_val_if_fail (PLUMA_IS_FILE_INDEX (index), 0);
+
+	if (index->priv->snapshot == NULL)
+		return 0;
+
+	return index->priv->snapshot->entries->len;
+}
+
+/**
+ * pluma_file_index_is_scanning:
+ * @index: a #PlumaFileIndex
+ *
+ * Returns: %TRUE if a scan is running in the background
+ */
+gboolean
+pluma_file_index_is_scanning (PlumaFileIndex *index)
+{
+	g_return_val_if_fail (PLUMA_IS_FILE_INDEX (index), FALSE);
+
+	return index->priv->scanning;
+}
+
+/**
+ * pluma_file_index_refresh:
+ * @index: a #PlumaFileIndex
+ *
+ * Rescans the tree in the background. Only directories that changed
+ * since the last scan are enumerated again. The #PlumaFileIndex::updated
+ * signal is emitted when the new content is available.
+ */
+void
+pluma_file_index_refresh (PlumaFileIndex *index)
+{
+	g_return_if_fail (PLUMA_IS_FILE_INDEX (index));
+
+	if (index->priv->scanning)
+	{
+		index->priv->rescan = TRUE;
+		return;
+	}
+
+	start_scan (index);
+}
+
+static gboolean
+is_subsequence (const gchar *needle,
+		const gchar *haystack)
+{
+	for (; *haystack != '\0' && *needle != '\0'; ++haystack)
+	{
+		if (*haystack == *needle)
+			++needle;
+	}
+
+	return *needle == '\0';
+}
+
+/* Quick rejection: every query byte must appear in order. memchr is
+ * vectorized by the C library, which makes this the cheap part of the
+ * scan even on large indexes. */
+static inline gboolean
+entry_matches (const gchar *path,
+	       guint32      length,
+	       const gchar *query,
+	       gsize        query_len)
+{
+	const gchar *end = path + length;
+	gsize i;
+
+	for (i = 0; i < query_len; ++i)
+	{
+		path = memchr (path, query[i], end - path);
+
+		if (path == NULL)
+			return FALSE;
+
+		++path;
+	}
+
+	return TRUE;
+}
+
+static inline gboolean
+is_boundary (gchar c)
+{
+	return c == '/' || c == '_' || c == '-' || c == '.' || c == ' ';
+}
+
+/* Matches the query backwards so that characters are preferably taken
+ * from the basename, rewarding word boundaries and runs of consecutive
+ * characters and penalizing gaps. */
+static gint
+entry_score (const gchar *path,
+	     guint32      length,
+	     guint32      basename,
+	     const gchar *query,
+	     gsize        query_len)
+{
+	const gchar *found;
+	gint score = 0;
+	gint prev = -1;
+	gint pos = length - 1;
+	gint i;
+
+	for (i = query_len - 1; i >= 0; --i)
+	{
+		while (pos >= 0 && path[pos] != query[i])
+			--pos;
+
+		if (pos < 0)
+			return G_MININT;
+
+		score += SCORE_MATCH;
+
+		if ((guint32) pos >= basename)
+			score += SCORE_BASENAME;
+
+		if (pos == 0 || is_boundary (path[pos - 1]))
+			score += SCORE_BOUNDARY;
+
+		if (prev == pos + 1)
+			score += SCORE_CONSECUTIVE;
+		else if (prev >= 0)
+			score -= MIN (prev - pos - 1, PENALTY_GAP_MAX);
+
+		prev = pos--;
+	}
+
+	found = strstr (path + basename, query);
+
+	if (found == path + basename)
+		score += SCORE_BASENAME_PREFIX;
+	else if (found != NULL)
+		score += SCORE_BASENAME_SUBSTR;
+
+	/* among equal matches prefer the shorter paths */
+	return score - (gint) (length / 16);
+}
+
+static inline gboolean
+match_is_worse (const Match *a,
+		const Match *b)
+{
+	return a->score < b->score ||
+	       (a->score == b->score && a->index > b->index);
+}
+
+/* Bounded min-heap keeping the best @max matches, the worst on top */
+static void
+heap_push (Match *heap,
+	   guint *size,
+	   guint  max,
+	   Match  match)
+{
+	guint i;
+
+	if (*size < max)
+	{
+		i = (*size)++;
+
+		while (i > 0 && match_is_worse (&match, &heap[(i - 1) / 2]))
+		{
+			heap[i] = heap[(i - 1) / 2];
+			i = (i - 1) / 2;
+		}
+
+		heap[i] = match;
+		return;
+	}
+
+	if (!match_is_worse (&heap[0], &match))
+		return;
+
+	i = 0;
+
+	for (;;)
+	{
+		guint child = 2 * i + 1;
+
+		if (child >= *size)
+			break;
+
+		if (child + 1 < *size && match_is_worse (&heap[child + 1], &heap[child]))
+			++child;
+
+		if (!match_is_worse (&heap[child], &match))
+			break;
+
+		heap[i] = heap[child];
+		i = child;
+	}
+
+	heap[i] = match;
+}
+
+static gint
+compare_matches (gconstpointer a,
+		 gconstpointer b)
+{
+	if (match_is_worse (a, b))
+		return 1;
+
+	if (match_is_worse (b, a))
+		return -1;
+
+	return 0;
+}
+
+/**
+ * pluma_file_index_query:
+ * @index: a #PlumaFileIndex
+ * @query: the text to match, case insensitively
+ * @max_results: the maximum number of results to return
+ *
+ * Finds the files whose relative path contains the characters of
+ * @query in order, and returns the best @max_results of them. While
+ * the user keeps typing, each query only tests the files that matched
+ * the previous one.
+ *
+ * Returns: (transfer full) (array zero-terminated=1): the matching
+ * paths, relative to the root, best match first
+ */
+gchar **
+pluma_file_index_query (PlumaFileIndex *index,
+			const gchar    *query,
+			guint           max_results)
+{
+	Snapshot *snapshot;
+	GArray *candidates;
+	Match *heap;
+	gchar *folded;
+	gchar **ret;
+	gsize query_len;
+	guint n_heap = 0;
+	guint n_items;
+	guint i;
+
+	g_return_val_if_fail (PLUMA_IS_FILE_INDEX (index), NULL);
+	g_return_val_if_fail (query != NULL, NULL);
+
+	snapshot = index->priv->snapshot;
+
+	if (snapshot == NULL || max_results == 0)
+		return g_new0 (gchar *, 1);
+
+	folded = g_ascii_strdown (query, -1);
+	query_len = strlen (folded);
+
+	if (index->priv->candidates != NULL &&
+	    is_subsequence (index->priv->last_query, folded))
+	{
+		n_items = index->priv->candidates->len;
+	}
+	else
+	{
+		if (index->priv->candidates != NULL)
+		{
+			g_array_free (index->priv->candidates, TRUE);
+			index->priv->candidates = NULL;
+		}
+
+		n_items = snapshot->entries->len;
+	}
+
+	candidates = g_array_new (FALSE, FALSE, sizeof (guint32));
+	heap = g_new (Match, max_results);
+
+	for (i = 0; i < n_items; ++i)
+	{
+		const IndexEntry *entry;
+		const gchar *path;
+		Match match;
+
+		if (index->priv->candidates != NULL)
+			match.index = g_array_index (index->priv->candidates, guint32, i);
+		else
+			match.index = i;
+
+		entry = &g_array_index (snapshot->entries, IndexEntry, match.index);
+		path = snapshot->folded + entry->offset;
+
+		if (!entry_matches (path, entry->length, folded, query_len))
+			continue;
+
+		g_array_append_val (candidates, match.index);
+
+		match.score = entry_score (path,
+					   entry->length,
+					   entry->basename,
+					   folded,
+					   query_len);
+
+		heap_push (heap, &n_heap, max_results, match);
+	}
+
+	qsort (heap, n_heap, sizeof (Match), compare_matches);
+
+	ret = g_new (gchar *, n_heap + 1);
+
+	for (i = 0; i < n_heap; ++i)
+	{
+		const IndexEntry *entry;
+
+		entry = &g_array_index (snapshot->entries, IndexEntry, heap[i].index);
+		ret[i] = g_strndup (snapshot->paths->str + entry->offset, entry->length);
+	}
+
+	ret[n_heap] = NULL;
+
+	if (index->priv->candidates != NULL)
+		g_array_free (index->priv->candidates, TRUE);
+
+	index->priv->candidates = candidates;
+
+	g_free (index->priv->last_query);
+	index->priv->last_query = folded;
+
+	g_free (heap);
+
+	return ret;
+}
@@ -34,12 +34,14 @@
 #include <config.h>
 #endif
 
+#include <string.h>
 #include <glib/gi18n.h>
 #include <glib/gstdio.h>
 #include <gio/gio.h>
 
 #include "pluma-gio-document-loader.h"
 #include "pluma-document-output-stream.h"
+#include "pluma-compression.h"
 #include "pluma-smart-charset-converter.h"
 #include "pluma-prefs-manager.h"
 #include "pluma-debug.h"
@@ -74,8 +76,34 @@ typedef struct
 static void	    pluma_gio_document_loader_load		(PlumaDocumentLoader *loader);
 static gboolean     pluma_gio_document_loader_cancel		(PlumaDocumentLoader *loader);
 static goffset      pluma_gio_document_loader_get_bytes_read	(PlumaDocumentLoader *loader);
+static void         pluma_gio_document_loader_resume		(PlumaDocumentLoader *loader);
 
 static void open_async_read (AsyncData *async);
+static void async_data_free (AsyncData *async);
+
+typedef struct
+{
+	PlumaGioDocumentLoader *loader;
+	GInputStream           *stream;
+	GOutputStream          *output;
+	goffset                 start;
+	GTimeVal                mtime;
+	gchar                   buffer[READ_CHUNK_SIZE];
+} AppendData;
+
+static void
+append_completed (GTask *task)
+{
+	AppendData *data = g_task_get_task_data (task);
+	GFileInfo *info = PLUMA_DOCUMENT_LOADER (data->loader)->info;
+
+	/* keep the info in sync with what was read */
+	if (info != NULL)
+		g_file_info_set_modification_time (info, &data->mtime);
+
+	g_task_return_int (task, data->loader->priv->raw_offset - data->start);
+	g_object_unref (task);
+}
 
 struct _PlumaGioDocumentLoaderPrivate
 {
@@ -84,14 +112,24 @@ struct _PlumaGioDocumentLoaderPrivate
 
 	goffset           bytes_read;
 
+	/* Offset in the file up to which it has been read, before the
+	 * charset conversion */
+	goffset           raw_offset;
+
 	/* Handle for remote files */
 	GCancellable 	 *cancellable;
 	GInputStream	 *stream;
 	GOutputStream    *output;
 	PlumaSmartCharsetConverter *converter;
 
+	/* The stream of the file itself, below the decompression */
+	GInputStream	 *file_stream;
+
 	gchar             buffer[READ_CHUNK_SIZE];
 
+	/* The read to issue when the loader is resumed */
+	AsyncData        *paused_read;
+
 	GError           *error;
 };
 
@@ -104,6 +142,12 @@ pluma_gio_document_loader_dispose (GObject *object)
 
 	priv = PLUMA_GIO_DOCUMENT_LOADER (object)->priv;
 
+	if (priv->paused_read != NULL)
+	{
+		async_data_free (priv->paused_read);
+		priv->paused_read = NULL;
+	}
+
 	if (priv->cancellable != NULL)
 	{
 		g_cancellable_cancel (priv->cancellable);
@@ -117,6 +161,12 @@ pluma_gio_document_loader_dispose (GObject *object)
 		priv->stream = NULL;
 	}
 
+	if (priv->file_stream != NULL)
+	{
+		g_object_unref (priv->file_stream);
+		priv->file_stream = NULL;
+	}
+
 	if (priv->output != NULL)
 	{
 		g_object_unref (priv->output);
@@ -155,6 +205,7 @@ pluma_gio_document_loader_class_init (PlumaGioDocumentLoaderClass *klass)
 	loader_class->load = pluma_gio_document_loader_load;
 	loader_class->cancel = pluma_gio_document_loader_cancel;
 	loader_class->get_bytes_read = pluma_gio_document_loader_get_bytes_read;
+	loader_class->resume = pluma_gio_document_loader_resume;
 
 	g_type_class_add_private (object_class, sizeof(PlumaGioDocumentLoaderPrivate));
 }
@@ -165,6 +216,7 @@ pluma_gio_document_loader_init (PlumaGioDocumentLoader *gvloader)
 	gvloader->priv = PLUMA_GIO_DOCUMENT_LOADER_GET_PRIVATE (gvloader);
 
 	gvloader->priv->converter = NULL;
+	gvloader->priv->paused_read = NULL;
 	gvloader->priv->error = NULL;
 }
 
@@ -290,7 +342,7 @@ write_complete (AsyncData *async)
 {
 	if (async->loader->priv->stream)
 		g_input_stream_close_async (G_INPUT_STREAM (async->loader->priv->stream),
-					    G_PRIORITY_HIGH,
+					    PLUMA_DOCUMENT_LOADER (async->loader)->io_priority,
 					    async->cancellable,
 					    (GAsyncReadyCallback)close_input_stream_ready_cb,
 					    async);
@@ -385,6 +437,11 @@ async_read_cb (GInputStream *stream,
 
 		loader = PLUMA_DOCUMENT_LOADER (gvloader);
 
+		/* remember where we stopped, for appending what gets
+		 * added to the file later */
+		if (G_IS_SEEKABLE (gvloader->priv->file_stream))
+			gvloader->priv->raw_offset = g_seekable_tell (G_SEEKABLE (gvloader->priv->file_stream));
+
 		g_output_stream_flush (gvloader->priv->output,
 				       NULL,
 				       &gvloader->priv->error);
@@ -423,10 +480,17 @@ read_file_chunk (AsyncData *async)
 	
 	gvloader = async->loader;
 
+	/* picked up again by pluma_gio_document_loader_resume */
+	if (PLUMA_DOCUMENT_LOADER (gvloader)->paused)
+	{
+		gvloader->priv->paused_read = async;
+		return;
+	}
+
 	g_input_stream_read_async (G_INPUT_STREAM (gvloader->priv->stream),
 				   gvloader->priv->buffer,
 				   READ_CHUNK_SIZE,
-				   G_PRIORITY_HIGH,
+				   PLUMA_DOCUMENT_LOADER (gvloader)->io_priority,
 				   async->cancellable,
 				   (GAsyncReadyCallback) async_read_cb,
 				   async);
@@ -450,31 +514,15 @@ get_candidate_encodings (PlumaGioDocumentLoader *gvloader)
 }
 
 static void
-finish_query_info (AsyncData *async)
+start_conversion (AsyncData *async)
 {
 	PlumaGioDocumentLoader *gvloader;
 	PlumaDocumentLoader *loader;
 	GInputStream *conv_stream;
-	GFileInfo *info;
 	GSList *candidate_encodings;
-	
+
 	gvloader = async->loader;
 	loader = PLUMA_DOCUMENT_LOADER (gvloader);
-	info = loader->info;
-
-	/* if it's not a regular file, error out... */
-	if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_TYPE) &&
-	    g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR)
-	{
-		g_set_error (&gvloader->priv->error,
-			     G_IO_ERROR,
-			     G_IO_ERROR_NOT_REGULAR_FILE,
-			     "Not a regular file");
-
-		remote_load_completed_or_failed (gvloader, async);
-
-		return;
-	}
 
 	/* Get the candidate encodings */
 	if (loader->encoding == NULL)
@@ -502,6 +550,122 @@ finish_query_info (AsyncData *async)
 	read_file_chunk (async);
 }
 
+static void
+fill_ready_cb (GBufferedInputStream *stream,
+	       GAsyncResult         *res,
+	       AsyncData            *async)
+{
+	PlumaGioDocumentLoader *gvloader;
+	PlumaDocumentLoader *loader;
+	GError *error = NULL;
+	const gchar *magic;
+	gsize length;
+	gssize read;
+
+	pluma_debug (DEBUG_LOADER);
+
+	/* manually check cancelled state */
+	if (g_cancellable_is_cancelled (async->cancellable))
+	{
+		async_data_free (async);
+		return;
+	}
+
+	gvloader = async->loader;
+	loader = PLUMA_DOCUMENT_LOADER (gvloader);
+
+	read = g_buffered_input_stream_fill_finish (stream, res, &error);
+
+	if (read == -1)
+	{
+		async_failed (async, error);
+		return;
+	}
+
+	/* remote files can come in smaller pieces */
+	if (read > 0 &&
+	    g_buffered_input_stream_get_available (stream) < PLUMA_COMPRESSION_MAGIC_LENGTH)
+	{
+		g_buffered_input_stream_fill_async (stream,
+						    PLUMA_COMPRESSION_MAGIC_LENGTH -
+						    g_buffered_input_stream_get_available (stream),
+						    loader->io_priority,
+						    async->cancellable,
+						    (GAsyncReadyCallback) fill_ready_cb,
+						    async);
+		return;
+	}
+
+	magic = g_buffered_input_stream_peek_buffer (stream, &length);
+
+	loader->auto_detected_compression_type =
+		pluma_compression_detect (magic, length);
+
+	if (loader->auto_detected_compression_type != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+	{
+		GConverter *decompressor;
+		GInputStream *decompressed;
+
+		pluma_debug_message (DEBUG_LOADER, "Compressed file: %d",
+				     loader->auto_detected_compression_type);
+
+		decompressor = pluma_compression_new_decompressor (loader->auto_detected_compression_type);
+
+		decompressed = g_converter_input_stream_new (gvloader->priv->stream,
+							     decompressor);
+		g_object_unref (decompressor);
+		g_object_unref (gvloader->priv->stream);
+
+		gvloader->priv->stream = decompressed;
+	}
+
+	start_conversion (async);
+}
+
+static void
+finish_query_info (AsyncData *async)
+{
+	PlumaGioDocumentLoader *gvloader;
+	PlumaDocumentLoader *loader;
+	GInputStream *buffered;
+	GFileInfo *info;
+
+	gvloader = async->loader;
+	loader = PLUMA_DOCUMENT_LOADER (gvloader);
+	info = loader->info;
+
+	/* if it's not a regular file, error out... */
+	if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_TYPE) &&
+	    g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR)
+	{
+		g_set_error (&gvloader->priv->error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_REGULAR_FILE,
+			     "Not a regular file");
+
+		remote_load_completed_or_failed (gvloader, async);
+
+		return;
+	}
+
+	gvloader->priv->file_stream = g_object_ref (gvloader->priv->stream);
+
+	/* look at the first bytes for the magic of a compressed file,
+	 * they stay in the buffer for the reads that follow */
+	buffered = g_buffered_input_stream_new_sized (gvloader->priv->stream,
+						      READ_CHUNK_SIZE);
+	g_object_unref (gvloader->priv->stream);
+
+	gvloader->priv->stream = buffered;
+
+	g_buffered_input_stream_fill_async (G_BUFFERED_INPUT_STREAM (buffered),
+					    PLUMA_COMPRESSION_MAGIC_LENGTH,
+					    loader->io_priority,
+					    async->cancellable,
+					    (GAsyncReadyCallback) fill_ready_cb,
+					    async);
+}
+
 static void
 query_info_cb (GFile        *source,
 	       GAsyncResult *res,
@@ -641,7 +805,7 @@ async_read_ready_callback (GObject      *source,
 	g_file_query_info_async (gvloader->priv->gfile,
 				 REMOTE_QUERY_ATTRIBUTES,
                                  G_FILE_QUERY_INFO_NONE,
-				 G_PRIORITY_HIGH,
+				 PLUMA_DOCUMENT_LOADER (gvloader)->io_priority,
 				 async->cancellable,
 				 (GAsyncReadyCallback) query_info_cb,
 				 async);
@@ -651,7 +815,7 @@ static void
 open_async_read (AsyncData *async)
 {
 	g_file_read_async (async->loader->priv->gfile, 
-	                   G_PRIORITY_HIGH,
+	                   PLUMA_DOCUMENT_LOADER (async->loader)->io_priority,
 	                   async->cancellable,
 	                   (GAsyncReadyCallback) async_read_ready_callback,
 	                   async);
@@ -684,7 +848,33 @@ pluma_gio_document_loader_load (PlumaDocumentLoader *loader)
 static goffset
 pluma_gio_document_loader_get_bytes_read (PlumaDocumentLoader *loader)
 {
-	return PLUMA_GIO_DOCUMENT_LOADER (loader)->priv->bytes_read;
+	PlumaGioDocumentLoaderPrivate *priv = PLUMA_GIO_DOCUMENT_LOADER (loader)->priv;
+
+	/* the progress is against the size of the file, not of the
+	 * decompressed text */
+	if (loader->auto_detected_compression_type != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE &&
+	    G_IS_SEEKABLE (priv->file_stream))
+	{
+		return g_seekable_tell (G_SEEKABLE (priv->file_stream));
+	}
+
+	return priv->bytes_read;
+}
+
+static void
+pluma_gio_document_loader_resume (PlumaDocumentLoader *loader)
+{
+	PlumaGioDocumentLoader *gvloader = PLUMA_GIO_DOCUMENT_LOADER (loader);
+	AsyncData *async;
+
+	async = gvloader->priv->paused_read;
+
+	if (async == NULL)
+		return;
+
+	gvloader->priv->paused_read = NULL;
+
+	read_file_chunk (async);
 }
 
 static gboolean
@@ -697,6 +887,13 @@ pluma_gio_document_loader_cancel (PlumaDocumentLoader *loader)
 
 	g_cancellable_cancel (gvloader->priv->cancellable);
 
+	/* no callback is pending to free it */
+	if (gvloader->priv->paused_read != NULL)
+	{
+		async_data_free (gvloader->priv->paused_read);
+		gvloader->priv->paused_read = NULL;
+	}
+
 	g_set_error (&gvloader->priv->error,
 		     G_IO_ERROR,
 		     G_IO_ERROR_CANCELLED,
@@ -706,3 +903,266 @@ pluma_gio_document_loader_cancel (PlumaDocumentLoader *loader)
 
 	return TRUE;
 }
+
+static void
+append_data_free (AppendData *data)
+{
+	if (data->stream != NULL)
+		g_object_unref (data->stream);
+
+	if (data->output != NULL)
+		g_object_unref (data->output);
+
+	g_object_unref (data->loader);
+	g_slice_free (AppendData, data);
+}
+
+static void append_read_chunk (GTask *task);
+
+static void
+append_failed (GTask  *task,
+	       GError *error)
+{
+	AppendData *data = g_task_get_task_data (task);
+
+	/* balance the not undoable action of the document stream */
+	if (data->output != NULL)
+		g_output_stream_close (data->output, NULL, NULL);
+
+	g_task_return_error (task, error);
+	g_object_unref (task);
+}
+
+static void
+append_read_cb (GInputStream *stream,
+		GAsyncResult *res,
+		GTask        *task)
+{
+	AppendData *data;
+	PlumaGioDocumentLoaderPrivate *priv;
+	GInputStream *base;
+	gssize read;
+	GError *error = NULL;
+
+	data = g_task_get_task_data (task);
+	priv = data->loader->priv;
+
+	read = g_input_stream_read_finish (stream, res, &error);
+
+	if (read == -1)
+	{
+		append_failed (task, error);
+		return;
+	}
+
+	if (read > 0)
+	{
+		/* the document stream is in memory, see write_file_chunk */
+		if (g_output_stream_write (data->output,
+					   data->buffer,
+					   read,
+					   g_task_get_cancellable (task),
+					   &error) == -1)
+		{
+			append_failed (task, error);
+			return;
+		}
+
+		priv->bytes_read += read;
+
+		append_read_chunk (task);
+		return;
+	}
+
+	base = g_filter_input_stream_get_base_stream (G_FILTER_INPUT_STREAM (stream));
+	priv->raw_offset = g_seekable_tell (G_SEEKABLE (base));
+
+	g_input_stream_close (data->stream, NULL, NULL);
+
+	if (!g_output_stream_close (data->output, NULL, &error))
+	{
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	/* the new stream knows the terminator to write before the
+	 * next chunk */
+	g_object_unref (priv->output);
+	priv->output = g_object_ref (data->output);
+
+	append_completed (task);
+}
+
+static void
+append_read_chunk (GTask *task)
+{
+	AppendData *data = g_task_get_task_data (task);
+
+	g_input_stream_read_async (data->stream,
+				   data->buffer,
+				   READ_CHUNK_SIZE,
+				   G_PRIORITY_DEFAULT,
+				   g_task_get_cancellable (task),
+				   (GAsyncReadyCallback) append_read_cb,
+				   task);
+}
+
+static void
+append_open_cb (GFile        *gfile,
+		GAsyncResult *res,
+		GTask        *task)
+{
+	AppendData *data;
+	PlumaGioDocumentLoaderPrivate *priv;
+	GFileInputStream *file_stream;
+	GFileInfo *info;
+	const gchar *ending_newline;
+	GError *error = NULL;
+
+	data = g_task_get_task_data (task);
+	priv = data->loader->priv;
+
+	file_stream = g_file_read_finish (gfile, res, &error);
+
+	if (file_stream == NULL)
+	{
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	/* fstat, does not block like a query on the file would */
+	info = g_file_input_stream_query_info (file_stream,
+					       G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+					       G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					       NULL,
+					       &error);
+
+	if (info == NULL)
+	{
+		g_object_unref (file_stream);
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	if (g_file_info_get_size (info) < priv->raw_offset)
+	{
+		/* truncated or replaced: the caller has to reload it all */
+		g_object_unref (info);
+		g_object_unref (file_stream);
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+					 "The file was truncated");
+		g_object_unref (task);
+		return;
+	}
+
+	g_file_info_get_modification_time (info, &data->mtime);
+
+	if (g_file_info_get_size (info) == priv->raw_offset)
+	{
+		g_object_unref (info);
+		g_object_unref (file_stream);
+		append_completed (task);
+		return;
+	}
+
+	g_object_unref (info);
+
+	if (!g_seekable_seek (G_SEEKABLE (file_stream),
+			      priv->raw_offset,
+			      G_SEEK_SET,
+			      g_task_get_cancellable (task),
+			      &error))
+	{
+		g_object_unref (file_stream);
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	/* keep converting with the encoding detected by the first load */
+	data->stream = g_converter_input_stream_new (G_INPUT_STREAM (file_stream),
+						     G_CONVERTER (priv->converter));
+	g_object_unref (file_stream);
+
+	data->output = pluma_document_output_stream_new_for_append (PLUMA_DOCUMENT_LOADER (data->loader)->document);
+
+	ending_newline = pluma_document_output_stream_get_ending_newline (PLUMA_DOCUMENT_OUTPUT_STREAM (priv->output));
+
+	if (ending_newline != NULL &&
+	    g_output_stream_write (data->output,
+				   ending_newline,
+				   strlen (ending_newline),
+				   NULL,
+				   &error) == -1)
+	{
+		append_failed (task, error);
+		return;
+	}
+
+	append_read_chunk (task);
+}
+
+/**
+ * pluma_gio_document_loader_append_async:
+ * @loader: a #PlumaGioDocumentLoader which completed loading its file
+ * @cancellable: (allow-none): a #GCancellable
+ * @callback: called when the new content has been appended
+ * @user_data: data for @callback
+ *
+ * Reads what has been added to the file since it was last read and
+ * appends it to the document, converted with the same charset converter.
+ * Like loading, this is not recorded in the undo history.
+ */
+void
+pluma_gio_document_loader_append_async (PlumaGioDocumentLoader *loader,
+					GCancellable           *cancellable,
+					GAsyncReadyCallback     callback,
+					gpointer                user_data)
+{
+	GTask *task;
+	AppendData *data;
+
+	g_return_if_fail (PLUMA_IS_GIO_DOCUMENT_LOADER (loader));
+	g_return_if_fail (loader->priv->output != NULL);
+	/* a compressed file cannot be read from the middle */
+	g_return_if_fail (PLUMA_DOCUMENT_LOADER (loader)->auto_detected_compression_type ==
+			  PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE);
+
+	pluma_debug (DEBUG_LOADER);
+
+	task = g_task_new (loader, cancellable, callback, user_data);
+
+	data = g_slice_new0 (AppendData);
+	data->loader = g_object_ref (loader);
+	data->start = loader->priv->raw_offset;
+	g_task_set_task_data (task, data, (GDestroyNotify) append_data_free);
+
+	g_file_read_async (loader->priv->gfile,
+			   G_PRIORITY_DEFAULT,
+			   cancellable,
+			   (GAsyncReadyCallback) append_open_cb,
+			   task);
+}
+
+/**
+ * pluma_gio_document_loader_append_finish:
+ * @loader: a #PlumaGioDocumentLoader
+ * @result: the #GAsyncResult
+ * @error: return location for a #GError
+ *
+ * Returns: the number of bytes read from the file, or -1 on error. The
+ * error is %G_IO_ERROR_INVALID_DATA when the file shrank, in which case
+ * it has to be loaded again.
+ */
+gssize
+pluma_gio_document_loader_append_finish (PlumaGioDocumentLoader  *loader,
+					 GAsyncResult            *result,
+					 GError                 **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, loader), -1);
+
+	return g_task_propagate_int (G_TASK (result), error);
+}
@@ -74,6 +74,15 @@ typedef PlumaDocumentLoaderClass PlumaGioDocumentLoaderClass;
  */
 GType 		 	 pluma_gio_document_loader_get_type	(void) G_GNUC_CONST;
 
+void			 pluma_gio_document_loader_append_async	(PlumaGioDocumentLoader  *loader,
+								 GCancellable            *cancellable,
+								 GAsyncReadyCallback      callback,
+								 gpointer                 user_data);
+
+gssize			 pluma_gio_document_loader_append_finish (PlumaGioDocumentLoader  *loader,
+								 GAsyncResult            *result,
+								 GError                 **error);
+
 G_END_DECLS
 
 #endif  /* __PLUMA_GIO_DOCUMENT_LOADER_H__  */
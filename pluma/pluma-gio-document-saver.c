@@ -39,6 +39,7 @@
 
 #include "pluma-gio-document-saver.h"
 #include "pluma-document-input-stream.h"
+#include "pluma-compression.h"
 #include "pluma-debug.h"
 
 #define WRITE_CHUNK_SIZE 8192
@@ -503,6 +504,7 @@ async_replace_ready_callback (GFile        *source,
 	PlumaDocumentSaver *saver;
 	GCharsetConverter *converter;
 	GFileOutputStream *file_stream;
+	GOutputStream *base_stream;
 	GError *error = NULL;
 
 	pluma_debug (DEBUG_SAVER);
@@ -526,6 +528,25 @@ async_replace_ready_callback (GFile        *source,
 		return;
 	}
 
+	base_stream = G_OUTPUT_STREAM (file_stream);
+
+	/* the text is compressed after the charset conversion */
+	if (saver->compression_type != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE)
+	{
+		GConverter *compressor;
+
+		pluma_debug_message (DEBUG_SAVER, "Compression: %d", saver->compression_type);
+
+		/* never NULL, the document only takes the supported ones */
+		compressor = pluma_compression_new_compressor (saver->compression_type);
+
+		base_stream = g_converter_output_stream_new (G_OUTPUT_STREAM (file_stream),
+							     compressor);
+
+		g_object_unref (file_stream);
+		g_object_unref (compressor);
+	}
+
 	/* FIXME: manage converter error? */
 	pluma_debug_message (DEBUG_SAVER, "Encoding charset: %s",
 			     pluma_encoding_get_charset (saver->encoding));
@@ -535,15 +556,15 @@ async_replace_ready_callback (GFile        *source,
 		converter = g_charset_converter_new (pluma_encoding_get_charset (saver->encoding),
 						     "UTF-8",
 						     NULL);
-		gvsaver->priv->stream = g_converter_output_stream_new (G_OUTPUT_STREAM (file_stream),
+		gvsaver->priv->stream = g_converter_output_stream_new (base_stream,
 								       G_CONVERTER (converter));
 
-		g_object_unref (file_stream);
+		g_object_unref (base_stream);
 		g_object_unref (converter);
 	}
 	else
 	{
-		gvsaver->priv->stream = G_OUTPUT_STREAM (file_stream);
+		gvsaver->priv->stream = base_stream;
 	}
 	
 	gvsaver->priv->input = pluma_document_input_stream_new (GTK_TEXT_BUFFER (saver->document),
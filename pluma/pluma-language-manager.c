@@ -88,3 +88,273 @@ pluma_language_manager_list_languages_sorted (GtkSourceLanguageManager *lm,
 	return g_slist_sort (languages, (GCompareFunc)language_compare);
 }
 
+
+/*
+ * gtk_source_language_manager_guess_language() matches the file name
+ * against the globs of every language each time. Its result only depends
+ * on the languages whose globs match and on the content type, so the
+ * globs are sorted once into tables, and the results are remembered for
+ * each set of matching languages and content type.
+ */
+
+#define GUESS_CACHE_KEY "pluma-language-guess-cache"
+
+typedef struct
+{
+	/* "*.ext" globs: extension -> GArray of language indexes */
+	GHashTable *extensions;
+	/* globs without wildcards: basename -> GArray of language indexes */
+	GHashTable *basenames;
+	/* anything else */
+	GPtrArray  *patterns;
+	GArray     *pattern_langs;
+
+	/* key -> GtkSourceLanguage, NULL values for no language */
+	GHashTable *results;
+} GuessCache;
+
+static void
+guess_cache_free (GuessCache *cache)
+{
+	g_hash_table_destroy (cache->extensions);
+	g_hash_table_destroy (cache->basenames);
+	g_ptr_array_free (cache->patterns, TRUE);
+	g_array_free (cache->pattern_langs, TRUE);
+	g_hash_table_destroy (cache->results);
+	g_slice_free (GuessCache, cache);
+}
+
+static void
+add_glob_lang (GHashTable  *table,
+	       const gchar *key,
+	       gint         lang)
+{
+	GArray *langs;
+
+	langs = g_hash_table_lookup (table, key);
+
+	if (langs == NULL)
+	{
+		langs = g_array_new (FALSE, FALSE, sizeof (gint));
+		g_hash_table_insert (table, g_strdup (key), langs);
+	}
+
+	/* a language may have the same glob twice */
+	if (langs->len == 0 || g_array_index (langs, gint, langs->len - 1) != lang)
+		g_array_append_val (langs, lang);
+}
+
+static gboolean
+has_wildcards (const gchar *glob)
+{
+	return strpbrk (glob, "*?[") != NULL;
+}
+
+static GuessCache *
+guess_cache_new (GtkSourceLanguageManager *lm)
+{
+	GuessCache *cache;
+	const gchar * const *ids;
+	gint i;
+
+	pluma_debug_span_begin (DEBUG_DOCUMENT, "language-glob-table");
+
+	cache = g_slice_new0 (GuessCache);
+	cache->extensions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						   (GDestroyNotify) g_array_unref);
+	cache->basenames = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						  (GDestroyNotify) g_array_unref);
+	cache->patterns = g_ptr_array_new_with_free_func ((GDestroyNotify) g_pattern_spec_free);
+	cache->pattern_langs = g_array_new (FALSE, FALSE, sizeof (gint));
+	cache->results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	ids = gtk_source_language_manager_get_language_ids (lm);
+
+	for (i = 0; ids != NULL && ids[i] != NULL; i++)
+	{
+		GtkSourceLanguage *lang;
+		gchar **globs;
+		gint j;
+
+		lang = gtk_source_language_manager_get_language (lm, ids[i]);
+		globs = gtk_source_language_get_globs (lang);
+
+		for (j = 0; globs != NULL && globs[j] != NULL; j++)
+		{
+			const gchar *glob = globs[j];
+
+			if (glob[0] == '*' && glob[1] == '.' && !has_wildcards (glob + 2))
+			{
+				add_glob_lang (cache->extensions, glob + 2, i);
+			}
+			else if (!has_wildcards (glob))
+			{
+				add_glob_lang (cache->basenames, glob, i);
+			}
+			else
+			{
+				g_ptr_array_add (cache->patterns, g_pattern_spec_new (glob));
+				g_array_append_val (cache->pattern_langs, i);
+			}
+		}
+
+		g_strfreev (globs);
+	}
+
+	pluma_debug_span_end (DEBUG_DOCUMENT, "language-glob-table");
+
+	return cache;
+}
+
+static void
+language_ids_changed (GtkSourceLanguageManager *lm)
+{
+	g_object_set_data (G_OBJECT (lm), GUESS_CACHE_KEY, NULL);
+}
+
+static GuessCache *
+get_guess_cache (GtkSourceLanguageManager *lm)
+{
+	GuessCache *cache;
+
+	cache = g_object_get_data (G_OBJECT (lm), GUESS_CACHE_KEY);
+
+	if (cache == NULL)
+	{
+		cache = guess_cache_new (lm);
+
+		g_object_set_data_full (G_OBJECT (lm),
+					GUESS_CACHE_KEY,
+					cache,
+					(GDestroyNotify) guess_cache_free);
+
+		if (g_signal_handler_find (lm, G_SIGNAL_MATCH_FUNC, 0, 0, NULL,
+					   language_ids_changed, NULL) == 0)
+		{
+			g_signal_connect (lm,
+					  "notify::language-ids",
+					  G_CALLBACK (language_ids_changed),
+					  NULL);
+		}
+	}
+
+	return cache;
+}
+
+static void
+add_matches (GArray *matches,
+	     GArray *langs)
+{
+	if (langs != NULL)
+		g_array_append_vals (matches, langs->data, langs->len);
+}
+
+static gint
+compare_indexes (gconstpointer a,
+		 gconstpointer b)
+{
+	return *(const gint *) a - *(const gint *) b;
+}
+
+/* Sorted indexes of the languages with a glob matching @filename */
+static GArray *
+match_filename (GuessCache  *cache,
+		const gchar *filename)
+{
+	GArray *matches;
+	const gchar *p;
+	guint i;
+	guint len;
+
+	matches = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	add_matches (matches, g_hash_table_lookup (cache->basenames, filename));
+
+	/* "*.in" and "*.spec.in" both match "foo.spec.in" */
+	for (p = strchr (filename + 1, '.'); p != NULL; p = strchr (p + 1, '.'))
+		add_matches (matches, g_hash_table_lookup (cache->extensions, p + 1));
+
+	if (filename[0] == '.')
+		add_matches (matches, g_hash_table_lookup (cache->extensions, filename + 1));
+
+	len = strlen (filename);
+
+	for (i = 0; i < cache->patterns->len; i++)
+	{
+		if (g_pattern_match (g_ptr_array_index (cache->patterns, i), len, filename, NULL))
+			g_array_append_val (matches, g_array_index (cache->pattern_langs, gint, i));
+	}
+
+	g_array_sort (matches, compare_indexes);
+
+	return matches;
+}
+
+/**
+ * pluma_language_manager_guess_language:
+ * @lm: a #GtkSourceLanguageManager
+ * @filename: (allow-none): a file name
+ * @content_type: (allow-none): a content type
+ *
+ * Same as gtk_source_language_manager_guess_language(), but cached.
+ *
+ * Returns: (transfer none): a #GtkSourceLanguage, or %NULL
+ */
+GtkSourceLanguage *
+pluma_language_manager_guess_language (GtkSourceLanguageManager *lm,
+				       const gchar              *filename,
+				       const gchar              *content_type)
+{
+	GuessCache *cache;
+	GString *key;
+	GtkSourceLanguage *lang;
+	gpointer value;
+
+	g_return_val_if_fail (GTK_SOURCE_IS_LANGUAGE_MANAGER (lm), NULL);
+
+	cache = get_guess_cache (lm);
+
+	key = g_string_new (content_type);
+	g_string_append_c (key, '\n');
+
+	if (filename != NULL && *filename != '\0')
+	{
+		gchar *display_name;
+		GArray *matches;
+		gint prev = -1;
+		guint i;
+
+		display_name = g_filename_display_name (filename);
+		matches = match_filename (cache, display_name);
+		g_free (display_name);
+
+		for (i = 0; i < matches->len; i++)
+		{
+			gint lang_index = g_array_index (matches, gint, i);
+
+			if (lang_index != prev)
+				g_string_append_printf (key, "%d,", lang_index);
+
+			prev = lang_index;
+		}
+
+		g_array_free (matches, TRUE);
+	}
+
+	if (g_hash_table_lookup_extended (cache->results, key->str, NULL, &value))
+	{
+		g_string_free (key, TRUE);
+
+		return value;
+	}
+
+	lang = gtk_source_language_manager_guess_language (lm, filename, content_type);
+
+	pluma_debug_message (DEBUG_DOCUMENT, "Guessed language for %s: %s",
+			     key->str,
+			     lang != NULL ? gtk_source_language_get_id (lang) : "none");
+
+	g_hash_table_insert (cache->results, g_string_free (key, FALSE), lang);
+
+	return lang;
+}
@@ -43,6 +43,11 @@ GSList				*pluma_language_manager_list_languages_sorted
 								(GtkSourceLanguageManager	*lm,
 								 gboolean			 include_hidden);
 
+GtkSourceLanguage		*pluma_language_manager_guess_language
+								(GtkSourceLanguageManager	*lm,
+								 const gchar			*filename,
+								 const gchar			*content_type);
+
 G_END_DECLS
 
 #endif /* __PLUMA_LANGUAGES_MANAGER_H__ */
@@ -0,0 +1,394 @@
+/*
+ * pluma-line-diff.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "pluma-line-diff.h"
+
+/*
+ * A line based diff, used to reload a document by editing only the lines
+ * that changed on disk. The common head and tail are skipped first, the
+ * rest is compared with the Myers O(ND) algorithm. It only works on bytes
+ * and can run in a worker thread.
+ */
+
+typedef struct
+{
+	const gchar *text;
+	gsize        len;	/* including the '\n', if any */
+	guint        hash;
+} Line;
+
+typedef struct
+{
+	gint x;
+	gint y;
+	gint len;
+} Snake;
+
+typedef struct
+{
+	const Line *lines;
+	gint        line;
+	gint        offset;
+} CharCursor;
+
+static guint
+hash_line (const gchar *text,
+	   gsize        len)
+{
+	guint hash = 2166136261u;
+	gsize i;
+
+	for (i = 0; i < len; i++)
+	{
+		hash ^= (guchar) text[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static GArray *
+split_lines (const gchar *text,
+	     gsize        len)
+{
+	GArray *lines;
+	const gchar *p = text;
+	const gchar *end = text + len;
+
+	lines = g_array_new (FALSE, FALSE, sizeof (Line));
+
+	while (p < end)
+	{
+		const gchar *nl;
+		Line line;
+
+		nl = memchr (p, '\n', end - p);
+
+		line.text = p;
+		line.len = (nl != NULL ? nl + 1 : end) - p;
+		line.hash = hash_line (p, line.len);
+
+		g_array_append_val (lines, line);
+
+		p += line.len;
+	}
+
+	return lines;
+}
+
+static inline gboolean
+lines_equal (const Line *a,
+	     const Line *b)
+{
+	return (a->hash == b->hash) &&
+	       (a->len == b->len) &&
+	       (memcmp (a->text, b->text, a->len) == 0);
+}
+
+/* Returns the common runs of @a and @b in order, or NULL if they differ by
+ * more than @max_d inserted and removed lines */
+static GArray *
+find_snakes (const Line *a,
+	     gint        n,
+	     const Line *b,
+	     gint        m,
+	     gint        max_d)
+{
+	GPtrArray *trace;
+	GArray *snakes = NULL;
+	gint *v;
+	gint offset;
+	gint max;
+	gint d;
+	gint k;
+	gint x, y;
+	gint found = -1;
+
+	max = MIN (n + m, max_d);
+	offset = max + 1;
+
+	v = g_new0 (gint, 2 * max + 3);
+	trace = g_ptr_array_new_with_free_func (g_free);
+
+	for (d = 0; d <= max && found < 0; d++)
+	{
+		gint *saved;
+
+		for (k = -d; k <= d; k += 2)
+		{
+			if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+				x = v[offset + k + 1];
+			else
+				x = v[offset + k - 1] + 1;
+
+			y = x - k;
+
+			while (x < n && y < m && lines_equal (&a[x], &b[y]))
+			{
+				++x;
+				++y;
+			}
+
+			v[offset + k] = x;
+
+			if (x >= n && y >= m)
+			{
+				found = d;
+				break;
+			}
+		}
+
+		saved = g_new (gint, 2 * d + 1);
+		memcpy (saved, &v[offset - d], (2 * d + 1) * sizeof (gint));
+		g_ptr_array_add (trace, saved);
+	}
+
+	if (found >= 0)
+	{
+		snakes = g_array_new (FALSE, FALSE, sizeof (Snake));
+
+		x = n;
+		y = m;
+
+		/* walk back from the end, collecting the diagonals */
+		for (d = found; d > 0; d--)
+		{
+			const gint *prev = g_ptr_array_index (trace, d - 1);
+			gint pd = d - 1;
+			gint prev_k;
+			gint prev_x;
+			gint mid_x;
+
+			k = x - y;
+
+			if (k == -d || (k != d && prev[k - 1 + pd] < prev[k + 1 + pd]))
+				prev_k = k + 1;
+			else
+				prev_k = k - 1;
+
+			prev_x = prev[prev_k + pd];
+
+			mid_x = (prev_k == k + 1) ? prev_x : prev_x + 1;
+
+			if (x > mid_x)
+			{
+				Snake snake = { mid_x, mid_x - k, x - mid_x };
+
+				g_array_append_val (snakes, snake);
+			}
+
+			x = prev_x;
+			y = prev_x - prev_k;
+		}
+
+		if (x > 0)
+		{
+			Snake snake = { 0, 0, x };
+
+			g_array_append_val (snakes, snake);
+		}
+	}
+
+	g_ptr_array_free (trace, TRUE);
+	g_free (v);
+
+	return snakes;
+}
+
+static void
+advance_cursor (CharCursor *cursor,
+		gint        line)
+{
+	while (cursor->line < line)
+	{
+		const Line *l = &cursor->lines[cursor->line];
+
+		cursor->offset += g_utf8_strlen (l->text, l->len);
+		cursor->line++;
+	}
+}
+
+static void
+hunk_free (PlumaLineDiffHunk *hunk)
+{
+	g_free (hunk->new_text);
+	g_slice_free (PlumaLineDiffHunk, hunk);
+}
+
+static void
+add_hunk (GPtrArray  *hunks,
+	  CharCursor *cursor,
+	  const Line *b,
+	  gint        a_start,
+	  gint        a_end,
+	  gint        b_start,
+	  gint        b_end)
+{
+	PlumaLineDiffHunk *hunk;
+
+	hunk = g_slice_new (PlumaLineDiffHunk);
+
+	advance_cursor (cursor, a_start);
+	hunk->old_offset = cursor->offset;
+
+	advance_cursor (cursor, a_end);
+	hunk->old_length = cursor->offset - hunk->old_offset;
+
+	if (b_end > b_start)
+	{
+		const Line *last = &b[b_end - 1];
+
+		hunk->new_text = g_strndup (b[b_start].text,
+					    last->text + last->len - b[b_start].text);
+	}
+	else
+	{
+		hunk->new_text = g_strdup ("");
+	}
+
+	g_ptr_array_add (hunks, hunk);
+}
+
+/**
+ * pluma_line_diff:
+ * @old_text: the current text
+ * @old_len: length of @old_text in bytes, or -1 if nul terminated
+ * @new_text: the text to turn @old_text into
+ * @new_len: length of @new_text in bytes, or -1 if nul terminated
+ * @max_edits: maximum number of inserted plus removed lines to look for
+ *
+ * Compares the two UTF-8 texts line by line. When they differ by more than
+ * @max_edits lines, everything between the common head and tail is returned
+ * as a single hunk.
+ *
+ * Returns: a #GPtrArray of #PlumaLineDiffHunk, ordered by offset
+ */
+GPtrArray *
+pluma_line_diff (const gchar *old_text,
+		 gssize       old_len,
+		 const gchar *new_text,
+		 gssize       new_len,
+		 guint        max_edits)
+{
+	GPtrArray *hunks;
+	GArray *a_lines;
+	GArray *b_lines;
+	const Line *a;
+	const Line *b;
+	gint n_a, n_b;
+	gint prefix, suffix;
+	gint n, m;
+
+	g_return_val_if_fail (old_text != NULL, NULL);
+	g_return_val_if_fail (new_text != NULL, NULL);
+
+	if (old_len < 0)
+		old_len = strlen (old_text);
+	if (new_len < 0)
+		new_len = strlen (new_text);
+
+	hunks = g_ptr_array_new_with_free_func ((GDestroyNotify) hunk_free);
+
+	a_lines = split_lines (old_text, old_len);
+	b_lines = split_lines (new_text, new_len);
+
+	a = (const Line *) a_lines->data;
+	b = (const Line *) b_lines->data;
+	n_a = a_lines->len;
+	n_b = b_lines->len;
+
+	prefix = 0;
+	while (prefix < n_a && prefix < n_b &&
+	       lines_equal (&a[prefix], &b[prefix]))
+	{
+		++prefix;
+	}
+
+	suffix = 0;
+	while (suffix < n_a - prefix && suffix < n_b - prefix &&
+	       lines_equal (&a[n_a - 1 - suffix], &b[n_b - 1 - suffix]))
+	{
+		++suffix;
+	}
+
+	n = n_a - prefix - suffix;
+	m = n_b - prefix - suffix;
+
+	if (n > 0 || m > 0)
+	{
+		CharCursor cursor = { a, 0, 0 };
+		GArray *snakes;
+
+		snakes = find_snakes (a + prefix, n,
+				      b + prefix, m,
+				      MIN (max_edits, G_MAXINT / 2 - 2));
+
+		if (snakes != NULL)
+		{
+			gint pos_a = 0;
+			gint pos_b = 0;
+			gint i;
+
+			/* the snakes were collected from the end */
+			for (i = snakes->len - 1; i >= 0; i--)
+			{
+				const Snake *snake = &g_array_index (snakes, Snake, i);
+
+				if (snake->x > pos_a || snake->y > pos_b)
+				{
+					add_hunk (hunks, &cursor, b,
+						  prefix + pos_a, prefix + snake->x,
+						  prefix + pos_b, prefix + snake->y);
+				}
+
+				pos_a = snake->x + snake->len;
+				pos_b = snake->y + snake->len;
+			}
+
+			if (pos_a < n || pos_b < m)
+			{
+				add_hunk (hunks, &cursor, b,
+					  prefix + pos_a, prefix + n,
+					  prefix + pos_b, prefix + m);
+			}
+
+			g_array_free (snakes, TRUE);
+		}
+		else
+		{
+			add_hunk (hunks, &cursor, b,
+				  prefix, prefix + n,
+				  prefix, prefix + m);
+		}
+	}
+
+	g_array_free (a_lines, TRUE);
+	g_array_free (b_lines, TRUE);
+
+	return hunks;
+}
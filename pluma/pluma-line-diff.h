@@ -0,0 +1,52 @@
+/*
+ * pluma-line-diff.h
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef __PLUMA_LINE_DIFF_H__
+#define __PLUMA_LINE_DIFF_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _PlumaLineDiffHunk PlumaLineDiffHunk;
+
+/*
+ * Replace @old_length characters starting at character @old_offset of the
+ * old text with @new_text. Offsets always refer to the old text, so hunks
+ * have to be applied from the last to the first.
+ */
+struct _PlumaLineDiffHunk
+{
+	gint   old_offset;
+	gint   old_length;
+	gchar *new_text;
+};
+
+GPtrArray	*pluma_line_diff	(const gchar *old_text,
+					 gssize       old_len,
+					 const gchar *new_text,
+					 gssize       new_len,
+					 guint        max_edits);
+
+G_END_DECLS
+
+#endif /* __PLUMA_LINE_DIFF_H__ */
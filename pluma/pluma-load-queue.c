@@ -0,0 +1,417 @@
+/*
+ * pluma-load-queue.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "pluma-load-queue.h"
+#include "pluma-tab.h"
+#include "pluma-document.h"
+#include "pluma-debug.h"
+
+/*
+ * Schedules the loads of the tabs of a window. Tabs are created with their
+ * load deferred (see _pluma_tab_new_from_uri_deferred) and queued here when
+ * added to the window. The active tab is loaded right away at high
+ * priority; the others are loaded in the order they were opened, at most
+ * MAX_CONCURRENT_LOADS at a time and at a priority below the redraws and
+ * the input handling. While the user types, the reads of the background
+ * loads are paused.
+ */
+
+#define PLUMA_LOAD_QUEUE_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE((object), PLUMA_TYPE_LOAD_QUEUE, PlumaLoadQueuePrivate))
+
+/* How many documents are loaded at the same time, the active one apart */
+#define MAX_CONCURRENT_LOADS	4
+
+/* I/O priority of the documents which are not visible */
+#define BACKGROUND_PRIORITY	G_PRIORITY_DEFAULT_IDLE
+
+/* The background loads are resumed this many ms after the last keystroke */
+#define TYPING_PAUSE		750
+
+struct _PlumaLoadQueuePrivate
+{
+	/* The window owns the queue */
+	PlumaWindow *window;
+
+	/* Tabs still waiting to be loaded, oldest first */
+	GQueue       pending;
+
+	guint        update_id;
+
+	guint        typing_id;
+	gint64       last_key_time;
+
+	/* Whether "drained" has to be emitted */
+	guint        busy : 1;
+};
+
+enum
+{
+	DRAINED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (PlumaLoadQueue, pluma_load_queue, G_TYPE_OBJECT)
+
+static void
+pluma_load_queue_dispose (GObject *object)
+{
+	PlumaLoadQueue *queue = PLUMA_LOAD_QUEUE (object);
+
+	if (queue->priv->update_id != 0)
+	{
+		g_source_remove (queue->priv->update_id);
+		queue->priv->update_id = 0;
+	}
+
+	if (queue->priv->typing_id != 0)
+	{
+		g_source_remove (queue->priv->typing_id);
+		queue->priv->typing_id = 0;
+	}
+
+	g_queue_foreach (&queue->priv->pending, (GFunc) g_object_unref, NULL);
+	g_queue_clear (&queue->priv->pending);
+
+	G_OBJECT_CLASS (pluma_load_queue_parent_class)->dispose (object);
+}
+
+static void
+pluma_load_queue_class_init (PlumaLoadQueueClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = pluma_load_queue_dispose;
+
+	/* Emitted when all the queued tabs have been loaded */
+	signals[DRAINED] =
+		g_signal_new ("drained",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaLoadQueueClass, drained),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+
+	g_type_class_add_private (object_class, sizeof (PlumaLoadQueuePrivate));
+}
+
+static void
+pluma_load_queue_init (PlumaLoadQueue *queue)
+{
+	queue->priv = PLUMA_LOAD_QUEUE_GET_PRIVATE (queue);
+
+	g_queue_init (&queue->priv->pending);
+}
+
+static gboolean
+is_typing (PlumaLoadQueue *queue)
+{
+	return queue->priv->typing_id != 0;
+}
+
+static gboolean
+tab_is_loading (PlumaTab *tab)
+{
+	PlumaTabState state;
+
+	if (_pluma_tab_is_load_deferred (tab))
+		return FALSE;
+
+	state = pluma_tab_get_state (tab);
+
+	return state == PLUMA_TAB_STATE_LOADING ||
+	       state == PLUMA_TAB_STATE_REVERTING;
+}
+
+static void
+set_tab_priority (PlumaLoadQueue *queue,
+		  PlumaTab       *tab,
+		  PlumaTab       *active)
+{
+	PlumaDocument *doc;
+
+	doc = pluma_tab_get_document (tab);
+
+	if (tab == active)
+		_pluma_document_set_load_priority (doc, G_PRIORITY_HIGH, FALSE);
+	else
+		_pluma_document_set_load_priority (doc,
+						   BACKGROUND_PRIORITY,
+						   is_typing (queue));
+}
+
+/* Returns the number of tabs being loaded */
+static gint
+update_priorities (PlumaLoadQueue *queue)
+{
+	PlumaTab *active;
+	GList *tabs, *l;
+	gint n_loading = 0;
+
+	active = pluma_window_get_active_tab (queue->priv->window);
+
+	tabs = gtk_container_get_children (GTK_CONTAINER (_pluma_window_get_notebook (queue->priv->window)));
+
+	for (l = tabs; l != NULL; l = g_list_next (l))
+	{
+		PlumaTab *tab = PLUMA_TAB (l->data);
+
+		if (!tab_is_loading (tab))
+			continue;
+
+		set_tab_priority (queue, tab, active);
+		++n_loading;
+	}
+
+	g_list_free (tabs);
+
+	return n_loading;
+}
+
+static void
+start_load (PlumaLoadQueue *queue,
+	    PlumaTab       *tab,
+	    PlumaTab       *active)
+{
+	GList *link;
+
+	link = g_queue_find (&queue->priv->pending, tab);
+	if (link != NULL)
+	{
+		g_queue_delete_link (&queue->priv->pending, link);
+		g_object_unref (tab);
+	}
+
+	/* before the first read is issued */
+	set_tab_priority (queue, tab, active);
+
+	_pluma_tab_load_deferred (tab);
+}
+
+static gboolean
+update_idle (PlumaLoadQueue *queue)
+{
+	PlumaTab *active;
+	gint n_loading;
+
+	queue->priv->update_id = 0;
+
+	active = pluma_window_get_active_tab (queue->priv->window);
+
+	/* the user is looking at it, it does not wait for its turn */
+	if (active != NULL && _pluma_tab_is_load_deferred (active))
+		start_load (queue, active, active);
+
+	n_loading = update_priorities (queue);
+
+	while (!is_typing (queue) &&
+	       n_loading < MAX_CONCURRENT_LOADS &&
+	       !g_queue_is_empty (&queue->priv->pending))
+	{
+		PlumaTab *tab = PLUMA_TAB (g_queue_peek_head (&queue->priv->pending));
+
+		if (_pluma_tab_is_load_deferred (tab))
+		{
+			start_load (queue, tab, active);
+			++n_loading;
+		}
+		else
+		{
+			g_queue_pop_head (&queue->priv->pending);
+			g_object_unref (tab);
+		}
+	}
+
+	if (queue->priv->busy && pluma_load_queue_is_idle (queue))
+	{
+		pluma_debug_message (DEBUG_WINDOW, "All queued documents loaded");
+
+		queue->priv->busy = FALSE;
+		g_signal_emit (queue, signals[DRAINED], 0);
+	}
+
+	return FALSE;
+}
+
+static void
+schedule_update (PlumaLoadQueue *queue)
+{
+	if (queue->priv->update_id != 0)
+		return;
+
+	queue->priv->update_id = g_idle_add ((GSourceFunc) update_idle, queue);
+}
+
+static void
+tab_state_changed (PlumaTab       *tab,
+		   GParamSpec     *pspec,
+		   PlumaLoadQueue *queue)
+{
+	schedule_update (queue);
+}
+
+static void
+tab_added (PlumaWindow    *window,
+	   PlumaTab       *tab,
+	   PlumaLoadQueue *queue)
+{
+	g_signal_connect_object (tab,
+				 "notify::state",
+				 G_CALLBACK (tab_state_changed),
+				 queue,
+				 0);
+
+	/* also true of a deferred tab dragged from another window */
+	if (_pluma_tab_is_load_deferred (tab))
+	{
+		g_queue_push_tail (&queue->priv->pending, g_object_ref (tab));
+		queue->priv->busy = TRUE;
+	}
+
+	schedule_update (queue);
+}
+
+static void
+tab_removed (PlumaWindow    *window,
+	     PlumaTab       *tab,
+	     PlumaLoadQueue *queue)
+{
+	GList *link;
+
+	g_signal_handlers_disconnect_by_func (tab, tab_state_changed, queue);
+
+	link = g_queue_find (&queue->priv->pending, tab);
+	if (link != NULL)
+	{
+		g_queue_delete_link (&queue->priv->pending, link);
+		g_object_unref (tab);
+	}
+
+	schedule_update (queue);
+}
+
+static void
+active_tab_changed (PlumaWindow    *window,
+		    PlumaTab       *tab,
+		    PlumaLoadQueue *queue)
+{
+	schedule_update (queue);
+}
+
+static gboolean
+typing_timeout (PlumaLoadQueue *queue)
+{
+	/* keep waiting while the keystrokes come in */
+	if (g_get_monotonic_time () - queue->priv->last_key_time < TYPING_PAUSE * 1000)
+		return TRUE;
+
+	pluma_debug_message (DEBUG_WINDOW, "Resuming the background loads");
+
+	queue->priv->typing_id = 0;
+	schedule_update (queue);
+
+	return FALSE;
+}
+
+static gboolean
+window_key_press (GtkWidget      *widget,
+		  GdkEventKey    *event,
+		  PlumaLoadQueue *queue)
+{
+	queue->priv->last_key_time = g_get_monotonic_time ();
+
+	if (queue->priv->typing_id == 0)
+	{
+		queue->priv->typing_id = g_timeout_add (TYPING_PAUSE,
+							(GSourceFunc) typing_timeout,
+							queue);
+
+		/* pause the reads in progress right away */
+		if (update_priorities (queue) > 0)
+			pluma_debug_message (DEBUG_WINDOW, "Pausing the background loads");
+	}
+
+	return FALSE;
+}
+
+PlumaLoadQueue *
+pluma_load_queue_new (PlumaWindow *window)
+{
+	PlumaLoadQueue *queue;
+
+	g_return_val_if_fail (PLUMA_IS_WINDOW (window), NULL);
+
+	queue = PLUMA_LOAD_QUEUE (g_object_new (PLUMA_TYPE_LOAD_QUEUE, NULL));
+	queue->priv->window = window;
+
+	g_signal_connect_object (window,
+				 "tab_added",
+				 G_CALLBACK (tab_added),
+				 queue,
+				 0);
+	g_signal_connect_object (window,
+				 "tab_removed",
+				 G_CALLBACK (tab_removed),
+				 queue,
+				 0);
+	g_signal_connect_object (window,
+				 "active_tab_changed",
+				 G_CALLBACK (active_tab_changed),
+				 queue,
+				 0);
+	g_signal_connect_object (window,
+				 "key-press-event",
+				 G_CALLBACK (window_key_press),
+				 queue,
+				 0);
+
+	return queue;
+}
+
+/* Whether no tab is being loaded or waiting to be */
+gboolean
+pluma_load_queue_is_idle (PlumaLoadQueue *queue)
+{
+	GList *tabs, *l;
+	gboolean idle = TRUE;
+
+	g_return_val_if_fail (PLUMA_IS_LOAD_QUEUE (queue), TRUE);
+
+	if (!g_queue_is_empty (&queue->priv->pending))
+		return FALSE;
+
+	tabs = gtk_container_get_children (GTK_CONTAINER (_pluma_window_get_notebook (queue->priv->window)));
+
+	for (l = tabs; l != NULL && idle; l = g_list_next (l))
+		idle = !tab_is_loading (PLUMA_TAB (l->data));
+
+	g_list_free (tabs);
+
+	return idle;
+}
@@ -0,0 +1,67 @@
+/*
+ * pluma-load-queue.h
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef __PLUMA_LOAD_QUEUE_H__
+#define __PLUMA_LOAD_QUEUE_H__
+
+#include <glib-object.h>
+
+#include "pluma-window.h"
+
+G_BEGIN_DECLS
+
+#define PLUMA_TYPE_LOAD_QUEUE			(pluma_load_queue_get_type ())
+#define PLUMA_LOAD_QUEUE(obj)			(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_LOAD_QUEUE, PlumaLoadQueue))
+#define PLUMA_LOAD_QUEUE_CONST(obj)		(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_LOAD_QUEUE, PlumaLoadQueue const))
+#define PLUMA_LOAD_QUEUE_CLASS(klass)		(G_TYPE_CHECK_CLASS_CAST ((klass), PLUMA_TYPE_LOAD_QUEUE, PlumaLoadQueueClass))
+#define PLUMA_IS_LOAD_QUEUE(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), PLUMA_TYPE_LOAD_QUEUE))
+#define PLUMA_IS_LOAD_QUEUE_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), PLUMA_TYPE_LOAD_QUEUE))
+#define PLUMA_LOAD_QUEUE_GET_CLASS(obj)		(G_TYPE_INSTANCE_GET_CLASS ((obj), PLUMA_TYPE_LOAD_QUEUE, PlumaLoadQueueClass))
+
+typedef struct _PlumaLoadQueue		PlumaLoadQueue;
+typedef struct _PlumaLoadQueueClass	PlumaLoadQueueClass;
+typedef struct _PlumaLoadQueuePrivate	PlumaLoadQueuePrivate;
+
+struct _PlumaLoadQueue
+{
+	GObject parent;
+
+	PlumaLoadQueuePrivate *priv;
+};
+
+struct _PlumaLoadQueueClass
+{
+	GObjectClass parent_class;
+
+	/* Signals */
+	void (* drained)	(PlumaLoadQueue *queue);
+};
+
+GType		 pluma_load_queue_get_type		(void) G_GNUC_CONST;
+
+PlumaLoadQueue	*pluma_load_queue_new			(PlumaWindow    *window);
+
+gboolean	 pluma_load_queue_is_idle		(PlumaLoadQueue *queue);
+
+G_END_DECLS
+
+#endif /* __PLUMA_LOAD_QUEUE_H__ */
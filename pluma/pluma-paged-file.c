@@ -0,0 +1,935 @@
+/*
+ * pluma-paged-file.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "pluma-paged-file.h"
+#include "pluma-debug.h"
+
+/*
+ * A read only view of a file too big to be loaded in a GtkTextBuffer.
+ * The file is mapped in memory, so only the pages which are actually
+ * looked at are read. The offset of every INDEX_STEP-th line is recorded
+ * by a worker thread; other lines are found by scanning forward from the
+ * closest recorded one, so lines are only found once they were counted.
+ * Searches run on a worker thread too, straight over the mapping, and
+ * find the line of the match themselves.
+ */
+
+#define PLUMA_PAGED_FILE_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE((object), PLUMA_TYPE_PAGED_FILE, PlumaPagedFilePrivate))
+
+/* Record the offset of one line every INDEX_STEP */
+#define INDEX_STEP		4096
+
+/* Publish the index and check for cancellation after this many bytes */
+#define INDEX_CHUNK		(8 * 1024 * 1024)
+#define SEARCH_CHUNK		(8 * 1024 * 1024)
+
+/* How often, in ms, "index-updated" may be emitted while indexing */
+#define INDEX_NOTIFY_INTERVAL	250
+
+/* Shared with the indexing thread, which may outlive the object */
+typedef struct
+{
+	volatile gint ref_count;
+
+	GMappedFile *mapped;
+	const gchar *data;
+	goffset      size;
+
+	GMutex       mutex;
+	GArray      *offsets;	/* goffset of the lines 0, INDEX_STEP, ... */
+	gint64       n_newlines;
+	gboolean     complete;
+} LineIndex;
+
+typedef struct
+{
+	goffset offset;
+	gint64  line;
+	goffset line_start;
+} SearchResult;
+
+typedef struct
+{
+	LineIndex *index;
+	gchar     *text;
+	gsize      len;
+	goffset    from;
+	guint      case_sensitive : 1;
+	guint      backward : 1;
+	guint      wrap_around : 1;
+} SearchData;
+
+struct _PlumaPagedFilePrivate
+{
+	GFile        *location;
+
+	LineIndex    *index;
+	GCancellable *cancellable;
+
+	guint         notify_id;
+	gint64        notified_newlines;
+};
+
+enum
+{
+	INDEX_UPDATED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (PlumaPagedFile, pluma_paged_file, G_TYPE_OBJECT)
+
+static LineIndex *
+line_index_ref (LineIndex *index)
+{
+	g_atomic_int_inc (&index->ref_count);
+
+	return index;
+}
+
+static void
+line_index_unref (LineIndex *index)
+{
+	if (!g_atomic_int_dec_and_test (&index->ref_count))
+		return;
+
+	g_mapped_file_unref (index->mapped);
+	g_array_free (index->offsets, TRUE);
+	g_mutex_clear (&index->mutex);
+
+	g_slice_free (LineIndex, index);
+}
+
+static void
+search_data_free (SearchData *data)
+{
+	line_index_unref (data->index);
+	g_free (data->text);
+
+	g_slice_free (SearchData, data);
+}
+
+static void
+index_thread (GTask        *task,
+	      gpointer      source_object,
+	      gpointer      task_data,
+	      GCancellable *cancellable)
+{
+	LineIndex *index = task_data;
+	GArray *pending;
+	gint64 n_newlines = 0;
+	goffset pos = 0;
+
+	pending = g_array_new (FALSE, FALSE, sizeof (goffset));
+
+	while (pos < index->size)
+	{
+		goffset chunk_end;
+
+		if (g_cancellable_is_cancelled (cancellable))
+			break;
+
+		chunk_end = MIN (index->size, pos + INDEX_CHUNK);
+
+		while (pos < chunk_end)
+		{
+			const gchar *nl;
+
+			nl = memchr (index->data + pos, '\n', chunk_end - pos);
+			if (nl == NULL)
+			{
+				pos = chunk_end;
+				break;
+			}
+
+			pos = nl - index->data + 1;
+
+			if (++n_newlines % INDEX_STEP == 0)
+				g_array_append_val (pending, pos);
+		}
+
+		g_mutex_lock (&index->mutex);
+
+		g_array_append_vals (index->offsets, pending->data, pending->len);
+		index->n_newlines = n_newlines;
+
+		g_mutex_unlock (&index->mutex);
+
+		g_array_set_size (pending, 0);
+	}
+
+	g_array_free (pending, TRUE);
+
+	if (pos >= index->size)
+	{
+		g_mutex_lock (&index->mutex);
+		index->complete = TRUE;
+		g_mutex_unlock (&index->mutex);
+	}
+
+	g_task_return_boolean (task, TRUE);
+}
+
+static gboolean
+notify_index (PlumaPagedFile *file)
+{
+	LineIndex *index = file->priv->index;
+	gint64 n_newlines;
+	gboolean complete;
+
+	g_mutex_lock (&index->mutex);
+	n_newlines = index->n_newlines;
+	complete = index->complete;
+	g_mutex_unlock (&index->mutex);
+
+	if (n_newlines != file->priv->notified_newlines || complete)
+	{
+		file->priv->notified_newlines = n_newlines;
+
+		g_signal_emit (file, signals[INDEX_UPDATED], 0);
+	}
+
+	if (complete)
+	{
+		file->priv->notify_id = 0;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+pluma_paged_file_dispose (GObject *object)
+{
+	PlumaPagedFile *file = PLUMA_PAGED_FILE (object);
+
+	pluma_paged_file_close (file);
+
+	g_clear_object (&file->priv->location);
+
+	G_OBJECT_CLASS (pluma_paged_file_parent_class)->dispose (object);
+}
+
+static void
+pluma_paged_file_finalize (GObject *object)
+{
+	PlumaPagedFile *file = PLUMA_PAGED_FILE (object);
+
+	if (file->priv->index != NULL)
+		line_index_unref (file->priv->index);
+
+	G_OBJECT_CLASS (pluma_paged_file_parent_class)->finalize (object);
+}
+
+static void
+pluma_paged_file_class_init (PlumaPagedFileClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = pluma_paged_file_dispose;
+	object_class->finalize = pluma_paged_file_finalize;
+
+	/* Emitted while the lines are counted, and once when done */
+	signals[INDEX_UPDATED] =
+		g_signal_new ("index-updated",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (PlumaPagedFileClass, index_updated),
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+
+	g_type_class_add_private (object_class, sizeof (PlumaPagedFilePrivate));
+}
+
+static void
+pluma_paged_file_init (PlumaPagedFile *file)
+{
+	file->priv = PLUMA_PAGED_FILE_GET_PRIVATE (file);
+
+	file->priv->notified_newlines = -1;
+}
+
+/**
+ * pluma_paged_file_new:
+ * @location: a local file
+ * @error: return location for a #GError, or %NULL
+ *
+ * Maps @location in memory and starts counting its lines in the
+ * background.
+ *
+ * Returns: a new #PlumaPagedFile, or %NULL if the file can't be mapped
+ */
+PlumaPagedFile *
+pluma_paged_file_new (GFile   *location,
+		      GError **error)
+{
+	PlumaPagedFile *file;
+	GMappedFile *mapped;
+	LineIndex *index;
+	GTask *task;
+	gchar *path;
+	goffset zero = 0;
+
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	path = g_file_get_path (location);
+	if (path == NULL)
+	{
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+				     "Only local files can be mapped");
+		return NULL;
+	}
+
+	mapped = g_mapped_file_new (path, FALSE, error);
+	g_free (path);
+
+	if (mapped == NULL)
+		return NULL;
+
+	index = g_slice_new0 (LineIndex);
+	index->ref_count = 1;
+	index->mapped = mapped;
+	index->data = g_mapped_file_get_contents (mapped);
+	index->size = g_mapped_file_get_length (mapped);
+	index->offsets = g_array_new (FALSE, FALSE, sizeof (goffset));
+	g_array_append_val (index->offsets, zero);
+	g_mutex_init (&index->mutex);
+
+	file = g_object_new (PLUMA_TYPE_PAGED_FILE, NULL);
+
+	file->priv->location = g_object_ref (location);
+	file->priv->index = index;
+	file->priv->cancellable = g_cancellable_new ();
+
+	task = g_task_new (NULL, file->priv->cancellable, NULL, NULL);
+	g_task_set_task_data (task,
+			      line_index_ref (index),
+			      (GDestroyNotify) line_index_unref);
+	g_task_run_in_thread (task, index_thread);
+	g_object_unref (task);
+
+	file->priv->notify_id = g_timeout_add (INDEX_NOTIFY_INTERVAL,
+					       (GSourceFunc) notify_index,
+					       file);
+
+	return file;
+}
+
+/**
+ * pluma_paged_file_close:
+ * @file: a #PlumaPagedFile
+ *
+ * Stops counting the lines, without waiting for the last reference to
+ * @file to go, which running searches hold. To be called when the file
+ * is not going to be used anymore, e.g. because it was truncated: the
+ * mapping cannot be read past the new end.
+ */
+void
+pluma_paged_file_close (PlumaPagedFile *file)
+{
+	g_return_if_fail (PLUMA_IS_PAGED_FILE (file));
+
+	if (file->priv->notify_id != 0)
+	{
+		g_source_remove (file->priv->notify_id);
+		file->priv->notify_id = 0;
+	}
+
+	if (file->priv->cancellable != NULL)
+	{
+		g_cancellable_cancel (file->priv->cancellable);
+		g_object_unref (file->priv->cancellable);
+		file->priv->cancellable = NULL;
+	}
+}
+
+GFile *
+pluma_paged_file_get_location (PlumaPagedFile *file)
+{
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), NULL);
+
+	return file->priv->location;
+}
+
+goffset
+pluma_paged_file_get_size (PlumaPagedFile *file)
+{
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), 0);
+
+	return file->priv->index->size;
+}
+
+/**
+ * pluma_paged_file_get_n_lines:
+ * @file: a #PlumaPagedFile
+ * @complete: (out) (allow-none): whether all the lines were counted
+ *
+ * Returns: the number of lines counted so far, the way #GtkTextBuffer
+ * counts them
+ */
+gint64
+pluma_paged_file_get_n_lines (PlumaPagedFile *file,
+			      gboolean       *complete)
+{
+	LineIndex *index;
+	gint64 n_lines;
+
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), 0);
+
+	index = file->priv->index;
+
+	g_mutex_lock (&index->mutex);
+
+	n_lines = index->n_newlines + 1;
+	if (complete != NULL)
+		*complete = index->complete;
+
+	g_mutex_unlock (&index->mutex);
+
+	return n_lines;
+}
+
+/**
+ * pluma_paged_file_get_line_offset:
+ * @file: a #PlumaPagedFile
+ * @line: a line number, counting from 0
+ *
+ * Only the lines counted so far can be found, this never looks further
+ * than INDEX_STEP lines from a recorded one. Wait for "index-updated"
+ * for the others.
+ *
+ * Returns: the offset of the start of @line in bytes, or -1 if the file
+ * has less lines or if they were not counted yet
+ */
+goffset
+pluma_paged_file_get_line_offset (PlumaPagedFile *file,
+				  gint64          line)
+{
+	LineIndex *index;
+	const gchar *p;
+	const gchar *end;
+	gint64 remaining;
+	guint i;
+
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), -1);
+	g_return_val_if_fail (line >= 0, -1);
+
+	index = file->priv->index;
+
+	g_mutex_lock (&index->mutex);
+
+	if (line > index->n_newlines)
+	{
+		g_mutex_unlock (&index->mutex);
+		return -1;
+	}
+
+	i = MIN (line / INDEX_STEP, (gint64) index->offsets->len - 1);
+	p = index->data + g_array_index (index->offsets, goffset, i);
+
+	g_mutex_unlock (&index->mutex);
+
+	remaining = line - (gint64) i * INDEX_STEP;
+	end = index->data + index->size;
+
+	while (remaining > 0)
+	{
+		p = memchr (p, '\n', end - p);
+		if (p == NULL)
+			return -1;
+
+		++p;
+		--remaining;
+	}
+
+	return p - index->data;
+}
+
+/* Finds the line @offset is in, and where that line starts, scanning
+ * from the closest recorded line */
+static gint64
+line_index_find_line (LineIndex *index,
+		      goffset    offset,
+		      goffset   *line_start)
+{
+	const gchar *p;
+	const gchar *start;
+	const gchar *end;
+	gint64 line;
+	guint lo, hi;
+
+	offset = CLAMP (offset, 0, index->size);
+
+	g_mutex_lock (&index->mutex);
+
+	/* last recorded line starting at or before @offset */
+	lo = 0;
+	hi = index->offsets->len;
+	while (hi - lo > 1)
+	{
+		guint mid = (lo + hi) / 2;
+
+		if (g_array_index (index->offsets, goffset, mid) <= offset)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	p = index->data + g_array_index (index->offsets, goffset, lo);
+
+	g_mutex_unlock (&index->mutex);
+
+	line = (gint64) lo * INDEX_STEP;
+	start = p;
+	end = index->data + offset;
+
+	while ((p = memchr (p, '\n', end - p)) != NULL)
+	{
+		start = ++p;
+		++line;
+	}
+
+	if (line_start != NULL)
+		*line_start = start - index->data;
+
+	return line;
+}
+
+/**
+ * pluma_paged_file_get_line_at_offset:
+ * @file: a #PlumaPagedFile
+ * @offset: an offset in bytes
+ *
+ * Scans the file from the closest recorded line, which may be far
+ * before @offset while the lines are being counted: prefer calling it
+ * from a thread.
+ *
+ * Returns: the line @offset is in, counting from 0
+ */
+gint64
+pluma_paged_file_get_line_at_offset (PlumaPagedFile *file,
+				     goffset         offset)
+{
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), 0);
+
+	return line_index_find_line (file->priv->index, offset, NULL);
+}
+
+/**
+ * pluma_paged_file_forward_lines:
+ * @file: a #PlumaPagedFile
+ * @offset: the start of a line
+ * @n_lines: (inout): the number of lines to skip, set to the number of
+ * lines actually skipped
+ * @max_bytes: the most bytes to look at
+ *
+ * Finds the line @n_lines after the one starting at @offset without
+ * needing the lines to be counted, looking at no more than @max_bytes.
+ *
+ * Returns: the start of that line, the end of the file if it has less
+ * lines, or the start of the last line found within @max_bytes
+ * (@offset + @max_bytes if the first line is longer than that)
+ */
+goffset
+pluma_paged_file_forward_lines (PlumaPagedFile *file,
+				goffset         offset,
+				gint64         *n_lines,
+				goffset         max_bytes)
+{
+	LineIndex *index;
+	const gchar *p;
+	const gchar *end;
+	gint64 skipped = 0;
+
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), -1);
+	g_return_val_if_fail (n_lines != NULL && *n_lines >= 0, -1);
+	g_return_val_if_fail (max_bytes > 0, -1);
+
+	index = file->priv->index;
+	offset = CLAMP (offset, 0, index->size);
+
+	if (max_bytes >= index->size - offset)
+		end = index->data + index->size;
+	else
+		end = index->data + offset + max_bytes;
+
+	p = index->data + offset;
+
+	while (skipped < *n_lines)
+	{
+		const gchar *nl;
+
+		nl = memchr (p, '\n', end - p);
+		if (nl == NULL)
+		{
+			/* stop at the end of the file, or at the last
+			 * line that fits unless there is none */
+			if (end == index->data + index->size || skipped == 0)
+				p = end;
+
+			break;
+		}
+
+		p = nl + 1;
+		++skipped;
+	}
+
+	*n_lines = skipped;
+
+	return p - index->data;
+}
+
+/**
+ * pluma_paged_file_get_text:
+ * @file: a #PlumaPagedFile
+ * @start: offset of the first byte
+ * @end: offset after the last byte
+ *
+ * Copies a range of the file. Bytes which are not valid UTF-8 are
+ * replaced, so that the text can be shown in a #GtkTextBuffer.
+ *
+ * Returns: a newly allocated UTF-8 string
+ */
+gchar *
+pluma_paged_file_get_text (PlumaPagedFile *file,
+			   goffset         start,
+			   goffset         end)
+{
+	LineIndex *index;
+	const gchar *p;
+	const gchar *stop;
+	GString *str;
+
+	g_return_val_if_fail (PLUMA_IS_PAGED_FILE (file), NULL);
+
+	index = file->priv->index;
+
+	start = CLAMP (start, 0, index->size);
+	end = CLAMP (end, start, index->size);
+
+	p = index->data + start;
+	stop = index->data + end;
+
+	str = g_string_sized_new (end - start + 1);
+
+	while (p < stop)
+	{
+		const gchar *valid_end;
+
+		if (g_utf8_validate (p, stop - p, &valid_end))
+		{
+			g_string_append_len (str, p, stop - p);
+			break;
+		}
+
+		g_string_append_len (str, p, valid_end - p);
+
+		/* U+FFFD REPLACEMENT CHARACTER, also for the NULs */
+		g_string_append (str, "\357\277\275");
+
+		p = valid_end + 1;
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+static void
+search_result_free (SearchResult *result)
+{
+	g_slice_free (SearchResult, result);
+}
+
+static inline gboolean
+match_at (const gchar *p,
+	  const gchar *text,
+	  gsize        len,
+	  gboolean     case_sensitive)
+{
+	if (case_sensitive)
+		return memcmp (p, text, len) == 0;
+
+	return g_ascii_strncasecmp (p, text, len) == 0;
+}
+
+/* Finds the first byte of the text in [p, end), in either case if
+ * @other is the other case of @c */
+static inline const gchar *
+find_first_byte (const gchar *p,
+		 const gchar *end,
+		 guchar       c,
+		 guchar       other)
+{
+	const gchar *found;
+	const gchar *found_other;
+
+	found = memchr (p, c, end - p);
+	if (other == c)
+		return found;
+
+	found_other = memchr (p, other, (found != NULL ? found : end) - p);
+
+	return found_other != NULL ? found_other : found;
+}
+
+/* Looks for a match starting in [first, last], returns -1 if none. The
+ * range is gone through in SEARCH_CHUNK blocks, the last match of a
+ * block is the one wanted when going @backward */
+static goffset
+search_range (const gchar  *data,
+	      const gchar  *text,
+	      gsize         len,
+	      gboolean      case_sensitive,
+	      goffset       first,
+	      goffset       last,
+	      gboolean      backward,
+	      GCancellable *cancellable)
+{
+	guchar c = text[0];
+	guchar other = case_sensitive ? c : (guchar) g_ascii_toupper (c);
+	goffset block_start;
+	goffset block_end;
+
+	if (!case_sensitive)
+		c = g_ascii_tolower (c);
+
+	if (first > last)
+		return -1;
+
+	if (backward)
+	{
+		block_end = last + 1;
+		block_start = MAX (first, block_end - SEARCH_CHUNK);
+	}
+	else
+	{
+		block_start = first;
+		block_end = MIN (last + 1, block_start + SEARCH_CHUNK);
+	}
+
+	while (TRUE)
+	{
+		const gchar *p;
+		const gchar *end;
+		goffset found = -1;
+
+		if (g_cancellable_is_cancelled (cancellable))
+			return -1;
+
+		p = data + block_start;
+		end = data + block_end;
+
+		while ((p = find_first_byte (p, end, c, other)) != NULL)
+		{
+			if (match_at (p, text, len, case_sensitive))
+			{
+				found = p - data;
+
+				if (!backward)
+					break;
+			}
+
+			++p;
+		}
+
+		if (found >= 0)
+			return found;
+
+		if (backward)
+		{
+			if (block_start == first)
+				return -1;
+
+			block_end = block_start;
+			block_start = MAX (first, block_end - SEARCH_CHUNK);
+		}
+		else
+		{
+			if (block_end > last)
+				return -1;
+
+			block_start = block_end;
+			block_end = MIN (last + 1, block_start + SEARCH_CHUNK);
+		}
+	}
+}
+
+static void
+search_thread (GTask        *task,
+	       gpointer      source_object,
+	       gpointer      task_data,
+	       GCancellable *cancellable)
+{
+	SearchData *data = task_data;
+	LineIndex *index = data->index;
+	SearchResult *result;
+	goffset last;
+	goffset found = -1;
+
+	pluma_debug_span_begin (DEBUG_SEARCH, "paged-search");
+
+	last = index->size - (goffset) data->len;
+
+	if (last >= 0)
+	{
+		goffset from = CLAMP (data->from, 0, index->size);
+
+		if (!data->backward)
+		{
+			found = search_range (index->data, data->text, data->len,
+					      data->case_sensitive,
+					      from, last, FALSE, cancellable);
+
+			if (found < 0 && data->wrap_around)
+				found = search_range (index->data, data->text, data->len,
+						      data->case_sensitive,
+						      0, MIN (from - 1, last), FALSE,
+						      cancellable);
+		}
+		else
+		{
+			found = search_range (index->data, data->text, data->len,
+					      data->case_sensitive,
+					      0, MIN (from - 1, last), TRUE,
+					      cancellable);
+
+			if (found < 0 && data->wrap_around)
+				found = search_range (index->data, data->text, data->len,
+						      data->case_sensitive,
+						      from, last, TRUE, cancellable);
+		}
+	}
+
+	result = g_slice_new (SearchResult);
+	result->offset = found;
+	result->line = -1;
+	result->line_start = -1;
+
+	/* the match may be far past the counted lines, and looking for its
+	 * line here keeps the scan off the main thread */
+	if (found >= 0 && !g_cancellable_is_cancelled (cancellable))
+		result->line = line_index_find_line (index, found, &result->line_start);
+
+	pluma_debug_span_end (DEBUG_SEARCH, "paged-search");
+
+	if (g_task_return_error_if_cancelled (task))
+	{
+		search_result_free (result);
+		return;
+	}
+
+	g_task_return_pointer (task, result, (GDestroyNotify) search_result_free);
+}
+
+/**
+ * pluma_paged_file_search_async:
+ * @file: a #PlumaPagedFile
+ * @text: the text to look for
+ * @case_sensitive: whether to match the case, only ASCII letters are folded
+ * @from: offset to start from
+ * @backward: whether to look for the last match before @from
+ * @wrap_around: whether to continue from the other end of the file
+ * @cancellable: (allow-none): optional #GCancellable object
+ * @callback: a #GAsyncReadyCallback to call when the search is done
+ * @user_data: data to pass to @callback
+ *
+ * Looks for @text in the file on a worker thread.
+ */
+void
+pluma_paged_file_search_async (PlumaPagedFile      *file,
+			       const gchar         *text,
+			       gboolean             case_sensitive,
+			       goffset              from,
+			       gboolean             backward,
+			       gboolean             wrap_around,
+			       GCancellable        *cancellable,
+			       GAsyncReadyCallback  callback,
+			       gpointer             user_data)
+{
+	SearchData *data;
+	GTask *task;
+
+	g_return_if_fail (PLUMA_IS_PAGED_FILE (file));
+	g_return_if_fail (text != NULL && *text != '\0');
+
+	data = g_slice_new0 (SearchData);
+	data->index = line_index_ref (file->priv->index);
+	data->text = g_strdup (text);
+	data->len = strlen (text);
+	data->from = from;
+	data->case_sensitive = case_sensitive != FALSE;
+	data->backward = backward != FALSE;
+	data->wrap_around = wrap_around != FALSE;
+
+	task = g_task_new (file, cancellable, callback, user_data);
+	g_task_set_task_data (task, data, (GDestroyNotify) search_data_free);
+	g_task_run_in_thread (task, search_thread);
+	g_object_unref (task);
+}
+
+/**
+ * pluma_paged_file_search_finish:
+ * @file: a #PlumaPagedFile
+ * @result: a #GAsyncResult
+ * @line: (out) (allow-none): return location for the line of the match
+ * @line_start: (out) (allow-none): return location for the offset of
+ * the start of that line
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: the offset of the match, or -1 if none was found or on error
+ */
+goffset
+pluma_paged_file_search_finish (PlumaPagedFile  *file,
+				GAsyncResult    *result,
+				gint64          *line,
+				goffset         *line_start,
+				GError         **error)
+{
+	SearchResult *found;
+	goffset ret;
+
+	g_return_val_if_fail (g_task_is_valid (result, file), -1);
+
+	found = g_task_propagate_pointer (G_TASK (result), error);
+	if (found == NULL)
+		return -1;
+
+	ret = found->offset;
+
+	if (line != NULL)
+		*line = found->line;
+	if (line_start != NULL)
+		*line_start = found->line_start;
+
+	search_result_free (found);
+
+	return ret;
+}
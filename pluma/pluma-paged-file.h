@@ -0,0 +1,104 @@
+/*
+ * pluma-paged-file.h
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef __PLUMA_PAGED_FILE_H__
+#define __PLUMA_PAGED_FILE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define PLUMA_TYPE_PAGED_FILE			(pluma_paged_file_get_type ())
+#define PLUMA_PAGED_FILE(obj)			(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_PAGED_FILE, PlumaPagedFile))
+#define PLUMA_PAGED_FILE_CONST(obj)		(G_TYPE_CHECK_INSTANCE_CAST ((obj), PLUMA_TYPE_PAGED_FILE, PlumaPagedFile const))
+#define PLUMA_PAGED_FILE_CLASS(klass)		(G_TYPE_CHECK_CLASS_CAST ((klass), PLUMA_TYPE_PAGED_FILE, PlumaPagedFileClass))
+#define PLUMA_IS_PAGED_FILE(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), PLUMA_TYPE_PAGED_FILE))
+#define PLUMA_IS_PAGED_FILE_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), PLUMA_TYPE_PAGED_FILE))
+#define PLUMA_PAGED_FILE_GET_CLASS(obj)		(G_TYPE_INSTANCE_GET_CLASS ((obj), PLUMA_TYPE_PAGED_FILE, PlumaPagedFileClass))
+
+typedef struct _PlumaPagedFile		PlumaPagedFile;
+typedef struct _PlumaPagedFileClass	PlumaPagedFileClass;
+typedef struct _PlumaPagedFilePrivate	PlumaPagedFilePrivate;
+
+struct _PlumaPagedFile
+{
+	GObject parent;
+
+	PlumaPagedFilePrivate *priv;
+};
+
+struct _PlumaPagedFileClass
+{
+	GObjectClass parent_class;
+
+	/* Signals */
+	void (* index_updated)	(PlumaPagedFile *file);
+};
+
+GType		 pluma_paged_file_get_type		(void) G_GNUC_CONST;
+
+PlumaPagedFile	*pluma_paged_file_new			(GFile           *location,
+							 GError         **error);
+
+void		 pluma_paged_file_close			(PlumaPagedFile  *file);
+
+GFile		*pluma_paged_file_get_location		(PlumaPagedFile  *file);
+
+goffset		 pluma_paged_file_get_size		(PlumaPagedFile  *file);
+
+gint64		 pluma_paged_file_get_n_lines		(PlumaPagedFile  *file,
+							 gboolean        *complete);
+
+goffset		 pluma_paged_file_get_line_offset	(PlumaPagedFile  *file,
+							 gint64           line);
+
+gint64		 pluma_paged_file_get_line_at_offset	(PlumaPagedFile  *file,
+							 goffset          offset);
+
+goffset		 pluma_paged_file_forward_lines		(PlumaPagedFile  *file,
+							 goffset          offset,
+							 gint64          *n_lines,
+							 goffset          max_bytes);
+
+gchar		*pluma_paged_file_get_text		(PlumaPagedFile  *file,
+							 goffset          start,
+							 goffset          end);
+
+void		 pluma_paged_file_search_async		(PlumaPagedFile      *file,
+							 const gchar         *text,
+							 gboolean             case_sensitive,
+							 goffset              from,
+							 gboolean             backward,
+							 gboolean             wrap_around,
+							 GCancellable        *cancellable,
+							 GAsyncReadyCallback  callback,
+							 gpointer             user_data);
+
+goffset		 pluma_paged_file_search_finish		(PlumaPagedFile  *file,
+							 GAsyncResult    *result,
+							 gint64          *line,
+							 goffset         *line_start,
+							 GError         **error);
+
+G_END_DECLS
+
+#endif /* __PLUMA_PAGED_FILE_H__ */
@@ -147,6 +147,13 @@ static gint side_panel_active_page = -1;
 static gint bottom_panel_active_page = -1;
 static gint active_file_filter = -1;
 
+/* Preference changes waiting to be applied to the views */
+static guint pending_changes = 0;
+static guint apply_changes_id = 0;
+
+/* All the live PlumaViews, registered by the views themselves */
+static GHashTable *registered_views = NULL;
+
 
 static gchar *
 get_state_filename (void)
@@ -724,203 +731,418 @@ pluma_prefs_manager_app_shutdown (void)
 {
 	pluma_debug (DEBUG_PREFS);
 
+	if (apply_changes_id != 0)
+	{
+		g_source_remove (apply_changes_id);
+		apply_changes_id = 0;
+	}
+
+	if (registered_views != NULL)
+	{
+		g_hash_table_destroy (registered_views);
+		registered_views = NULL;
+	}
+
 	pluma_prefs_manager_shutdown ();
 
 	pluma_state_file_sync ();
 }
 
 
-static void
-pluma_prefs_manager_editor_font_changed (GSettings *settings,
-					 gchar       *key,
-					 gpointer     user_data)
+/* Changes to the preferences which apply to every view or document are
+ * not applied right away: the keys changed during one main loop
+ * iteration are collected and applied to each view in a single pass,
+ * so that changing several keys at once (e.g. when resetting to the
+ * defaults) does not update and relayout all the views once per key. */
+typedef enum
 {
-	GList *views;
-	GList *l;
-	gchar *font = NULL;
-	gboolean def = TRUE;
-	gint ts;
+	PREFS_CHANGE_FONT		= 1 << 0,
+	PREFS_CHANGE_TAB_WIDTH		= 1 << 1,
+	PREFS_CHANGE_INSERT_SPACES	= 1 << 2,
+	PREFS_CHANGE_WRAP_MODE		= 1 << 3,
+	PREFS_CHANGE_LINE_NUMBERS	= 1 << 4,
+	PREFS_CHANGE_HL_CURRENT_LINE	= 1 << 5,
+	PREFS_CHANGE_AUTO_INDENT	= 1 << 6,
+	PREFS_CHANGE_RIGHT_MARGIN_POS	= 1 << 7,
+	PREFS_CHANGE_RIGHT_MARGIN	= 1 << 8,
+	PREFS_CHANGE_SMART_HOME_END	= 1 << 9,
+	PREFS_CHANGE_BRACKET_MATCHING	= 1 << 10,
+	PREFS_CHANGE_UNDO		= 1 << 11,
+	PREFS_CHANGE_SYNTAX_HL		= 1 << 12,
+	PREFS_CHANGE_SEARCH_HL		= 1 << 13,
+	PREFS_CHANGE_STYLE_SCHEME	= 1 << 14,
+	PREFS_CHANGE_AUTO_SAVE		= 1 << 15,
+	PREFS_CHANGE_AUTO_SAVE_INTERVAL	= 1 << 16
+} PrefsChange;
 
-	pluma_debug (DEBUG_PREFS);
+void
+_pluma_prefs_manager_app_register_view (PlumaView *view)
+{
+	if (registered_views == NULL)
+		registered_views = g_hash_table_new (g_direct_hash, g_direct_equal);
 
-	if (strcmp (key, GPM_USE_DEFAULT_FONT) == 0)
-	{
-		def = g_settings_get_boolean (settings, key);
+	g_hash_table_add (registered_views, view);
+}
 
-		if (def)
-			font = pluma_prefs_manager_get_system_font ();
-		else
-			font = pluma_prefs_manager_get_editor_font ();
-	}
-	else if (strcmp (key, GPM_EDITOR_FONT) == 0)
-	{
-		font = g_settings_get_string (settings, key);
+void
+_pluma_prefs_manager_app_unregister_view (PlumaView *view)
+{
+	if (registered_views != NULL)
+		g_hash_table_remove (registered_views, view);
+}
 
-		def = pluma_prefs_manager_get_use_default_font ();
-	}
-	else
-		return;
+static GtkSourceStyleScheme *
+get_changed_style_scheme (void)
+{
+	static gchar *old_scheme = NULL;
+	gchar *scheme;
+	GtkSourceStyleScheme *style;
 
-	g_return_if_fail (font != NULL);
+	scheme = pluma_prefs_manager_get_source_style_scheme ();
 
-	ts = pluma_prefs_manager_get_tabs_size ();
+	if (old_scheme != NULL && (strcmp (scheme, old_scheme) == 0))
+	{
+		g_free (scheme);
+		return NULL;
+	}
 
-	views = pluma_app_get_views (pluma_app_get_default ());
-	l = views;
+	g_free (old_scheme);
+	old_scheme = scheme;
 
-	while (l != NULL)
+	style = gtk_source_style_scheme_manager_get_scheme (
+			pluma_get_style_scheme_manager (),
+			scheme);
+
+	if (style == NULL)
 	{
-		/* Note: we use def=FALSE to avoid PlumaView to query GSettings */
-		pluma_view_set_font (PLUMA_VIEW (l->data), FALSE,  font);
-		gtk_source_view_set_tab_width (GTK_SOURCE_VIEW (l->data), ts);
+		g_warning ("Default style scheme '%s' not found, falling back to 'classic'", scheme);
 
-		l = l->next;
+		style = gtk_source_style_scheme_manager_get_scheme (
+			pluma_get_style_scheme_manager (),
+			"classic");
+
+		if (style == NULL)
+		{
+			g_warning ("Style scheme 'classic' cannot be found, check your GtkSourceView installation.");
+		}
 	}
 
-	g_list_free (views);
-	g_free (font);
+	return style;
 }
 
 static void
-pluma_prefs_manager_system_font_changed (GSettings *settings,
-					 gchar       *key,
-					 gpointer     user_data)
+apply_document_changes (PlumaDocument        *doc,
+			guint                 changes,
+			gboolean              bracket_matching,
+			gint                  undo_levels,
+			gboolean              syntax_hl,
+			gboolean              search_hl,
+			GtkSourceStyleScheme *style,
+			gboolean              auto_save,
+			gint                  auto_save_interval)
 {
-	GList *views;
-	GList *l;
-	gchar *font;
-	gint ts;
+	GtkSourceBuffer *buffer = GTK_SOURCE_BUFFER (doc);
+	PlumaDocumentFeatures disabled;
+	PlumaTab *tab;
 
-	pluma_debug (DEBUG_PREFS);
+	disabled = pluma_document_get_disabled_features (doc);
 
-	if (strcmp (key, GPM_SYSTEM_FONT) != 0)
-		return;
+	if (changes & PREFS_CHANGE_BRACKET_MATCHING)
+		gtk_source_buffer_set_highlight_matching_brackets (buffer,
+			bracket_matching && !(disabled & PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING));
 
-	if (!pluma_prefs_manager_get_use_default_font ())
-		return;
+	if (changes & PREFS_CHANGE_UNDO)
+		gtk_source_buffer_set_max_undo_levels (buffer, undo_levels);
 
-	font = g_settings_get_string (settings, key);
+	if (changes & PREFS_CHANGE_SYNTAX_HL)
+		gtk_source_buffer_set_highlight_syntax (buffer,
+			syntax_hl && !(disabled & PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING));
 
-	ts = pluma_prefs_manager_get_tabs_size ();
+	if (changes & PREFS_CHANGE_SEARCH_HL)
+		pluma_document_set_enable_search_highlighting (doc,
+			search_hl && !(disabled & PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING));
 
-	views = pluma_app_get_views (pluma_app_get_default ());
-	l = views;
+	if (changes & PREFS_CHANGE_STYLE_SCHEME)
+		gtk_source_buffer_set_style_scheme (buffer, style);
 
-	while (l != NULL)
-	{
-		/* Note: we use def=FALSE to avoid PlumaView to query GSettings */
-		pluma_view_set_font (PLUMA_VIEW (l->data), FALSE, font);
+	tab = pluma_tab_get_from_document (doc);
 
-		gtk_source_view_set_tab_width (GTK_SOURCE_VIEW (l->data), ts);
-		l = l->next;
-	}
+	if (tab == NULL)
+		return;
 
-	g_list_free (views);
-	g_free (font);
+	if (changes & PREFS_CHANGE_AUTO_SAVE)
+		pluma_tab_set_auto_save_enabled (tab, auto_save);
+
+	if (changes & PREFS_CHANGE_AUTO_SAVE_INTERVAL)
+		pluma_tab_set_auto_save_interval (tab, auto_save_interval);
 }
 
-static void
-pluma_prefs_manager_tabs_size_changed (GSettings *settings,
-				       gchar       *key,
-				       gpointer     user_data)
+static gboolean
+apply_changes (gpointer data)
 {
+	guint changes;
+	GHashTable *docs;
+	GHashTableIter iter;
+	gpointer key;
+	gchar *font = NULL;
+	gint tab_width = 0;
+	gboolean insert_spaces = FALSE;
+	GtkWrapMode wrap_mode = GTK_WRAP_NONE;
+	gboolean line_numbers = FALSE;
+	gboolean hl_current_line = FALSE;
+	gboolean auto_indent = FALSE;
+	gint right_margin_pos = 0;
+	gboolean right_margin = FALSE;
+	GtkSourceSmartHomeEndType smart_home_end = GTK_SOURCE_SMART_HOME_END_DISABLED;
+	gboolean bracket_matching = FALSE;
+	gint undo_levels = 0;
+	gboolean syntax_hl = FALSE;
+	gboolean search_hl = FALSE;
+	GtkSourceStyleScheme *style = NULL;
+	gboolean auto_save = FALSE;
+	gint auto_save_interval = 0;
+
 	pluma_debug (DEBUG_PREFS);
 
-	if (strcmp (key, GPM_TABS_SIZE) == 0)
+	changes = pending_changes;
+	pending_changes = 0;
+	apply_changes_id = 0;
+
+	/* Read each changed preference only once */
+	if (changes & PREFS_CHANGE_FONT)
 	{
-		gint tab_width;
-		GList *views;
-		GList *l;
+		if (pluma_prefs_manager_get_use_default_font ())
+			font = pluma_prefs_manager_get_system_font ();
+		else
+			font = pluma_prefs_manager_get_editor_font ();
 
-		tab_width = g_settings_get_int (settings, key);
+		if (font == NULL)
+			changes &= ~PREFS_CHANGE_FONT;
 
-		tab_width = CLAMP (tab_width, 1, 24);
+		/* the font changes the width of the tabs */
+		changes |= PREFS_CHANGE_TAB_WIDTH;
+	}
 
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
+	if (changes & PREFS_CHANGE_TAB_WIDTH)
+		tab_width = CLAMP (pluma_prefs_manager_get_tabs_size (), 1, 24);
 
-		while (l != NULL)
-		{
-			gtk_source_view_set_tab_width (GTK_SOURCE_VIEW (l->data),
-						       tab_width);
+	if (changes & PREFS_CHANGE_INSERT_SPACES)
+		insert_spaces = pluma_prefs_manager_get_insert_spaces ();
 
-			l = l->next;
-		}
+	if (changes & PREFS_CHANGE_WRAP_MODE)
+		wrap_mode = pluma_prefs_manager_get_wrap_mode ();
+
+	if (changes & PREFS_CHANGE_LINE_NUMBERS)
+		line_numbers = pluma_prefs_manager_get_display_line_numbers ();
+
+	if (changes & PREFS_CHANGE_HL_CURRENT_LINE)
+		hl_current_line = pluma_prefs_manager_get_highlight_current_line ();
+
+	if (changes & PREFS_CHANGE_AUTO_INDENT)
+		auto_indent = pluma_prefs_manager_get_auto_indent ();
+
+	if (changes & PREFS_CHANGE_RIGHT_MARGIN_POS)
+		right_margin_pos = CLAMP (pluma_prefs_manager_get_right_margin_position (), 1, 160);
+
+	if (changes & PREFS_CHANGE_RIGHT_MARGIN)
+		right_margin = pluma_prefs_manager_get_display_right_margin ();
 
-		g_list_free (views);
+	if (changes & PREFS_CHANGE_SMART_HOME_END)
+		smart_home_end = pluma_prefs_manager_get_smart_home_end ();
+
+	if (changes & PREFS_CHANGE_BRACKET_MATCHING)
+		bracket_matching = pluma_prefs_manager_get_bracket_matching ();
+
+	if (changes & PREFS_CHANGE_UNDO)
+		undo_levels = CLAMP (pluma_prefs_manager_get_undo_actions_limit (), -1, 250);
+
+	if (changes & PREFS_CHANGE_SYNTAX_HL)
+		syntax_hl = pluma_prefs_manager_get_enable_syntax_highlighting ();
+
+	if (changes & PREFS_CHANGE_SEARCH_HL)
+		search_hl = pluma_prefs_manager_get_enable_search_highlighting ();
+
+	if (changes & PREFS_CHANGE_STYLE_SCHEME)
+	{
+		style = get_changed_style_scheme ();
+
+		if (style == NULL)
+			changes &= ~PREFS_CHANGE_STYLE_SCHEME;
 	}
-	else if (strcmp (key, GPM_INSERT_SPACES) == 0)
+
+	if (changes & PREFS_CHANGE_AUTO_SAVE)
+		auto_save = pluma_prefs_manager_get_auto_save ();
+
+	if (changes & PREFS_CHANGE_AUTO_SAVE_INTERVAL)
 	{
-		gboolean enable;
-		GList *views;
-		GList *l;
+		auto_save_interval = pluma_prefs_manager_get_auto_save_interval ();
+
+		if (auto_save_interval <= 0)
+			auto_save_interval = GPM_DEFAULT_AUTO_SAVE_INTERVAL;
+	}
+
+	if (registered_views == NULL)
+		goto out;
+
+	/* documents may be shown in more than one view */
+	docs = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_hash_table_iter_init (&iter, registered_views);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		GtkSourceView *view = GTK_SOURCE_VIEW (key);
+		GtkTextBuffer *doc;
+		PlumaDocumentFeatures disabled = 0;
+
+		doc = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+
+		if (PLUMA_IS_DOCUMENT (doc))
+			disabled = pluma_document_get_disabled_features (PLUMA_DOCUMENT (doc));
+
+		/* Note: we use def=FALSE to avoid PlumaView to query GSettings */
+		if (changes & PREFS_CHANGE_FONT)
+			pluma_view_set_font (PLUMA_VIEW (view), FALSE, font);
+
+		if (changes & PREFS_CHANGE_TAB_WIDTH)
+			gtk_source_view_set_tab_width (view, tab_width);
+
+		if (changes & PREFS_CHANGE_INSERT_SPACES)
+			gtk_source_view_set_insert_spaces_instead_of_tabs (view, insert_spaces);
+
+		if (changes & PREFS_CHANGE_WRAP_MODE)
+			gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (view), wrap_mode);
+
+		if (changes & PREFS_CHANGE_LINE_NUMBERS)
+			gtk_source_view_set_show_line_numbers (view,
+				line_numbers && !(disabled & PLUMA_DOCUMENT_FEATURE_LINE_NUMBERS));
+
+		if (changes & PREFS_CHANGE_HL_CURRENT_LINE)
+			gtk_source_view_set_highlight_current_line (view,
+				hl_current_line && !(disabled & PLUMA_DOCUMENT_FEATURE_CURRENT_LINE));
+
+		if (changes & PREFS_CHANGE_AUTO_INDENT)
+			gtk_source_view_set_auto_indent (view, auto_indent);
+
+		if (changes & PREFS_CHANGE_RIGHT_MARGIN_POS)
+			gtk_source_view_set_right_margin_position (view, right_margin_pos);
 
-		enable = g_settings_get_boolean (settings, key);
+		if (changes & PREFS_CHANGE_RIGHT_MARGIN)
+			gtk_source_view_set_show_right_margin (view, right_margin);
 
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
+		if (changes & PREFS_CHANGE_SMART_HOME_END)
+			gtk_source_view_set_smart_home_end (view, smart_home_end);
 
-		while (l != NULL)
+		if (!PLUMA_IS_DOCUMENT (doc) || g_hash_table_contains (docs, doc))
+			continue;
+
+		g_hash_table_add (docs, doc);
+
+		apply_document_changes (PLUMA_DOCUMENT (doc),
+					changes,
+					bracket_matching,
+					undo_levels,
+					syntax_hl,
+					search_hl,
+					style,
+					auto_save,
+					auto_save_interval);
+	}
+
+	g_hash_table_destroy (docs);
+
+out:
+	if (changes & PREFS_CHANGE_SYNTAX_HL)
+	{
+		const GList *windows;
+
+		/* update the sensitivity of the Higlight Mode menu item */
+		windows = pluma_app_get_windows (pluma_app_get_default ());
+		while (windows != NULL)
 		{
-			gtk_source_view_set_insert_spaces_instead_of_tabs (
-					GTK_SOURCE_VIEW (l->data),
-					enable);
+			GtkUIManager *ui;
+			GtkAction *a;
 
-			l = l->next;
-		}
+			ui = pluma_window_get_ui_manager (PLUMA_WINDOW (windows->data));
+
+			a = gtk_ui_manager_get_action (ui,
+						       "/MenuBar/ViewMenu/ViewHighlightModeMenu");
+
+			gtk_action_set_sensitive (a, syntax_hl);
 
-		g_list_free (views);
+			windows = g_list_next (windows);
+		}
 	}
+
+	g_free (font);
+
+	return FALSE;
 }
 
-static GtkWrapMode
-get_wrap_mode_from_string (const gchar* str)
+static void
+queue_change (PrefsChange change)
 {
-	GtkWrapMode res;
-
-	g_return_val_if_fail (str != NULL, GTK_WRAP_WORD);
+	pending_changes |= change;
 
-	if (strcmp (str, "GTK_WRAP_NONE") == 0)
-		res = GTK_WRAP_NONE;
-	else
+	/* before the views get relayouted and redrawn */
+	if (apply_changes_id == 0)
 	{
-		if (strcmp (str, "GTK_WRAP_CHAR") == 0)
-			res = GTK_WRAP_CHAR;
-		else
-			res = GTK_WRAP_WORD;
+		apply_changes_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
+						    apply_changes,
+						    NULL,
+						    NULL);
 	}
+}
 
-	return res;
+static void
+pluma_prefs_manager_editor_font_changed (GSettings *settings,
+					 gchar       *key,
+					 gpointer     user_data)
+{
+	pluma_debug (DEBUG_PREFS);
+
+	if (strcmp (key, GPM_USE_DEFAULT_FONT) == 0 ||
+	    strcmp (key, GPM_EDITOR_FONT) == 0)
+		queue_change (PREFS_CHANGE_FONT);
 }
 
 static void
-pluma_prefs_manager_wrap_mode_changed (GSettings *settings,
-	                               gchar         *key,
-	                               gpointer       user_data)
+pluma_prefs_manager_system_font_changed (GSettings *settings,
+					 gchar       *key,
+					 gpointer     user_data)
 {
 	pluma_debug (DEBUG_PREFS);
 
-	if (strcmp (key, GPM_WRAP_MODE) == 0)
-	{
-		GtkWrapMode wrap_mode;
-		GList *views;
-		GList *l;
+	if (strcmp (key, GPM_SYSTEM_FONT) != 0)
+		return;
 
-		wrap_mode = get_wrap_mode_from_string (g_settings_get_string(settings, key));
+	if (!pluma_prefs_manager_get_use_default_font ())
+		return;
 
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
+	queue_change (PREFS_CHANGE_FONT);
+}
 
-		while (l != NULL)
-		{
-			gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (l->data),
-						     wrap_mode);
+static void
+pluma_prefs_manager_tabs_size_changed (GSettings *settings,
+				       gchar       *key,
+				       gpointer     user_data)
+{
+	pluma_debug (DEBUG_PREFS);
 
-			l = l->next;
-		}
+	if (strcmp (key, GPM_TABS_SIZE) == 0)
+		queue_change (PREFS_CHANGE_TAB_WIDTH);
+	else if (strcmp (key, GPM_INSERT_SPACES) == 0)
+		queue_change (PREFS_CHANGE_INSERT_SPACES);
+}
 
-		g_list_free (views);
-	}
+static void
+pluma_prefs_manager_wrap_mode_changed (GSettings *settings,
+	                               gchar         *key,
+	                               gpointer       user_data)
+{
+	pluma_debug (DEBUG_PREFS);
+
+	if (strcmp (key, GPM_WRAP_MODE) == 0)
+		queue_change (PREFS_CHANGE_WRAP_MODE);
 }
 
 static void
@@ -931,26 +1153,7 @@ pluma_prefs_manager_line_numbers_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_DISPLAY_LINE_NUMBERS) == 0)
-	{
-		gboolean dln;
-		GList *views;
-		GList *l;
-
-		dln = g_settings_get_boolean (settings, key);
-
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
-
-		while (l != NULL)
-		{
-			gtk_source_view_set_show_line_numbers (GTK_SOURCE_VIEW (l->data),
-							       dln);
-
-			l = l->next;
-		}
-
-		g_list_free (views);
-	}
+		queue_change (PREFS_CHANGE_LINE_NUMBERS);
 }
 
 static void
@@ -961,26 +1164,7 @@ pluma_prefs_manager_hl_current_line_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_HIGHLIGHT_CURRENT_LINE) == 0)
-	{
-		gboolean hl;
-		GList *views;
-		GList *l;
-
-		hl = g_settings_get_boolean (settings, key);
-
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
-
-		while (l != NULL)
-		{
-			gtk_source_view_set_highlight_current_line (GTK_SOURCE_VIEW (l->data),
-								    hl);
-
-			l = l->next;
-		}
-
-		g_list_free (views);
-	}
+		queue_change (PREFS_CHANGE_HL_CURRENT_LINE);
 }
 
 static void
@@ -991,26 +1175,7 @@ pluma_prefs_manager_bracket_matching_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_BRACKET_MATCHING) == 0)
-	{
-		gboolean enable;
-		GList *docs;
-		GList *l;
-
-		enable = g_settings_get_boolean (settings, key);
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		l = docs;
-
-		while (l != NULL)
-		{
-			gtk_source_buffer_set_highlight_matching_brackets (GTK_SOURCE_BUFFER (l->data),
-									   enable);
-
-			l = l->next;
-		}
-
-		g_list_free (docs);
-	}
+		queue_change (PREFS_CHANGE_BRACKET_MATCHING);
 }
 
 static void
@@ -1021,26 +1186,7 @@ pluma_prefs_manager_auto_indent_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_AUTO_INDENT) == 0)
-	{
-		gboolean enable;
-		GList *views;
-		GList *l;
-
-		enable = g_settings_get_boolean (settings, key);
-
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
-
-		while (l != NULL)
-		{
-			gtk_source_view_set_auto_indent (GTK_SOURCE_VIEW (l->data),
-							 enable);
-
-			l = l->next;
-		}
-
-		g_list_free (views);
-	}
+		queue_change (PREFS_CHANGE_AUTO_INDENT);
 }
 
 static void
@@ -1051,28 +1197,7 @@ pluma_prefs_manager_undo_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_UNDO_ACTIONS_LIMIT) == 0)
-	{
-		gint ul;
-		GList *docs;
-		GList *l;
-
-		ul = g_settings_get_int (settings, key);
-
-		ul = CLAMP (ul, -1, 250);
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		l = docs;
-
-		while (l != NULL)
-		{
-			gtk_source_buffer_set_max_undo_levels (GTK_SOURCE_BUFFER (l->data),
-							       ul);
-
-			l = l->next;
-		}
-
-		g_list_free (docs);
-	}
+		queue_change (PREFS_CHANGE_UNDO);
 }
 
 static void
@@ -1083,68 +1208,9 @@ pluma_prefs_manager_right_margin_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_RIGHT_MARGIN_POSITION) == 0)
-	{
-		gint pos;
-		GList *views;
-		GList *l;
-
-		pos = g_settings_get_int (settings, key);
-
-		pos = CLAMP (pos, 1, 160);
-
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
-
-		while (l != NULL)
-		{
-			gtk_source_view_set_right_margin_position (GTK_SOURCE_VIEW (l->data),
-								   pos);
-
-			l = l->next;
-		}
-
-		g_list_free (views);
-	}
+		queue_change (PREFS_CHANGE_RIGHT_MARGIN_POS);
 	else if (strcmp (key, GPM_DISPLAY_RIGHT_MARGIN) == 0)
-	{
-		gboolean display;
-		GList *views;
-		GList *l;
-
-		display = g_settings_get_boolean (settings, key);
-
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
-
-		while (l != NULL)
-		{
-			gtk_source_view_set_show_right_margin (GTK_SOURCE_VIEW (l->data),
-							       display);
-
-			l = l->next;
-		}
-
-		g_list_free (views);
-	}
-}
-
-static GtkSourceSmartHomeEndType
-get_smart_home_end_from_string (const gchar *str)
-{
-	GtkSourceSmartHomeEndType res;
-
-	g_return_val_if_fail (str != NULL, GTK_SOURCE_SMART_HOME_END_AFTER);
-
-	if (strcmp (str, "DISABLED") == 0)
-		res = GTK_SOURCE_SMART_HOME_END_DISABLED;
-	else if (strcmp (str, "BEFORE") == 0)
-		res = GTK_SOURCE_SMART_HOME_END_BEFORE;
-	else if (strcmp (str, "ALWAYS") == 0)
-		res = GTK_SOURCE_SMART_HOME_END_ALWAYS;
-	else
-		res = GTK_SOURCE_SMART_HOME_END_AFTER;
-
-	return res;
+		queue_change (PREFS_CHANGE_RIGHT_MARGIN);
 }
 
 static void
@@ -1155,26 +1221,7 @@ pluma_prefs_manager_smart_home_end_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_SMART_HOME_END) == 0)
-	{
-		GtkSourceSmartHomeEndType smart_he;
-		GList *views;
-		GList *l;
-
-		smart_he = get_smart_home_end_from_string (g_settings_get_string (settings, key));
-
-		views = pluma_app_get_views (pluma_app_get_default ());
-		l = views;
-
-		while (l != NULL)
-		{
-			gtk_source_view_set_smart_home_end (GTK_SOURCE_VIEW (l->data),
-							    smart_he);
-
-			l = l->next;
-		}
-
-		g_list_free (views);
-	}
+		queue_change (PREFS_CHANGE_SMART_HOME_END);
 }
 
 static void
@@ -1185,46 +1232,7 @@ pluma_prefs_manager_syntax_hl_enable_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_SYNTAX_HL_ENABLE) == 0)
-	{
-		gboolean enable;
-		GList *docs;
-		GList *l;
-		const GList *windows;
-
-		enable = g_settings_get_boolean (settings, key);
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		l = docs;
-
-		while (l != NULL)
-		{
-			g_return_if_fail (GTK_SOURCE_IS_BUFFER (l->data));
-
-			gtk_source_buffer_set_highlight_syntax (GTK_SOURCE_BUFFER (l->data),
-								enable);
-
-			l = l->next;
-		}
-
-		g_list_free (docs);
-
-		/* update the sensitivity of the Higlight Mode menu item */
-		windows = pluma_app_get_windows (pluma_app_get_default ());
-		while (windows != NULL)
-		{
-			GtkUIManager *ui;
-			GtkAction *a;
-
-			ui = pluma_window_get_ui_manager (PLUMA_WINDOW (windows->data));
-
-			a = gtk_ui_manager_get_action (ui,
-						       "/MenuBar/ViewMenu/ViewHighlightModeMenu");
-
-			gtk_action_set_sensitive (a, enable);
-
-			windows = g_list_next (windows);
-		}
-	}
+		queue_change (PREFS_CHANGE_SYNTAX_HL);
 }
 
 static void
@@ -1235,28 +1243,7 @@ pluma_prefs_manager_search_hl_enable_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_SEARCH_HIGHLIGHTING_ENABLE) == 0)
-	{
-		gboolean enable;
-		GList *docs;
-		GList *l;
-
-		enable = g_settings_get_boolean (settings, key);
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		l = docs;
-
-		while (l != NULL)
-		{
-			g_return_if_fail (PLUMA_IS_DOCUMENT (l->data));
-
-			pluma_document_set_enable_search_highlighting  (PLUMA_DOCUMENT (l->data),
-									enable);
-
-			l = l->next;
-		}
-
-		g_list_free (docs);
-	}
+		queue_change (PREFS_CHANGE_SEARCH_HL);
 }
 
 static void
@@ -1267,51 +1254,7 @@ pluma_prefs_manager_source_style_scheme_changed (GSettings *settings,
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_SOURCE_STYLE_SCHEME) == 0)
-	{
-		static gchar *old_scheme = NULL;
-		gchar *scheme;
-		GtkSourceStyleScheme *style;
-		GList *docs;
-		GList *l;
-
-		scheme = g_settings_get_string (settings, key);
-
-		if (old_scheme != NULL && (strcmp (scheme, old_scheme) == 0))
-		    	return;
-
-		g_free (old_scheme);
-		old_scheme = scheme;
-
-		style = gtk_source_style_scheme_manager_get_scheme (
-				pluma_get_style_scheme_manager (),
-				scheme);
-
-		if (style == NULL)
-		{
-			g_warning ("Default style scheme '%s' not found, falling back to 'classic'", scheme);
-
-			style = gtk_source_style_scheme_manager_get_scheme (
-				pluma_get_style_scheme_manager (),
-				"classic");
-
-			if (style == NULL)
-			{
-				g_warning ("Style scheme 'classic' cannot be found, check your GtkSourceView installation.");
-				return;
-			}
-		}
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		for (l = docs; l != NULL; l = l->next)
-		{
-			g_return_if_fail (GTK_SOURCE_IS_BUFFER (l->data));
-
-			gtk_source_buffer_set_style_scheme (GTK_SOURCE_BUFFER (l->data),
-							    style);
-		}
-
-		g_list_free (docs);
-	}
+		queue_change (PREFS_CHANGE_STYLE_SCHEME);
 }
 
 static void
@@ -1353,56 +1296,12 @@ pluma_prefs_manager_auto_save_changed (GSettings *settings,
 				       gchar       *key,
 				       gpointer     user_data)
 {
-	GList *docs;
-	GList *l;
-
 	pluma_debug (DEBUG_PREFS);
 
 	if (strcmp (key, GPM_AUTO_SAVE) == 0)
-	{
-		gboolean auto_save;
-
-		auto_save = g_settings_get_boolean (settings, key);
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		l = docs;
-
-		while (l != NULL)
-		{
-			PlumaDocument *doc = PLUMA_DOCUMENT (l->data);
-			PlumaTab *tab = pluma_tab_get_from_document (doc);
-
-			pluma_tab_set_auto_save_enabled (tab, auto_save);
-
-			l = l->next;
-		}
-
-		g_list_free (docs);
-	}
+		queue_change (PREFS_CHANGE_AUTO_SAVE);
 	else if (strcmp (key,  GPM_AUTO_SAVE_INTERVAL) == 0)
-	{
-		gint auto_save_interval;
-
-		auto_save_interval = g_settings_get_int (settings, key);
-
-		if (auto_save_interval <= 0)
-			auto_save_interval = GPM_DEFAULT_AUTO_SAVE_INTERVAL;
-
-		docs = pluma_app_get_documents (pluma_app_get_default ());
-		l = docs;
-
-		while (l != NULL)
-		{
-			PlumaDocument *doc = PLUMA_DOCUMENT (l->data);
-			PlumaTab *tab = pluma_tab_get_from_document (doc);
-
-			pluma_tab_set_auto_save_interval (tab, auto_save_interval);
-
-			l = l->next;
-		}
-
-		g_list_free (docs);
-	}
+		queue_change (PREFS_CHANGE_AUTO_SAVE_INTERVAL);
 }
 
 static void
@@ -34,6 +34,7 @@
 
 #include <glib.h>
 #include <pluma/pluma-prefs-manager.h>
+#include <pluma/pluma-view.h>
 
 /** LIFE CYCLE MANAGEMENT FUNCTIONS **/
 
@@ -80,5 +81,12 @@ gint		 pluma_prefs_manager_get_active_file_filter	(void);
 void 		 pluma_prefs_manager_set_active_file_filter	(gint id);
 gboolean	 pluma_prefs_manager_active_file_filter_can_set	(void);
 
+/*
+ * Non exported functions
+ */
+
+/* Views get the preference changes applied by the prefs manager */
+void		 _pluma_prefs_manager_app_register_view		(PlumaView *view);
+void		 _pluma_prefs_manager_app_unregister_view	(PlumaView *view);
 
 #endif /* __PLUMA_PREFS_MANAGER_APP_H__ */
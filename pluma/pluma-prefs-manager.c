@@ -265,6 +265,26 @@ DEFINE_BOOL_PREF (auto_save,
 DEFINE_INT_PREF (auto_save_interval,
 		 GPM_AUTO_SAVE_INTERVAL)
 
+/* Follow mode */
+DEFINE_BOOL_PREF (follow_auto_scroll,
+		  GPM_FOLLOW_AUTO_SCROLL)
+
+/* Follow mode max lines: if < 1 then no limits */
+DEFINE_INT_PREF (follow_max_lines,
+		 GPM_FOLLOW_MAX_LINES)
+
+/* Large file size, in MiB: if < 1 then the size is not checked */
+DEFINE_INT_PREF (large_file_size,
+		 GPM_LARGE_FILE_SIZE)
+
+/* Large file lines: if < 1 then the lines are not counted */
+DEFINE_INT_PREF (large_file_lines,
+		 GPM_LARGE_FILE_LINES)
+
+/* Paged file size, in MiB: if < 1 then files are never paged */
+DEFINE_INT_PREF (paged_file_size,
+		 GPM_PAGED_FILE_SIZE)
+
 
 /* Undo actions limit: if < 1 then no limits */
 DEFINE_INT_PREF (undo_actions_limit,
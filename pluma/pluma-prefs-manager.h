@@ -46,6 +46,13 @@
 #define GPM_AUTO_SAVE			"auto-save"
 #define GPM_AUTO_SAVE_INTERVAL	"auto-save-interval"
 
+#define GPM_FOLLOW_AUTO_SCROLL	"follow-auto-scroll"
+#define GPM_FOLLOW_MAX_LINES	"follow-max-lines"
+
+#define GPM_LARGE_FILE_SIZE		"large-file-size"
+#define GPM_LARGE_FILE_LINES	"large-file-lines"
+#define GPM_PAGED_FILE_SIZE		"paged-file-size"
+
 #define GPM_UNDO_ACTIONS_LIMIT	"max-undo-actions"
 
 #define GPM_WRAP_MODE			"wrap-mode"
@@ -167,6 +174,31 @@ gint			 pluma_prefs_manager_get_auto_save_interval	(void);
 void			 pluma_prefs_manager_set_auto_save_interval	(gint asi);
 gboolean		 pluma_prefs_manager_auto_save_interval_can_set	(void);
 
+/* Follow mode */
+gboolean		 pluma_prefs_manager_get_follow_auto_scroll	(void);
+void			 pluma_prefs_manager_set_follow_auto_scroll	(gboolean fas);
+gboolean		 pluma_prefs_manager_follow_auto_scroll_can_set	(void);
+
+/* Follow mode max lines: if < 1 then no limits */
+gint			 pluma_prefs_manager_get_follow_max_lines	(void);
+void			 pluma_prefs_manager_set_follow_max_lines	(gint fml);
+gboolean		 pluma_prefs_manager_follow_max_lines_can_set	(void);
+
+/* Large file size, in MiB: if < 1 then the size is not checked */
+gint			 pluma_prefs_manager_get_large_file_size	(void);
+void			 pluma_prefs_manager_set_large_file_size	(gint lfs);
+gboolean		 pluma_prefs_manager_large_file_size_can_set	(void);
+
+/* Large file lines: if < 1 then the lines are not counted */
+gint			 pluma_prefs_manager_get_large_file_lines	(void);
+void			 pluma_prefs_manager_set_large_file_lines	(gint lfl);
+gboolean		 pluma_prefs_manager_large_file_lines_can_set	(void);
+
+/* Paged file size, in MiB: if < 1 then files are never paged */
+gint			 pluma_prefs_manager_get_paged_file_size	(void);
+void			 pluma_prefs_manager_set_paged_file_size	(gint pfs);
+gboolean		 pluma_prefs_manager_paged_file_size_can_set	(void);
+
 /* Undo actions limit: if < 1 then no limits */
 gint 			 pluma_prefs_manager_get_undo_actions_limit	(void);
 void			 pluma_prefs_manager_set_undo_actions_limit	(gint ual);
@@ -49,6 +49,7 @@
 #include "pluma-prefs-manager-app.h"
 #include "pluma-metadata-manager.h"
 #include "pluma-window.h"
+#include "pluma-window-private.h"
 #include "pluma-app.h"
 #include "pluma-commands.h"
 #include "dialogs/pluma-close-confirmation-dialog.h"
@@ -64,6 +65,12 @@ static void	ask_next_confirmation	(void);
 
 #define PLUMA_SESSION_LIST_OF_DOCS_TO_SAVE "pluma-session-list-of-docs-to-save-key"
 
+/* Staged restore: the load queue of each window loads its active document
+ * first and the other tabs in the background, these are only used to
+ * report how long it took */
+static guint    restoring_windows = 0;
+static GTimer  *restore_timer = NULL;
+
 static void
 save_window_session (GKeyFile    *state_file,
 		     const gchar *group_name,
@@ -450,6 +457,55 @@ pluma_session_is_restored (void)
 	return restored;
 }
 
+static void
+active_document_loaded (PlumaDocument *doc,
+			const GError  *error,
+			gpointer       data)
+{
+	g_signal_handlers_disconnect_by_func (doc, active_document_loaded, data);
+
+	pluma_debug_message (DEBUG_SESSION,
+			     "Active document ready after %f seconds",
+			     g_timer_elapsed (restore_timer, NULL));
+}
+
+static gboolean
+restore_window_key_press (GtkWidget   *widget,
+			  GdkEventKey *event,
+			  gpointer     data)
+{
+	const GList *windows;
+
+	windows = pluma_app_get_windows (pluma_app_get_default ());
+
+	for (; windows != NULL; windows = g_list_next (windows))
+	{
+		g_signal_handlers_disconnect_by_func (windows->data,
+						      restore_window_key_press,
+						      data);
+	}
+
+	pluma_debug_message (DEBUG_SESSION,
+			     "First keystroke after %f seconds",
+			     g_timer_elapsed (restore_timer, NULL));
+
+	return FALSE;
+}
+
+static void
+restore_window_drained (PlumaLoadQueue *queue,
+			gpointer        data)
+{
+	g_signal_handlers_disconnect_by_func (queue, restore_window_drained, data);
+
+	if (--restoring_windows > 0)
+		return;
+
+	pluma_debug_message (DEBUG_SESSION,
+			     "All documents restored after %f seconds",
+			     g_timer_elapsed (restore_timer, NULL));
+}
+
 static void
 parse_window (GKeyFile *state_file, const char *group_name)
 {
@@ -535,10 +591,16 @@ parse_window (GKeyFile *state_file, const char *group_name)
 						 "active-document", NULL);
 	documents = g_key_file_get_string_list (state_file, group_name,
 						"documents", NULL, NULL);
+	g_signal_connect (window,
+			  "key-press-event",
+			  G_CALLBACK (restore_window_key_press),
+			  NULL);
+
 	if (documents)
 	{
 	        int i;
 		gboolean jump_to = FALSE;
+		PlumaTab *tab;
   
 		for (i = 0; documents[i]; i++)
 		{
@@ -550,14 +612,31 @@ parse_window (GKeyFile *state_file, const char *group_name)
 					     "URI: %s (%s)",
 					     documents[i],
 					     jump_to ? "active" : "not active");
-			pluma_window_create_tab_from_uri (window,
-							  documents[i],
-							  NULL,
-							  0,
-							  FALSE,
-							  jump_to);
+
+			/* only the active tab is loaded right away, the
+			 * others wait in the load queue of the window */
+			tab = pluma_window_create_tab_from_uri (window,
+								documents[i],
+								NULL,
+								0,
+								FALSE,
+								jump_to);
+
+			if (tab != NULL && jump_to)
+			{
+				g_signal_connect_after (pluma_tab_get_document (tab),
+							"loaded",
+							G_CALLBACK (active_document_loaded),
+							NULL);
+			}
 		}
 		g_strfreev (documents);
+
+		++restoring_windows;
+		g_signal_connect (window->priv->load_queue,
+				  "drained",
+				  G_CALLBACK (restore_window_drained),
+				  NULL);
 	}
  
 	g_free (active_document);
@@ -588,6 +667,13 @@ pluma_session_load (void)
 
 	groups = g_key_file_get_groups (state_file, NULL);
 
+	if (restore_timer == NULL)
+		restore_timer = g_timer_new ();
+	else
+		g_timer_start (restore_timer);
+
+	restoring_windows = 0;
+
 	for (i = 0; groups[i] != NULL; i++)
 	{
 		if (g_str_has_prefix (groups[i], "pluma window "))
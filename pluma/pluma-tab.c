@@ -67,6 +67,11 @@ struct _PlumaTabPrivate
 	/* tmp data for loading */
 	gint                    tmp_line_pos;
 	const PlumaEncoding    *tmp_encoding;
+
+	/* uri of a load which has been deferred, see
+	 * _pluma_tab_new_from_uri_deferred */
+	gchar		       *pending_uri;
+	gboolean                pending_create;
 	
 	GTimer 		       *timer;
 	guint		        times_called;
@@ -81,6 +86,8 @@ struct _PlumaTabPrivate
 
 	gint                    ask_if_externally_modified : 1;
 
+	gint                    paged_shifting : 1;
+
 	guint			idle_scroll;
 };
 
@@ -231,6 +238,7 @@ pluma_tab_finalize (GObject *object)
 		g_timer_destroy (tab->priv->timer);
 
 	g_free (tab->priv->tmp_save_uri);
+	g_free (tab->priv->pending_uri);
 
 	if (tab->priv->auto_save_timeout > 0)
 		remove_auto_save_timeout (tab);
@@ -368,9 +376,12 @@ set_view_properties_according_to_state (PlumaTab      *tab,
 {
 	gboolean val;
 
+	/* appending to a followed file drops the undo history, so it
+	 * must not hold any edits */
 	val = ((state == PLUMA_TAB_STATE_NORMAL) &&
 	       (tab->priv->print_preview == NULL) &&
-	       !tab->priv->not_editable);
+	       !tab->priv->not_editable &&
+	       !_pluma_document_get_follow (pluma_tab_get_document (tab)));
 	gtk_text_view_set_editable (GTK_TEXT_VIEW (tab->priv->view), val);
 
 	val = ((state != PLUMA_TAB_STATE_LOADING) &&
@@ -379,7 +390,9 @@ set_view_properties_according_to_state (PlumaTab      *tab,
 
 	val = ((state != PLUMA_TAB_STATE_LOADING) &&
 	       (state != PLUMA_TAB_STATE_CLOSING) &&
-	       (pluma_prefs_manager_get_highlight_current_line ()));
+	       (pluma_prefs_manager_get_highlight_current_line ()) &&
+	       !(pluma_document_get_disabled_features (pluma_tab_get_document (tab)) &
+		 PLUMA_DOCUMENT_FEATURE_CURRENT_LINE));
 	gtk_source_view_set_highlight_current_line (GTK_SOURCE_VIEW (tab->priv->view), val);
 }
 
@@ -547,7 +560,9 @@ file_already_open_warning_message_area_response (GtkWidget   *message_area,
 	
 	view = pluma_tab_get_view (tab);
 	
-	if (response_id == GTK_RESPONSE_YES)
+	if (response_id == GTK_RESPONSE_YES &&
+	    !_pluma_document_is_paged (pluma_tab_get_document (tab)) &&
+	    !_pluma_document_get_follow (pluma_tab_get_document (tab)))
 	{
 		tab->priv->not_editable = FALSE;
 		
@@ -1017,6 +1032,9 @@ document_loaded (PlumaDocument *document,
 			tab->priv->idle_scroll = g_idle_add ((GSourceFunc)scroll_to_cursor, tab);
 		}
 
+		/* only part of a paged file is loaded, it cannot be edited */
+		tab->priv->not_editable = _pluma_document_is_paged (document);
+
 		all_documents = pluma_app_get_documents (pluma_app_get_default ());
 
 		for (l = all_documents; l != NULL; l = g_list_next (l))
@@ -1380,6 +1398,71 @@ document_saved (PlumaDocument *document,
 	}
 }
 
+static void
+document_reloaded (PlumaDocument *doc,
+		   GAsyncResult  *res,
+		   PlumaTab      *tab)
+{
+	GError *error = NULL;
+	gboolean success;
+
+	success = _pluma_document_reload_finish (doc, res, &error);
+
+	/* the tab is being or has been closed */
+	if (tab->priv->state != PLUMA_TAB_STATE_REVERTING ||
+	    gtk_widget_get_parent (GTK_WIDGET (tab)) == NULL)
+	{
+		if (error != NULL)
+			g_error_free (error);
+
+		g_object_unref (tab);
+		return;
+	}
+
+	pluma_tab_set_state (tab, PLUMA_TAB_STATE_NORMAL);
+
+	if (success)
+	{
+		tab->priv->ask_if_externally_modified = TRUE;
+	}
+	else
+	{
+		pluma_debug_message (DEBUG_TAB,
+				     "Incremental reload failed: %s", error->message);
+		g_error_free (error);
+
+		/* load the whole file again */
+		_pluma_tab_revert (tab);
+	}
+
+	g_object_unref (tab);
+}
+
+/* Reloads a file changed on disk by applying only the lines that
+ * changed, which keeps undo history, marks and the scroll position */
+static void
+reload_externally_modified (PlumaTab *tab)
+{
+	PlumaDocument *doc;
+
+	doc = pluma_tab_get_document (tab);
+
+	/* following the file needs a loader which read all of it, and a
+	 * paged file is too big to be read and compared */
+	if (_pluma_document_get_follow (doc) || _pluma_document_is_paged (doc))
+	{
+		_pluma_tab_revert (tab);
+		return;
+	}
+
+	pluma_tab_set_state (tab, PLUMA_TAB_STATE_REVERTING);
+
+	_pluma_document_reload_async (doc,
+				      NULL,
+				      (GAsyncReadyCallback) document_reloaded,
+				      g_object_ref (tab));
+}
+
 static void 
 externally_modified_notification_message_area_response (GtkWidget        *message_area,
 							gint              response_id,
@@ -1392,7 +1475,7 @@ externally_modified_notification_message_area_response (GtkWidget        *messag
 
 	if (response_id == GTK_RESPONSE_OK)
 	{
-		_pluma_tab_revert (tab);
+		reload_externally_modified (tab);
 	}
 	else
 	{
@@ -1435,25 +1518,21 @@ display_externally_modified_notification (PlumaTab *tab)
 			  tab);
 }
 
-static gboolean
-view_focused_in (GtkWidget     *widget,
-                 GdkEventFocus *event,
-                 PlumaTab      *tab)
+static void
+check_externally_modified (PlumaTab *tab)
 {
 	PlumaDocument *doc;
 
-	g_return_val_if_fail (PLUMA_IS_TAB (tab), FALSE);
-
 	/* we try to detect file changes only in the normal state */
 	if (tab->priv->state != PLUMA_TAB_STATE_NORMAL)
 	{
-		return FALSE;
+		return;
 	}
 
 	/* we already asked, don't bug the user again */
 	if (!tab->priv->ask_if_externally_modified)
 	{
-		return FALSE;
+		return;
 	}
 
 	doc = pluma_tab_get_document (tab);
@@ -1461,21 +1540,143 @@ view_focused_in (GtkWidget     *widget,
 	/* If file was never saved or is remote we do not check */
 	if (!pluma_document_is_local (doc))
 	{
-		return FALSE;
+		return;
 	}
 
+	/* this only looks at the state cached by the document, the file
+	 * itself is checked asynchronously */
 	if (_pluma_document_check_externally_modified (doc))
 	{
 		pluma_tab_set_state (tab, PLUMA_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION);
 
 		display_externally_modified_notification (tab);
-
-		return FALSE;
 	}
+}
+
+static gboolean
+view_focused_in (GtkWidget     *widget,
+                 GdkEventFocus *event,
+                 PlumaTab      *tab)
+{
+	g_return_val_if_fail (PLUMA_IS_TAB (tab), FALSE);
+
+	check_externally_modified (tab);
 
 	return FALSE;
 }
 
+static void
+document_file_appended (PlumaDocument *document,
+			PlumaTab      *tab)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (document);
+	GtkTextMark *mark;
+	GtkTextIter end;
+
+	if (!pluma_prefs_manager_get_follow_auto_scroll ())
+		return;
+
+	/* a mark with right gravity stays at the end while text is
+	 * appended, and can be scrolled to before the view validates
+	 * the new lines */
+	mark = gtk_text_buffer_get_mark (buffer, "pluma-follow-end");
+
+	if (mark == NULL)
+	{
+		gtk_text_buffer_get_end_iter (buffer, &end);
+		mark = gtk_text_buffer_create_mark (buffer, "pluma-follow-end",
+						    &end, FALSE);
+	}
+
+	gtk_text_view_scroll_mark_onscreen (GTK_TEXT_VIEW (tab->priv->view),
+					    mark);
+}
+
+/* The cursor was moved once the lines up to it were counted */
+static void
+document_paged_line_shown (PlumaDocument *document,
+			   PlumaTab      *tab)
+{
+	pluma_view_scroll_to_cursor (PLUMA_VIEW (tab->priv->view));
+}
+
+/* Paged documents only hold part of the file: move the window when
+ * getting close to one of its ends, keeping the same line on top */
+static void
+paged_scrolled (GtkAdjustment *adjustment,
+		PlumaTab      *tab)
+{
+	PlumaDocument *doc;
+	GtkTextBuffer *buffer;
+	GtkTextView *view;
+	GtkTextMark *mark;
+	GtkTextIter iter;
+	gdouble value;
+	gdouble upper;
+	gdouble page_size;
+	gboolean forward;
+	gint64 top_line;
+	gint line;
+
+	doc = pluma_tab_get_document (tab);
+
+	if (tab->priv->paged_shifting || !_pluma_document_is_paged (doc))
+		return;
+
+	value = gtk_adjustment_get_value (adjustment);
+	upper = gtk_adjustment_get_upper (adjustment);
+	page_size = gtk_adjustment_get_page_size (adjustment);
+
+	if (value + 2 * page_size >= upper)
+		forward = TRUE;
+	else if (value <= page_size)
+		forward = FALSE;
+	else
+		return;
+
+	buffer = GTK_TEXT_BUFFER (doc);
+	view = GTK_TEXT_VIEW (tab->priv->view);
+
+	gtk_text_view_get_line_at_y (view, &iter, (gint) value, NULL);
+	top_line = _pluma_document_get_paged_first_line (doc) +
+		   gtk_text_iter_get_line (&iter);
+
+	tab->priv->paged_shifting = TRUE;
+
+	if (_pluma_document_shift_paged_window (doc, forward))
+	{
+		line = CLAMP (top_line - _pluma_document_get_paged_first_line (doc),
+			      0,
+			      gtk_text_buffer_get_line_count (buffer) - 1);
+
+		gtk_text_buffer_get_iter_at_line (buffer, &iter, line);
+
+		/* the new lines are not validated yet, scroll to a mark */
+		mark = gtk_text_buffer_get_mark (buffer, "pluma-paged-top");
+
+		if (mark == NULL)
+			mark = gtk_text_buffer_create_mark (buffer, "pluma-paged-top",
+							    &iter, TRUE);
+		else
+			gtk_text_buffer_move_mark (buffer, mark, &iter);
+
+		gtk_text_view_scroll_to_mark (view, mark, 0.0, TRUE, 0.0, 0.0);
+	}
+
+	tab->priv->paged_shifting = FALSE;
+}
+
+static void
+document_externally_modified (PlumaDocument *document,
+			      PlumaTab      *tab)
+{
+	/* tabs the user is not looking at wait for focus-in */
+	if (gtk_widget_has_focus (tab->priv->view))
+	{
+		check_externally_modified (tab);
+	}
+}
+
 static GMountOperation *
 tab_mount_operation_factory (PlumaDocument *doc,
 			     gpointer userdata)
@@ -1544,6 +1745,11 @@ pluma_tab_init (PlumaTab *tab)
 					     GTK_SHADOW_IN);	
 	gtk_widget_show (sw);
 
+	g_signal_connect (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw)),
+			  "value-changed",
+			  G_CALLBACK (paged_scrolled),
+			  tab);
+
 	g_signal_connect (doc,
 			  "notify::uri",
 			  G_CALLBACK (document_uri_notify_handler),
@@ -1572,6 +1778,21 @@ pluma_tab_init (PlumaTab *tab)
 			  "saved",
 			  G_CALLBACK (document_saved),
 			  tab);
+	g_signal_connect_object (doc,
+				 "externally-modified",
+				 G_CALLBACK (document_externally_modified),
+				 tab,
+				 0);
+	g_signal_connect_object (doc,
+				 "file-appended",
+				 G_CALLBACK (document_file_appended),
+				 tab,
+				 0);
+	g_signal_connect_object (doc,
+				 "paged-line-shown",
+				 G_CALLBACK (document_paged_line_shown),
+				 tab,
+				 0);
 
 	g_signal_connect_after (tab->priv->view,
 				"focus-in-event",
@@ -1613,6 +1834,71 @@ _pluma_tab_new_from_uri (const gchar         *uri,
 	return GTK_WIDGET (tab);
 }		
 
+/* Creates a tab for @uri without starting to load it: the tab shows the
+ * document name and stays in the loading state until
+ * _pluma_tab_load_deferred is called. The window queues such tabs, so
+ * that the ones the user sees are loaded first, see pluma-load-queue.c */
+GtkWidget *
+_pluma_tab_new_from_uri_deferred (const gchar         *uri,
+				  const PlumaEncoding *encoding,
+				  gint                 line_pos,
+				  gboolean             create)
+{
+	PlumaTab *tab;
+
+	g_return_val_if_fail (uri != NULL, NULL);
+
+	tab = PLUMA_TAB (_pluma_tab_new ());
+
+	tab->priv->pending_uri = g_strdup (uri);
+	tab->priv->pending_create = create;
+	tab->priv->tmp_line_pos = line_pos;
+	tab->priv->tmp_encoding = encoding;
+
+	/* so that the tab label and the saved session know the document */
+	pluma_document_set_uri (pluma_tab_get_document (tab), uri);
+
+	pluma_tab_set_state (tab, PLUMA_TAB_STATE_LOADING);
+
+	return GTK_WIDGET (tab);
+}
+
+gboolean
+_pluma_tab_is_load_deferred (PlumaTab *tab)
+{
+	g_return_val_if_fail (PLUMA_IS_TAB (tab), FALSE);
+
+	return tab->priv->pending_uri != NULL;
+}
+
+void
+_pluma_tab_load_deferred (PlumaTab *tab)
+{
+	gchar *uri;
+
+	g_return_if_fail (PLUMA_IS_TAB (tab));
+	g_return_if_fail (tab->priv->state == PLUMA_TAB_STATE_LOADING);
+
+	if (tab->priv->pending_uri == NULL)
+		return;
+
+	uri = tab->priv->pending_uri;
+	tab->priv->pending_uri = NULL;
+
+	pluma_debug_message (DEBUG_TAB, "Loading deferred uri: %s", uri);
+
+	if (tab->priv->auto_save_timeout > 0)
+		remove_auto_save_timeout (tab);
+
+	pluma_document_load (pluma_tab_get_document (tab),
+			     uri,
+			     tab->priv->tmp_encoding,
+			     tab->priv->tmp_line_pos,
+			     tab->priv->pending_create);
+
+	g_free (uri);
+}
+
 /**
  * pluma_tab_get_view:
  * @tab: a #PlumaTab
@@ -2040,6 +2326,54 @@ _pluma_tab_revert (PlumaTab *tab)
 	g_free (uri);
 }
 
+/**
+ * _pluma_tab_set_follow:
+ * @tab: a #PlumaTab
+ * @follow: whether to follow the file
+ *
+ * In follow mode, text appended to the file is shown as soon as it is
+ * written, like tail -f does. The document is reloaded if needed, and
+ * cannot be edited until following stops.
+ */
+void
+_pluma_tab_set_follow (PlumaTab *tab,
+		       gboolean  follow)
+{
+	PlumaDocument *doc;
+
+	g_return_if_fail (PLUMA_IS_TAB (tab));
+
+	doc = pluma_tab_get_document (tab);
+
+	/* reloading would throw away unsaved changes, and a compressed
+	 * file cannot be read from where it was left */
+	if (follow &&
+	    (!pluma_document_is_local (doc) ||
+	     gtk_text_buffer_get_modified (GTK_TEXT_BUFFER (doc)) ||
+	     pluma_document_get_compression_type (doc) != PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE))
+	{
+		return;
+	}
+
+	if (!_pluma_document_set_follow (doc, follow) &&
+	    ((tab->priv->state == PLUMA_TAB_STATE_NORMAL) ||
+	     (tab->priv->state == PLUMA_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION)))
+	{
+		_pluma_tab_revert (tab);
+	}
+
+	/* the document is read-only while it is followed */
+	set_view_properties_according_to_state (tab, tab->priv->state);
+}
+
+gboolean
+_pluma_tab_get_follow (PlumaTab *tab)
+{
+	g_return_val_if_fail (PLUMA_IS_TAB (tab), FALSE);
+
+	return _pluma_document_get_follow (pluma_tab_get_document (tab));
+}
+
 void
 _pluma_tab_save (PlumaTab *tab)
 {
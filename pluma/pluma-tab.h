@@ -134,6 +134,13 @@ GtkWidget	*_pluma_tab_new_from_uri	(const gchar         *uri,
 						 const PlumaEncoding *encoding,
 						 gint                 line_pos,
 						 gboolean             create);
+GtkWidget	*_pluma_tab_new_from_uri_deferred
+						(const gchar         *uri,
+						 const PlumaEncoding *encoding,
+						 gint                 line_pos,
+						 gboolean             create);
+gboolean	 _pluma_tab_is_load_deferred	(PlumaTab            *tab);
+void		 _pluma_tab_load_deferred	(PlumaTab            *tab);
 gchar 		*_pluma_tab_get_name		(PlumaTab            *tab);
 gchar 		*_pluma_tab_get_tooltips	(PlumaTab            *tab);
 GdkPixbuf 	*_pluma_tab_get_icon		(PlumaTab            *tab);
@@ -143,6 +150,9 @@ void		 _pluma_tab_load		(PlumaTab            *tab,
 						 gint                 line_pos,
 						 gboolean             create);
 void		 _pluma_tab_revert		(PlumaTab            *tab);
+void		 _pluma_tab_set_follow		(PlumaTab            *tab,
+						 gboolean             follow);
+gboolean	 _pluma_tab_get_follow		(PlumaTab            *tab);
 void		 _pluma_tab_save		(PlumaTab            *tab);
 void		 _pluma_tab_save_as		(PlumaTab            *tab,
 						 const gchar         *uri,
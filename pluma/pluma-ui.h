@@ -97,6 +97,8 @@ static const GtkActionEntry pluma_menu_entries[] =
 	  N_("Cut the selection"), G_CALLBACK (_pluma_cmd_edit_cut) },
 	{ "EditCopy", GTK_STOCK_COPY, NULL, "<control>C",
 	  N_("Copy the selection"), G_CALLBACK (_pluma_cmd_edit_copy) },
+	{ "EditCopyLines", NULL, N_("Copy _Lines..."), NULL,
+	  N_("Copy a range of lines of the file"), G_CALLBACK (_pluma_cmd_edit_copy_lines) },
 	{ "EditPaste", GTK_STOCK_PASTE, NULL, "<control>V",
 	  N_("Paste the clipboard"), G_CALLBACK (_pluma_cmd_edit_paste) },
 	{ "EditDelete", GTK_STOCK_DELETE, NULL, NULL,
@@ -136,6 +138,14 @@ static const GtkActionEntry pluma_menu_entries[] =
 	  N_("Move the current document to a new window"), G_CALLBACK (_pluma_cmd_documents_move_to_new_window) }
 };
 
+/* toggles which depend on the active tab, in the same group as above */
+static const GtkToggleActionEntry pluma_toggle_menu_entries[] =
+{
+	{ "ViewFollow", NULL, N_("_Follow File Changes"), NULL,
+	  N_("Show text appended to the file as soon as it is written"),
+	  G_CALLBACK (_pluma_cmd_view_follow), FALSE }
+};
+
 /* separate group, needs to be sensitive on OS X even when there are no tabs */
 static const GtkActionEntry pluma_close_menu_entries[] =
 {
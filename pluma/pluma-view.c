@@ -54,6 +54,14 @@
 
 #define MIN_SEARCH_COMPLETION_KEY_LEN	3
 
+/* While typing, the interactive search scans at most this many chars
+ * per keystroke, the rest of the buffer is scanned on idle */
+#define SEARCH_KEYSTROKE_CHARS	(256 * 1024)
+#define SEARCH_IDLE_CHARS	(64 * 1024)
+
+/* Max number of matches remembered to narrow the next search */
+#define SEARCH_MAX_CANDIDATES	100000
+
 #define PLUMA_VIEW_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE ((object), PLUMA_TYPE_VIEW, PlumaViewPrivate))
 
 typedef enum
@@ -73,6 +81,10 @@ struct _PlumaViewPrivate
 	
 	GtkTextIter  start_search_iter;
 
+	/* line of the file start_search_iter was on: going to a line of
+	 * a paged document replaces the text and invalidates the iter */
+	gint64       start_search_line;
+
 	/* used to restore the search state if an
 	 * incremental search is cancelled
 	 */
@@ -91,6 +103,28 @@ struct _PlumaViewPrivate
 
 	guint        typeselect_flush_timeout;
 	guint        search_entry_changed_id;
+
+	/* state of the incremental search while typing: the offsets of
+	 * the matches of narrow_query found in the first narrow_scanned
+	 * chars after start_search_iter (wrapping around if needed).
+	 * A longer query can only match where a shorter one did, so
+	 * only those need to be checked again. While they are checked,
+	 * the first narrow_kept ones still match and the ones from
+	 * narrow_checked on were not checked yet.
+	 */
+	gchar       *narrow_query;
+	gint         narrow_query_len;
+	guint        narrow_flags;
+	GArray      *narrow_matches;
+	gint         narrow_start;
+	gint         narrow_length;
+	gint         narrow_n_chars;
+	gint         narrow_scanned;
+	guint        narrow_kept;
+	guint        narrow_checked;
+	gboolean     narrow_wrap;
+	gboolean     narrow_selected;
+	guint        narrow_idle_id;
 	
 	gboolean     disable_popdown;
 	
@@ -127,6 +161,7 @@ static gboolean	pluma_view_button_press_event	(GtkWidget        *widget,
 static gboolean start_interactive_search	(PlumaView        *view);
 static gboolean start_interactive_goto_line	(PlumaView        *view);
 static gboolean reset_searched_text		(PlumaView        *view);
+static void	reset_incremental_search	(PlumaView        *view);
 
 static void	hide_search_window 		(PlumaView        *view,
 						 gboolean          cancel);
@@ -173,6 +208,28 @@ document_read_only_notify_handler (PlumaDocument *document,
 				    !pluma_document_get_readonly (document));
 }
 
+static void
+document_disabled_features_notify_handler (PlumaDocument *document,
+					   GParamSpec    *pspec,
+					   PlumaView     *view)
+{
+	PlumaDocumentFeatures disabled;
+
+	pluma_debug (DEBUG_VIEW);
+
+	disabled = pluma_document_get_disabled_features (document);
+
+	gtk_source_view_set_show_line_numbers (GTK_SOURCE_VIEW (view),
+		pluma_prefs_manager_get_display_line_numbers () &&
+		!(disabled & PLUMA_DOCUMENT_FEATURE_LINE_NUMBERS));
+
+	/* the tab hides the cursor and the current line while loading */
+	gtk_source_view_set_highlight_current_line (GTK_SOURCE_VIEW (view),
+		pluma_prefs_manager_get_highlight_current_line () &&
+		gtk_text_view_get_cursor_visible (GTK_TEXT_VIEW (view)) &&
+		!(disabled & PLUMA_DOCUMENT_FEATURE_CURRENT_LINE));
+}
+
 static void
 pluma_view_class_init (PlumaViewClass *klass)
 {
@@ -292,6 +349,9 @@ current_buffer_removed (PlumaView *view)
 		g_signal_handlers_disconnect_by_func (view->priv->current_buffer,
 						      document_read_only_notify_handler,
 						      view);
+		g_signal_handlers_disconnect_by_func (view->priv->current_buffer,
+						      document_disabled_features_notify_handler,
+						      view);
 		g_signal_handlers_disconnect_by_func (view->priv->current_buffer,
 						      search_highlight_updated_cb,
 						      view);
@@ -323,6 +383,14 @@ on_notify_buffer_cb (PlumaView  *view,
 	gtk_text_view_set_editable (GTK_TEXT_VIEW (view), 
 				    !pluma_document_get_readonly (PLUMA_DOCUMENT (buffer)));
 
+	g_signal_connect (buffer,
+			  "notify::disabled-features",
+			  G_CALLBACK (document_disabled_features_notify_handler),
+			  view);
+
+	if (pluma_document_get_disabled_features (PLUMA_DOCUMENT (buffer)) != 0)
+		document_disabled_features_notify_handler (PLUMA_DOCUMENT (buffer), NULL, view);
+
 	g_signal_connect (buffer,
 			  "search_highlight_updated",
 			  G_CALLBACK (search_highlight_updated_cb),
@@ -370,9 +438,13 @@ pluma_view_init (PlumaView *view)
 		      "indent_on_tab", TRUE,
 		      NULL);
 
+	_pluma_prefs_manager_app_register_view (view);
+
 	view->priv->typeselect_flush_timeout = 0;
 	view->priv->wrap_around = TRUE;
 
+	view->priv->narrow_matches = g_array_new (FALSE, FALSE, sizeof (gint));
+
 	/* Drag and drop support */	
 	tl = gtk_drag_dest_get_target_list (GTK_WIDGET (view));
 
@@ -393,6 +465,10 @@ pluma_view_dispose (GObject *object)
 
 	view = PLUMA_VIEW (object);
 
+	_pluma_prefs_manager_app_unregister_view (view);
+
+	reset_incremental_search (view);
+
 	if (view->priv->search_window != NULL)
 	{
 		gtk_widget_destroy (view->priv->search_window);
@@ -425,6 +501,7 @@ pluma_view_finalize (GObject *object)
 	current_buffer_removed (view);
 
 	g_free (view->priv->old_search_text);
+	g_array_free (view->priv->narrow_matches, TRUE);
 
 	(* G_OBJECT_CLASS (pluma_view_parent_class)->finalize) (object);
 }
@@ -758,6 +835,324 @@ set_entry_state (GtkWidget             *entry,
 	}
 }
 
+static void
+reset_incremental_search (PlumaView *view)
+{
+	if (view->priv->narrow_idle_id != 0)
+	{
+		g_source_remove (view->priv->narrow_idle_id);
+		view->priv->narrow_idle_id = 0;
+	}
+
+	g_free (view->priv->narrow_query);
+	view->priv->narrow_query = NULL;
+
+	g_array_set_size (view->priv->narrow_matches, 0);
+	view->priv->narrow_scanned = 0;
+	view->priv->narrow_kept = 0;
+	view->priv->narrow_checked = 0;
+	view->priv->narrow_selected = FALSE;
+}
+
+static gboolean
+incremental_search_match_at (PlumaView     *view,
+			     PlumaDocument *doc,
+			     gint           offset,
+			     GtkTextIter   *match_start,
+			     GtkTextIter   *match_end)
+{
+	GtkTextIter iter;
+	GtkTextIter limit;
+
+	gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (doc), &iter, offset);
+
+	/* leave some room for case insensitive matches of different length */
+	limit = iter;
+	gtk_text_iter_forward_chars (&limit, 2 * view->priv->narrow_query_len);
+
+	if (!pluma_document_search_forward (doc,
+					    &iter,
+					    &limit,
+					    match_start,
+					    match_end))
+		return FALSE;
+
+	return gtk_text_iter_equal (match_start, &iter);
+}
+
+static gboolean
+narrow_incremental_search_pending (PlumaView *view)
+{
+	return view->priv->narrow_checked < view->priv->narrow_matches->len;
+}
+
+static gboolean
+incremental_search_pending (PlumaView *view)
+{
+	return narrow_incremental_search_pending (view) ||
+	       ((view->priv->narrow_scanned < view->priv->narrow_length) &&
+	        (view->priv->narrow_matches->len < SEARCH_MAX_CANDIDATES));
+}
+
+/* Starts checking the previous matches against the (longer) query */
+static void
+start_narrow_incremental_search (PlumaView *view)
+{
+	PlumaViewPrivate *priv = view->priv;
+
+	/* drop the ones the previous query already ruled out, those
+	 * it kept and those it did not check yet are checked again */
+	g_array_remove_range (priv->narrow_matches,
+			      priv->narrow_kept,
+			      priv->narrow_checked - priv->narrow_kept);
+
+	priv->narrow_kept = 0;
+	priv->narrow_checked = 0;
+}
+
+/* Keep only the previous matches that still match the query, checking
+ * at most as many as fit in max_chars of search */
+static void
+narrow_incremental_search (PlumaView     *view,
+			   PlumaDocument *doc,
+			   gint           max_chars)
+{
+	PlumaViewPrivate *priv = view->priv;
+	GArray *matches = priv->narrow_matches;
+	guint stop;
+
+	/* each check searches at most 2 * narrow_query_len chars */
+	stop = priv->narrow_checked +
+	       MAX (max_chars / MAX (2 * priv->narrow_query_len, 1), 1);
+	stop = MIN (stop, matches->len);
+
+	while (priv->narrow_checked < stop)
+	{
+		GtkTextIter match_start;
+		GtkTextIter match_end;
+		gint offset;
+
+		offset = g_array_index (matches, gint, priv->narrow_checked++);
+
+		if (incremental_search_match_at (view,
+						 doc,
+						 offset,
+						 &match_start,
+						 &match_end))
+		{
+			g_array_index (matches, gint, priv->narrow_kept++) = offset;
+		}
+	}
+
+	if (priv->narrow_checked == matches->len)
+	{
+		g_array_set_size (matches, priv->narrow_kept);
+		priv->narrow_checked = priv->narrow_kept;
+	}
+}
+
+/* Scan up to max_chars more of the buffer, remembering the matches */
+static void
+scan_incremental_search (PlumaView     *view,
+			 PlumaDocument *doc,
+			 gint           max_chars)
+{
+	PlumaViewPrivate *priv = view->priv;
+	gint stop;
+
+	stop = MIN (priv->narrow_scanned + max_chars, priv->narrow_length);
+
+	while (priv->narrow_scanned < stop)
+	{
+		GtkTextIter iter;
+		GtkTextIter limit;
+		GtkTextIter match_start;
+		GtkTextIter match_end;
+		gint from;
+		gint to;
+
+		/* wrap around at the end of the buffer */
+		from = priv->narrow_start + priv->narrow_scanned;
+		if (from >= priv->narrow_n_chars)
+			from -= priv->narrow_n_chars;
+
+		to = from + MIN (stop - priv->narrow_scanned,
+				 priv->narrow_n_chars - from);
+
+		gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (doc),
+						    &iter,
+						    from);
+
+		/* matches starting before 'to' may end after it */
+		gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (doc),
+						    &limit,
+						    MIN (to + 2 * priv->narrow_query_len,
+							 priv->narrow_n_chars));
+
+		while (pluma_document_search_forward (doc,
+						      &iter,
+						      &limit,
+						      &match_start,
+						      &match_end))
+		{
+			gint offset;
+
+			offset = gtk_text_iter_get_offset (&match_start);
+
+			if (offset >= to)
+				break;
+
+			if (priv->narrow_matches->len >= SEARCH_MAX_CANDIDATES)
+			{
+				/* the rest is scanned again by the next query */
+				priv->narrow_scanned += offset - from;
+				return;
+			}
+
+			g_array_append_val (priv->narrow_matches, offset);
+			priv->narrow_kept++;
+			priv->narrow_checked++;
+
+			/* matches may overlap */
+			iter = match_start;
+			gtk_text_iter_forward_char (&iter);
+		}
+
+		priv->narrow_scanned += to - from;
+	}
+}
+
+static void
+show_incremental_search_result (PlumaView     *view,
+				PlumaDocument *doc)
+{
+	GtkTextIter match_start;
+	GtkTextIter match_end;
+
+	if (view->priv->narrow_selected)
+		return;
+
+	/* the matches are in search order, the first one that is still
+	 * kept is the result, before that the remaining ones are checked */
+	if ((view->priv->narrow_kept > 0) &&
+	    incremental_search_match_at (view,
+					 doc,
+					 g_array_index (view->priv->narrow_matches, gint, 0),
+					 &match_start,
+					 &match_end))
+	{
+		gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (doc),
+					      &match_start);
+
+		gtk_text_buffer_move_mark_by_name (GTK_TEXT_BUFFER (doc),
+						   "selection_bound", &match_end);
+
+		pluma_view_scroll_to_cursor (view);
+
+		set_entry_state (view->priv->search_entry,
+		                 PLUMA_SEARCH_ENTRY_NORMAL);
+
+		view->priv->narrow_selected = TRUE;
+	}
+	else if (!incremental_search_pending (view))
+	{
+		gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (doc),
+					      &view->priv->start_search_iter);
+
+		set_entry_state (view->priv->search_entry,
+		                 PLUMA_SEARCH_ENTRY_NOT_FOUND);
+	}
+}
+
+static gboolean
+incremental_search_idle (PlumaView *view)
+{
+	PlumaDocument *doc;
+
+	doc = PLUMA_DOCUMENT (gtk_text_view_get_buffer (GTK_TEXT_VIEW (view)));
+
+	/* finish checking the previous matches before scanning on, and
+	 * keep scanning after the result is shown, so that the next
+	 * keystroke can narrow the matches */
+	if (narrow_incremental_search_pending (view))
+		narrow_incremental_search (view, doc, SEARCH_IDLE_CHARS);
+	else
+		scan_incremental_search (view, doc, SEARCH_IDLE_CHARS);
+
+	show_incremental_search_result (view, doc);
+
+	if (incremental_search_pending (view))
+		return TRUE;
+
+	view->priv->narrow_idle_id = 0;
+
+	return FALSE;
+}
+
+/* Forward search while typing: the buffer is scanned only once for
+ * each query, a bounded amount per keystroke and the rest on idle */
+static void
+run_incremental_search (PlumaView     *view,
+			PlumaDocument *doc,
+			const gchar   *entry_text)
+{
+	PlumaViewPrivate *priv = view->priv;
+	gchar *query;
+	gint start;
+	gint n_chars;
+
+	if (priv->narrow_idle_id != 0)
+	{
+		g_source_remove (priv->narrow_idle_id);
+		priv->narrow_idle_id = 0;
+	}
+
+	query = pluma_utils_unescape_search_text (entry_text);
+	start = gtk_text_iter_get_offset (&priv->start_search_iter);
+	n_chars = gtk_text_buffer_get_char_count (GTK_TEXT_BUFFER (doc));
+
+	if ((priv->narrow_query != NULL) &&
+	    !PLUMA_SEARCH_IS_ENTIRE_WORD (priv->search_flags) &&
+	    (priv->narrow_flags == priv->search_flags) &&
+	    (priv->narrow_wrap == priv->wrap_around) &&
+	    (priv->narrow_start == start) &&
+	    (priv->narrow_n_chars == n_chars) &&
+	    g_str_has_prefix (query, priv->narrow_query))
+	{
+		g_free (priv->narrow_query);
+		priv->narrow_query = query;
+		priv->narrow_query_len = g_utf8_strlen (query, -1);
+
+		start_narrow_incremental_search (view);
+		narrow_incremental_search (view, doc, SEARCH_KEYSTROKE_CHARS);
+	}
+	else
+	{
+		reset_incremental_search (view);
+
+		priv->narrow_query = query;
+		priv->narrow_query_len = g_utf8_strlen (query, -1);
+		priv->narrow_flags = priv->search_flags;
+		priv->narrow_wrap = priv->wrap_around;
+		priv->narrow_start = start;
+		priv->narrow_n_chars = n_chars;
+		priv->narrow_length = priv->wrap_around ? n_chars : n_chars - start;
+	}
+
+	priv->narrow_selected = FALSE;
+
+	if (priv->narrow_matches->len == 0)
+		scan_incremental_search (view, doc, SEARCH_KEYSTROKE_CHARS);
+
+	show_incremental_search_result (view, doc);
+
+	if (incremental_search_pending (view))
+	{
+		priv->narrow_idle_id =
+			g_idle_add ((GSourceFunc) incremental_search_idle, view);
+	}
+}
+
 static gboolean
 run_search (PlumaView        *view,
             const gchar      *entry_text,
@@ -774,6 +1169,23 @@ run_search (PlumaView        *view,
 	g_return_val_if_fail (view->priv->search_mode == SEARCH, FALSE);
 
 	doc = PLUMA_DOCUMENT (gtk_text_view_get_buffer (GTK_TEXT_VIEW (view)));
+
+	if (typing && !search_backward && (*entry_text != '\0') &&
+	    !PLUMA_SEARCH_IS_MATCH_REGEX (view->priv->search_flags))
+	{
+		pluma_debug_span_begin (DEBUG_SEARCH, "interactive-search");
+		run_incremental_search (view, doc, entry_text);
+		pluma_debug_span_end (DEBUG_SEARCH, "interactive-search");
+
+		return view->priv->narrow_selected;
+	}
+
+	/* do not let a pending incremental search move the selection */
+	if (view->priv->narrow_idle_id != 0)
+	{
+		g_source_remove (view->priv->narrow_idle_id);
+		view->priv->narrow_idle_id = 0;
+	}
 	
 	start_iter = view->priv->start_search_iter;
 	
@@ -915,6 +1327,8 @@ hide_search_window (PlumaView *view, gboolean cancel)
 		view->priv->typeselect_flush_timeout = 0;
 	}
 
+	reset_incremental_search (view);
+
 	/* send focus-in event */
 	send_focus_change (GTK_WIDGET (view->priv->search_entry), FALSE);
 	gtk_text_view_set_cursor_visible (GTK_TEXT_VIEW (view), TRUE);
@@ -925,7 +1339,13 @@ hide_search_window (PlumaView *view, gboolean cancel)
 		GtkTextBuffer *buffer;
 		
 		buffer = GTK_TEXT_BUFFER (gtk_text_view_get_buffer (GTK_TEXT_VIEW (view)));
-		gtk_text_buffer_place_cursor (buffer, &view->priv->start_search_iter);
+
+		if (view->priv->search_mode == GOTO_LINE &&
+		    _pluma_document_is_paged (PLUMA_DOCUMENT (buffer)))
+			pluma_document_goto_line (PLUMA_DOCUMENT (buffer),
+						  MIN (view->priv->start_search_line, G_MAXINT));
+		else
+			gtk_text_buffer_place_cursor (buffer, &view->priv->start_search_iter);
 		
 		pluma_view_scroll_to_cursor (view);
 	}
@@ -1555,12 +1975,10 @@ init_search_entry (PlumaView *view)
 	
 	if (view->priv->search_mode == GOTO_LINE)
 	{	
-		gint   line;
 		gchar *line_str;
 		
-		line = gtk_text_iter_get_line (&view->priv->start_search_iter);
-		
-		line_str = g_strdup_printf ("%d", line + 1);
+		line_str = g_strdup_printf ("%" G_GINT64_FORMAT,
+					    view->priv->start_search_line + 1);
 		
 		gtk_entry_set_text (GTK_ENTRY (view->priv->search_entry), 
 				    line_str);
@@ -1680,7 +2098,7 @@ search_init (GtkWidget *entry,
 			
 			if (*text == '-')
 			{
-				gint cur_line = gtk_text_iter_get_line (&view->priv->start_search_iter);
+				gint cur_line = MIN (view->priv->start_search_line, G_MAXINT);
 			
 				if (*(text + 1) != '\0')
 					offset_line = MAX (atoi (text + 1), 0);
@@ -1689,7 +2107,7 @@ search_init (GtkWidget *entry,
 			}
 			else if (*entry_text == '+')
 			{
-				gint cur_line = gtk_text_iter_get_line (&view->priv->start_search_iter);
+				gint cur_line = MIN (view->priv->start_search_line, G_MAXINT);
 			
 				if (*(text + 1) != '\0')
 					offset_line = MAX (atoi (text + 1), 0);
@@ -1745,6 +2163,9 @@ start_interactive_search_real (PlumaView *view)
 						  &view->priv->start_search_iter,
 						  gtk_text_buffer_get_insert (buffer));
 
+	view->priv->start_search_line = gtk_text_iter_get_line (&view->priv->start_search_iter) +
+					_pluma_document_get_paged_first_line (PLUMA_DOCUMENT (buffer));
+
 	ensure_search_window (view);
 
 	/* done, show it */
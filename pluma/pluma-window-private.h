@@ -36,6 +36,7 @@
 #include "pluma/pluma-window.h"
 #include "pluma-prefs-manager.h"
 #include "pluma-message-bus.h"
+#include "pluma-load-queue.h"
 
 G_BEGIN_DECLS
 
@@ -53,10 +54,14 @@ struct _PlumaWindowPrivate
 	
 	GtkWidget      *tab_width_combo;
 	GtkWidget      *language_combo;
+	GtkWidget      *large_file_combo;
 
 	PlumaMessageBus *message_bus;
 	PeasExtensionSet *extensions;
 
+	/* Schedules the loads of the tabs */
+	PlumaLoadQueue *load_queue;
+
 	/* Widgets for fullscreen mode */
 	GtkWidget      *fullscreen_controls;
 	guint           fullscreen_animation_timeout_id;
@@ -69,6 +74,8 @@ struct _PlumaWindowPrivate
 	guint 		tab_width_id;
 	guint 		spaces_instead_of_tabs_id;
 	guint 		language_changed_id;
+	guint 		disabled_features_id;
+	guint 		large_file_profile_id;
 
 	/* Menus & Toolbars */
 	GtkUIManager   *manager;
@@ -65,6 +65,7 @@
 #define PLUMA_UIFILE "pluma-ui.xml"
 #define TAB_WIDTH_DATA "PlumaWindowTabWidthData"
 #define LANGUAGE_DATA "PlumaWindowLanguageData"
+#define FEATURE_DATA "PlumaWindowFeatureData"
 #define FULLSCREEN_ANIMATION_SPEED 4
 
 #define PLUMA_WINDOW_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE ((object),\
@@ -229,6 +230,12 @@ pluma_window_dispose (GObject *object)
 		window->priv->message_bus = NULL;
 	}
 
+	if (window->priv->load_queue != NULL)
+	{
+		g_object_unref (window->priv->load_queue);
+		window->priv->load_queue = NULL;
+	}
+
 	if (window->priv->window_group != NULL)
 	{
 		g_object_unref (window->priv->window_group);
@@ -664,6 +671,7 @@ set_sensitivity_according_to_tab (PlumaWindow *window,
 	gboolean       b;
 	gboolean       state_normal;
 	gboolean       editable;
+	gboolean       paged;
 	PlumaTabState  state;
 	GtkClipboard  *clipboard;
 	PlumaLockdownMask lockdown;
@@ -682,6 +690,9 @@ set_sensitivity_according_to_tab (PlumaWindow *window,
 
 	doc = PLUMA_DOCUMENT (gtk_text_view_get_buffer (GTK_TEXT_VIEW (view)));
 
+	/* only part of a paged document is in the buffer */
+	paged = _pluma_document_is_paged (doc);
+
 	clipboard = gtk_widget_get_clipboard (GTK_WIDGET (window),
 					      GDK_SELECTION_CLIPBOARD);
 
@@ -701,6 +712,7 @@ set_sensitivity_according_to_tab (PlumaWindow *window,
 				   (state == PLUMA_TAB_STATE_SAVING_ERROR) ||
 				   (state == PLUMA_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION) ||
 				   (state == PLUMA_TAB_STATE_SHOWING_PRINT_PREVIEW)) &&
+				  !paged &&
 				  !(lockdown & PLUMA_LOCKDOWN_SAVE_TO_DISK));
 
 	action = gtk_action_group_get_action (window->priv->action_group,
@@ -759,6 +771,12 @@ set_sensitivity_according_to_tab (PlumaWindow *window,
 				  (state_normal ||
 				   state == PLUMA_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION) &&
 				  gtk_text_buffer_get_has_selection (GTK_TEXT_BUFFER (doc)));
+
+	action = gtk_action_group_get_action (window->priv->action_group,
+					      "EditCopyLines");
+	gtk_action_set_sensitive (action,
+				  state_normal &&
+				  paged);
 				  
 	action = gtk_action_group_get_action (window->priv->action_group,
 					      "EditPaste");
@@ -828,9 +846,23 @@ set_sensitivity_according_to_tab (PlumaWindow *window,
 				  (state != PLUMA_TAB_STATE_CLOSING) &&
 				  pluma_prefs_manager_get_enable_syntax_highlighting ());
 
+	action = gtk_action_group_get_action (window->priv->action_group,
+					      "ViewFollow");
+	gtk_action_set_sensitive (action,
+				  (state_normal ||
+				   state == PLUMA_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION) &&
+				  !paged &&
+				  pluma_document_is_local (doc));
+	g_signal_handlers_block_by_func (action, G_CALLBACK (_pluma_cmd_view_follow), window);
+	gtk_toggle_action_set_active (GTK_TOGGLE_ACTION (action),
+				      _pluma_tab_get_follow (tab));
+	g_signal_handlers_unblock_by_func (action, G_CALLBACK (_pluma_cmd_view_follow), window);
+
 	update_next_prev_doc_sensitivity (window, tab);
 
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 	peas_extension_set_call (window->priv->extensions, "update_state", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 }
 
 static void
@@ -1446,6 +1478,10 @@ create_menu_bar_and_toolbar (PlumaWindow *window,
 				      pluma_menu_entries,
 				      G_N_ELEMENTS (pluma_menu_entries),
 				      window);
+	gtk_action_group_add_toggle_actions (action_group,
+					     pluma_toggle_menu_entries,
+					     G_N_ELEMENTS (pluma_toggle_menu_entries),
+					     window);
 	gtk_ui_manager_insert_action_group (manager, action_group, 0);
 	g_object_unref (action_group);
 	window->priv->action_group = action_group;
@@ -1824,6 +1860,30 @@ language_combo_changed (PlumaStatusComboBox *combo,
 	g_signal_handler_unblock (doc, window->priv->language_changed_id);
 }
 
+static void
+feature_toggled (GtkCheckMenuItem *item,
+		 PlumaWindow      *window)
+{
+	PlumaDocument *doc;
+	PlumaDocumentFeatures feature;
+	PlumaDocumentFeatures disabled;
+
+	doc = pluma_window_get_active_document (window);
+
+	if (!doc)
+		return;
+
+	feature = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (item), FEATURE_DATA));
+	disabled = pluma_document_get_disabled_features (doc);
+
+	if (gtk_check_menu_item_get_active (item))
+		disabled &= ~feature;
+	else
+		disabled |= feature;
+
+	pluma_document_set_disabled_features (doc, disabled);
+}
+
 typedef struct
 {
 	const gchar *label;
@@ -1916,6 +1976,42 @@ fill_language_combo (PlumaWindow *window)
 	g_slist_free (languages);
 }
 
+static void
+fill_large_file_combo (PlumaWindow *window)
+{
+	static const struct
+	{
+		const gchar *label;
+		PlumaDocumentFeatures feature;
+	} defs[] = {
+		{ N_("Syntax Highlighting"), PLUMA_DOCUMENT_FEATURE_SYNTAX_HIGHLIGHTING },
+		{ N_("Bracket Matching"), PLUMA_DOCUMENT_FEATURE_BRACKET_MATCHING },
+		{ N_("Search Highlighting"), PLUMA_DOCUMENT_FEATURE_SEARCH_HIGHLIGHTING },
+		{ N_("Spell Checking"), PLUMA_DOCUMENT_FEATURE_SPELL_CHECKING },
+		{ N_("Line Numbers"), PLUMA_DOCUMENT_FEATURE_LINE_NUMBERS },
+		{ N_("Current Line Highlighting"), PLUMA_DOCUMENT_FEATURE_CURRENT_LINE }
+	};
+
+	PlumaStatusComboBox *combo = PLUMA_STATUS_COMBO_BOX (window->priv->large_file_combo);
+	GtkWidget *item;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (defs); i++)
+	{
+		item = gtk_check_menu_item_new_with_label (_(defs[i].label));
+		g_object_set_data (G_OBJECT (item), FEATURE_DATA,
+				   GUINT_TO_POINTER (defs[i].feature));
+
+		pluma_status_combo_box_add_item (combo, GTK_MENU_ITEM (item), NULL);
+		gtk_widget_show (item);
+
+		g_signal_connect (item,
+				  "toggled",
+				  G_CALLBACK (feature_toggled),
+				  window);
+	}
+}
+
 static void
 create_statusbar (PlumaWindow *window, 
 		  GtkWidget   *main_box)
@@ -1965,6 +2061,19 @@ create_statusbar (PlumaWindow *window,
 			  G_CALLBACK (language_combo_changed),
 			  window);
 
+	/* only shown for documents with the large file profile */
+	window->priv->large_file_combo = pluma_status_combo_box_new (_("Large File"));
+	gtk_widget_set_tooltip_text (window->priv->large_file_combo,
+				     _("Some features are turned off for this big document, "
+				       "choose the ones to turn back on"));
+	gtk_box_pack_end (GTK_BOX (window->priv->statusbar),
+			  window->priv->large_file_combo,
+			  FALSE,
+			  TRUE,
+			  0);
+
+	fill_large_file_combo (window);
+
 	g_signal_connect_after (G_OBJECT (window->priv->statusbar),
 				"show",
 				G_CALLBACK (statusbar_visibility_changed),
@@ -2065,6 +2174,10 @@ update_cursor_position_statusbar (GtkTextBuffer *buffer,
 					  gtk_text_buffer_get_insert (buffer));
 	
 	row = gtk_text_iter_get_line (&iter);
+
+	/* paged documents only hold part of the file */
+	row = MIN (row + _pluma_document_get_paged_first_line (PLUMA_DOCUMENT (buffer)),
+		   G_MAXINT - 1);
 	
 	start = iter;
 	gtk_text_iter_set_line_offset (&start, 0);
@@ -2342,6 +2455,56 @@ language_changed (GObject     *object,
 	g_list_free (items);
 }
 
+static void
+large_file_profile_changed (GObject     *object,
+			    GParamSpec  *pspec,
+			    PlumaWindow *window)
+{
+	PlumaDocument *doc = PLUMA_DOCUMENT (object);
+	PlumaDocumentFeatures disabled;
+	GList *items;
+	GList *item;
+
+	disabled = pluma_document_get_disabled_features (doc);
+
+	items = pluma_status_combo_box_get_items (
+			PLUMA_STATUS_COMBO_BOX (window->priv->large_file_combo));
+
+	for (item = items; item; item = item->next)
+	{
+		PlumaDocumentFeatures feature;
+
+		feature = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (item->data), FEATURE_DATA));
+
+		g_signal_handlers_block_by_func (item->data, feature_toggled, window);
+		gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (item->data),
+						!(disabled & feature));
+		g_signal_handlers_unblock_by_func (item->data, feature_toggled, window);
+	}
+
+	g_list_free (items);
+
+	gtk_widget_set_visible (window->priv->large_file_combo,
+				pluma_document_get_large_file_profile (doc));
+}
+
+static void
+disconnect_large_file_profile (PlumaWindow   *window,
+			       PlumaDocument *doc)
+{
+	if (window->priv->disabled_features_id)
+	{
+		g_signal_handler_disconnect (doc, window->priv->disabled_features_id);
+		window->priv->disabled_features_id = 0;
+	}
+
+	if (window->priv->large_file_profile_id)
+	{
+		g_signal_handler_disconnect (doc, window->priv->large_file_profile_id);
+		window->priv->large_file_profile_id = 0;
+	}
+}
+
 static void 
 notebook_switch_page (GtkNotebook     *book,
 		      GtkWidget       *pg,
@@ -2377,6 +2540,9 @@ notebook_switch_page (GtkNotebook     *book,
 		
 			window->priv->spaces_instead_of_tabs_id = 0;
 		}
+
+		disconnect_large_file_profile (window,
+					       pluma_tab_get_document (window->priv->active_tab));
 	}
 	
 	/* set the active tab */		
@@ -2427,10 +2593,20 @@ notebook_switch_page (GtkNotebook     *book,
 							      G_CALLBACK (language_changed),
 							      window);
 
+	window->priv->disabled_features_id = g_signal_connect (pluma_tab_get_document (tab),
+							       "notify::disabled-features",
+							       G_CALLBACK (large_file_profile_changed),
+							       window);
+	window->priv->large_file_profile_id = g_signal_connect (pluma_tab_get_document (tab),
+								"notify::large-file-profile",
+								G_CALLBACK (large_file_profile_changed),
+								window);
+
 	/* call it for the first time */
 	tab_width_changed (G_OBJECT (view), NULL, window);
 	spaces_instead_of_tabs_changed (G_OBJECT (view), NULL, window);
 	language_changed (G_OBJECT (pluma_tab_get_document (tab)), NULL, window);
+	large_file_profile_changed (G_OBJECT (pluma_tab_get_document (tab)), NULL, window);
 
 	g_signal_emit (G_OBJECT (window), 
 		       signals[ACTIVE_TAB_CHANGED], 
@@ -2690,7 +2866,9 @@ sync_name (PlumaTab    *tab,
 	g_free (escaped_name);
 	g_free (tip);
 
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 	peas_extension_set_call (window->priv->extensions, "update_state", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 }
 
 static PlumaWindow *
@@ -3081,7 +3259,9 @@ selection_changed (PlumaDocument *doc,
 				  editable &&
 				  gtk_text_buffer_get_has_selection (GTK_TEXT_BUFFER (doc)));
 
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 	peas_extension_set_call (window->priv->extensions, "update_state", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 }
 
 static void
@@ -3090,7 +3270,9 @@ sync_languages_menu (PlumaDocument *doc,
 		     PlumaWindow   *window)
 {
 	update_languages_menu (window);
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 	peas_extension_set_call (window->priv->extensions, "update_state", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 }
 
 static void
@@ -3102,7 +3284,9 @@ readonly_changed (PlumaDocument *doc,
 
 	sync_name (window->priv->active_tab, NULL, window);
 
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 	peas_extension_set_call (window->priv->extensions, "update_state", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 }
 
 static void
@@ -3110,7 +3294,9 @@ editable_changed (PlumaView  *view,
                   GParamSpec  *arg1,
                   PlumaWindow *window)
 {
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 	peas_extension_set_call (window->priv->extensions, "update_state", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 }
 
 static void
@@ -3283,6 +3469,9 @@ notebook_tab_removed (PlumaNotebook *notebook,
 		window->priv->language_changed_id = 0;
 	}
 
+	if (tab == pluma_window_get_active_tab (window))
+		disconnect_large_file_profile (window, doc);
+
 	g_return_if_fail (window->priv->num_tabs >= 0);
 	if (window->priv->num_tabs == 0)
 	{
@@ -3302,6 +3491,7 @@ notebook_tab_removed (PlumaNotebook *notebook,
 		/* hide the combos */
 		gtk_widget_hide (window->priv->tab_width_combo);
 		gtk_widget_hide (window->priv->language_combo);
+		gtk_widget_hide (window->priv->large_file_combo);
 	}
 
 	if (!window->priv->removing_tabs)
@@ -3322,7 +3512,9 @@ notebook_tab_removed (PlumaNotebook *notebook,
 
 	if (window->priv->num_tabs == 0)
 	{
+		pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-update-state");
 		peas_extension_set_call (window->priv->extensions, "update_state", window);
+		pluma_debug_span_end (DEBUG_PLUGINS, "plugins-update-state");
 	}
 
 	update_window_state (window);
@@ -3821,7 +4013,9 @@ on_extension_added (PeasExtensionSet *extensions,
 		    PeasExtension    *exten,
 		    PlumaWindow      *window)
 {
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-activate");
 	peas_extension_call (exten, "activate", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-activate");
 }
 
 static void
@@ -3830,7 +4024,9 @@ on_extension_removed (PeasExtensionSet *extensions,
 		      PeasExtension    *exten,
 		      PlumaWindow      *window)
 {
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-deactivate");
 	peas_extension_call (exten, "deactivate", window);
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-deactivate");
 
 	/* Ensure update of ui manager, because we suspect it does something
 	 * with expected static strings in the type module (when unloaded the
@@ -3857,6 +4053,7 @@ pluma_window_init (PlumaWindow *window)
 	window->priv->fullscreen_animation_timeout_id = 0;
 
 	window->priv->message_bus = pluma_message_bus_new ();
+	window->priv->load_queue = pluma_load_queue_new (window);
 
 	window->priv->window_group = gtk_window_group_new ();
 	gtk_window_group_add_window (window->priv->window_group, GTK_WINDOW (window));
@@ -3967,7 +4164,9 @@ pluma_window_init (PlumaWindow *window)
 	window->priv->extensions = peas_extension_set_new (PEAS_ENGINE (pluma_plugins_engine_get_default ()),
 	                                                   PEAS_TYPE_ACTIVATABLE, "object", window, NULL);
 
+	pluma_debug_span_begin (DEBUG_PLUGINS, "plugins-activate");
 	peas_extension_set_call (window->priv->extensions, "activate");
+	pluma_debug_span_end (DEBUG_PLUGINS, "plugins-activate");
 
 	g_signal_connect (window->priv->extensions,
 	                  "extension-added",
@@ -4086,7 +4285,9 @@ pluma_window_create_tab (PlumaWindow *window,
  * Creates a new #PlumaTab loading the document specified by @uri.
  * In case @jump_to is %TRUE the #PlumaNotebook swithes to that new #PlumaTab.
  * Whether @create is %TRUE, creates a new empty document if location does 
- * not refer to an existing file
+ * not refer to an existing file.
+ * The load starts once the window gets back to the main loop: right away
+ * if the tab is the active one, otherwise when its turn comes.
  *
  * Returns: (transfer none): a new #PlumaTab
  */
@@ -4103,10 +4304,11 @@ pluma_window_create_tab_from_uri (PlumaWindow         *window,
 	g_return_val_if_fail (PLUMA_IS_WINDOW (window), NULL);
 	g_return_val_if_fail (uri != NULL, NULL);
 
-	tab = _pluma_tab_new_from_uri (uri,
-				       encoding,
-				       line_pos,
-				       create);	
+	/* loaded by the load queue, see pluma-load-queue.c */
+	tab = _pluma_tab_new_from_uri_deferred (uri,
+						encoding,
+						line_pos,
+						create);
 	if (tab == NULL)
 		return NULL;
 
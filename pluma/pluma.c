@@ -75,7 +75,9 @@ static gint line_position = 0;
 static gchar *encoding_charset = NULL;
 static gboolean new_window_option = FALSE;
 static gboolean new_document_option = FALSE;
+static gboolean enqueue_option = FALSE;
 static gchar **remaining_args = NULL;
+static gchar *trace_file = NULL;
 static GSList *file_list = NULL;
 
 static void
@@ -119,6 +121,12 @@ static const GOptionEntry options [] =
 	{ "new-document", '\0', 0, G_OPTION_ARG_NONE, &new_document_option,
 	  N_("Create a new document in an existing instance of pluma"), NULL },
 
+	{ "enqueue", '\0', 0, G_OPTION_ARG_NONE, &enqueue_option,
+	  N_("Hand the files to an existing instance of pluma without opening the display, and exit as soon as they are queued"), NULL },
+
+	{ "trace-file", '\0', 0, G_OPTION_ARG_FILENAME, &trace_file,
+	  N_("Record a trace of the session and write it to FILE on exit"), N_("FILE") },
+
 	{ G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY, &remaining_args,
 	  NULL, N_("[FILE...]") }, /* collects file arguments */
 
@@ -216,6 +224,60 @@ get_startup_timestamp (void)
 	return (retval > 0) ? retval : 0;
 }
 
+/* A request is what a client asks the running instance to do. Clients
+ * send a batch of them as a serialized GVariant of type BATCH_TYPE */
+#define REQUEST_TYPE "(usiiiibbisas)"
+#define BATCH_TYPE "a" REQUEST_TYPE
+
+typedef struct
+{
+	guint32   timestamp;
+	gchar    *display_name;	/* empty for the default display */
+	gint      screen_number;
+	gint      workspace;	/* -1 for the active window */
+	gint      viewport_x;
+	gint      viewport_y;
+	gboolean  new_window;
+	gboolean  new_document;
+	gint      line_position;
+	gchar    *encoding_charset;
+	GSList   *files;
+} Request;
+
+static GQueue pending_requests = G_QUEUE_INIT;
+static guint process_requests_id = 0;
+
+static void
+request_free (Request *request)
+{
+	g_free (request->display_name);
+	g_free (request->encoding_charset);
+	g_slist_free_full (request->files, g_object_unref);
+	g_slice_free (Request, request);
+}
+
+/* serverside */
+
+/* Requests for the same window and options are executed at once, so
+ * that a burst of clients only opens and presents the window once */
+static gboolean
+can_merge_requests (const Request *request,
+		    const Request *next)
+{
+	return !next->new_window &&
+	       !request->new_document &&
+	       !next->new_document &&
+	       request->files != NULL &&
+	       next->files != NULL &&
+	       strcmp (request->display_name, next->display_name) == 0 &&
+	       request->screen_number == next->screen_number &&
+	       request->workspace == next->workspace &&
+	       request->viewport_x == next->viewport_x &&
+	       request->viewport_y == next->viewport_y &&
+	       request->line_position == next->line_position &&
+	       strcmp (request->encoding_charset, next->encoding_charset) == 0;
+}
+
 static GdkDisplay *
 display_open_if_needed (const gchar *name)
 {
@@ -223,6 +285,9 @@ display_open_if_needed (const gchar *name)
 	GSList *l;
 	GdkDisplay *display = NULL;
 
+	if (*name == '\0')
+		return gdk_display_get_default ();
+
 	displays = gdk_display_manager_list_displays (gdk_display_manager_get ());
 
 	for (l = displays; l != NULL; l = l->next)
@@ -239,126 +304,60 @@ display_open_if_needed (const gchar *name)
 	return display != NULL ? display : gdk_display_open (name);
 }
 
-/* serverside */
 static void
-on_message_received (const char *message,
-		     gpointer    data)
+execute_request (Request *request)
 {
 	const PlumaEncoding *encoding = NULL;
-	gchar **commands;
-	gchar **params;
-	gint workspace;
-	gint viewport_x;
-	gint viewport_y;
-	gchar *display_name;
-	gint screen_number;
-	gint i;
+	guint32 timestamp;
 	PlumaApp *app;
 	PlumaWindow *window;
 	GdkDisplay *display;
 	GdkScreen *screen;
 
-	g_return_if_fail (message != NULL);
-
-	pluma_debug_message (DEBUG_APP, "Received message:\n%s\n", message);
-
-	commands = g_strsplit (message, "\v", -1);
-
-	/* header */
-	params = g_strsplit (commands[0], "\t", 6);
-	startup_timestamp = atoi (params[0]);
-	display_name = params[1];
-	screen_number = atoi (params[2]);
-	workspace = atoi (params[3]);
-	viewport_x = atoi (params[4]);
-	viewport_y = atoi (params[5]);
-
-	display = display_open_if_needed (display_name);
+	display = display_open_if_needed (request->display_name);
 	if (display == NULL)
 	{
-		g_warning ("Could not open display %s\n", display_name);
-		g_strfreev (params);
-		goto out;
+		g_warning ("Could not open display %s\n", request->display_name);
+		return;
 	}
 
-	screen = gdk_display_get_screen (display, screen_number);
-
-	g_strfreev (params);
-
-	/* body */
-	for (i = 1; commands[i] != NULL; i++)
-	{
-		params = g_strsplit (commands[i], "\t", -1);
-
-		if (strcmp (params[0], "NEW-WINDOW") == 0)
-		{
-			new_window_option = TRUE;
-		}
-		else if (strcmp (params[0], "NEW-DOCUMENT") == 0)
-		{
-			new_document_option = TRUE;
-		}
-		else if (strcmp (params[0], "OPEN-URIS") == 0)
-		{
-			gint n_uris, j;
-			gchar **uris;
-
-			line_position = atoi (params[1]);
-
-			if (params[2] != '\0')
-				encoding = pluma_encoding_get_from_charset (params[2]);
-
-			n_uris = atoi (params[3]);
-			uris = g_strsplit (params[4], " ", n_uris);
-
-			for (j = 0; j < n_uris; j++)
-			{
-				GFile *file;
-
-				file = g_file_new_for_uri (uris[j]);
-				file_list = g_slist_prepend (file_list, file);
-			}
-
-			file_list = g_slist_reverse (file_list);
-
-			/* the list takes ownerhip of the strings,
-			 * only free the array */
-			g_free (uris);
-		}
-		else
-		{
-			g_warning ("Unexpected bacon command");
-		}
-
-		g_strfreev (params);
-	}
+	screen = gdk_display_get_screen (display, request->screen_number);
 
-	/* execute the commands */
+	if (*request->encoding_charset != '\0')
+		encoding = pluma_encoding_get_from_charset (request->encoding_charset);
 
 	app = pluma_app_get_default ();
 
-	if (new_window_option)
+	if (request->new_window)
 	{
 		window = pluma_app_create_window (app, screen);
 	}
+	else if (request->workspace < 0)
+	{
+		/* the client did not look at the display */
+		window = pluma_app_get_active_window (app);
+
+		if (window == NULL)
+			window = pluma_app_create_window (app, screen);
+	}
 	else
 	{
 		/* get a window in the current workspace (if exists) and raise it */
 		window = _pluma_app_get_window_in_viewport (app,
 							    screen,
-							    workspace,
-							    viewport_x,
-							    viewport_y);
+							    request->workspace,
+							    request->viewport_x,
+							    request->viewport_y);
 	}
 
-	if (file_list != NULL)
+	if (request->files != NULL)
 	{
 		_pluma_cmd_load_files_from_prompt (window,
-						   file_list,
+						   request->files,
 						   encoding,
-						   line_position);
+						   request->line_position);
 
-		if (new_document_option)
+		if (request->new_document)
 			pluma_window_create_tab (window, TRUE);
 	}
 	else
@@ -368,7 +367,7 @@ on_message_received (const char *message,
 
 		if (doc == NULL ||
 		    !pluma_document_is_untouched (doc) ||
-		    new_document_option)
+		    request->new_document)
 			pluma_window_create_tab (window, TRUE);
 	}
 
@@ -381,116 +380,183 @@ on_message_received (const char *message,
 	if (!gtk_widget_get_realized (GTK_WIDGET (window)))
 		gtk_widget_realize (GTK_WIDGET (window));
 
-	if (startup_timestamp <= 0)
-		startup_timestamp = gdk_x11_get_server_time (gtk_widget_get_window (GTK_WIDGET (window)));
+	timestamp = request->timestamp;
+	if (timestamp <= 0)
+		timestamp = gdk_x11_get_server_time (gtk_widget_get_window (GTK_WIDGET (window)));
 
 	gdk_x11_window_set_user_time (gtk_widget_get_window (GTK_WIDGET (window)),
-				      startup_timestamp);
+				      timestamp);
 
 	gtk_window_present (GTK_WINDOW (window));
+}
 
- out:
-	g_strfreev (commands);
+static gboolean
+process_requests (gpointer data)
+{
+	Request *request;
+
+	process_requests_id = 0;
+
+	pluma_debug_span_begin (DEBUG_APP, "process-requests");
+
+	while ((request = g_queue_pop_head (&pending_requests)) != NULL)
+	{
+		Request *next;
+
+		while ((next = g_queue_peek_head (&pending_requests)) != NULL &&
+		       can_merge_requests (request, next))
+		{
+			g_queue_pop_head (&pending_requests);
 
-	free_command_line_data ();
+			request->files = g_slist_concat (request->files, next->files);
+			request->timestamp = MAX (request->timestamp, next->timestamp);
+			next->files = NULL;
+
+			request_free (next);
+		}
+
+		execute_request (request);
+		request_free (request);
+	}
+
+	pluma_debug_span_end (DEBUG_APP, "process-requests");
+
+	return FALSE;
 }
 
-/* clientside */
+/* Only queues the requests: the client is acknowledged as soon as this
+ * returns, and they are executed in an idle */
 static void
-send_bacon_message (void)
+on_data_received (const char *data,
+		  gsize       len,
+		  gpointer    user_data)
 {
-	GdkScreen *screen;
-	GdkDisplay *display;
+	GVariant *batch;
+	GVariantIter iter;
 	const gchar *display_name;
-	gint screen_number;
-	gint ws;
-	gint viewport_x;
-	gint viewport_y;
-	GString *command;
-
-	/* the messages have the following format:
-	 * <---                                  header                                     ---> <----            body             ----->
-	 * timestamp \t display_name \t screen_number \t workspace \t viewport_x \t viewport_y \v OP1 \t arg \t arg \v OP2 \t arg \t arg|...
-	 *
-	 * when the arg is a list of uri, they are separated by a space.
-	 * So the delimiters are \v for the commands, \t for the tokens in
-	 * a command and ' ' for the uris: note that such delimiters cannot
-	 * be part of an uri, this way parsing is easier.
-	 */
+	const gchar *charset;
+	GVariantIter *uris;
+	Request request;
+
+	batch = g_variant_new_from_data (G_VARIANT_TYPE (BATCH_TYPE),
+					 data, len, FALSE, NULL, NULL);
+	g_variant_ref_sink (batch);
+
+	pluma_debug_message (DEBUG_APP, "Received %" G_GSIZE_FORMAT " requests",
+			     g_variant_n_children (batch));
+
+	g_variant_iter_init (&iter, batch);
+
+	while (g_variant_iter_next (&iter, "(u&siiiibb&sas)",
+				    &request.timestamp,
+				    &display_name,
+				    &request.screen_number,
+				    &request.workspace,
+				    &request.viewport_x,
+				    &request.viewport_y,
+				    &request.new_window,
+				    &request.new_document,
+				    &request.line_position,
+				    &charset,
+				    &uris))
+	{
+		Request *r;
+		const gchar *uri;
 
-	pluma_debug (DEBUG_APP);
+		r = g_slice_dup (Request, &request);
+		r->display_name = g_strdup (display_name);
+		r->encoding_charset = g_strdup (charset);
+		r->files = NULL;
 
-	screen = gdk_screen_get_default ();
-	display = gdk_screen_get_display (screen);
+		while (g_variant_iter_next (uris, "&s", &uri))
+			r->files = g_slist_prepend (r->files, g_file_new_for_uri (uri));
 
-	display_name = gdk_display_get_name (display);
-	screen_number = gdk_screen_get_number (screen);
+		r->files = g_slist_reverse (r->files);
+		g_variant_iter_free (uris);
 
-	pluma_debug_message (DEBUG_APP, "Display: %s", display_name);
-	pluma_debug_message (DEBUG_APP, "Screen: %d", screen_number);
+		g_queue_push_tail (&pending_requests, r);
+	}
 
-	ws = pluma_utils_get_current_workspace (screen);
-	pluma_utils_get_current_viewport (screen, &viewport_x, &viewport_y);
+	g_variant_unref (batch);
 
-	command = g_string_new (NULL);
+	if (process_requests_id == 0)
+		process_requests_id = g_idle_add (process_requests, NULL);
+}
 
-	/* header */
-	g_string_append_printf (command,
-				"%" G_GUINT32_FORMAT "\t%s\t%d\t%d\t%d\t%d",
-				startup_timestamp,
-				display_name,
-				screen_number,
-				ws,
-				viewport_x,
-				viewport_y);
+/* clientside */
+static void
+send_bacon_message (gboolean query_display)
+{
+	const gchar *display_name = "";
+	gint screen_number = 0;
+	gint ws = -1;
+	gint viewport_x = 0;
+	gint viewport_y = 0;
+	GVariantBuilder uris;
+	GVariantBuilder batch;
+	GVariant *message;
+	GSList *l;
 
-	/* NEW-WINDOW command */
-	if (new_window_option)
-	{
-		command = g_string_append_c (command, '\v');
-		command = g_string_append (command, "NEW-WINDOW");
-	}
+	pluma_debug (DEBUG_APP);
 
-	/* NEW-DOCUMENT command */
-	if (new_document_option)
+	/* without the display the server uses its active window */
+	if (query_display)
 	{
-		command = g_string_append_c (command, '\v');
-		command = g_string_append (command, "NEW-DOCUMENT");
-	}
+		GdkScreen *screen;
+		GdkDisplay *display;
 
-	/* OPEN_URIS command, optionally specify line_num and encoding */
-	if (file_list)
-	{
-		GSList *l;
+		screen = gdk_screen_get_default ();
+		display = gdk_screen_get_display (screen);
 
-		command = g_string_append_c (command, '\v');
-		command = g_string_append (command, "OPEN-URIS");
+		display_name = gdk_display_get_name (display);
+		screen_number = gdk_screen_get_number (screen);
 
-		g_string_append_printf (command,
-					"\t%d\t%s\t%u\t",
-					line_position,
-					encoding_charset ? encoding_charset : "",
-					g_slist_length (file_list));
+		pluma_debug_message (DEBUG_APP, "Display: %s", display_name);
+		pluma_debug_message (DEBUG_APP, "Screen: %d", screen_number);
 
-		for (l = file_list; l != NULL; l = l->next)
-		{
-			gchar *uri;
+		ws = pluma_utils_get_current_workspace (screen);
+		pluma_utils_get_current_viewport (screen, &viewport_x, &viewport_y);
+	}
 
-			uri = g_file_get_uri (G_FILE (l->data));
-			command = g_string_append (command, uri);
-			if (l->next != NULL)
-				command = g_string_append_c (command, ' ');
+	g_variant_builder_init (&uris, G_VARIANT_TYPE_STRING_ARRAY);
 
-			g_free (uri);
-		}
-	}
+	for (l = file_list; l != NULL; l = l->next)
+	{
+		gchar *uri;
 
-	pluma_debug_message (DEBUG_APP, "Bacon Message: %s", command->str);
+		uri = g_file_get_uri (G_FILE (l->data));
+		g_variant_builder_add (&uris, "s", uri);
+		g_free (uri);
+	}
 
-	bacon_message_connection_send (connection,
-				       command->str);
+	g_variant_builder_init (&batch, G_VARIANT_TYPE (BATCH_TYPE));
+	g_variant_builder_add (&batch, REQUEST_TYPE,
+			       startup_timestamp,
+			       display_name,
+			       screen_number,
+			       ws,
+			       viewport_x,
+			       viewport_y,
+			       new_window_option,
+			       new_document_option,
+			       line_position,
+			       encoding_charset ? encoding_charset : "",
+			       &uris);
+
+	message = g_variant_ref_sink (g_variant_builder_end (&batch));
+
+	pluma_debug_message (DEBUG_APP, "Bacon message: %" G_GSIZE_FORMAT " bytes",
+			     g_variant_get_size (message));
+
+	if (!bacon_message_connection_send_data (connection,
+						 g_variant_get_data (message),
+						 g_variant_get_size (message),
+						 TRUE))
+	{
+		g_warning ("The running instance of pluma did not answer.");
+	}
 
-	g_string_free (command, TRUE);
+	g_variant_unref (message);
 }
 
 int
@@ -525,7 +591,8 @@ main (int argc, char *argv[])
 	/* Setup command line options */
 	context = g_option_context_new (_("- Edit text files"));
 	g_option_context_add_main_entries (context, options, GETTEXT_PACKAGE);
-	g_option_context_add_group (context, gtk_get_option_group (TRUE));
+	/* the display is only opened once we know we need it */
+	g_option_context_add_group (context, gtk_get_option_group (FALSE));
 	g_option_context_add_group (context, egg_sm_client_get_option_group ());
 
 #ifdef HAVE_INTROSPECTION
@@ -543,6 +610,9 @@ main (int argc, char *argv[])
 
 	g_option_context_free (context);
 
+	if (trace_file != NULL)
+		pluma_debug_set_trace_file (trace_file);
+
 	pluma_debug_message (DEBUG_APP, "Create bacon connection");
 
 	connection = bacon_message_connection_new ("pluma");
@@ -553,16 +623,20 @@ main (int argc, char *argv[])
 		{
 			pluma_debug_message (DEBUG_APP, "I'm a client");
 
+			if (!enqueue_option)
+				gtk_init (&argc, &argv);
+
 			pluma_get_command_line_data ();
 
-			send_bacon_message ();
+			send_bacon_message (!enqueue_option);
 
 			free_command_line_data ();
 
 			/* we never popup a window... tell startup-notification
 			 * that we are done.
 			 */
-			gdk_notify_startup_complete ();
+			if (!enqueue_option)
+				gdk_notify_startup_complete ();
 
 			bacon_message_connection_free (connection);
 
@@ -572,9 +646,9 @@ main (int argc, char *argv[])
 		{
 		  	pluma_debug_message (DEBUG_APP, "I'm a server");
 
-			bacon_message_connection_set_callback (connection,
-							       on_message_received,
-							       NULL);
+			bacon_message_connection_set_data_callback (connection,
+								    on_data_received,
+								    NULL);
 		}
 	}
 	else
@@ -582,6 +656,8 @@ main (int argc, char *argv[])
 		g_warning ("Cannot create the 'pluma' connection.");
 	}
 
+	gtk_init (&argc, &argv);
+
 	pluma_debug_message (DEBUG_APP, "Set icon");
 
 	dir = pluma_dirs_get_pluma_data_dir ();
@@ -664,6 +740,8 @@ main (int argc, char *argv[])
 	pluma_metadata_manager_shutdown ();
 #endif
 
+	pluma_debug_shutdown ();
+
 	return 0;
 }
 
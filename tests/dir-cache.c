@@ -0,0 +1,432 @@
+/*
+ * dir-cache.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+
+#include "pluma-dir-cache.h"
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <utime.h>
+
+typedef struct
+{
+	gchar         *path;
+	GFile         *directory;
+	PlumaDirCache *cache;
+} Fixture;
+
+static void
+fixture_setup (Fixture       *fixture,
+	       gconstpointer  data)
+{
+	gchar *cache_path;
+	gchar *listed_path;
+
+	fixture->path = g_dir_make_tmp ("pluma-dir-cache-XXXXXX", NULL);
+	g_assert (fixture->path != NULL);
+
+	/* keep the cache out of the listed directory, storing a listing
+	 * must not change its mtime */
+	cache_path = g_build_filename (fixture->path, "cache", NULL);
+	listed_path = g_build_filename (fixture->path, "listed", NULL);
+	g_assert (g_mkdir (listed_path, 0700) == 0);
+
+	fixture->cache = pluma_dir_cache_new (cache_path);
+	fixture->directory = g_file_new_for_path (listed_path);
+
+	g_free (listed_path);
+	g_free (cache_path);
+}
+
+static void
+remove_recursive (const gchar *path)
+{
+	GDir *dir;
+	const gchar *name;
+
+	dir = g_dir_open (path, 0, NULL);
+
+	if (dir != NULL)
+	{
+		while ((name = g_dir_read_name (dir)) != NULL)
+		{
+			gchar *child = g_build_filename (path, name, NULL);
+
+			remove_recursive (child);
+			g_free (child);
+		}
+
+		g_dir_close (dir);
+	}
+
+	g_remove (path);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+		  gconstpointer  data)
+{
+	remove_recursive (fixture->path);
+
+	g_object_unref (fixture->cache);
+	g_object_unref (fixture->directory);
+	g_free (fixture->path);
+}
+
+static GFileInfo *
+new_info (const gchar *name,
+	  const gchar *display_name,
+	  GFileType    type,
+	  gboolean     hidden)
+{
+	GFileInfo *info;
+
+	info = g_file_info_new ();
+	g_file_info_set_name (info, name);
+
+	if (display_name != NULL)
+		g_file_info_set_display_name (info, display_name);
+
+	g_file_info_set_file_type (info, type);
+	g_file_info_set_is_hidden (info, hidden);
+
+	return info;
+}
+
+static void
+test_round_trip (Fixture       *fixture,
+		 gconstpointer  data)
+{
+	PlumaDirListing *listing;
+	GList *infos = NULL;
+
+	g_assert (pluma_dir_cache_lookup (fixture->cache, fixture->directory) == NULL);
+
+	infos = g_list_append (infos, new_info ("src", NULL, G_FILE_TYPE_DIRECTORY, FALSE));
+	infos = g_list_append (infos, new_info ("README", "README", G_FILE_TYPE_REGULAR, FALSE));
+	infos = g_list_append (infos, new_info ("\xe9t\xe9", "\xc3\xa9t\xc3\xa9", G_FILE_TYPE_REGULAR, FALSE));
+	infos = g_list_append (infos, new_info (".git", NULL, G_FILE_TYPE_DIRECTORY, TRUE));
+
+	g_assert (pluma_dir_cache_store (fixture->cache, fixture->directory, 1234, infos));
+	g_list_free_full (infos, g_object_unref);
+
+	listing = pluma_dir_cache_lookup (fixture->cache, fixture->directory);
+	g_assert (listing != NULL);
+
+	g_assert_cmpuint (pluma_dir_listing_get_mtime (listing), ==, 1234);
+	g_assert_cmpuint (pluma_dir_listing_get_n_entries (listing), ==, 4);
+
+	g_assert_cmpstr (pluma_dir_listing_get_name (listing, 0), ==, "src");
+	g_assert_cmpstr (pluma_dir_listing_get_display_name (listing, 0), ==, "src");
+	g_assert_cmpint (pluma_dir_listing_get_file_type (listing, 0), ==, G_FILE_TYPE_DIRECTORY);
+
+	g_assert_cmpstr (pluma_dir_listing_get_name (listing, 2), ==, "\xe9t\xe9");
+	g_assert_cmpstr (pluma_dir_listing_get_display_name (listing, 2), ==, "\xc3\xa9t\xc3\xa9");
+	g_assert_cmpint (pluma_dir_listing_get_file_type (listing, 2), ==, G_FILE_TYPE_REGULAR);
+
+	g_assert (!pluma_dir_listing_get_is_hidden (listing, 1));
+	g_assert (pluma_dir_listing_get_is_hidden (listing, 3));
+
+	pluma_dir_listing_unref (listing);
+}
+
+static void
+test_content_type (Fixture       *fixture,
+		   gconstpointer  data)
+{
+	PlumaDirListing *listing;
+	GFileInfo *info;
+	GList *infos = NULL;
+
+	info = new_info ("a.txt", NULL, G_FILE_TYPE_REGULAR, FALSE);
+	g_file_info_set_content_type (info, "text/plain");
+	infos = g_list_append (infos, info);
+	infos = g_list_append (infos, new_info ("b.png", NULL, G_FILE_TYPE_REGULAR, FALSE));
+
+	g_assert (pluma_dir_cache_store (fixture->cache, fixture->directory, 1, infos));
+	g_list_free_full (infos, g_object_unref);
+
+	listing = pluma_dir_cache_lookup (fixture->cache, fixture->directory);
+	g_assert_cmpstr (pluma_dir_listing_get_content_type (listing, 0), ==, "text/plain");
+	g_assert (pluma_dir_listing_get_content_type (listing, 1) == NULL);
+
+	info = pluma_dir_listing_get_info (listing, 0);
+	g_assert_cmpstr (g_file_info_get_content_type (info), ==, "text/plain");
+	g_assert (g_file_info_get_icon (info) != NULL);
+	g_object_unref (info);
+
+	info = pluma_dir_listing_get_info (listing, 1);
+	g_assert (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE));
+	g_object_unref (info);
+
+	pluma_dir_listing_unref (listing);
+
+	/* listed again without content types, the known one is kept */
+	infos = g_list_append (NULL, new_info ("a.txt", NULL, G_FILE_TYPE_REGULAR, FALSE));
+	infos = g_list_append (infos, new_info ("c", NULL, G_FILE_TYPE_REGULAR, FALSE));
+
+	g_assert (pluma_dir_cache_store (fixture->cache, fixture->directory, 2, infos));
+	g_list_free_full (infos, g_object_unref);
+
+	listing = pluma_dir_cache_lookup (fixture->cache, fixture->directory);
+	g_assert_cmpuint (pluma_dir_listing_get_n_entries (listing), ==, 2);
+	g_assert_cmpstr (pluma_dir_listing_get_content_type (listing, 0), ==, "text/plain");
+	g_assert (pluma_dir_listing_get_content_type (listing, 1) == NULL);
+	pluma_dir_listing_unref (listing);
+}
+
+static void
+test_other_directory (Fixture       *fixture,
+		      gconstpointer  data)
+{
+	GFile *other;
+
+	g_assert (pluma_dir_cache_store (fixture->cache, fixture->directory, 1, NULL));
+
+	other = g_file_get_child (fixture->directory, "other");
+	g_assert (pluma_dir_cache_lookup (fixture->cache, other) == NULL);
+	g_object_unref (other);
+}
+
+static void
+test_corrupt (Fixture       *fixture,
+	      gconstpointer  data)
+{
+	PlumaDirListing *listing;
+	GList *infos = NULL;
+	GDir *dir;
+	gchar *cache_path;
+	gchar *file;
+	gchar *contents;
+	gsize length;
+
+	infos = g_list_append (infos, new_info ("a", NULL, G_FILE_TYPE_REGULAR, FALSE));
+	g_assert (pluma_dir_cache_store (fixture->cache, fixture->directory, 1, infos));
+	g_list_free_full (infos, g_object_unref);
+
+	g_object_get (fixture->cache, "path", &cache_path, NULL);
+	dir = g_dir_open (cache_path, 0, NULL);
+	file = g_build_filename (cache_path, g_dir_read_name (dir), NULL);
+	g_dir_close (dir);
+
+	g_assert (g_file_get_contents (file, &contents, &length, NULL));
+
+	/* a truncated file must be ignored, not read past its end */
+	g_assert (g_file_set_contents (file, contents, length - 2, NULL));
+
+	listing = pluma_dir_cache_lookup (fixture->cache, fixture->directory);
+	g_assert (listing == NULL);
+
+	g_free (contents);
+	g_free (file);
+	g_free (cache_path);
+}
+
+static gchar *
+listing_file (Fixture *fixture,
+	      GFile   *directory)
+{
+	gchar *cache_path;
+	gchar *uri;
+	gchar *checksum;
+	gchar *file;
+
+	g_object_get (fixture->cache, "path", &cache_path, NULL);
+	uri = g_file_get_uri (directory);
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+	file = g_build_filename (cache_path, checksum, NULL);
+
+	g_free (checksum);
+	g_free (uri);
+	g_free (cache_path);
+
+	return file;
+}
+
+static void
+test_evict (Fixture       *fixture,
+	    gconstpointer  data)
+{
+	PlumaDirCache *cache;
+	GFile *dirs[3];
+	gchar *cache_path;
+	gchar *file;
+	struct utimbuf old = { 0, 0 };
+	gint i;
+
+	/* keeps two listings only */
+	g_object_get (fixture->cache, "path", &cache_path, NULL);
+	cache = g_object_new (PLUMA_TYPE_DIR_CACHE,
+			      "path", cache_path,
+			      "max-listings", 2,
+			      NULL);
+	g_object_unref (fixture->cache);
+	fixture->cache = cache;
+	g_free (cache_path);
+
+	for (i = 0; i < 3; ++i)
+	{
+		gchar *name = g_strdup_printf ("dir%d", i);
+
+		dirs[i] = g_file_get_child (fixture->directory, name);
+		g_free (name);
+	}
+
+	g_assert (pluma_dir_cache_store (fixture->cache, dirs[0], 1, NULL));
+	g_assert (pluma_dir_cache_store (fixture->cache, dirs[1], 1, NULL));
+
+	/* the first one was not used for a long time */
+	file = listing_file (fixture, dirs[0]);
+	g_assert (g_utime (file, &old) == 0);
+	g_free (file);
+
+	g_assert (pluma_dir_cache_store (fixture->cache, dirs[2], 1, NULL));
+
+	g_assert (pluma_dir_cache_lookup (fixture->cache, dirs[0]) == NULL);
+
+	for (i = 1; i < 3; ++i)
+	{
+		PlumaDirListing *listing;
+
+		listing = pluma_dir_cache_lookup (fixture->cache, dirs[i]);
+		g_assert (listing != NULL);
+		pluma_dir_listing_unref (listing);
+	}
+
+	for (i = 0; i < 3; ++i)
+		g_object_unref (dirs[i]);
+}
+
+static void
+test_unwritable (Fixture       *fixture,
+		 gconstpointer  data)
+{
+	PlumaDirCache *cache;
+	PlumaDirListing *listing;
+	GList *infos = NULL;
+	gchar *blocker;
+	gchar *cache_path;
+
+	/* a file where the cache directory should be, unlike permissions
+	 * this also stops root */
+	blocker = g_build_filename (fixture->path, "blocker", NULL);
+	g_assert (g_file_set_contents (blocker, "", 0, NULL));
+	cache_path = g_build_filename (blocker, "cache", NULL);
+
+	cache = pluma_dir_cache_new (cache_path);
+
+	infos = g_list_append (infos, new_info ("README", NULL, G_FILE_TYPE_REGULAR, FALSE));
+
+	g_assert (pluma_dir_cache_store (cache, fixture->directory, 1234, infos));
+	g_list_free_full (infos, g_object_unref);
+
+	g_assert (!g_file_test (cache_path, G_FILE_TEST_EXISTS));
+
+	/* kept in memory instead */
+	listing = pluma_dir_cache_lookup (cache, fixture->directory);
+	g_assert (listing != NULL);
+	g_assert_cmpuint (pluma_dir_listing_get_mtime (listing), ==, 1234);
+	g_assert_cmpuint (pluma_dir_listing_get_n_entries (listing), ==, 1);
+	g_assert_cmpstr (pluma_dir_listing_get_name (listing, 0), ==, "README");
+	pluma_dir_listing_unref (listing);
+
+	g_object_unref (cache);
+	g_free (cache_path);
+	g_free (blocker);
+}
+
+static void
+on_changed (PlumaDirCache *cache,
+	    GFile         *directory,
+	    gboolean      *changed)
+{
+	*changed = TRUE;
+}
+
+static void
+wait_for_revalidation (Fixture  *fixture,
+		       gboolean *changed)
+{
+	gint i;
+
+	*changed = FALSE;
+	pluma_dir_cache_revalidate (fixture->cache, fixture->directory);
+
+	/* let the worker thread finish */
+	for (i = 0; i < 200 && !*changed; ++i)
+	{
+		while (g_main_context_iteration (NULL, FALSE));
+		g_usleep (10000);
+	}
+}
+
+static void
+test_revalidate (Fixture       *fixture,
+		 gconstpointer  data)
+{
+	PlumaDirListing *listing;
+	gboolean changed;
+	gchar *file;
+
+	file = g_build_filename (fixture->path, "listed", "new.txt", NULL);
+	g_assert (g_file_set_contents (file, "", 0, NULL));
+	g_free (file);
+
+	g_signal_connect (fixture->cache, "changed", G_CALLBACK (on_changed), &changed);
+
+	/* nothing cached yet, the directory is listed */
+	wait_for_revalidation (fixture, &changed);
+	g_assert (changed);
+
+	listing = pluma_dir_cache_lookup (fixture->cache, fixture->directory);
+	g_assert (listing != NULL);
+	g_assert_cmpuint (pluma_dir_listing_get_mtime (listing), ==,
+			  pluma_dir_cache_query_mtime (fixture->directory, NULL, NULL));
+	pluma_dir_listing_unref (listing);
+
+	/* the mtime did not change, the listing is kept */
+	wait_for_revalidation (fixture, &changed);
+	g_assert (!changed);
+}
+
+int main (int   argc,
+          char *argv[])
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add ("/dir-cache/round-trip", Fixture, NULL,
+		    fixture_setup, test_round_trip, fixture_teardown);
+	g_test_add ("/dir-cache/content-type", Fixture, NULL,
+		    fixture_setup, test_content_type, fixture_teardown);
+	g_test_add ("/dir-cache/other-directory", Fixture, NULL,
+		    fixture_setup, test_other_directory, fixture_teardown);
+	g_test_add ("/dir-cache/corrupt", Fixture, NULL,
+		    fixture_setup, test_corrupt, fixture_teardown);
+	g_test_add ("/dir-cache/evict", Fixture, NULL,
+		    fixture_setup, test_evict, fixture_teardown);
+	g_test_add ("/dir-cache/unwritable", Fixture, NULL,
+		    fixture_setup, test_unwritable, fixture_teardown);
+	g_test_add ("/dir-cache/revalidate", Fixture, NULL,
+		    fixture_setup, test_revalidate, fixture_teardown);
+
+	return g_test_run ();
+}
@@ -20,7 +20,12 @@
  * Boston, MA  02110-1301  USA
  */
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include "pluma-gio-document-loader.h"
+#include "pluma-compression.h"
 #include "pluma-prefs-manager-app.h"
 #include <gio/gio.h>
 #include <gtk/gtk.h>
@@ -236,6 +241,201 @@ test_begin_new_line_detection ()
 	             PLUMA_DOCUMENT_NEWLINE_TYPE_CR);
 }
 
+static void
+test_paused ()
+{
+	GFile *file;
+	gchar *uri;
+	PlumaDocument *document;
+	LoaderTestData data;
+	gint i;
+
+	file = create_document ("document-loader.txt", "hello world\n");
+
+	document = pluma_document_new ();
+
+	data.in_buffer = "hello world";
+	data.newline_type = -1;
+	data.file = file;
+
+	test_completed = FALSE;
+
+	g_signal_connect (document,
+	                  "loaded",
+	                  G_CALLBACK (on_document_loaded),
+	                  &data);
+
+	_pluma_document_set_load_priority (document, G_PRIORITY_LOW, TRUE);
+
+	uri = g_file_get_uri (file);
+	pluma_document_load (document, uri, pluma_encoding_get_utf8 (), 0, FALSE);
+	g_free (uri);
+
+	/* the file is opened, but not read */
+	for (i = 0; i < 100; ++i)
+	{
+		while (g_main_context_iteration (NULL, FALSE));
+		g_usleep (1000);
+	}
+
+	g_assert (!test_completed);
+
+	_pluma_document_set_load_priority (document, G_PRIORITY_HIGH, FALSE);
+
+	while (!test_completed)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	g_object_unref (file);
+	g_object_unref (document);
+}
+
+/* Lines long enough for the converters to fill their output buffer
+ * several times */
+static gchar *
+create_long_text (void)
+{
+	GString *text;
+	gint i;
+
+	text = g_string_new (NULL);
+
+	for (i = 0; i < 5000; ++i)
+		g_string_append_printf (text, "line %d of the compressed file\n", i);
+
+	return g_string_free (text, FALSE);
+}
+
+static void
+append_compressed (GByteArray                   *bytes,
+                   PlumaDocumentCompressionType  compression_type,
+                   const gchar                  *text,
+                   gsize                         length)
+{
+	GOutputStream *memory;
+	GOutputStream *stream;
+	GConverter *compressor;
+	GError *error = NULL;
+
+	memory = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+	compressor = pluma_compression_new_compressor (compression_type);
+	g_assert (compressor != NULL);
+	stream = g_converter_output_stream_new (memory, compressor);
+
+	g_output_stream_write_all (stream, text, length, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_output_stream_close (stream, NULL, &error);
+	g_assert_no_error (error);
+
+	g_byte_array_append (bytes,
+	                     g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (memory)),
+	                     g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (memory)));
+
+	g_object_unref (stream);
+	g_object_unref (compressor);
+	g_object_unref (memory);
+}
+
+/* With @concatenated the file is made of two compressed streams, as
+ * written by "xz -c a b" or "zstd -c a b" */
+static void
+test_compressed (const gchar                  *filename,
+                 PlumaDocumentCompressionType  compression_type,
+                 gboolean                      concatenated)
+{
+	GFile *file;
+	GByteArray *bytes;
+	gchar *text;
+	gsize length;
+	gchar *uri;
+	PlumaDocument *document;
+	LoaderTestData data;
+	GError *error = NULL;
+
+	text = create_long_text ();
+	length = strlen (text);
+
+	bytes = g_byte_array_new ();
+
+	if (concatenated)
+	{
+		const gchar *middle;
+
+		middle = strchr (text + length / 2, '\n') + 1;
+
+		append_compressed (bytes, compression_type, text, middle - text);
+		append_compressed (bytes, compression_type, middle, length - (middle - text));
+	}
+	else
+	{
+		append_compressed (bytes, compression_type, text, length);
+	}
+
+	g_file_set_contents (filename, (const gchar *) bytes->data, bytes->len, &error);
+	g_assert_no_error (error);
+
+	g_byte_array_free (bytes, TRUE);
+
+	file = g_file_new_for_path (filename);
+	document = pluma_document_new ();
+
+	/* without the last newline */
+	text[length - 1] = '\0';
+
+	data.in_buffer = text;
+	data.newline_type = PLUMA_DOCUMENT_NEWLINE_TYPE_LF;
+	data.file = file;
+
+	test_completed = FALSE;
+
+	g_signal_connect (document,
+	                  "loaded",
+	                  G_CALLBACK (on_document_loaded),
+	                  &data);
+
+	uri = g_file_get_uri (file);
+	pluma_document_load (document, uri, pluma_encoding_get_utf8 (), 0, FALSE);
+	g_free (uri);
+
+	while (!test_completed)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	g_assert_cmpint (pluma_document_get_compression_type (document),
+	                 ==,
+	                 compression_type);
+
+	g_free (text);
+	g_object_unref (file);
+	g_object_unref (document);
+}
+
+static void
+test_gzip ()
+{
+	test_compressed ("document-loader.txt.gz", PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP, FALSE);
+}
+
+#ifdef HAVE_LZMA
+static void
+test_xz ()
+{
+	test_compressed ("document-loader.txt.xz", PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ, FALSE);
+	test_compressed ("document-loader.txt.xz", PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ, TRUE);
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static void
+test_zstd ()
+{
+	test_compressed ("document-loader.txt.zst", PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD, FALSE);
+	test_compressed ("document-loader.txt.zst", PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD, TRUE);
+}
+#endif
+
 int main (int   argc,
           char *argv[])
 {
@@ -246,6 +446,14 @@ int main (int   argc,
 	g_test_add_func ("/document-loader/end-line-stripping", test_end_line_stripping);
 	g_test_add_func ("/document-loader/end-new-line-detection", test_end_new_line_detection);
 	g_test_add_func ("/document-loader/begin-new-line-detection", test_begin_new_line_detection);
+	g_test_add_func ("/document-loader/paused", test_paused);
+	g_test_add_func ("/document-loader/gzip", test_gzip);
+#ifdef HAVE_LZMA
+	g_test_add_func ("/document-loader/xz", test_xz);
+#endif
+#ifdef HAVE_ZSTD
+	g_test_add_func ("/document-loader/zstd", test_zstd);
+#endif
 
 	return g_test_run ();
 }
@@ -20,7 +20,12 @@
  * Boston, MA  02110-1301  USA
  */
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include "pluma-gio-document-loader.h"
+#include "pluma-compression.h"
 #include "pluma-prefs-manager-app.h"
 #include <gio/gio.h>
 #include <gtk/gtk.h>
@@ -333,6 +338,120 @@ test_local ()
 	            saver_test_data_new (DEFAULT_LOCAL_URI, "hello world\n\n", NULL));
 }
 
+/* Saves a document which was loaded with @from_type as @filename, and
+ * checks the file is compressed according to its name */
+static void
+test_local_compressed (const gchar                  *filename,
+                       PlumaDocumentCompressionType  from_type,
+                       PlumaDocumentCompressionType  to_type)
+{
+	PlumaDocument *document;
+	GFile *file;
+	GString *text;
+	GInputStream *stream;
+	GConverter *decompressor;
+	GError *error = NULL;
+	gchar *buffer;
+	gchar *uri;
+	gsize read;
+	gint i;
+
+	/* long enough to fill the output buffer of the compressor */
+	text = g_string_new (NULL);
+
+	for (i = 0; i < 5000; ++i)
+		g_string_append_printf (text, "line %d of the compressed file\n", i);
+
+	document = create_document (text->str);
+	pluma_document_set_compression_type (document, from_type);
+
+	g_signal_connect (document, "saved", G_CALLBACK (complete_test_error), NULL);
+	g_signal_connect_after (document, "saved", G_CALLBACK (complete_test), NULL);
+
+	test_completed = FALSE;
+
+	file = g_file_new_for_path (filename);
+	uri = g_file_get_uri (file);
+
+	pluma_document_save_as (document, uri, pluma_encoding_get_utf8 (), 0);
+
+	while (!test_completed)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	g_assert_cmpint (pluma_document_get_compression_type (document), ==, to_type);
+
+	stream = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+	g_assert_no_error (error);
+
+	decompressor = pluma_compression_new_decompressor (to_type);
+
+	if (decompressor != NULL)
+	{
+		GInputStream *decompressed;
+
+		decompressed = g_converter_input_stream_new (stream, decompressor);
+		g_object_unref (decompressor);
+		g_object_unref (stream);
+
+		stream = decompressed;
+	}
+
+	/* the saver adds a last newline */
+	buffer = g_malloc (text->len + 64);
+
+	g_input_stream_read_all (stream, buffer, text->len + 63, &read, NULL, &error);
+	g_assert_no_error (error);
+	buffer[read] = '\0';
+
+	g_string_append_c (text, '\n');
+	g_assert_cmpstr (buffer, ==, text->str);
+
+	g_free (buffer);
+	g_object_unref (stream);
+
+	g_file_delete (file, NULL, NULL);
+
+	g_string_free (text, TRUE);
+	g_free (uri);
+	g_object_unref (file);
+	g_object_unref (document);
+}
+
+static void
+test_local_gzip ()
+{
+	test_local_compressed (DEFAULT_LOCAL_URI ".gz",
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE,
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP);
+
+	/* saved as a plain file, it is no longer compressed */
+	test_local_compressed (DEFAULT_LOCAL_URI,
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_GZIP,
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE);
+}
+
+#ifdef HAVE_LZMA
+static void
+test_local_xz ()
+{
+	test_local_compressed (DEFAULT_LOCAL_URI ".xz",
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE,
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_XZ);
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static void
+test_local_zstd ()
+{
+	test_local_compressed (DEFAULT_LOCAL_URI ".zst",
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_NONE,
+	                       PLUMA_DOCUMENT_COMPRESSION_TYPE_ZSTD);
+}
+#endif
+
 static void
 test_remote_newline ()
 {
@@ -698,6 +817,13 @@ int main (int   argc,
 
 	g_test_add_func ("/document-saver/local", test_local);
 	g_test_add_func ("/document-saver/local-new-line", test_local_newline);
+	g_test_add_func ("/document-saver/local-gzip", test_local_gzip);
+#ifdef HAVE_LZMA
+	g_test_add_func ("/document-saver/local-xz", test_local_xz);
+#endif
+#ifdef HAVE_ZSTD
+	g_test_add_func ("/document-saver/local-zstd", test_local_zstd);
+#endif
 
 	if (have_unowned)
 	{
@@ -0,0 +1,141 @@
+/*
+ * line-diff.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+
+#include "pluma-line-diff.h"
+#include <glib.h>
+#include <string.h>
+
+/* Applies the hunks to a copy of @old_text, the way the document does */
+static gchar *
+apply_hunks (const gchar *old_text,
+	     GPtrArray   *hunks)
+{
+	GString *str;
+	gint i;
+
+	str = g_string_new (old_text);
+
+	for (i = hunks->len - 1; i >= 0; i--)
+	{
+		PlumaLineDiffHunk *hunk = g_ptr_array_index (hunks, i);
+		const gchar *start;
+		const gchar *end;
+
+		start = g_utf8_offset_to_pointer (str->str, hunk->old_offset);
+		end = g_utf8_offset_to_pointer (start, hunk->old_length);
+
+		g_string_erase (str, start - str->str, end - start);
+		g_string_insert (str, start - str->str, hunk->new_text);
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+static void
+test_diff (const gchar *old_text,
+	   const gchar *new_text,
+	   guint        max_edits,
+	   guint        n_hunks)
+{
+	GPtrArray *hunks;
+	gchar *result;
+	guint i;
+
+	hunks = pluma_line_diff (old_text, -1, new_text, -1, max_edits);
+
+	g_assert_cmpuint (hunks->len, ==, n_hunks);
+
+	for (i = 1; i < hunks->len; i++)
+	{
+		PlumaLineDiffHunk *prev = g_ptr_array_index (hunks, i - 1);
+		PlumaLineDiffHunk *hunk = g_ptr_array_index (hunks, i);
+
+		g_assert_cmpint (prev->old_offset + prev->old_length, <=, hunk->old_offset);
+	}
+
+	result = apply_hunks (old_text, hunks);
+	g_assert_cmpstr (result, ==, new_text);
+
+	g_free (result);
+	g_ptr_array_free (hunks, TRUE);
+}
+
+static void
+test_equal ()
+{
+	test_diff ("", "", 100, 0);
+	test_diff ("a\nb\nc", "a\nb\nc", 100, 0);
+}
+
+static void
+test_change ()
+{
+	GPtrArray *hunks;
+	PlumaLineDiffHunk *hunk;
+
+	hunks = pluma_line_diff ("a\nb\nc\nd", -1, "a\nX\nc\nd", -1, 100);
+
+	g_assert_cmpuint (hunks->len, ==, 1);
+
+	hunk = g_ptr_array_index (hunks, 0);
+	g_assert_cmpint (hunk->old_offset, ==, 2);
+	g_assert_cmpint (hunk->old_length, ==, 2);
+	g_assert_cmpstr (hunk->new_text, ==, "X\n");
+
+	g_ptr_array_free (hunks, TRUE);
+
+	test_diff ("a\nb\nc\nd\ne", "a\nB\nc\nD\ne", 100, 2);
+	test_diff ("\303\250\n\303\250\nb", "\303\250\n\303\251\nb", 100, 1);
+}
+
+static void
+test_insert_delete ()
+{
+	test_diff ("", "a\nb", 100, 1);
+	test_diff ("a\nb", "", 100, 1);
+	test_diff ("a\nb\nc", "a\nb\nc\nd", 100, 1);
+	test_diff ("a\nb\nc", "x\na\nb\nc", 100, 1);
+	test_diff ("a\nb\nc\nd", "a\nd", 100, 1);
+	test_diff ("a\nb\nc\nd\ne\nf", "a\nc\nd\nX\nY\nf", 100, 2);
+}
+
+static void
+test_max_edits ()
+{
+	/* too many changes: everything between the common lines at once */
+	test_diff ("h\na\nb\nc\nt", "h\nx\nb\ny\nt", 0, 1);
+	test_diff ("h\na\nb\nc\nt", "h\nx\nb\ny\nt", 100, 2);
+}
+
+int main (int   argc,
+          char *argv[])
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/line-diff/equal", test_equal);
+	g_test_add_func ("/line-diff/change", test_change);
+	g_test_add_func ("/line-diff/insert-delete", test_insert_delete);
+	g_test_add_func ("/line-diff/max-edits", test_max_edits);
+
+	return g_test_run ();
+}
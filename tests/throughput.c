@@ -0,0 +1,663 @@
+/*
+ * throughput.c
+ * This file is part of pluma
+ *
+ * Copyright (C) 2026 - The pluma Team
+ *
+ * pluma is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * pluma is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pluma; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Times the load and save pipeline on generated files and checks the
+ * results against the baselines in throughput-baselines.ini. Absolute
+ * figures depend on the machine, so what is compared is relative to the
+ * same run: the time of the pipeline divided by the time of a fixed
+ * CPU-bound calibration loop, and how much the peak RSS grew over the
+ * RSS before it. A test fails when one of them is higher than the
+ * baseline by more than PLUMA_THROUGHPUT_TOLERANCE (25% by default),
+ * plus RSS_SLACK_KB for the allocator, and is skipped when there is no
+ * baseline for it.
+ *
+ * It takes a while, so it is not part of make check: run it with make
+ * bench.
+ *
+ * Run with PLUMA_THROUGHPUT_UPDATE_BASELINES=1 (or make
+ * update-throughput-baselines) to store the results as the new
+ * baselines, keeping the comment at the top of the file.
+ */
+
+#include "pluma-document.h"
+#include "pluma-document-input-stream.h"
+#include "pluma-document-output-stream.h"
+#include "pluma-prefs-manager-app.h"
+#include <gio/gio.h>
+#include <gtk/gtk.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+/* The best of RUNS is kept, the first ones warm up the caches */
+#define RUNS		3
+#define CHUNK_SIZE	8192
+
+#define DEFAULT_TOLERANCE 0.25
+
+/* Allowed on top of the tolerance, small growths are mostly noise */
+#define RSS_SLACK_KB	4096
+
+/* Hashed by the calibration loop, long enough for its time not to be
+ * noise */
+#define CALIBRATION_SIZE	(64 * 1024 * 1024)
+
+typedef struct
+{
+	const gchar              *name;
+	gsize                     size;
+	gint                      line_length;
+	PlumaDocumentNewlineType  newline_type;
+	const gchar              *charset;
+} Corpus;
+
+static const Corpus corpora[] = {
+	{ "small",       1024 * 1024,      60,   PLUMA_DOCUMENT_NEWLINE_TYPE_LF,    "UTF-8" },
+	{ "short-lines", 16 * 1024 * 1024, 60,   PLUMA_DOCUMENT_NEWLINE_TYPE_LF,    "UTF-8" },
+	{ "long-lines",  16 * 1024 * 1024, 4000, PLUMA_DOCUMENT_NEWLINE_TYPE_LF,    "UTF-8" },
+	{ "crlf",        16 * 1024 * 1024, 60,   PLUMA_DOCUMENT_NEWLINE_TYPE_CR_LF, "UTF-8" },
+	{ "latin9",      16 * 1024 * 1024, 60,   PLUMA_DOCUMENT_NEWLINE_TYPE_LF,    "ISO-8859-15" }
+};
+
+typedef struct
+{
+	const Corpus *corpus;
+
+	/* The text with the newlines of the corpus, in UTF-8 */
+	gchar        *text;
+	gsize         text_length;
+	gsize         newline_length;
+
+	/* The same, in the charset of the corpus */
+	gchar        *encoded;
+	gsize         encoded_length;
+
+	gchar        *path;
+	gchar        *uri;
+} Fixture;
+
+static gchar *tmp_dir;
+static gint64 calibration_usec;
+static GKeyFile *baselines;
+static GKeyFile *results;
+static gdouble tolerance;
+
+static gboolean operation_completed;
+
+/* Lines of latin text with a few letters outside of ASCII, all of them
+ * in ISO-8859-15 */
+static void
+append_line (GString *text,
+	     gint     length)
+{
+	static const gchar *words[] = {
+		"lorem", "ipsum", "dolor", "sit", "amet", "caf\xc3\xa9",
+		"na\xc3\xafve", "stra\xc3\x9f" "e", "\xc3\xa0", "d\xc3\xa9j\xc3\xa0",
+		"consectetur", "adipiscing", "\xe2\x82\xac", "elit"
+	};
+	static guint next = 0;
+	gint chars = 0;
+
+	while (chars < length)
+	{
+		const gchar *word = words[next++ % G_N_ELEMENTS (words)];
+
+		if (chars > 0)
+		{
+			g_string_append_c (text, ' ');
+			++chars;
+		}
+
+		g_string_append (text, word);
+		chars += g_utf8_strlen (word, -1);
+	}
+}
+
+/* Best time of hashing CALIBRATION_SIZE bytes, what the pipelines are
+ * compared with. Unlike reading a file it does not depend on the page
+ * cache */
+static gint64
+time_calibration (void)
+{
+	guchar *data;
+	gint64 best = G_MAXINT64;
+	gsize i;
+	gint j;
+
+	data = g_malloc (CALIBRATION_SIZE);
+
+	for (i = 0; i < CALIBRATION_SIZE; ++i)
+		data[i] = i * 31;
+
+	for (j = 0; j < RUNS; ++j)
+	{
+		gchar *checksum;
+		gint64 start;
+
+		start = g_get_monotonic_time ();
+		checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, data, CALIBRATION_SIZE);
+		best = MIN (best, g_get_monotonic_time () - start);
+
+		g_free (checksum);
+	}
+
+	g_free (data);
+
+	return MAX (best, 1);
+}
+
+static void
+fixture_setup (Fixture       *fixture,
+	       gconstpointer  data)
+{
+	const Corpus *corpus = data;
+	const gchar *newline;
+	GString *text;
+	GError *error = NULL;
+
+	fixture->corpus = corpus;
+
+	switch (corpus->newline_type)
+	{
+		case PLUMA_DOCUMENT_NEWLINE_TYPE_CR_LF:
+			newline = "\r\n";
+			break;
+		case PLUMA_DOCUMENT_NEWLINE_TYPE_CR:
+			newline = "\r";
+			break;
+		default:
+			newline = "\n";
+			break;
+	}
+
+	text = g_string_sized_new (corpus->size + corpus->line_length * 4);
+
+	while (text->len < corpus->size)
+	{
+		append_line (text, corpus->line_length);
+		g_string_append (text, newline);
+	}
+
+	fixture->text_length = text->len;
+	fixture->text = g_string_free (text, FALSE);
+	fixture->newline_length = strlen (newline);
+
+	fixture->encoded = g_convert (fixture->text, fixture->text_length,
+				      corpus->charset, "UTF-8",
+				      NULL, &fixture->encoded_length, &error);
+	g_assert_no_error (error);
+
+	fixture->path = g_build_filename (tmp_dir, corpus->name, NULL);
+	fixture->uri = g_filename_to_uri (fixture->path, NULL, NULL);
+
+	g_file_set_contents (fixture->path, fixture->encoded, fixture->encoded_length, &error);
+	g_assert_no_error (error);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+		  gconstpointer  data)
+{
+	gchar *backup;
+
+	g_remove (fixture->path);
+
+	backup = g_strconcat (fixture->path, "~", NULL);
+	g_remove (backup);
+	g_free (backup);
+
+	g_free (fixture->text);
+	g_free (fixture->encoded);
+	g_free (fixture->path);
+	g_free (fixture->uri);
+}
+
+static gsize get_peak_rss (void);
+
+/* Returns the RSS the peak starts from, in KB */
+static gsize
+reset_peak_rss (void)
+{
+	FILE *clear_refs;
+
+	/* Linux resets VmHWM on "5", elsewhere the peak of the process
+	 * is reported */
+	clear_refs = fopen ("/proc/self/clear_refs", "w");
+
+	if (clear_refs != NULL)
+	{
+		fputs ("5", clear_refs);
+		fclose (clear_refs);
+	}
+
+	return get_peak_rss ();
+}
+
+/* In KB */
+static gsize
+get_peak_rss (void)
+{
+	struct rusage usage;
+	gchar *status;
+
+	if (g_file_get_contents ("/proc/self/status", &status, NULL, NULL))
+	{
+		gchar *hwm;
+		gsize kb = 0;
+
+		hwm = strstr (status, "VmHWM:");
+
+		if (hwm != NULL)
+			kb = g_ascii_strtoull (hwm + strlen ("VmHWM:"), NULL, 10);
+
+		g_free (status);
+
+		if (kb > 0)
+			return kb;
+	}
+
+	getrusage (RUSAGE_SELF, &usage);
+
+	return usage.ru_maxrss;
+}
+
+/* Where the peak cannot be reset this is the growth of the peak of the
+ * process, often 0 */
+static gsize
+get_rss_growth (gsize start)
+{
+	gsize peak;
+
+	peak = get_peak_rss ();
+
+	return peak > start ? peak - start : 0;
+}
+
+static void
+check_result (const gchar *pipeline,
+	      Fixture     *fixture,
+	      gint64       best_usec,
+	      gsize        rss_growth)
+{
+	gchar *group;
+	gdouble mb_per_s;
+	gdouble relative_time;
+
+	best_usec = MAX (best_usec, 1);
+
+	mb_per_s = (fixture->encoded_length / (1024.0 * 1024.0)) /
+		   (best_usec / (gdouble) G_USEC_PER_SEC);
+	relative_time = best_usec / (gdouble) calibration_usec;
+
+	group = g_strdup_printf ("%s/%s", pipeline, fixture->corpus->name);
+
+	g_print ("%-26s %9.1f MB/s %9.3fx calibration %9" G_GSIZE_FORMAT " KB RSS growth\n",
+		 group, mb_per_s, relative_time, rss_growth);
+
+	if (results != NULL)
+	{
+		g_key_file_set_double (results, group, "relative-time", relative_time);
+		g_key_file_set_uint64 (results, group, "rss-growth-kb", rss_growth);
+	}
+	else if (g_key_file_has_group (baselines, group))
+	{
+		gdouble baseline_time;
+		guint64 baseline_growth;
+
+		baseline_time = g_key_file_get_double (baselines, group, "relative-time", NULL);
+		baseline_growth = g_key_file_get_uint64 (baselines, group, "rss-growth-kb", NULL);
+
+		if (baseline_time > 0)
+			g_assert_cmpfloat (relative_time, <=, baseline_time * (1 + tolerance));
+
+		if (baseline_growth > 0)
+			g_assert_cmpfloat (rss_growth, <=, baseline_growth * (1 + tolerance) + RSS_SLACK_KB);
+	}
+	else
+	{
+		g_test_skip ("No baseline, run make update-throughput-baselines");
+	}
+
+	g_free (group);
+}
+
+static void
+on_loaded (PlumaDocument *document,
+	   const GError  *error,
+	   gpointer       data)
+{
+	g_assert_no_error (error);
+
+	operation_completed = TRUE;
+}
+
+static void
+test_loader (Fixture       *fixture,
+	     gconstpointer  data)
+{
+	const PlumaEncoding *encoding;
+	gint64 best = G_MAXINT64;
+	gsize rss_growth = 0;
+	gint i;
+
+	encoding = pluma_encoding_get_from_charset (fixture->corpus->charset);
+
+	for (i = 0; i < RUNS; ++i)
+	{
+		PlumaDocument *document;
+		gint64 start;
+		gsize rss_start;
+
+		rss_start = reset_peak_rss ();
+
+		document = pluma_document_new ();
+		g_signal_connect (document, "loaded", G_CALLBACK (on_loaded), NULL);
+
+		operation_completed = FALSE;
+
+		start = g_get_monotonic_time ();
+		pluma_document_load (document, fixture->uri, encoding, 0, FALSE);
+
+		while (!operation_completed)
+		{
+			g_main_context_iteration (NULL, TRUE);
+		}
+
+		best = MIN (best, g_get_monotonic_time () - start);
+		rss_growth = MAX (rss_growth, get_rss_growth (rss_start));
+
+		/* without the last newline */
+		g_assert_cmpint (gtk_text_buffer_get_char_count (GTK_TEXT_BUFFER (document)),
+				 ==,
+				 g_utf8_strlen (fixture->text, fixture->text_length) - fixture->newline_length);
+
+		g_object_unref (document);
+	}
+
+	check_result ("loader", fixture, best, rss_growth);
+}
+
+static void
+on_saved (PlumaDocument *document,
+	  const GError  *error,
+	  gpointer       data)
+{
+	g_assert_no_error (error);
+
+	operation_completed = TRUE;
+}
+
+static void
+test_saver (Fixture       *fixture,
+	    gconstpointer  data)
+{
+	const PlumaEncoding *encoding;
+	PlumaDocument *document;
+	gint64 best = G_MAXINT64;
+	gsize rss_growth = 0;
+	gint i;
+
+	encoding = pluma_encoding_get_from_charset (fixture->corpus->charset);
+
+	document = pluma_document_new ();
+
+	/* as loaded, the saver adds the last newline */
+	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (document),
+				  fixture->text,
+				  fixture->text_length - fixture->newline_length);
+	pluma_document_set_newline_type (document, fixture->corpus->newline_type);
+
+	g_signal_connect (document, "saved", G_CALLBACK (on_saved), NULL);
+
+	for (i = 0; i < RUNS; ++i)
+	{
+		gint64 start;
+		gsize rss_start;
+
+		rss_start = reset_peak_rss ();
+
+		operation_completed = FALSE;
+
+		start = g_get_monotonic_time ();
+		pluma_document_save_as (document, fixture->uri, encoding, 0);
+
+		while (!operation_completed)
+		{
+			g_main_context_iteration (NULL, TRUE);
+		}
+
+		best = MIN (best, g_get_monotonic_time () - start);
+		rss_growth = MAX (rss_growth, get_rss_growth (rss_start));
+	}
+
+	g_object_unref (document);
+
+	check_result ("saver", fixture, best, rss_growth);
+}
+
+static void
+test_input_stream (Fixture       *fixture,
+		   gconstpointer  data)
+{
+	PlumaDocument *document;
+	gchar *buffer;
+	gint64 best = G_MAXINT64;
+	gsize rss_growth = 0;
+	gint i;
+
+	document = pluma_document_new ();
+
+	/* as loaded, the stream adds the last newline */
+	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (document),
+				  fixture->text,
+				  fixture->text_length - fixture->newline_length);
+
+	buffer = g_malloc (CHUNK_SIZE);
+
+	for (i = 0; i < RUNS; ++i)
+	{
+		GInputStream *in;
+		GError *error = NULL;
+		gint64 start;
+		gsize rss_start;
+		gssize read;
+		gsize total = 0;
+
+		rss_start = reset_peak_rss ();
+
+		start = g_get_monotonic_time ();
+
+		in = pluma_document_input_stream_new (GTK_TEXT_BUFFER (document),
+						      fixture->corpus->newline_type);
+
+		do
+		{
+			read = g_input_stream_read (in, buffer, CHUNK_SIZE, NULL, &error);
+			g_assert_no_error (error);
+
+			total += read;
+		} while (read > 0);
+
+		g_object_unref (in);
+
+		best = MIN (best, g_get_monotonic_time () - start);
+		rss_growth = MAX (rss_growth, get_rss_growth (rss_start));
+
+		g_assert_cmpuint (total, ==, fixture->text_length);
+	}
+
+	g_free (buffer);
+	g_object_unref (document);
+
+	check_result ("input-stream", fixture, best, rss_growth);
+}
+
+static void
+test_output_stream (Fixture       *fixture,
+		    gconstpointer  data)
+{
+	gint64 best = G_MAXINT64;
+	gsize rss_growth = 0;
+	gint i;
+
+	for (i = 0; i < RUNS; ++i)
+	{
+		PlumaDocument *document;
+		GOutputStream *out;
+		GError *error = NULL;
+		gint64 start;
+		gsize rss_start;
+		gsize written = 0;
+
+		rss_start = reset_peak_rss ();
+
+		document = pluma_document_new ();
+
+		start = g_get_monotonic_time ();
+
+		out = pluma_document_output_stream_new (document);
+
+		while (written < fixture->text_length)
+		{
+			gssize w;
+
+			w = g_output_stream_write (out,
+						   fixture->text + written,
+						   MIN (CHUNK_SIZE, fixture->text_length - written),
+						   NULL,
+						   &error);
+			g_assert_no_error (error);
+
+			written += w;
+		}
+
+		g_output_stream_close (out, NULL, &error);
+		g_assert_no_error (error);
+
+		g_object_unref (out);
+
+		best = MIN (best, g_get_monotonic_time () - start);
+		rss_growth = MAX (rss_growth, get_rss_growth (rss_start));
+
+		g_object_unref (document);
+	}
+
+	check_result ("output-stream", fixture, best, rss_growth);
+}
+
+static void
+add_tests (const gchar *pipeline,
+	   void (*test) (Fixture *, gconstpointer))
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (corpora); ++i)
+	{
+		gchar *path;
+
+		path = g_strdup_printf ("/throughput/%s/%s", pipeline, corpora[i].name);
+
+		g_test_add (path, Fixture, &corpora[i],
+			    fixture_setup, test, fixture_teardown);
+
+		g_free (path);
+	}
+}
+
+int main (int   argc,
+          char *argv[])
+{
+	const gchar *env;
+	GError *error = NULL;
+	gint ret;
+
+	g_test_init (&argc, &argv, NULL);
+
+	pluma_prefs_manager_app_init ();
+
+	env = g_getenv ("PLUMA_THROUGHPUT_TOLERANCE");
+	tolerance = env != NULL ? g_ascii_strtod (env, NULL) : DEFAULT_TOLERANCE;
+
+	baselines = g_key_file_new ();
+
+	if (g_getenv ("PLUMA_THROUGHPUT_UPDATE_BASELINES") != NULL)
+	{
+		gchar *header;
+
+		results = g_key_file_new ();
+
+		/* g_key_file_to_data() only writes the comments it knows of */
+		g_key_file_load_from_file (baselines, BASELINES_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL);
+		header = g_key_file_get_comment (baselines, NULL, NULL, NULL);
+
+		if (header != NULL)
+			g_key_file_set_comment (results, NULL, NULL, header, NULL);
+
+		g_free (header);
+	}
+	else
+	{
+		g_key_file_load_from_file (baselines, BASELINES_FILE, G_KEY_FILE_NONE, NULL);
+	}
+
+	calibration_usec = time_calibration ();
+	g_print ("Calibration: %" G_GINT64_FORMAT " us\n", calibration_usec);
+
+	tmp_dir = g_dir_make_tmp ("pluma-throughput-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	add_tests ("loader", test_loader);
+	add_tests ("saver", test_saver);
+	add_tests ("input-stream", test_input_stream);
+	add_tests ("output-stream", test_output_stream);
+
+	ret = g_test_run ();
+
+	if (results != NULL)
+	{
+		gchar *data;
+		gsize length;
+
+		data = g_key_file_to_data (results, &length, NULL);
+
+		if (!g_file_set_contents (BASELINES_FILE, data, length, &error))
+		{
+			g_printerr ("Could not store the baselines: %s\n", error->message);
+			g_error_free (error);
+			ret = 1;
+		}
+
+		g_free (data);
+		g_key_file_free (results);
+	}
+
+	g_key_file_free (baselines);
+
+	g_rmdir (tmp_dir);
+	g_free (tmp_dir);
+
+	return ret;
+}